@@ -65,6 +65,16 @@ CREATE TABLE IF NOT EXISTS game_moves (
     FOREIGN KEY (player_id) REFERENCES users(user_id)
 );
 
+-- Match logs table: one binary event log per match (see src/server/move_log.h)
+CREATE TABLE IF NOT EXISTS match_logs (
+    match_id INTEGER PRIMARY KEY,
+    format_version INTEGER NOT NULL,
+    event_count INTEGER NOT NULL,
+    log BLOB NOT NULL,
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    FOREIGN KEY (match_id) REFERENCES matches(match_id)
+);
+
 -- Challenge requests table
 CREATE TABLE IF NOT EXISTS challenge_requests (
     challenge_id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -81,7 +91,9 @@ CREATE TABLE IF NOT EXISTS challenge_requests (
 CREATE INDEX IF NOT EXISTS idx_users_username ON users(username);
 CREATE INDEX IF NOT EXISTS idx_sessions_user ON sessions(user_id);
 CREATE INDEX IF NOT EXISTS idx_sessions_active ON sessions(is_active);
-CREATE INDEX IF NOT EXISTS idx_matches_players ON matches(player1_id, player2_id);
+-- Per-side history indexes: one seek per side serves a keyset page of a user's history
+CREATE INDEX IF NOT EXISTS idx_matches_p1_history ON matches(player1_id, end_time, match_id) WHERE status = 'completed';
+CREATE INDEX IF NOT EXISTS idx_matches_p2_history ON matches(player2_id, end_time, match_id) WHERE status = 'completed';
 CREATE INDEX IF NOT EXISTS idx_game_moves_match ON game_moves(match_id);
 CREATE INDEX IF NOT EXISTS idx_online_status ON online_players(status);
 CREATE INDEX IF NOT EXISTS idx_challenges_challenged ON challenge_requests(challenged_id);
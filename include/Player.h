@@ -1,9 +0,0 @@
-#pragma once
-
-typedef struct {
-  int id;
-  char *name;
-  int money;
-  int jailed;
-  int position;
-} Game_Player;
@@ -0,0 +1,1102 @@
+/*
+ * Lockstep Batch Simulator
+ *
+ * Plays thousands of games side by side, one dice roll per game per step,
+ * with the game state in structure-of-arrays form (one array per field,
+ * indexed by lane) so that the common turn runs in SIMD registers:
+ * - Vector step: dice (per-lane xorshift), movement, GO salary, taxes and
+ *   rent (gathered from per-lane owner and rent tables, utilities times the
+ *   dice) for 8 lanes (AVX2) or 4 lanes (SSE2) at once
+ * - Lanes the vector step cannot finish (jail, a third double, Go to Jail,
+ *   cards, buying, debt, the roll limit) keep their state and are replayed
+ *   with the same dice by the scalar step, which mirrors game_state.c
+ * - A lane whose game ends starts the next one, until all games are played
+ *
+ * Both players use the "always" policy of monopoly_sim (buy everything
+ * affordable, never build), and the rules are the server's current ones
+ * (move log version 4). Dice come from a xorshift generator rather than
+ * the rand_r of the server, so games are not the same as monopoly_sim's:
+ * -v checks the engine statistically against the server rules instead,
+ * and checks that every kernel gives exactly the scalar step's results.
+ *
+ * Usage: batch_sim [-n games] [-l lanes] [-t threads] [-m max_rolls]
+ *                  [-s seed] [-k scalar|sse2|avx2] [-v]
+ */
+
+#include "game_state.h"
+#include "card_deck.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_X86 1
+#endif
+
+#define BATCH_WIDTH 8           // Lanes are allocated in multiples of the widest kernel
+#define LENGTH_BUCKET 10        // Rolls per game length histogram bucket
+#define LENGTH_BUCKETS 51       // Last bucket collects everything longer
+#define STAT_GROUPS 64          // Independent slices of the games for the landing test
+#define VALIDATE_Z 4.5          // |z| above this fails validation (p < 1e-5 per test)
+
+// What landing on a square does; kinds below SQ_CHANCE are vectorized
+typedef enum {
+    SQ_PLAIN,                   // Jail (visiting), Free Parking
+    SQ_GO,
+    SQ_TAX,
+    SQ_STREET,
+    SQ_RAILROAD,
+    SQ_UTILITY,
+    SQ_CHANCE,
+    SQ_CHEST,
+    SQ_GOTO_JAIL
+} SquareKind;
+
+static const int32_t square_kinds[TOTAL_PROPERTIES] = {
+    SQ_GO, SQ_STREET, SQ_CHEST, SQ_STREET, SQ_TAX,
+    SQ_RAILROAD, SQ_STREET, SQ_CHANCE, SQ_STREET, SQ_STREET,
+    SQ_PLAIN, SQ_STREET, SQ_UTILITY, SQ_STREET, SQ_STREET,
+    SQ_RAILROAD, SQ_STREET, SQ_CHEST, SQ_STREET, SQ_STREET,
+    SQ_PLAIN, SQ_STREET, SQ_CHANCE, SQ_STREET, SQ_STREET,
+    SQ_RAILROAD, SQ_STREET, SQ_STREET, SQ_UTILITY, SQ_STREET,
+    SQ_GOTO_JAIL, SQ_STREET, SQ_STREET, SQ_CHEST, SQ_STREET,
+    SQ_RAILROAD, SQ_CHANCE, SQ_STREET, SQ_TAX, SQ_STREET
+};
+
+// Income Tax and Luxury Tax
+static const int32_t square_taxes[TOTAL_PROPERTIES] = {
+    [4] = 200, [38] = 100
+};
+
+static const char* square_names[TOTAL_PROPERTIES] = {
+    "GO", "Mediterranean", "Community Chest", "Baltic", "Income Tax",
+    "Reading RR", "Oriental", "Chance", "Vermont", "Connecticut",
+    "Jail", "St. Charles", "Electric Co", "States", "Virginia",
+    "Pennsylvania RR", "St. James", "Community Chest", "Tennessee", "New York",
+    "Free Parking", "Kentucky", "Chance", "Indiana", "Illinois",
+    "B&O RR", "Atlantic", "Ventnor", "Water Works", "Marvin Gardens",
+    "Go to Jail", "Pacific", "North Carolina", "Community Chest", "Pennsylvania",
+    "Short Line RR", "Chance", "Park Place", "Luxury Tax", "Boardwalk"
+};
+
+typedef enum {
+    KERNEL_SCALAR,
+    KERNEL_SSE2,
+    KERNEL_AVX2,
+    KERNEL_COUNT
+} Kernel;
+
+static const char* kernel_names[KERNEL_COUNT] = { "scalar", "sse2", "avx2" };
+
+// Totals of one engine run (per worker, merged at the end)
+typedef struct {
+    long games;
+    long wins[2];
+    long unfinished;
+    long rolls;
+    long finished_rolls;
+    double finished_rolls_sq;
+    long length_hist[LENGTH_BUCKETS];
+    long group_rolls[STAT_GROUPS];
+    long landings[STAT_GROUPS][TOTAL_PROPERTIES];
+} BatchStats;
+
+// Games in structure-of-arrays form. Per-lane arrays are indexed by lane,
+// per-player ones by player * lanes + lane and per-square ones by
+// square * lanes + lane; every array starts on a cache line
+typedef struct {
+    int lanes;
+    int max_rolls;
+    int running;                // Lanes still playing
+    int next_game;              // Game index the next lane to finish starts
+    int end_game;               // One past the last game index of this batch
+    unsigned int seed;
+
+    // Vector step
+    uint32_t* rng;
+    int32_t* die1;
+    int32_t* die2;
+    int32_t* active;
+    int32_t* current;
+    int32_t* rolls;
+    int32_t* landed;            // Square the last roll ended on (vector step)
+    int32_t* fast;              // Nonzero if the vector step played the last roll
+    int32_t* position;          // [2][lanes]
+    int32_t* money;             // [2][lanes]
+    int32_t* jailed;            // [2][lanes]
+    int32_t* doubles;           // [2][lanes]
+    int32_t* owner;             // [TOTAL_PROPERTIES][lanes], -1 if unowned
+    int32_t* rent;              // [TOTAL_PROPERTIES][lanes], utilities: dice multiplier
+
+    // Scalar step only
+    int32_t* jail_turns;        // [2][lanes]
+    int32_t* jail_free;         // [2][lanes]
+    int32_t* game_index;        // Statistics group of the lane's game
+    BoardMask* owned;           // [2][lanes]
+    CardDeck* decks;            // [DECK_COUNT][lanes]
+
+    void* memory;
+    BatchStats stats;
+} Batch;
+
+#define LANE(b, array, row, lane) ((b)->array[(size_t)(row) * (b)->lanes + (lane)])
+
+typedef struct {
+    int games;
+    int lanes;
+    int max_rolls;
+    unsigned int seed;
+    Kernel kernel;
+} BatchJob;
+
+typedef struct {
+    const BatchJob* job;
+    int first;
+    int last;
+    BatchStats stats;
+} BatchWorker;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Per-game seeds, spread over the seed space like monopoly_sim's
+static unsigned int game_seed(unsigned int seed, int index) {
+    return (seed + (unsigned int)index) * 2654435761u;
+}
+
+static int kernel_supported(Kernel kernel) {
+    switch (kernel) {
+        case KERNEL_SCALAR:
+            return 1;
+#ifdef BATCH_X86
+        case KERNEL_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return 0;
+    }
+}
+
+// ============ Batch ============
+
+static void* carve(char** cursor, size_t bytes) {
+    void* block = *cursor;
+    *cursor += (bytes + 63) & ~(size_t)63;
+    return block;
+}
+
+static int batch_alloc(Batch* b, int lanes) {
+    memset(b, 0, sizeof(*b));
+    b->lanes = (lanes + BATCH_WIDTH - 1) / BATCH_WIDTH * BATCH_WIDTH;
+    size_t n = (size_t)b->lanes;
+    size_t lane_arrays = 9 * n * sizeof(int32_t) + 6 * 2 * n * sizeof(int32_t) +
+                         2 * TOTAL_PROPERTIES * n * sizeof(int32_t);
+    size_t total = lane_arrays + 2 * n * sizeof(BoardMask) + DECK_COUNT * n * sizeof(CardDeck) +
+                   19 * 64;   // Rounding of every array to a cache line
+    b->memory = aligned_alloc(64, (total + 63) & ~(size_t)63);
+    if (!b->memory) return -1;
+
+    char* cursor = b->memory;
+    b->rng = carve(&cursor, n * sizeof(uint32_t));
+    b->die1 = carve(&cursor, n * sizeof(int32_t));
+    b->die2 = carve(&cursor, n * sizeof(int32_t));
+    b->active = carve(&cursor, n * sizeof(int32_t));
+    b->current = carve(&cursor, n * sizeof(int32_t));
+    b->rolls = carve(&cursor, n * sizeof(int32_t));
+    b->landed = carve(&cursor, n * sizeof(int32_t));
+    b->fast = carve(&cursor, n * sizeof(int32_t));
+    b->position = carve(&cursor, 2 * n * sizeof(int32_t));
+    b->money = carve(&cursor, 2 * n * sizeof(int32_t));
+    b->jailed = carve(&cursor, 2 * n * sizeof(int32_t));
+    b->doubles = carve(&cursor, 2 * n * sizeof(int32_t));
+    b->owner = carve(&cursor, TOTAL_PROPERTIES * n * sizeof(int32_t));
+    b->rent = carve(&cursor, TOTAL_PROPERTIES * n * sizeof(int32_t));
+    b->jail_turns = carve(&cursor, 2 * n * sizeof(int32_t));
+    b->jail_free = carve(&cursor, 2 * n * sizeof(int32_t));
+    b->game_index = carve(&cursor, n * sizeof(int32_t));
+    b->owned = carve(&cursor, 2 * n * sizeof(BoardMask));
+    b->decks = carve(&cursor, DECK_COUNT * n * sizeof(CardDeck));
+    memset(b->memory, 0, (size_t)(cursor - (char*)b->memory));
+    return 0;
+}
+
+static void batch_free(Batch* b) {
+    free(b->memory);
+    b->memory = NULL;
+}
+
+// Set a lane up for a new game (game_init_state for one lane)
+static void start_lane(Batch* b, int lane, int index) {
+    unsigned int seed = game_seed(b->seed, index);
+    b->game_index[lane] = index;
+    b->rng[lane] = seed ? seed : 1;   // xorshift never leaves 0
+    b->active[lane] = 1;
+    b->current[lane] = 0;
+    b->rolls[lane] = 0;
+    for (int p = 0; p < 2; p++) {
+        LANE(b, position, p, lane) = 0;
+        LANE(b, money, p, lane) = STARTING_MONEY;
+        LANE(b, jailed, p, lane) = 0;
+        LANE(b, doubles, p, lane) = 0;
+        LANE(b, jail_turns, p, lane) = 0;
+        LANE(b, jail_free, p, lane) = 0;
+        LANE(b, owned, p, lane) = 0;
+    }
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        LANE(b, owner, i, lane) = -1;
+        LANE(b, rent, i, lane) = 0;
+    }
+    unsigned int deck_rng = seed ^ 0x5bd1e995u;
+    for (int d = 0; d < DECK_COUNT; d++) {
+        card_deck_shuffle(&LANE(b, decks, d, lane), &deck_rng);
+    }
+}
+
+static void batch_start(Batch* b, int first, int last, int max_rolls, unsigned int seed) {
+    b->max_rolls = max_rolls;
+    b->seed = seed;
+    b->next_game = first;
+    b->end_game = last;
+    b->running = 0;
+    for (int lane = 0; lane < b->lanes; lane++) {
+        if (b->next_game < b->end_game) {
+            start_lane(b, lane, b->next_game++);
+            b->running++;
+        } else {
+            b->active[lane] = 0;
+        }
+    }
+}
+
+// Record a finished game (winner -1: stopped at the roll limit) and start
+// the next one in the lane, or retire the lane
+static void finish_game(Batch* b, int lane, int winner) {
+    BatchStats* stats = &b->stats;
+    int rolls = b->rolls[lane];
+    stats->games++;
+    stats->rolls += rolls;
+    stats->group_rolls[b->game_index[lane] % STAT_GROUPS] += rolls;
+    if (winner >= 0) {
+        stats->wins[winner]++;
+        stats->finished_rolls += rolls;
+        stats->finished_rolls_sq += (double)rolls * rolls;
+        int bucket = rolls / LENGTH_BUCKET;
+        stats->length_hist[bucket < LENGTH_BUCKETS ? bucket : LENGTH_BUCKETS - 1]++;
+    } else {
+        stats->unfinished++;
+    }
+
+    if (b->next_game < b->end_game) {
+        start_lane(b, lane, b->next_game++);
+    } else {
+        b->active[lane] = 0;
+        b->running--;
+    }
+}
+
+// ============ Scalar Step ============
+
+// Rent of an owned square under the current rules (see property_rent)
+static int lane_square_rent(const Batch* b, int lane, int owner, int pos) {
+    BoardMask owned = LANE(b, owned, owner, lane);
+    switch (square_kinds[pos]) {
+        case SQ_RAILROAD:
+            return game_table_rent(pos, board_count(owned, BOARD_RAILROADS) - 1);
+        case SQ_UTILITY:
+            return game_table_rent(pos, board_count(owned, BOARD_UTILITIES) - 1);
+        default:
+            return game_table_rent(pos, 0) * (board_owns_group(owned, pos) ? 2 : 1);
+    }
+}
+
+static void lane_buy(Batch* b, int lane, int player, int pos) {
+    LANE(b, money, player, lane) -= game_property_price(pos);
+    LANE(b, owner, pos, lane) = player;
+    LANE(b, owned, player, lane) |= BOARD_BIT(pos);
+
+    BoardMask group = board_group_mask(pos);
+    while (group) {
+        int i = board_pop_lowest(&group);
+        int owner = LANE(b, owner, i, lane);
+        LANE(b, rent, i, lane) = owner < 0 ? 0 : lane_square_rent(b, lane, owner, i);
+    }
+}
+
+static void lane_send_to_jail(Batch* b, int lane, int player) {
+    LANE(b, doubles, player, lane) = 0;
+    if (LANE(b, jail_free, player, lane) > 0) {
+        LANE(b, jail_free, player, lane)--;
+        return;
+    }
+    LANE(b, jailed, player, lane) = 1;
+    LANE(b, position, player, lane) = JAIL_POSITION;
+    LANE(b, jail_turns, player, lane) = 0;
+}
+
+static int lane_land(Batch* b, int lane, int player, int pos, int dice);
+
+static int lane_advance(Batch* b, int lane, int player, int pos, int dice) {
+    if (pos < LANE(b, position, player, lane) && pos != 0) {
+        LANE(b, money, player, lane) += GO_BONUS;
+    }
+    LANE(b, position, player, lane) = pos;
+    return lane_land(b, lane, player, pos, dice);
+}
+
+// Draw and apply a card (see draw_card); returns 1 if the player is in debt
+static int lane_card(Batch* b, int lane, int player, DeckKind kind, int dice) {
+    CardDeck* deck = &LANE(b, decks, kind, lane);
+    const CardDef* card = card_def(kind, card_deck_draw(deck));
+    int32_t* money = &LANE(b, money, player, lane);
+    int32_t* other = &LANE(b, money, 1 - player, lane);
+
+    // Nobody builds, so repairs cost nothing
+    int amount = 0;
+    if (card->action == CARD_ACT_MONEY) {
+        amount = card->amount;
+    } else if (card->action == CARD_ACT_EACH_PLAYER) {
+        amount = card->amount;
+        if (amount > 0 && amount > *other) {
+            amount = *other > 0 ? *other : 0;
+        }
+        *other -= amount;
+    }
+    *money += amount;
+
+    int pos = LANE(b, position, player, lane);
+    switch (card->action) {
+        case CARD_ACT_ADVANCE:
+            return lane_advance(b, lane, player, card->target, dice);
+        case CARD_ACT_NEAREST:
+            return lane_advance(b, lane, player, board_next_in(board_group_masks[card->target], pos), dice);
+        case CARD_ACT_BACK:
+            pos = (pos + TOTAL_PROPERTIES - card->amount) % TOTAL_PROPERTIES;
+            LANE(b, position, player, lane) = pos;
+            return lane_land(b, lane, player, pos, dice);
+        case CARD_ACT_JAIL:
+            lane_send_to_jail(b, lane, player);
+            return 0;
+        case CARD_ACT_JAIL_FREE:
+            LANE(b, jail_free, player, lane)++;
+            return 0;
+        default:
+            return *money < 0;
+    }
+}
+
+// Resolve a landing, buying whatever is affordable (see handle_landing);
+// returns 1 if the player is in debt
+static int lane_land(Batch* b, int lane, int player, int pos, int dice) {
+    int32_t* money = &LANE(b, money, player, lane);
+
+    switch (square_kinds[pos]) {
+        case SQ_GO:
+            *money += GO_BONUS;
+            return 0;
+        case SQ_STREET:
+        case SQ_RAILROAD:
+        case SQ_UTILITY: {
+            int owner = LANE(b, owner, pos, lane);
+            if (owner < 0) {
+                if (*money >= game_property_price(pos)) lane_buy(b, lane, player, pos);
+                return 0;
+            }
+            if (owner == player) return 0;
+            int rent = LANE(b, rent, pos, lane);
+            if (square_kinds[pos] == SQ_UTILITY) rent *= dice;
+            *money -= rent;
+            LANE(b, money, owner, lane) += rent;
+            return *money < 0;
+        }
+        case SQ_TAX:
+            *money -= square_taxes[pos];
+            return *money < 0;
+        case SQ_CHANCE:
+            return lane_card(b, lane, player, DECK_CHANCE, dice);
+        case SQ_CHEST:
+            return lane_card(b, lane, player, DECK_COMMUNITY_CHEST, dice);
+        case SQ_GOTO_JAIL:
+            lane_send_to_jail(b, lane, player);
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+static void lane_next_player(Batch* b, int lane) {
+    LANE(b, doubles, b->current[lane], lane) = 0;
+    b->current[lane] ^= 1;
+}
+
+// Count where the roll ended, then end the game on a bankruptcy or at the
+// roll limit
+static void lane_end_roll(Batch* b, int lane, int roller, int bankrupt) {
+    b->stats.landings[b->game_index[lane] % STAT_GROUPS][LANE(b, position, roller, lane)]++;
+    if (bankrupt) {
+        finish_game(b, lane, 1 - roller);
+    } else if (b->rolls[lane] >= b->max_rolls) {
+        finish_game(b, lane, -1);
+    }
+}
+
+// One roll of one lane with the dice already in die1/die2 (game_roll_dice
+// followed by the policy's buy or bankruptcy)
+static void lane_step(Batch* b, int lane) {
+    if (!b->active[lane]) return;
+
+    int player = b->current[lane];
+    int die1 = b->die1[lane];
+    int die2 = b->die2[lane];
+    int total = die1 + die2;
+    int is_doubles = die1 == die2;
+    int left_jail = 0;
+    b->rolls[lane]++;
+
+    if (LANE(b, jailed, player, lane)) {
+        int turns = ++LANE(b, jail_turns, player, lane);
+        if (is_doubles) {
+            left_jail = 1;
+        } else if (turns >= MAX_JAIL_TURNS) {
+            if (LANE(b, money, player, lane) < JAIL_FINE) {
+                lane_end_roll(b, lane, player, 1);
+                return;
+            }
+            LANE(b, money, player, lane) -= JAIL_FINE;
+            left_jail = 1;
+        } else {
+            lane_next_player(b, lane);
+            lane_end_roll(b, lane, player, 0);
+            return;
+        }
+        LANE(b, jailed, player, lane) = 0;
+        LANE(b, jail_turns, player, lane) = 0;
+    }
+
+    if (is_doubles && !left_jail) {
+        if (++LANE(b, doubles, player, lane) >= 3) {
+            lane_send_to_jail(b, lane, player);
+            lane_next_player(b, lane);
+            lane_end_roll(b, lane, player, 0);
+            return;
+        }
+    } else {
+        LANE(b, doubles, player, lane) = 0;
+    }
+
+    int old_pos = LANE(b, position, player, lane);
+    int pos = (old_pos + total) % TOTAL_PROPERTIES;
+    LANE(b, position, player, lane) = pos;
+    if (pos < old_pos && pos != 0) {
+        LANE(b, money, player, lane) += GO_BONUS;
+    }
+
+    int debt = lane_land(b, lane, player, pos, total);
+    if (!debt && (!is_doubles || left_jail)) {
+        lane_next_player(b, lane);
+    }
+    lane_end_roll(b, lane, player, debt);
+}
+
+// xorshift32, one draw per roll: the high and low halves scaled to 1-6
+static void roll_scalar(Batch* b) {
+    for (int lane = 0; lane < b->lanes; lane++) {
+        uint32_t x = b->rng[lane];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        b->rng[lane] = x;
+        b->die1[lane] = (int32_t)(((x >> 16) * 6) >> 16) + 1;
+        b->die2[lane] = (int32_t)(((x & 0xFFFF) * 6) >> 16) + 1;
+    }
+}
+
+static void step_scalar(Batch* b) {
+    roll_scalar(b);
+    memset(b->fast, 0, (size_t)b->lanes * sizeof(int32_t));
+}
+
+// ============ Vector Step ============
+
+#ifdef BATCH_X86
+
+// The common turn for 4 lanes. SSE2 has no gather, blend or 32-bit
+// multiply: gathers are scalar loads, blends are and/andnot/or, and the
+// utility multiply uses 16-bit lanes (rent multiplier and dice both fit)
+#define SEL(mask, a, b) _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a))
+
+__attribute__((target("sse2")))
+static void step_sse2(Batch* b) {
+    const int n = b->lanes;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i low16 = _mm_set1_epi32(0xFFFF);
+    const __m128i limit = _mm_set1_epi32(b->max_rolls - 1);
+    _Alignas(16) int32_t sq[4];
+
+    for (int i = 0; i < n; i += 4) {
+        __m128i x = _mm_load_si128((const __m128i*)&b->rng[i]);
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        _mm_store_si128((__m128i*)&b->rng[i], x);
+        __m128i hi = _mm_srli_epi32(x, 16);
+        __m128i lo = _mm_and_si128(x, low16);
+        hi = _mm_add_epi32(_mm_slli_epi32(hi, 2), _mm_slli_epi32(hi, 1));   // * 6
+        lo = _mm_add_epi32(_mm_slli_epi32(lo, 2), _mm_slli_epi32(lo, 1));
+        __m128i d1 = _mm_add_epi32(_mm_srli_epi32(hi, 16), one);
+        __m128i d2 = _mm_add_epi32(_mm_srli_epi32(lo, 16), one);
+        _mm_store_si128((__m128i*)&b->die1[i], d1);
+        _mm_store_si128((__m128i*)&b->die2[i], d2);
+
+        __m128i cur = _mm_load_si128((const __m128i*)&b->current[i]);
+        __m128i second = _mm_cmpeq_epi32(cur, one);
+        __m128i pos0 = _mm_load_si128((const __m128i*)&b->position[i]);
+        __m128i pos1 = _mm_load_si128((const __m128i*)&b->position[n + i]);
+        __m128i money0 = _mm_load_si128((const __m128i*)&b->money[i]);
+        __m128i money1 = _mm_load_si128((const __m128i*)&b->money[n + i]);
+        __m128i dbl0 = _mm_load_si128((const __m128i*)&b->doubles[i]);
+        __m128i dbl1 = _mm_load_si128((const __m128i*)&b->doubles[n + i]);
+        __m128i jailed = SEL(second, _mm_load_si128((const __m128i*)&b->jailed[i]),
+                             _mm_load_si128((const __m128i*)&b->jailed[n + i]));
+        __m128i rolls = _mm_load_si128((const __m128i*)&b->rolls[i]);
+
+        __m128i total = _mm_add_epi32(d1, d2);
+        __m128i is_doubles = _mm_cmpeq_epi32(d1, d2);
+        __m128i dbl = _mm_and_si128(is_doubles, _mm_add_epi32(SEL(second, dbl0, dbl1), one));
+        __m128i ok = _mm_cmpgt_epi32(_mm_load_si128((const __m128i*)&b->active[i]), zero);
+        ok = _mm_and_si128(ok, _mm_cmpeq_epi32(jailed, zero));
+        ok = _mm_andnot_si128(_mm_cmpgt_epi32(dbl, _mm_set1_epi32(2)), ok);
+        ok = _mm_and_si128(ok, _mm_cmpgt_epi32(limit, rolls));
+
+        // Move, with the salary for passing or landing on GO
+        __m128i pos = _mm_add_epi32(SEL(second, pos0, pos1), total);
+        __m128i wrapped = _mm_cmpgt_epi32(pos, _mm_set1_epi32(TOTAL_PROPERTIES - 1));
+        pos = _mm_sub_epi32(pos, _mm_and_si128(wrapped, _mm_set1_epi32(TOTAL_PROPERTIES)));
+        __m128i money = _mm_add_epi32(SEL(second, money0, money1),
+                                      _mm_and_si128(wrapped, _mm_set1_epi32(GO_BONUS)));
+        __m128i other_money = SEL(second, money1, money0);
+
+        _mm_store_si128((__m128i*)sq, pos);
+        __m128i kind = _mm_setr_epi32(square_kinds[sq[0]], square_kinds[sq[1]],
+                                      square_kinds[sq[2]], square_kinds[sq[3]]);
+        __m128i tax = _mm_setr_epi32(square_taxes[sq[0]], square_taxes[sq[1]],
+                                     square_taxes[sq[2]], square_taxes[sq[3]]);
+        __m128i owner = _mm_setr_epi32(LANE(b, owner, sq[0], i), LANE(b, owner, sq[1], i + 1),
+                                       LANE(b, owner, sq[2], i + 2), LANE(b, owner, sq[3], i + 3));
+        __m128i rent = _mm_setr_epi32(LANE(b, rent, sq[0], i), LANE(b, rent, sq[1], i + 1),
+                                      LANE(b, rent, sq[2], i + 2), LANE(b, rent, sq[3], i + 3));
+        ok = _mm_and_si128(ok, _mm_cmpgt_epi32(_mm_set1_epi32(SQ_CHANCE), kind));
+        money = _mm_sub_epi32(money, tax);
+
+        // Buying is left to the scalar step; rent goes to the other player
+        __m128i property = _mm_cmpgt_epi32(kind, _mm_set1_epi32(SQ_TAX));
+        __m128i unowned = _mm_cmpeq_epi32(owner, _mm_set1_epi32(-1));
+        ok = _mm_andnot_si128(_mm_and_si128(property, unowned), ok);
+        __m128i pays = _mm_cmpeq_epi32(owner, _mm_xor_si128(cur, one));
+        __m128i multiplier = SEL(_mm_cmpeq_epi32(kind, _mm_set1_epi32(SQ_UTILITY)), one, total);
+        rent = _mm_and_si128(pays, _mm_mullo_epi16(rent, multiplier));
+        money = _mm_sub_epi32(money, rent);
+        other_money = _mm_add_epi32(other_money, rent);
+        ok = _mm_andnot_si128(_mm_cmpgt_epi32(zero, money), ok);
+
+        // Commit the lanes the vector step finished
+        __m128i first_ok = _mm_andnot_si128(second, ok);
+        __m128i second_ok = _mm_and_si128(second, ok);
+        _mm_store_si128((__m128i*)&b->position[i], SEL(first_ok, pos0, pos));
+        _mm_store_si128((__m128i*)&b->position[n + i], SEL(second_ok, pos1, pos));
+        _mm_store_si128((__m128i*)&b->money[i], SEL(ok, money0, SEL(second, money, other_money)));
+        _mm_store_si128((__m128i*)&b->money[n + i], SEL(ok, money1, SEL(second, other_money, money)));
+        _mm_store_si128((__m128i*)&b->doubles[i], SEL(first_ok, dbl0, dbl));
+        _mm_store_si128((__m128i*)&b->doubles[n + i], SEL(second_ok, dbl1, dbl));
+        _mm_store_si128((__m128i*)&b->current[i],
+                        _mm_xor_si128(cur, _mm_andnot_si128(is_doubles, _mm_and_si128(ok, one))));
+        _mm_store_si128((__m128i*)&b->rolls[i], _mm_sub_epi32(rolls, ok));
+        _mm_store_si128((__m128i*)&b->landed[i], pos);
+        _mm_store_si128((__m128i*)&b->fast[i], ok);
+    }
+}
+
+#undef SEL
+
+// The same turn for 8 lanes, with hardware gathers from the square tables
+// and the per-lane owner and rent tables
+__attribute__((target("avx2")))
+static void step_avx2(Batch* b) {
+    const int n = b->lanes;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i low16 = _mm256_set1_epi32(0xFFFF);
+    const __m256i limit = _mm256_set1_epi32(b->max_rolls - 1);
+    const __m256i stride = _mm256_set1_epi32(n);
+    const __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int i = 0; i < n; i += 8) {
+        __m256i x = _mm256_load_si256((const __m256i*)&b->rng[i]);
+        x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+        x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+        x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+        _mm256_store_si256((__m256i*)&b->rng[i], x);
+        __m256i hi = _mm256_srli_epi32(x, 16);
+        __m256i lo = _mm256_and_si256(x, low16);
+        hi = _mm256_add_epi32(_mm256_slli_epi32(hi, 2), _mm256_slli_epi32(hi, 1));   // * 6
+        lo = _mm256_add_epi32(_mm256_slli_epi32(lo, 2), _mm256_slli_epi32(lo, 1));
+        __m256i d1 = _mm256_add_epi32(_mm256_srli_epi32(hi, 16), one);
+        __m256i d2 = _mm256_add_epi32(_mm256_srli_epi32(lo, 16), one);
+        _mm256_store_si256((__m256i*)&b->die1[i], d1);
+        _mm256_store_si256((__m256i*)&b->die2[i], d2);
+
+        __m256i cur = _mm256_load_si256((const __m256i*)&b->current[i]);
+        __m256i second = _mm256_cmpeq_epi32(cur, one);
+        __m256i pos0 = _mm256_load_si256((const __m256i*)&b->position[i]);
+        __m256i pos1 = _mm256_load_si256((const __m256i*)&b->position[n + i]);
+        __m256i money0 = _mm256_load_si256((const __m256i*)&b->money[i]);
+        __m256i money1 = _mm256_load_si256((const __m256i*)&b->money[n + i]);
+        __m256i dbl0 = _mm256_load_si256((const __m256i*)&b->doubles[i]);
+        __m256i dbl1 = _mm256_load_si256((const __m256i*)&b->doubles[n + i]);
+        __m256i jailed = _mm256_blendv_epi8(_mm256_load_si256((const __m256i*)&b->jailed[i]),
+                                            _mm256_load_si256((const __m256i*)&b->jailed[n + i]), second);
+        __m256i rolls = _mm256_load_si256((const __m256i*)&b->rolls[i]);
+
+        __m256i total = _mm256_add_epi32(d1, d2);
+        __m256i is_doubles = _mm256_cmpeq_epi32(d1, d2);
+        __m256i dbl = _mm256_and_si256(is_doubles,
+                                       _mm256_add_epi32(_mm256_blendv_epi8(dbl0, dbl1, second), one));
+        __m256i ok = _mm256_cmpgt_epi32(_mm256_load_si256((const __m256i*)&b->active[i]), zero);
+        ok = _mm256_and_si256(ok, _mm256_cmpeq_epi32(jailed, zero));
+        ok = _mm256_andnot_si256(_mm256_cmpgt_epi32(dbl, _mm256_set1_epi32(2)), ok);
+        ok = _mm256_and_si256(ok, _mm256_cmpgt_epi32(limit, rolls));
+
+        // Move, with the salary for passing or landing on GO
+        __m256i pos = _mm256_add_epi32(_mm256_blendv_epi8(pos0, pos1, second), total);
+        __m256i wrapped = _mm256_cmpgt_epi32(pos, _mm256_set1_epi32(TOTAL_PROPERTIES - 1));
+        pos = _mm256_sub_epi32(pos, _mm256_and_si256(wrapped, _mm256_set1_epi32(TOTAL_PROPERTIES)));
+        __m256i money = _mm256_add_epi32(_mm256_blendv_epi8(money0, money1, second),
+                                         _mm256_and_si256(wrapped, _mm256_set1_epi32(GO_BONUS)));
+        __m256i other_money = _mm256_blendv_epi8(money1, money0, second);
+
+        __m256i kind = _mm256_i32gather_epi32(square_kinds, pos, 4);
+        __m256i tax = _mm256_i32gather_epi32(square_taxes, pos, 4);
+        __m256i slot = _mm256_add_epi32(_mm256_mullo_epi32(pos, stride),
+                                        _mm256_add_epi32(_mm256_set1_epi32(i), iota));
+        __m256i owner = _mm256_i32gather_epi32(b->owner, slot, 4);
+        ok = _mm256_and_si256(ok, _mm256_cmpgt_epi32(_mm256_set1_epi32(SQ_CHANCE), kind));
+        money = _mm256_sub_epi32(money, tax);
+
+        // Buying is left to the scalar step; rent goes to the other player
+        __m256i property = _mm256_cmpgt_epi32(kind, _mm256_set1_epi32(SQ_TAX));
+        __m256i unowned = _mm256_cmpeq_epi32(owner, _mm256_set1_epi32(-1));
+        ok = _mm256_andnot_si256(_mm256_and_si256(property, unowned), ok);
+        __m256i pays = _mm256_cmpeq_epi32(owner, _mm256_xor_si256(cur, one));
+        __m256i rent = _mm256_mask_i32gather_epi32(zero, b->rent, slot, pays, 4);
+        __m256i utility = _mm256_cmpeq_epi32(kind, _mm256_set1_epi32(SQ_UTILITY));
+        rent = _mm256_mullo_epi32(rent, _mm256_blendv_epi8(one, total, utility));
+        money = _mm256_sub_epi32(money, rent);
+        other_money = _mm256_add_epi32(other_money, rent);
+        ok = _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, money), ok);
+
+        // Commit the lanes the vector step finished
+        __m256i first_ok = _mm256_andnot_si256(second, ok);
+        __m256i second_ok = _mm256_and_si256(second, ok);
+        _mm256_store_si256((__m256i*)&b->position[i], _mm256_blendv_epi8(pos0, pos, first_ok));
+        _mm256_store_si256((__m256i*)&b->position[n + i], _mm256_blendv_epi8(pos1, pos, second_ok));
+        _mm256_store_si256((__m256i*)&b->money[i],
+                           _mm256_blendv_epi8(money0, _mm256_blendv_epi8(money, other_money, second), ok));
+        _mm256_store_si256((__m256i*)&b->money[n + i],
+                           _mm256_blendv_epi8(money1, _mm256_blendv_epi8(other_money, money, second), ok));
+        _mm256_store_si256((__m256i*)&b->doubles[i], _mm256_blendv_epi8(dbl0, dbl, first_ok));
+        _mm256_store_si256((__m256i*)&b->doubles[n + i], _mm256_blendv_epi8(dbl1, dbl, second_ok));
+        _mm256_store_si256((__m256i*)&b->current[i],
+                           _mm256_xor_si256(cur, _mm256_andnot_si256(is_doubles, _mm256_and_si256(ok, one))));
+        _mm256_store_si256((__m256i*)&b->rolls[i], _mm256_sub_epi32(rolls, ok));
+        _mm256_store_si256((__m256i*)&b->landed[i], pos);
+        _mm256_store_si256((__m256i*)&b->fast[i], ok);
+    }
+}
+
+#endif // BATCH_X86
+
+typedef void (*StepFn)(Batch* b);
+
+static StepFn kernel_step(Kernel kernel) {
+#ifdef BATCH_X86
+    if (kernel == KERNEL_AVX2) return step_avx2;
+    if (kernel == KERNEL_SSE2) return step_sse2;
+#endif
+    (void)kernel;
+    return step_scalar;
+}
+
+// ============ Workers ============
+
+// Step every lane until all games are played; lanes the vector step left
+// alone take the scalar step with the same dice
+static void batch_run(Batch* b, StepFn step) {
+    while (b->running > 0) {
+        step(b);
+        for (int lane = 0; lane < b->lanes; lane++) {
+            if (b->fast[lane]) {
+                b->stats.landings[b->game_index[lane] % STAT_GROUPS][b->landed[lane]]++;
+            } else {
+                lane_step(b, lane);
+            }
+        }
+    }
+}
+
+static void* batch_worker(void* arg) {
+    BatchWorker* worker = arg;
+    const BatchJob* job = worker->job;
+    int games = worker->last - worker->first;
+    if (games <= 0) return NULL;
+
+    Batch* b = aligned_alloc(_Alignof(Batch), sizeof(Batch));
+    if (!b) return NULL;
+    if (batch_alloc(b, games < job->lanes ? games : job->lanes) != 0) {
+        free(b);
+        return NULL;
+    }
+    batch_start(b, worker->first, worker->last, job->max_rolls, job->seed);
+    batch_run(b, kernel_step(job->kernel));
+    worker->stats = b->stats;
+
+    batch_free(b);
+    free(b);
+    return NULL;
+}
+
+static void merge_stats(BatchStats* total, const BatchStats* s) {
+    total->games += s->games;
+    total->wins[0] += s->wins[0];
+    total->wins[1] += s->wins[1];
+    total->unfinished += s->unfinished;
+    total->rolls += s->rolls;
+    total->finished_rolls += s->finished_rolls;
+    total->finished_rolls_sq += s->finished_rolls_sq;
+    for (int i = 0; i < LENGTH_BUCKETS; i++) total->length_hist[i] += s->length_hist[i];
+    for (int g = 0; g < STAT_GROUPS; g++) {
+        total->group_rolls[g] += s->group_rolls[g];
+        for (int q = 0; q < TOTAL_PROPERTIES; q++) total->landings[g][q] += s->landings[g][q];
+    }
+}
+
+// Run a job on threads and merge their totals; returns the elapsed seconds
+static double run_job(const BatchJob* job, int threads, BatchStats* total) {
+    BatchWorker* workers = aligned_alloc(_Alignof(BatchWorker), sizeof(BatchWorker) * threads);
+    pthread_t* ids = malloc(sizeof(pthread_t) * threads);
+    if (!workers || !ids) {
+        free(workers);
+        free(ids);
+        return -1;
+    }
+    memset(workers, 0, sizeof(BatchWorker) * threads);
+
+    double start = now_sec();
+    for (int i = 0; i < threads; i++) {
+        workers[i].job = job;
+        workers[i].first = (int)((long)job->games * i / threads);
+        workers[i].last = (int)((long)job->games * (i + 1) / threads);
+        pthread_create(&ids[i], NULL, batch_worker, &workers[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    memset(total, 0, sizeof(*total));
+    for (int i = 0; i < threads; i++) merge_stats(total, &workers[i].stats);
+    free(ids);
+    free(workers);
+    return elapsed;
+}
+
+// ============ Reference ============
+
+// The same games through the server rules, played like monopoly_sim's
+// "always" policy (seeds differ, so only the statistics can agree)
+static void play_reference(ActiveGame* game, int index, const BatchJob* job, BatchStats* stats) {
+    game_init_state(game, index + 1, 1, "a", 2, "b", game_seed(job->seed, index));
+    game->active = 1;
+
+    int group = index % STAT_GROUPS;
+    int rolls = 0;
+    while (game->state != GSTATE_ENDED && rolls < job->max_rolls) {
+        int player = game->current_player;
+        switch (game->state) {
+            case GSTATE_WAITING_BUY:
+                game_buy_property(game, player);
+                break;
+            case GSTATE_WAITING_DEBT:
+                game_declare_bankrupt(game, player);
+                break;
+            default:
+                game_roll_dice(game, player);
+                rolls++;
+                stats->landings[group][game->players[player].position]++;
+                break;
+        }
+    }
+
+    stats->games++;
+    stats->rolls += rolls;
+    stats->group_rolls[group] += rolls;
+    if (game->state == GSTATE_ENDED) {
+        stats->wins[game->players[0].money >= 0 ? 0 : 1]++;
+        stats->finished_rolls += rolls;
+        stats->finished_rolls_sq += (double)rolls * rolls;
+        int bucket = rolls / LENGTH_BUCKET;
+        stats->length_hist[bucket < LENGTH_BUCKETS ? bucket : LENGTH_BUCKETS - 1]++;
+    } else {
+        stats->unfinished++;
+    }
+}
+
+static double run_reference(const BatchJob* job, BatchStats* stats) {
+    ActiveGame* game = aligned_alloc(_Alignof(ActiveGame), sizeof(ActiveGame));
+    if (!game) return -1;
+    memset(game, 0, sizeof(*game));
+    pthread_mutex_init(&game->mutex, NULL);
+    memset(stats, 0, sizeof(*stats));
+
+    double start = now_sec();
+    for (int i = 0; i < job->games; i++) {
+        play_reference(game, i, job, stats);
+    }
+    double elapsed = now_sec() - start;
+
+    pthread_mutex_destroy(&game->mutex);
+    free(game);
+    return elapsed;
+}
+
+// ============ Validation ============
+
+// z score of the difference of two proportions
+static double proportion_z(long hits_a, long n_a, long hits_b, long n_b) {
+    double pa = (double)hits_a / n_a;
+    double pb = (double)hits_b / n_b;
+    double pooled = (double)(hits_a + hits_b) / (n_a + n_b);
+    double se = sqrt(pooled * (1 - pooled) * (1.0 / n_a + 1.0 / n_b));
+    return se > 0 ? (pa - pb) / se : 0;
+}
+
+// z score of the difference of two means given count, sum and sum of squares
+static double mean_z(long n_a, double sum_a, double sq_a, long n_b, double sum_b, double sq_b) {
+    if (n_a < 2 || n_b < 2) return 0;
+    double ma = sum_a / n_a;
+    double mb = sum_b / n_b;
+    double va = (sq_a - n_a * ma * ma) / (n_a - 1);
+    double vb = (sq_b - n_b * mb * mb) / (n_b - 1);
+    double se = sqrt(va / n_a + vb / n_b);
+    return se > 0 ? (ma - mb) / se : 0;
+}
+
+// Largest z over the squares of the share of rolls ending there; the game
+// groups are independent samples, so the spread between groups gives the
+// standard error even though rolls within a game are not independent
+static double landing_z(const BatchStats* a, const BatchStats* b, int* worst) {
+    double max_z = 0;
+    *worst = 0;
+    for (int q = 0; q < TOTAL_PROPERTIES; q++) {
+        double sum[2] = { 0, 0 };
+        double sq[2] = { 0, 0 };
+        const BatchStats* side[2] = { a, b };
+        for (int s = 0; s < 2; s++) {
+            for (int g = 0; g < STAT_GROUPS; g++) {
+                double share = side[s]->group_rolls[g] ? (double)side[s]->landings[g][q] / side[s]->group_rolls[g] : 0;
+                sum[s] += share;
+                sq[s] += share * share;
+            }
+        }
+        double z = fabs(mean_z(STAT_GROUPS, sum[0], sq[0], STAT_GROUPS, sum[1], sq[1]));
+        if (z > max_z) {
+            max_z = z;
+            *worst = q;
+        }
+    }
+    return max_z;
+}
+
+static int check(const char* name, double batch, double reference, double z) {
+    int ok = fabs(z) < VALIDATE_Z;
+    fprintf(stderr, "  %-28s batch %9.4f  rules %9.4f  z %6.2f  %s\n", name, batch, reference, z,
+            ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Every kernel against the scalar step (exact), then the fastest one
+// against the server rules (statistical); returns 0 if all checks pass
+static int validate(BatchJob job, int threads) {
+    BatchStats* stats = calloc(KERNEL_COUNT + 1, sizeof(BatchStats));
+    if (!stats) return 1;
+    int failed = 0;
+    int best = KERNEL_SCALAR;
+
+    fprintf(stderr, "Kernels (%d games, %d lanes, %d threads, max %d rolls):\n", job.games, job.lanes,
+            threads, job.max_rolls);
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        if (!kernel_supported((Kernel)k)) {
+            fprintf(stderr, "  %-7s not supported\n", kernel_names[k]);
+            continue;
+        }
+        job.kernel = (Kernel)k;
+        double elapsed = run_job(&job, threads, &stats[k]);
+        int same = memcmp(&stats[k], &stats[KERNEL_SCALAR], sizeof(BatchStats)) == 0;
+        fprintf(stderr, "  %-7s %10.0f games/s %8.1f M rolls/s  %s\n", kernel_names[k], job.games / elapsed,
+                stats[k].rolls / elapsed / 1e6, same ? "identical to scalar" : "DIFFERS from scalar");
+        failed |= !same;
+        best = k;
+    }
+
+    BatchStats* ref = &stats[KERNEL_COUNT];
+    double elapsed = run_reference(&job, ref);
+    fprintf(stderr, "  %-7s %10.0f games/s %8.1f M rolls/s  (server rules, 1 thread)\n\n", "rules",
+            job.games / elapsed, ref->rolls / elapsed / 1e6);
+
+    const BatchStats* bat = &stats[best];
+    long bat_done = bat->wins[0] + bat->wins[1];
+    long ref_done = ref->wins[0] + ref->wins[1];
+    fprintf(stderr, "Batch (%s) against the server rules (|z| < %.1f):\n", kernel_names[best], VALIDATE_Z);
+    if (!check("seat 1 wins", (double)bat->wins[0] / bat->games, (double)ref->wins[0] / ref->games,
+               proportion_z(bat->wins[0], bat->games, ref->wins[0], ref->games))) failed = 1;
+    if (!check("unfinished", (double)bat->unfinished / bat->games, (double)ref->unfinished / ref->games,
+               proportion_z(bat->unfinished, bat->games, ref->unfinished, ref->games))) failed = 1;
+    if (bat_done > 1 && ref_done > 1) {
+        if (!check("mean length (finished)", (double)bat->finished_rolls / bat_done,
+                   (double)ref->finished_rolls / ref_done,
+                   mean_z(bat_done, bat->finished_rolls, bat->finished_rolls_sq, ref_done,
+                          ref->finished_rolls, ref->finished_rolls_sq))) failed = 1;
+    }
+
+    int worst;
+    double z = landing_z(bat, ref, &worst);
+    long bat_hits = 0;
+    long ref_hits = 0;
+    for (int g = 0; g < STAT_GROUPS; g++) {
+        bat_hits += bat->landings[g][worst];
+        ref_hits += ref->landings[g][worst];
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "landings (worst: %s)", square_names[worst]);
+    if (!check(name, (double)bat_hits / bat->rolls, (double)ref_hits / ref->rolls, z)) failed = 1;
+
+    fprintf(stderr, "\nValidation %s\n", failed ? "FAILED" : "passed");
+    free(stats);
+    return failed;
+}
+
+// ============ Report ============
+
+static void report(const BatchJob* job, const BatchStats* total, int threads, double elapsed) {
+    long finished = total->wins[0] + total->wins[1];
+
+    fprintf(stderr, "%ld games (%s, %d lanes, %d threads) in %.2f s: %.0f games/s, %.1f M rolls/s\n",
+            total->games, kernel_names[job->kernel], job->lanes, threads, elapsed, total->games / elapsed,
+            total->rolls / elapsed / 1e6);
+    fprintf(stderr, "Rules: STARTING_MONEY=%d GO_BONUS=%d JAIL_FINE=%d MAX_JAIL_TURNS=%d\n\n",
+            STARTING_MONEY, GO_BONUS, JAIL_FINE, MAX_JAIL_TURNS);
+
+    fprintf(stderr, "Win rates (always vs always):\n");
+    for (int p = 0; p < 2; p++) {
+        fprintf(stderr, "  seat %d %6.2f%%\n", p + 1, total->games ? 100.0 * total->wins[p] / total->games : 0.0);
+    }
+    fprintf(stderr, "  unfinished after %d rolls: %.2f%%\n\n", job->max_rolls,
+            total->games ? 100.0 * total->unfinished / total->games : 0.0);
+
+    if (finished > 0) {
+        fprintf(stderr, "Game length (rolls, finished games): mean %.1f\n",
+                (double)total->finished_rolls / finished);
+        long peak = 1;
+        for (int i = 0; i < LENGTH_BUCKETS; i++) {
+            if (total->length_hist[i] > peak) peak = total->length_hist[i];
+        }
+        for (int i = 0; i < LENGTH_BUCKETS; i++) {
+            if (total->length_hist[i] == 0) continue;
+            int bar = (int)(40 * total->length_hist[i] / peak);
+            fprintf(stderr, "  %4d-%-5d %6.2f%% %.*s\n", i * LENGTH_BUCKET,
+                    i == LENGTH_BUCKETS - 1 ? 0 : (i + 1) * LENGTH_BUCKET - 1,
+                    100.0 * total->length_hist[i] / finished, bar,
+                    "########################################");
+        }
+        fprintf(stderr, "\n");
+    }
+
+    fprintf(stderr, "Where rolls end (%% of %ld rolls):\n", total->rolls);
+    for (int q = 0; q < TOTAL_PROPERTIES; q++) {
+        long hits = 0;
+        for (int g = 0; g < STAT_GROUPS; g++) hits += total->landings[g][q];
+        fprintf(stderr, "  %2d %-16s %5.2f%%%s", q, square_names[q],
+                total->rolls ? 100.0 * hits / total->rolls : 0.0, q % 2 == 1 ? "\n" : "   ");
+    }
+}
+
+static int parse_kernel(const char* name) {
+    for (int i = 0; i < KERNEL_COUNT; i++) {
+        if (strcmp(name, kernel_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    int games = 1000000;
+    int lanes = 4096;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_rolls = 1000;
+    unsigned int seed = 1;
+    int kernel = -1;
+    int validate_only = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) lanes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) max_rolls = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) kernel = parse_kernel(argv[++i]);
+        else if (strcmp(argv[i], "-v") == 0) validate_only = 1;
+        else {
+            printf("Usage: %s [-n games] [-l lanes] [-t threads] [-m max_rolls] [-s seed]\n"
+                   "          [-k scalar|sse2|avx2] [-v]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (games < 1) games = 1;
+    if (lanes < 1) lanes = 1;
+    if (threads < 1) threads = 1;
+    if (max_rolls < 1) max_rolls = 1;
+    if (kernel < 0) {
+        kernel = KERNEL_SCALAR;
+        for (int k = KERNEL_SCALAR + 1; k < KERNEL_COUNT; k++) {
+            if (kernel_supported((Kernel)k)) kernel = k;
+        }
+    } else if (!kernel_supported((Kernel)kernel)) {
+        fprintf(stderr, "Kernel %s is not supported on this CPU\n", kernel_names[kernel]);
+        return 1;
+    }
+
+    // The rules log some actions to stdout; keep the report readable
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    BatchJob job = { .games = games, .lanes = lanes, .max_rolls = max_rolls, .seed = seed,
+                     .kernel = (Kernel)kernel };
+    if (validate_only) {
+        return validate(job, threads);
+    }
+
+    BatchStats* total = malloc(sizeof(BatchStats));
+    if (!total) return 1;
+    double elapsed = run_job(&job, threads, total);
+    if (elapsed < 0) return 1;
+    report(&job, total, threads, elapsed);
+    free(total);
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*
+ * Game Layout Benchmark
+ *
+ * Measures the memory footprint and per-turn latency of ActiveGame with
+ * many concurrent games, so that every turn touches a game that is not in
+ * cache:
+ * - Layout: the same turn kernel (lock, roll, move, rent or buy, next
+ *   player) over the packed ActiveGame and over the layout it replaced
+ *   (ints per property field, usernames inline in the players), with
+ *   games picked at random
+ * - Rules: real game actions (game_roll_dice, buy/skip, ...) including
+ *   the move log, on the same number of games
+ *
+ * Usage: game_layout_bench [-n games] [-t turns]
+ */
+
+#include "game_state.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ActiveGame before the hot/cold split
+typedef struct {
+    int owner;
+    int upgrades;
+    int mortgaged;
+} LegacyProperty;
+
+typedef struct {
+    int user_id;
+    char username[50];
+    int money;
+    int position;
+    int jailed;
+    int turns_in_jail;
+    int consecutive_doubles;
+} LegacyPlayer;
+
+typedef struct {
+    int match_id;
+    int active;
+    LegacyPlayer players[2];
+    LegacyProperty properties[TOTAL_PROPERTIES];
+    int current_player;
+    GameStateType state;
+    GameStateType state_before_pause;
+    int paused;
+    int paused_by;
+    int last_roll[2];
+    int just_left_jail;
+    int move_count;
+    unsigned int rng;
+    unsigned int revision;
+    time_t last_activity;
+    char message[128];
+    char message2[128];
+    MoveLog log;
+    pthread_mutex_t mutex;
+} LegacyGame;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ============ Layout ============
+
+// One simplified turn; the field names are the same in both layouts
+#define PLAY_TURN(game) do {                                                   \
+    pthread_mutex_lock(&(game)->mutex);                                        \
+    int me = (game)->current_player;                                           \
+    int die1 = rand_r(&(game)->rng) % 6 + 1;                                   \
+    int die2 = rand_r(&(game)->rng) % 6 + 1;                                   \
+    int pos = ((game)->players[me].position + die1 + die2) % TOTAL_PROPERTIES; \
+    (game)->players[me].position = pos;                                        \
+    (game)->last_roll[0] = die1;                                               \
+    (game)->last_roll[1] = die2;                                               \
+    int owner = (game)->properties[pos].owner;                                 \
+    if (owner == 1 - me && !(game)->properties[pos].mortgaged) {               \
+        int rent = 10 + 40 * (game)->properties[pos].upgrades;                 \
+        (game)->players[me].money -= rent;                                     \
+        (game)->players[owner].money += rent;                                  \
+    } else if (owner == -1 && (game)->players[me].money >= 200) {              \
+        (game)->properties[pos].owner = me;                                    \
+        (game)->players[me].money -= 200;                                      \
+    } else if (owner == me && (game)->properties[pos].upgrades < 5) {          \
+        (game)->properties[pos].upgrades++;                                    \
+    }                                                                          \
+    (game)->current_player = 1 - me;                                           \
+    (game)->move_count++;                                                      \
+    (game)->revision++;                                                        \
+    pthread_mutex_unlock(&(game)->mutex);                                      \
+} while (0)
+
+#define RESET_GAME(game, id) do {                                              \
+    (game)->match_id = (id);                                                   \
+    (game)->active = 1;                                                        \
+    (game)->rng = (unsigned int)(id) * 2654435761u;                            \
+    for (int p = 0; p < 2; p++) {                                              \
+        (game)->players[p].user_id = 2 * (id) + p;                             \
+        (game)->players[p].money = STARTING_MONEY;                             \
+    }                                                                          \
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {                               \
+        (game)->properties[i].owner = -1;                                      \
+    }                                                                          \
+    pthread_mutex_init(&(game)->mutex, NULL);                                  \
+} while (0)
+
+static void* alloc_games(size_t count, size_t size, size_t alignment) {
+    void* games = aligned_alloc(alignment, count * size);
+    if (games) memset(games, 0, count * size);
+    return games;
+}
+
+// Random game order, fixed per run so both layouts see the same accesses
+static int* make_schedule(int games, int turns) {
+    int* schedule = malloc(sizeof(int) * turns);
+    if (!schedule) return NULL;
+    unsigned int seed = 12345;
+    for (int i = 0; i < turns; i++) {
+        schedule[i] = rand_r(&seed) % games;
+    }
+    return schedule;
+}
+
+static void bench_layouts(int games, int turns, const int* schedule) {
+    fprintf(stderr, "Layout (%d games, %d turns at random games):\n", games, turns);
+    fprintf(stderr, "  %-8s %10s %12s %12s\n", "layout", "bytes", "total MB", "ns/turn");
+
+    LegacyGame* legacy = alloc_games(games, sizeof(LegacyGame), _Alignof(LegacyGame));
+    if (legacy) {
+        for (int i = 0; i < games; i++) RESET_GAME(&legacy[i], i + 1);
+        double start = now_sec();
+        for (int t = 0; t < turns; t++) PLAY_TURN(&legacy[schedule[t]]);
+        double elapsed = now_sec() - start;
+        fprintf(stderr, "  %-8s %10zu %12.1f %12.1f\n", "legacy", sizeof(LegacyGame),
+                (double)games * sizeof(LegacyGame) / (1024 * 1024), elapsed * 1e9 / turns);
+        free(legacy);
+    }
+
+    ActiveGame* packed = alloc_games(games, sizeof(ActiveGame), _Alignof(ActiveGame));
+    if (packed) {
+        for (int i = 0; i < games; i++) RESET_GAME(&packed[i], i + 1);
+        double start = now_sec();
+        for (int t = 0; t < turns; t++) PLAY_TURN(&packed[schedule[t]]);
+        double elapsed = now_sec() - start;
+        fprintf(stderr, "  %-8s %10zu %12.1f %12.1f\n", "packed", sizeof(ActiveGame),
+                (double)games * sizeof(ActiveGame) / (1024 * 1024), elapsed * 1e9 / turns);
+        fprintf(stderr, "  packed hot part: %zu bytes (%zu cache lines)\n", offsetof(ActiveGame, rent),
+                (offsetof(ActiveGame, rent) + 63) / 64);
+        free(packed);
+    }
+}
+
+// ============ Rules ============
+
+static void start_game(ActiveGame* game, int match_id) {
+    unsigned int seed = (unsigned int)match_id * 2654435761u;
+    move_log_free(&game->log);
+    game_init_state(game, match_id, 2 * match_id, "player_a", 2 * match_id + 1, "player_b", seed);
+    move_log_start(&game->log, match_id, 2 * match_id, 2 * match_id + 1, seed);
+    game->active = 1;
+}
+
+// One action by whoever is to move, as a client would send it
+static void play_action(ActiveGame* game, unsigned int* choices) {
+    int player = game->current_player;
+    int r = rand_r(choices) % 100;
+
+    switch (game->state) {
+        case GSTATE_WAITING_BUY:
+            if (r < 70) game_buy_property(game, player);
+            else game_skip_property(game, player);
+            break;
+        case GSTATE_WAITING_DEBT:
+            game_declare_bankrupt(game, player);
+            break;
+        default:
+            if (r < 10) game_upgrade_property(game, player, rand_r(choices) % TOTAL_PROPERTIES);
+            else game_roll_dice(game, player);
+            break;
+    }
+}
+
+static void bench_rules(int games, int turns, const int* schedule) {
+    ActiveGame* all = alloc_games(games, sizeof(ActiveGame), _Alignof(ActiveGame));
+    if (!all) {
+        fprintf(stderr, "Out of memory\n");
+        return;
+    }
+    for (int i = 0; i < games; i++) {
+        pthread_mutex_init(&all[i].mutex, NULL);
+        start_game(&all[i], i + 1);
+    }
+
+    unsigned int choices = 42;
+    int next_match = games + 1;
+    int finished = 0;
+    double start = now_sec();
+    for (int t = 0; t < turns; t++) {
+        ActiveGame* game = &all[schedule[t]];
+        play_action(game, &choices);
+        if (game->state == GSTATE_ENDED) {
+            start_game(game, next_match++);
+            finished++;
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    size_t log_bytes = 0;
+    for (int i = 0; i < games; i++) log_bytes += all[i].log.capacity;
+
+    fprintf(stderr, "Rules (%d games, %d actions at random games):\n", games, turns);
+    fprintf(stderr, "  %.1f ns/action, %d games finished\n", elapsed * 1e9 / turns, finished);
+    fprintf(stderr, "  memory: %.1f MB games + %.1f MB move logs (%.0f bytes per game)\n",
+            (double)games * sizeof(ActiveGame) / (1024 * 1024), (double)log_bytes / (1024 * 1024),
+            (double)(games * sizeof(ActiveGame) + log_bytes) / games);
+
+    for (int i = 0; i < games; i++) {
+        move_log_free(&all[i].log);
+        pthread_mutex_destroy(&all[i].mutex);
+    }
+    free(all);
+}
+
+int main(int argc, char* argv[]) {
+    int games = 100000;
+    int turns = 2000000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) turns = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-n games] [-t turns]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (games < 1) games = 1;
+    if (turns < 1) turns = 1;
+
+    int* schedule = make_schedule(games, turns);
+    if (!schedule) return 1;
+
+    // The rules log every action to stdout; keep the report readable
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    bench_layouts(games, turns, schedule);
+    bench_rules(games, turns, schedule);
+
+    free(schedule);
+    return 0;
+}
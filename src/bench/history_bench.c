@@ -0,0 +1,182 @@
+/*
+ * Match History Benchmark
+ *
+ * Builds a synthetic matches table (10M rows by default) and measures
+ * per-page latency of db_get_user_match_history at increasing depths.
+ * With keyset pagination every page should cost the same, no matter how
+ * far back in the history the cursor points.
+ *
+ * Usage: history_bench [-d file] [-n matches] [-u users] [-p pages]
+ */
+
+#include "database.h"
+#include "storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static long long count_matches(sqlite3* db) {
+    sqlite3_stmt* stmt;
+    long long n = 0;
+    if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM matches", -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) n = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+    }
+    return n;
+}
+
+// Fill users and completed matches. end_time advances one second per match
+// so that history order is well defined.
+static int populate(sqlite3* db, long long matches, int users) {
+    sqlite3_exec(db, "PRAGMA synchronous = OFF; PRAGMA journal_mode = MEMORY;", NULL, NULL, NULL);
+    sqlite3_exec(db, "BEGIN", NULL, NULL, NULL);
+
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO users (user_id, username, password_hash) VALUES (?, ?, 'x')",
+                       -1, &stmt, NULL);
+    for (int u = 1; u <= users; u++) {
+        char name[32];
+        snprintf(name, sizeof(name), "bench_%d", u);
+        sqlite3_bind_int(stmt, 1, u);
+        sqlite3_bind_text(stmt, 2, name, -1, SQLITE_TRANSIENT);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    const char* sql = "INSERT INTO matches (player1_id, player2_id, winner_id, "
+                      "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
+                      "start_time, end_time, status) "
+                      "VALUES (?1, ?2, ?3, 1200, 1200, ?4, ?5, "
+                      "datetime(1600000000 + ?6, 'unixepoch'), datetime(1600000600 + ?6, 'unixepoch'), 'completed')";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "prepare: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    srand(42);
+    double start = now_ms();
+    for (long long i = 0; i < matches; i++) {
+        int p1 = 1 + rand() % users;
+        int p2 = 1 + rand() % (users - 1);
+        if (p2 >= p1) p2++;
+        int p1_won = rand() & 1;
+
+        sqlite3_bind_int(stmt, 1, p1);
+        sqlite3_bind_int(stmt, 2, p2);
+        sqlite3_bind_int(stmt, 3, p1_won ? p1 : p2);
+        sqlite3_bind_int(stmt, 4, p1_won ? 1216 : 1184);
+        sqlite3_bind_int(stmt, 5, p1_won ? 1184 : 1216);
+        sqlite3_bind_int64(stmt, 6, i);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+
+        if ((i + 1) % 1000000 == 0) {
+            sqlite3_exec(db, "COMMIT; BEGIN", NULL, NULL, NULL);
+            printf("  %lld rows (%.1f s)\n", i + 1, (now_ms() - start) / 1000.0);
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "COMMIT", NULL, NULL, NULL);
+    sqlite3_exec(db, "ANALYZE", NULL, NULL, NULL);
+    return 0;
+}
+
+// Previous implementation: OR across both player columns, sorted in full
+static double legacy_first_page_ms(sqlite3* db, int user_id) {
+    const char* sql =
+        "SELECT m.match_id, u.username FROM matches m "
+        "JOIN users u ON u.user_id = (CASE WHEN m.player1_id = ?1 THEN m.player2_id ELSE m.player1_id END) "
+        "WHERE (m.player1_id = ?1 OR m.player2_id = ?1) AND m.status = 'completed' "
+        "ORDER BY m.start_time DESC LIMIT 20";
+    sqlite3_stmt* stmt;
+    double start = now_ms();
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) return -1;
+    sqlite3_bind_int(stmt, 1, user_id);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {}
+    sqlite3_finalize(stmt);
+    return now_ms() - start;
+}
+
+int main(int argc, char* argv[]) {
+    const char* db_file = "history_bench.db";
+    long long matches = 10000000;
+    int users = 1000;
+    int pages = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) db_file = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) matches = atoll(argv[++i]);
+        else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc) users = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) pages = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-d file] [-n matches] [-u users] [-p pages]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (users < 2) users = 2;
+
+    Database db;
+    if (db_init(&db, db_file) != 0) return 1;
+
+    // Fixtures are bulk-loaded straight into the SQLite file
+    sqlite3* raw = storage_sqlite_handle(&db);
+
+    long long existing = count_matches(raw);
+    if (existing < matches) {
+        printf("Populating %lld matches across %d users...\n", matches - existing, users);
+        if (populate(raw, matches - existing, users) != 0) {
+            db_close(&db);
+            return 1;
+        }
+    }
+    printf("Database: %s (%lld matches)\n\n", db_file, count_matches(raw));
+
+    int user_id = 1;
+    int before = 0;
+    int total_rows = 0, done = 0;
+    double total_ms = 0, worst_ms = 0;
+
+    printf("%-10s %-12s %-10s\n", "page", "latency_ms", "rows");
+    for (int p = 1; p <= pages; p++) {
+        MatchHistoryEntry* history = NULL;
+        int count = 0;
+
+        double start = now_ms();
+        if (db_get_user_match_history(&db, user_id, before, MATCH_HISTORY_PAGE_SIZE, &history, &count) != 0) {
+            fprintf(stderr, "history query failed at page %d\n", p);
+            break;
+        }
+        double elapsed = now_ms() - start;
+
+        done++;
+        total_ms += elapsed;
+        if (elapsed > worst_ms) worst_ms = elapsed;
+        total_rows += count;
+
+        if (p == 1 || p == 10 || p == 100 || p == pages || count == 0 || (p % 250) == 0) {
+            printf("%-10d %-12.3f %-10d\n", p, elapsed, count);
+        }
+
+        if (count == 0) {
+            free(history);
+            break;
+        }
+        before = history[count - 1].match_id;
+        free(history);
+    }
+
+    printf("\nKeyset pages: %d rows, avg %.3f ms/page, worst %.3f ms/page\n",
+           total_rows, total_ms / (done > 0 ? done : 1), worst_ms);
+    printf("Legacy OR-scan first page: %.3f ms\n", legacy_first_page_ms(raw, user_id));
+
+    db_close(&db);
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * Latency Injection Proxy
+ *
+ * Forwards TCP connections to the server, holding everything it relays
+ * for a fixed delay in each direction, so that local clients can stand in
+ * for players on slow links: the server's heartbeat probes measure the
+ * added round trip, and matchmaking sees it. Each connection through the
+ * proxy is reported on stderr with the bytes relayed.
+ *
+ * Example: players connecting to port 8889 have 300 ms more round trip
+ * than those connecting to the server directly
+ *   monopoly_server -p 8888 &
+ *   lag_proxy -l 8889 -t 127.0.0.1:8888 -d 150
+ *
+ * Usage: lag_proxy [-l listen_port] [-t host:port] [-d delay_ms]
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PROXY_MAX_CONNECTIONS 64
+#define PROXY_CHUNK 4096
+
+// Data read from one side, due to be written to the other
+typedef struct Chunk {
+    struct Chunk* next;
+    int64_t due_ms;
+    int length;
+    int sent;
+    char data[PROXY_CHUNK];
+} Chunk;
+
+// One direction of a connection
+typedef struct {
+    int from;
+    int to;
+    Chunk* head;
+    Chunk* tail;
+    int closed;                     // from reached end of stream
+    long bytes;
+} Flow;
+
+typedef struct {
+    int active;
+    Flow flows[2];                  // Client to server, server to client
+} Connection;
+
+static Connection connections[PROXY_MAX_CONNECTIONS];
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int listen_on(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, PROXY_MAX_CONNECTIONS) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int connect_to(const struct sockaddr_in* target) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (const struct sockaddr*)target, sizeof(*target)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void close_connection(Connection* conn, int index) {
+    fprintf(stderr, "[PROXY] Connection %d closed (%ld bytes up, %ld down)\n",
+            index, conn->flows[0].bytes, conn->flows[1].bytes);
+    for (int f = 0; f < 2; f++) {
+        Flow* flow = &conn->flows[f];
+        while (flow->head) {
+            Chunk* next = flow->head->next;
+            free(flow->head);
+            flow->head = next;
+        }
+    }
+    close(conn->flows[0].from);
+    close(conn->flows[1].from);
+    memset(conn, 0, sizeof(*conn));
+}
+
+static void accept_connection(int listen_fd, const struct sockaddr_in* target) {
+    int client = accept(listen_fd, NULL, NULL);
+    if (client < 0) return;
+
+    int slot = 0;
+    while (slot < PROXY_MAX_CONNECTIONS && connections[slot].active) slot++;
+    int server = slot < PROXY_MAX_CONNECTIONS ? connect_to(target) : -1;
+    if (server < 0) {
+        fprintf(stderr, "[PROXY] Refused a connection (%s)\n",
+                slot < PROXY_MAX_CONNECTIONS ? "server unreachable" : "too many connections");
+        close(client);
+        return;
+    }
+
+    Connection* conn = &connections[slot];
+    memset(conn, 0, sizeof(*conn));
+    conn->active = 1;
+    conn->flows[0].from = conn->flows[1].to = client;
+    conn->flows[0].to = conn->flows[1].from = server;
+    fprintf(stderr, "[PROXY] Connection %d opened\n", slot);
+}
+
+// Read what arrived into a chunk due delay_ms from now
+// Returns 0 on success, -1 at end of stream or on error
+static int read_flow(Flow* flow, int delay_ms) {
+    Chunk* chunk = malloc(sizeof(Chunk));
+    if (!chunk) return -1;
+    int length = (int)recv(flow->from, chunk->data, PROXY_CHUNK, 0);
+    if (length <= 0) {
+        free(chunk);
+        return -1;
+    }
+    chunk->next = NULL;
+    chunk->due_ms = monotonic_ms() + delay_ms;
+    chunk->length = length;
+    chunk->sent = 0;
+    if (flow->tail) flow->tail->next = chunk;
+    else flow->head = chunk;
+    flow->tail = chunk;
+    flow->bytes += length;
+    return 0;
+}
+
+// Write the chunks that are due
+// Returns 0 on success, -1 on error
+static int write_flow(Flow* flow, int64_t now) {
+    while (flow->head && flow->head->due_ms <= now) {
+        Chunk* chunk = flow->head;
+        ssize_t sent = send(flow->to, chunk->data + chunk->sent, chunk->length - chunk->sent, MSG_NOSIGNAL);
+        if (sent < 0) return -1;
+        chunk->sent += (int)sent;
+        if (chunk->sent < chunk->length) return 0;
+        flow->head = chunk->next;
+        if (!flow->head) flow->tail = NULL;
+        free(chunk);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int port = 8889;
+    const char* target_spec = "127.0.0.1:8888";
+    int delay_ms = 100;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) target_spec = argv[++i];
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) delay_ms = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-l listen_port] [-t host:port] [-d delay_ms]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (delay_ms < 0) delay_ms = 0;
+
+    char host[64];
+    int target_port = 0;
+    struct sockaddr_in target;
+    memset(&target, 0, sizeof(target));
+    target.sin_family = AF_INET;
+    if (sscanf(target_spec, "%63[^:]:%d", host, &target_port) != 2 ||
+        inet_pton(AF_INET, host, &target.sin_addr) != 1) {
+        fprintf(stderr, "Bad target %s (expected host:port, host as an IPv4 address)\n", target_spec);
+        return 1;
+    }
+    target.sin_port = htons(target_port);
+
+    int listen_fd = listen_on(port);
+    if (listen_fd < 0) {
+        perror("listen");
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    fprintf(stderr, "[PROXY] Port %d -> %s, %d ms each way\n", port, target_spec, delay_ms);
+
+    for (;;) {
+        // Listen, read from every open side, and wait at most until the
+        // next chunk is due
+        struct pollfd fds[1 + PROXY_MAX_CONNECTIONS * 2];
+        int owner[1 + PROXY_MAX_CONNECTIONS * 2];
+        int count = 0;
+        int64_t now = monotonic_ms();
+        int64_t next_due = -1;
+
+        fds[count].fd = listen_fd;
+        fds[count].events = POLLIN;
+        owner[count++] = -1;
+        for (int c = 0; c < PROXY_MAX_CONNECTIONS; c++) {
+            if (!connections[c].active) continue;
+            for (int f = 0; f < 2; f++) {
+                Flow* flow = &connections[c].flows[f];
+                if (!flow->closed) {
+                    fds[count].fd = flow->from;
+                    fds[count].events = POLLIN;
+                    owner[count++] = c * 2 + f;
+                }
+                if (flow->head && (next_due < 0 || flow->head->due_ms < next_due)) next_due = flow->head->due_ms;
+            }
+        }
+        int timeout = next_due < 0 ? -1 : next_due > now ? (int)(next_due - now) : 0;
+
+        if (poll(fds, count, timeout) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            return 1;
+        }
+
+        if (fds[0].revents & POLLIN) accept_connection(listen_fd, &target);
+        for (int i = 1; i < count; i++) {
+            if (!fds[i].revents) continue;
+            Flow* flow = &connections[owner[i] / 2].flows[owner[i] % 2];
+            if (read_flow(flow, delay_ms) != 0) flow->closed = 1;
+        }
+
+        // Deliver what is due; a side that ended closes the connection
+        // once everything it sent has been delivered
+        now = monotonic_ms();
+        for (int c = 0; c < PROXY_MAX_CONNECTIONS; c++) {
+            Connection* conn = &connections[c];
+            if (!conn->active) continue;
+            int done = 0;
+            for (int f = 0; f < 2; f++) {
+                Flow* flow = &conn->flows[f];
+                if (write_flow(flow, now) != 0 || (flow->closed && !flow->head)) done = 1;
+            }
+            if (done) close_connection(conn, c);
+        }
+    }
+}
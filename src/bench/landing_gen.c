@@ -0,0 +1,346 @@
+/*
+ * Landing Probability Generator
+ *
+ * Solves the Markov chain of one token going round the board and writes
+ * the long-run landing tables as a C header (src/shared/landing_table.h),
+ * so that valuation code only looks numbers up:
+ * - Squares come from the local game's board (BoardData.c) and card
+ *   effects from the shared decks that Cards.c draws from
+ * - Movement follows the server rules: doubles roll again and the third
+ *   one goes to jail; a jailed player rolls for doubles and pays the fine
+ *   on the last turn; Go to Jail, jail cards and card moves (which can
+ *   chain, e.g. Chance back 3 to Community Chest) are resolved in full;
+ *   a Get Out of Jail Free card is kept and used when sent to jail
+ * - A chain state is what matters for the next roll: the square, doubles
+ *   in a row, turns spent in jail and jail cards held (capped)
+ *
+ * Two simplifications: every card is equally likely on every draw (the
+ * decks are shuffled, but then cycle in order), and the player never pays
+ * the fine early, like the simulators' policies.
+ *
+ * Usage: landing_gen > landing_table.h  (or: make tables)
+ */
+
+#include "BoardData.h"
+#include "card_deck.h"
+#include "game_state.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CARDS_HELD 3            // Jail cards tracked per state (more count as this many)
+#define SOLVE_EPSILON 1e-15     // L1 change that ends the power iteration
+#define SOLVE_MAX_ITERATIONS 100000
+
+// States: free on a square with doubles rolled this turn, or in jail after
+// some turns; each with the jail cards held
+#define FREE_STATES (TOTAL_PROPERTIES * 3)
+#define JAIL_STATES MAX_JAIL_TURNS
+#define CARD_STATES (FREE_STATES + JAIL_STATES)
+#define STATES (CARD_STATES * (CARDS_HELD + 1))
+
+static Game_Prop board[TOTAL_PROPERTIES];
+static int jail_square = -1;
+
+static int free_state(int pos, int doubles, int cards) {
+    return cards * CARD_STATES + doubles * TOTAL_PROPERTIES + pos;
+}
+
+static int jail_state(int turns, int cards) {
+    return cards * CARD_STATES + FREE_STATES + turns;
+}
+
+// Square a token in this state stands on
+static int state_square(int state) {
+    int rest = state % CARD_STATES;
+    return rest < FREE_STATES ? rest % TOTAL_PROPERTIES : jail_square;
+}
+
+// ============ Landing ============
+
+// Where a move can end, once cards and Go to Jail are resolved
+typedef enum {
+    END_FREE,               // On the square
+    END_PARDONED,           // Sent to jail, used a card and stayed on the square
+    END_JAILED,             // In jail
+    END_KINDS
+} EndKind;
+
+typedef struct {
+    double p[END_KINDS][TOTAL_PROPERTIES][CARDS_HELD + 1];
+} Ends;
+
+static void send_to_jail(int pos, int cards, double p, Ends* ends) {
+    if (cards > 0) ends->p[END_PARDONED][pos][cards - 1] += p;
+    else ends->p[END_JAILED][jail_square][0] += p;
+}
+
+static int nearest(int pos, Game_Prop_Type type) {
+    for (int step = 1; step <= TOTAL_PROPERTIES; step++) {
+        int square = (pos + step) % TOTAL_PROPERTIES;
+        if (board[square].type == type) return square;
+    }
+    return pos;
+}
+
+static void land(int pos, int cards, double p, Ends* ends);
+
+// Every card of a deck with the same chance (see the header comment)
+static void draw(DeckKind deck, int pos, int cards, double p, Ends* ends) {
+    double each = p / CARD_DECK_SIZE;
+    for (int i = 0; i < CARD_DECK_SIZE; i++) {
+        const CardDef* card = card_def(deck, i);
+        switch (card->action) {
+            case CARD_ACT_ADVANCE:
+                land(card->target, cards, each, ends);
+                break;
+            case CARD_ACT_BACK:
+                land((pos + TOTAL_PROPERTIES - card->amount) % TOTAL_PROPERTIES, cards, each, ends);
+                break;
+            case CARD_ACT_NEAREST:
+                land(nearest(pos, card->target == BOARD_GROUP_UTILITY ? Game_PT_UTILITY : Game_PT_RAILROAD),
+                     cards, each, ends);
+                break;
+            case CARD_ACT_JAIL:
+                send_to_jail(pos, cards, each, ends);
+                break;
+            case CARD_ACT_JAIL_FREE:
+                ends->p[END_FREE][pos][cards < CARDS_HELD ? cards + 1 : cards] += each;
+                break;
+            default:
+                ends->p[END_FREE][pos][cards] += each;
+                break;
+        }
+    }
+}
+
+static void land(int pos, int cards, double p, Ends* ends) {
+    switch (board[pos].type) {
+        case Game_PT_GOTO_JAIL:
+            send_to_jail(pos, cards, p, ends);
+            break;
+        case Game_PT_CHANCE:
+            draw(DECK_CHANCE, pos, cards, p, ends);
+            break;
+        case Game_PT_COMMUNITY_CHEST:
+            draw(DECK_COMMUNITY_CHEST, pos, cards, p, ends);
+            break;
+        default:
+            ends->p[END_FREE][pos][cards] += p;
+            break;
+    }
+}
+
+// ============ Chain ============
+
+// One roll from each state: into[to][from] is the chance of the next roll
+// being made from state to, split by whether the turn goes on
+static double (*turn_goes_on)[STATES];
+static double (*turn_ends)[STATES];
+
+// Add the ends of a move to the transitions of state from. doubles is the
+// number rolled in a row including this roll, or -1 when the roll cannot
+// give another one (out of jail)
+static void add_ends(int from, const Ends* ends, int doubles) {
+    int again = doubles > 0;
+    for (int pos = 0; pos < TOTAL_PROPERTIES; pos++) {
+        for (int c = 0; c <= CARDS_HELD; c++) {
+            double p;
+            if ((p = ends->p[END_FREE][pos][c]) > 0) {
+                if (again) turn_goes_on[free_state(pos, doubles, c)][from] += p;
+                else turn_ends[free_state(pos, 0, c)][from] += p;
+            }
+            // Jail resets the doubles, but a doubles roll is still followed
+            // by another one (game_roll_dice only checks just_left_jail)
+            if ((p = ends->p[END_PARDONED][pos][c]) > 0) {
+                (again ? turn_goes_on : turn_ends)[free_state(pos, 0, c)][from] += p;
+            }
+            if ((p = ends->p[END_JAILED][pos][c]) > 0) {
+                (again ? turn_goes_on : turn_ends)[jail_state(0, c)][from] += p;
+            }
+        }
+    }
+}
+
+static void build_chain(void) {
+    Ends* ends = malloc(sizeof(Ends));
+    for (int cards = 0; cards <= CARDS_HELD; cards++) {
+        for (int doubles = 0; doubles < 3; doubles++) {
+            for (int pos = 0; pos < TOTAL_PROPERTIES; pos++) {
+                int from = free_state(pos, doubles, cards);
+                for (int d1 = 1; d1 <= 6; d1++) {
+                    for (int d2 = 1; d2 <= 6; d2++) {
+                        memset(ends, 0, sizeof(*ends));
+                        if (d1 == d2 && doubles == 2) {
+                            // Third double: jail without moving
+                            send_to_jail(pos, cards, 1.0 / 36, ends);
+                            add_ends(from, ends, -1);
+                            continue;
+                        }
+                        land((pos + d1 + d2) % TOTAL_PROPERTIES, cards, 1.0 / 36, ends);
+                        add_ends(from, ends, d1 == d2 ? doubles + 1 : 0);
+                    }
+                }
+            }
+        }
+        for (int turns = 0; turns < JAIL_STATES; turns++) {
+            int from = jail_state(turns, cards);
+            for (int d1 = 1; d1 <= 6; d1++) {
+                for (int d2 = 1; d2 <= 6; d2++) {
+                    if (d1 != d2 && turns + 1 < MAX_JAIL_TURNS) {
+                        turn_ends[jail_state(turns + 1, cards)][from] += 1.0 / 36;
+                        continue;
+                    }
+                    // Out on doubles or with the fine: move, and the turn ends
+                    memset(ends, 0, sizeof(*ends));
+                    land((jail_square + d1 + d2) % TOTAL_PROPERTIES, cards, 1.0 / 36, ends);
+                    add_ends(from, ends, -1);
+                }
+            }
+        }
+    }
+    free(ends);
+}
+
+// Long-run share of rolls made from each state
+static void solve(double* share) {
+    double* next = malloc(sizeof(double) * STATES);
+    for (int s = 0; s < STATES; s++) share[s] = 0;
+    share[free_state(0, 0, 0)] = 1;
+
+    for (int iteration = 0; iteration < SOLVE_MAX_ITERATIONS; iteration++) {
+        for (int to = 0; to < STATES; to++) {
+            double p = 0;
+            for (int from = 0; from < STATES; from++) {
+                p += (turn_goes_on[to][from] + turn_ends[to][from]) * share[from];
+            }
+            next[to] = p;
+        }
+        double change = 0;
+        for (int s = 0; s < STATES; s++) {
+            change += fabs(next[s] - share[s]);
+            share[s] = next[s];
+        }
+        if (change < SOLVE_EPSILON) break;
+    }
+    free(next);
+}
+
+// Expected landings on each square during one turn started in state start
+static void one_turn(int start, double* landings) {
+    double* going = calloc(STATES, sizeof(double));
+    double* next = malloc(sizeof(double) * STATES);
+    going[start] = 1;
+    for (int q = 0; q < TOTAL_PROPERTIES; q++) landings[q] = 0;
+
+    double left = 1;
+    while (left > SOLVE_EPSILON) {
+        left = 0;
+        for (int to = 0; to < STATES; to++) {
+            double on = 0, ended = 0;
+            for (int from = 0; from < STATES; from++) {
+                on += turn_goes_on[to][from] * going[from];
+                ended += turn_ends[to][from] * going[from];
+            }
+            landings[state_square(to)] += on + ended;
+            next[to] = on;
+            left += on;
+        }
+        memcpy(going, next, sizeof(double) * STATES);
+    }
+    free(going);
+    free(next);
+}
+
+// ============ Output ============
+
+static void print_row(const char* indent, const double* values) {
+    for (int q = 0; q < TOTAL_PROPERTIES; q++) {
+        printf("%s%.8ff,%s", q % 8 == 0 ? indent : "", values[q], q % 8 == 7 ? "\n" : " ");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        fprintf(stderr, "Usage: %s > landing_table.h\n", argv[0]);
+        return 1;
+    }
+
+    BoardData_initializeBoard(board);
+    for (int q = 0; q < TOTAL_PROPERTIES; q++) {
+        if (board[q].type == Game_PT_JAIL) jail_square = q;
+    }
+    if (jail_square < 0) {
+        fprintf(stderr, "The board has no jail\n");
+        return 1;
+    }
+
+    turn_goes_on = calloc(STATES, sizeof(*turn_goes_on));
+    turn_ends = calloc(STATES, sizeof(*turn_ends));
+    double* share = malloc(sizeof(double) * STATES);
+    if (!turn_goes_on || !turn_ends || !share) return 1;
+    build_chain();
+    solve(share);
+
+    // Per roll, and per turn through the share of rolls that end one
+    double per_roll[TOTAL_PROPERTIES] = { 0 };
+    double per_turn[TOTAL_PROPERTIES];
+    double ending = 0;
+    for (int to = 0; to < STATES; to++) {
+        for (int from = 0; from < STATES; from++) {
+            double p = (turn_goes_on[to][from] + turn_ends[to][from]) * share[from];
+            per_roll[state_square(to)] += p;
+            ending += turn_ends[to][from] * share[from];
+        }
+    }
+    for (int q = 0; q < TOTAL_PROPERTIES; q++) per_turn[q] = per_roll[q] / ending;
+
+    printf("/*\n"
+           " * Landing Probabilities\n"
+           " *\n"
+           " * Generated by src/bench/landing_gen.c from the board and the card decks;\n"
+           " * do not edit. Regenerate with: make tables\n"
+           " *\n"
+           " * Long-run chances of a token ending a roll on each square, for valuing\n"
+           " * squares without simulating (see landing_gen.c for the rules modelled).\n"
+           " * The jail square counts turns spent in jail as well as visits.\n"
+           " */\n\n"
+           "#ifndef LANDING_TABLE_H\n"
+           "#define LANDING_TABLE_H\n\n"
+           "#include \"bitboard.h\"\n\n"
+           "#define LANDING_FROM_JAIL BOARD_SQUARES  // landing_next_turn row for a turn started in jail\n\n");
+
+    printf("// Share of rolls that end on each square\n"
+           "static const float landing_per_roll[BOARD_SQUARES] = {\n");
+    print_row("    ", per_roll);
+    printf("};\n\n");
+
+    printf("// Expected rolls ending on each square per turn (%.4f rolls per turn)\n"
+           "static const float landing_per_turn[BOARD_SQUARES] = {\n", 1 / ending);
+    print_row("    ", per_turn);
+    printf("};\n\n");
+
+    printf("// Expected rolls ending on each square during one turn started on a square\n"
+           "// (no doubles yet, no jail card) or in jail\n"
+           "static const float landing_next_turn[BOARD_SQUARES + 1][BOARD_SQUARES] = {\n");
+    double landings[TOTAL_PROPERTIES];
+    for (int from = 0; from <= TOTAL_PROPERTIES; from++) {
+        if (from < TOTAL_PROPERTIES) {
+            printf("    { // %d %s\n", from, BoardData_getSpaceName(from));
+            one_turn(free_state(from, 0, 0), landings);
+        } else {
+            printf("    { // In jail\n");
+            one_turn(jail_state(0, 0), landings);
+        }
+        print_row("        ", landings);
+        printf("    },\n");
+    }
+    printf("};\n\n"
+           "#endif // LANDING_TABLE_H\n");
+
+    free(turn_goes_on);
+    free(turn_ends);
+    free(share);
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * Match Commit Benchmark
+ *
+ * Compares the per-statement game-end sequence (two user reads, two ELO
+ * updates, match lookup + update, two stats updates, two online updates,
+ * each its own implicit transaction) against db_commit_match_result,
+ * which does the same work in one transaction.
+ *
+ * Usage: match_commit_bench [-d file] [-n games] [-s sqlite|memory]
+ */
+
+#include "database.h"
+#include "elo.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// The sequence handle_game_end used to issue
+static void legacy_game_end(Database* db, int match_id, int winner_id, int loser_id) {
+    UserInfo winner_info, loser_info;
+    db_get_user_info(db, winner_id, &winner_info);
+    db_get_user_info(db, loser_id, &loser_info);
+
+    EloResult elo;
+    elo_calculate_match(winner_info.elo_rating, loser_info.elo_rating,
+                        winner_info.total_matches, loser_info.total_matches, &elo);
+
+    db_update_user_elo(db, winner_id, elo.winner_new_elo);
+    db_update_user_elo(db, loser_id, elo.loser_new_elo);
+    db_update_match_result(db, match_id, winner_id, elo.winner_new_elo, elo.loser_new_elo);
+    db_update_user_stats(db, winner_id, 1);
+    db_update_user_stats(db, loser_id, 0);
+    db_set_player_online(db, winner_id, "idle");
+    db_set_player_online(db, loser_id, "idle");
+}
+
+static double run(Database* db, int games, int batched) {
+    int* match_ids = malloc(sizeof(int) * games);
+    for (int i = 0; i < games; i++) {
+        match_ids[i] = db_create_match(db, 1 + (i & 1), 2 - (i & 1), 1200, 1200);
+    }
+
+    double start = now_sec();
+    for (int i = 0; i < games; i++) {
+        int winner = 1 + (i % 3 == 0);
+        int loser = 3 - winner;
+        if (batched) {
+            MatchCommit commit;
+            db_commit_match_result(db, match_ids[i], winner, loser, &commit);
+        } else {
+            legacy_game_end(db, match_ids[i], winner, loser);
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    free(match_ids);
+    return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    const char* db_file = "match_commit_bench.db";
+    int games = 2000;
+    DatabaseBackend backend = DB_BACKEND_SQLITE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) db_file = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc && db_backend_from_name(argv[i + 1], &backend) == 0) i++;
+        else {
+            printf("Usage: %s [-d file] [-n games] [-s sqlite|memory]\n", argv[0]);
+            return 0;
+        }
+    }
+
+    unlink(db_file);
+
+    // The ELO module logs every result; keep the report on stderr readable
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    Database db;
+    if (db_open(&db, backend, db_file) != 0) return 1;
+    db_create_user(&db, "bench_a", "x", NULL);
+    db_create_user(&db, "bench_b", "x", NULL);
+    db_set_player_online(&db, 1, "in_game");
+    db_set_player_online(&db, 2, "in_game");
+
+    double legacy = run(&db, games, 0);
+    double batched = run(&db, games, 1);
+
+    fprintf(stderr, "Database: %s (%s), %d game endings per mode\n\n", db_file, db_backend_name(&db), games);
+    fprintf(stderr, "%-24s %-12s %-14s\n", "mode", "total_s", "games_per_s");
+    fprintf(stderr, "%-24s %-12.3f %-14.1f\n", "per-statement (legacy)", legacy, games / legacy);
+    fprintf(stderr, "%-24s %-12.3f %-14.1f\n", "single transaction", batched, games / batched);
+    fprintf(stderr, "\nSpeedup: %.1fx\n", legacy / batched);
+
+    db_close(&db);
+    unlink(db_file);
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Match Pairing Benchmark
+ *
+ * Compares the two ways the matchmaking thread can pair its queue on a
+ * tick: greedy (closest acceptable pair first, match_queue_pair) and batch
+ * (least total cost, match_queue_pair_batch). Each round builds a queue of
+ * searchers with normally distributed ratings and random waits, and both
+ * modes pair a copy of it. Reports the time per pairing and the quality
+ * of the result: rating gaps, how lopsided the games are, who is left
+ * waiting, and the batch cost of each outcome.
+ *
+ * Usage: match_pair_bench [-n players] [-r rounds] [-w max_wait]
+ */
+
+#include "match_queue.h"
+#include "elo.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_NOW 1000000           // Virtual time of the tick
+#define RATING_MEAN 1500
+#define RATING_SPREAD 300           // Standard deviation
+
+typedef int (*PairFn)(MatchQueue* queue, int now, MatchPair* pairs);
+
+typedef struct {
+    const char* name;
+    PairFn pair;
+    double seconds;
+    long pairs;
+    long waiting;
+    double gap_sum;
+    int gap_max;
+    double edge_sum;                // |win probability - 0.5| over the games
+    double wait_left_sum;           // Seconds already waited by those left
+    int wait_left_max;
+    double cost_sum;
+} PairMode;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int random_rating(unsigned int* seed) {
+    double u1 = (rand_r(seed) + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand_r(seed) + 1.0) / (RAND_MAX + 2.0);
+    int rating = RATING_MEAN + (int)(RATING_SPREAD * sqrt(-2 * log(u1)) * cos(2 * M_PI * u2));
+    return rating < ELO_MIN_RATING ? ELO_MIN_RATING : rating;
+}
+
+static void fill_queue(MatchQueue* queue, int players, int max_wait, unsigned int seed) {
+    match_queue_init(queue);
+    for (int i = 0; i < players; i++) {
+        int wait = rand_r(&seed) % (max_wait + 1);
+        match_queue_add(queue, i + 1, "bench", random_rating(&seed), (int64_t)(BENCH_NOW - wait) * 1000, -1);
+    }
+}
+
+static void run_mode(PairMode* mode, int players, int max_wait, int rounds) {
+    MatchPair* pairs = malloc(sizeof(MatchPair) * (players / 2 + 1));
+    if (!pairs) return;
+
+    for (int r = 0; r < rounds; r++) {
+        MatchQueue queue;
+        fill_queue(&queue, players, max_wait, 1000 + r);
+        match_queue_settle(&queue);     // Both modes start from a settled queue
+
+        double start = now_sec();
+        int count = mode->pair(&queue, BENCH_NOW, pairs);
+        mode->seconds += now_sec() - start;
+        if (count < 0) {
+            match_queue_free(&queue);
+            continue;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int gap = abs(pairs[i].first.elo_rating - pairs[i].second.elo_rating);
+            mode->gap_sum += gap;
+            if (gap > mode->gap_max) mode->gap_max = gap;
+            mode->edge_sum += fabs(elo_expected_score(pairs[i].first.elo_rating, pairs[i].second.elo_rating) - 0.5);
+            mode->cost_sum += gap;
+        }
+        for (int i = 0; i < queue.count; i++) {
+            int wait = BENCH_NOW - queue.players[i].search_start_time;
+            mode->wait_left_sum += wait;
+            if (wait > mode->wait_left_max) mode->wait_left_max = wait;
+            mode->cost_sum += ELO_MATCHMAKING_RANGE_MAX / 2 + (double)MATCH_WAIT_WEIGHT * wait;
+        }
+        mode->pairs += count;
+        mode->waiting += queue.count;
+        match_queue_free(&queue);
+    }
+    free(pairs);
+}
+
+static void report(const PairMode* modes, int mode_count, int players, int max_wait, int rounds) {
+    fprintf(stderr, "%d searchers, waits 0-%ds, %d rounds:\n", players, max_wait, rounds);
+    fprintf(stderr, "  %-7s %10s %8s %8s %9s %8s %9s %10s %9s %12s\n", "mode", "ms/tick", "pairs",
+            "waiting", "avg gap", "max gap", "avg edge", "left wait", "max left", "cost/round");
+    for (int m = 0; m < mode_count; m++) {
+        const PairMode* mode = &modes[m];
+        long pairs = mode->pairs ? mode->pairs : 1;
+        long waiting = mode->waiting ? mode->waiting : 1;
+        fprintf(stderr, "  %-7s %10.3f %8.1f %8.1f %9.1f %8d %8.1f%% %9.1fs %8ds %12.0f\n",
+                mode->name, mode->seconds * 1000 / rounds, (double)mode->pairs / rounds,
+                (double)mode->waiting / rounds, mode->gap_sum / pairs, mode->gap_max,
+                100 * mode->edge_sum / pairs, mode->wait_left_sum / waiting, mode->wait_left_max,
+                mode->cost_sum / rounds);
+    }
+}
+
+static void bench(int players, int max_wait, int rounds) {
+    PairMode modes[] = {
+        { .name = "greedy", .pair = match_queue_pair },
+        { .name = "batch", .pair = match_queue_pair_batch },
+    };
+    int mode_count = (int)(sizeof(modes) / sizeof(modes[0]));
+    for (int m = 0; m < mode_count; m++) {
+        run_mode(&modes[m], players, max_wait, rounds);
+    }
+    report(modes, mode_count, players, max_wait, rounds);
+}
+
+int main(int argc, char* argv[]) {
+    int players = 0;
+    int rounds = 20;
+    int max_wait = 60;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) players = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) rounds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) max_wait = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-n players] [-r rounds] [-w max_wait]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (rounds < 1) rounds = 1;
+    if (max_wait < 0) max_wait = 0;
+
+    // Without -n: a quiet queue, a busy one, and the 10k and 100k searchers
+    // of match_sim's largest runs
+    if (players > 0) {
+        bench(players, max_wait, rounds);
+    } else {
+        int sizes[] = { 100, 1000, 10000, 100000 };
+        for (int i = 0; i < 4; i++) {
+            bench(sizes[i], max_wait, rounds);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+/*
+ * Match Replay Tool
+ *
+ * Rebuilds stored matches from their move logs (see replay.h).
+ *
+ * - Show one match:     match_replay -d file -m match_id [-a actions]
+ *   prints the game state after `actions` actions (default: the end)
+ * - Validate all:       match_replay -d file -v [-t threads] [-r rounds]
+ *   replays every stored log on all cores and reports matches/s
+ * - Generate fixtures:  match_replay -d file -g matches
+ *   plays random games through the rules and stores their logs
+ */
+
+#include "database.h"
+#include "replay.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_GENERATED_ACTIONS 2000
+#define GENERATE_BATCH 256
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ============ Generate ============
+
+// Play one game with random (but legal) choices; the game's log records it
+static void play_random_game(ActiveGame* game, unsigned int* choices) {
+    for (int i = 0; i < MAX_GENERATED_ACTIONS && game->state != GSTATE_ENDED; i++) {
+        int player = game->current_player;
+        int r = rand_r(choices) % 100;
+
+        switch (game->state) {
+            case GSTATE_WAITING_BUY:
+                if (r < 70) game_buy_property(game, player);
+                else game_skip_property(game, player);
+                break;
+            case GSTATE_WAITING_DEBT:
+                game_declare_bankrupt(game, player);
+                break;
+            default:
+                if (r < 10) game_upgrade_property(game, player, rand_r(choices) % TOTAL_PROPERTIES);
+                else if (r < 13) game_mortgage_property(game, player, rand_r(choices) % TOTAL_PROPERTIES);
+                else if (r < 15 && game->players[player].jailed) game_pay_jail_fine(game, player);
+                else game_roll_dice(game, player);
+                break;
+        }
+    }
+    if (game->state != GSTATE_ENDED) {
+        game_surrender(game, game->current_player);
+    }
+}
+
+static int generate(Database* db, int matches) {
+    ActiveGame* games = aligned_alloc(_Alignof(ActiveGame), GENERATE_BATCH * sizeof(ActiveGame));
+    MatchLogBlob* blobs = calloc(GENERATE_BATCH, sizeof(MatchLogBlob));
+    if (!games || !blobs) return -1;
+    memset(games, 0, GENERATE_BATCH * sizeof(ActiveGame));
+
+    int* existing = NULL;
+    int existing_count = 0;
+    db_get_match_log_ids(db, &existing, &existing_count);
+    int next_id = existing_count > 0 ? existing[existing_count - 1] + 1 : 1;
+    free(existing);
+
+    unsigned int choices = (unsigned int)time(NULL);
+    int pending = 0;
+    long events = 0;
+    for (int m = 0; m < matches; m++) {
+        ActiveGame* game = &games[pending];
+        int match_id = next_id + m;
+        unsigned int seed = rand_r(&choices);
+
+        pthread_mutex_init(&game->mutex, NULL);
+        game_init_state(game, match_id, 1, "bot_a", 2, "bot_b", seed);
+        move_log_start(&game->log, match_id, 1, 2, seed);
+        play_random_game(game, &choices);
+
+        blobs[pending].match_id = match_id;
+        blobs[pending].data = game->log.data;
+        blobs[pending].length = game->log.length;
+        blobs[pending].event_count = game->log.event_count;
+        events += game->log.event_count;
+        pending++;
+
+        if (pending == GENERATE_BATCH || m == matches - 1) {
+            if (db_save_match_logs(db, blobs, pending) != 0) return -1;
+            for (int i = 0; i < pending; i++) {
+                move_log_free(&games[i].log);
+                pthread_mutex_destroy(&games[i].mutex);
+            }
+            pending = 0;
+        }
+    }
+
+    fprintf(stderr, "Generated %d matches (%ld events), ids %d-%d\n",
+            matches, events, next_id, next_id + matches - 1);
+    free(blobs);
+    free(games);
+    return 0;
+}
+
+// ============ Show ============
+
+static int show(Database* db, int match_id, int actions) {
+    uint8_t* data;
+    size_t length;
+    if (db_load_match_log(db, match_id, &data, &length) != 0) {
+        fprintf(stderr, "No move log for match %d\n", match_id);
+        return -1;
+    }
+
+    Replay* replay = aligned_alloc(_Alignof(Replay), sizeof(Replay));
+    if (!replay || replay_open(replay, data, length) != 0) {
+        fprintf(stderr, "Match %d: %s\n", match_id, replay ? replay->error : "out of memory");
+        free(replay);
+        free(data);
+        return -1;
+    }
+
+    // Show the real usernames instead of ids
+    for (int i = 0; i < 2; i++) {
+        UserInfo info;
+        if (db_get_user_info(db, replay->game.players[i].user_id, &info) == 0) {
+            snprintf(replay->game.usernames[i], sizeof(replay->game.usernames[i]),
+                     "%s", info.username);
+        }
+    }
+
+    int applied = replay_run(replay, actions);
+    int rc = 0;
+    if (applied < 0) {
+        fprintf(stderr, "Match %d diverged after %d actions: %s\n",
+                match_id, replay->actions_applied, replay->error);
+        rc = -1;
+    }
+
+    char* state = game_serialize_state(&replay->game);
+    fprintf(stderr, "Match %d after %d actions (%zu byte log):\n", match_id, replay->actions_applied, length);
+    fprintf(stderr, "%s\n", state ? state : "");
+    free(state);
+
+    replay_close(replay);
+    free(replay);
+    free(data);
+    return rc;
+}
+
+// ============ Validate ============
+
+typedef struct {
+    int match_id;
+    uint8_t* data;
+    size_t length;
+} StoredLog;
+
+typedef struct {
+    StoredLog* logs;
+    int count;
+    int rounds;
+    atomic_int next;
+    atomic_long actions;
+    atomic_int failures;
+} ValidateJob;
+
+static void* validate_worker(void* arg) {
+    ValidateJob* job = arg;
+    int total = job->count * job->rounds;
+    long actions = 0;
+
+    for (;;) {
+        int i = atomic_fetch_add(&job->next, 1);
+        if (i >= total) break;
+
+        StoredLog* log = &job->logs[i % job->count];
+        char error[128];
+        int n = replay_validate(log->data, log->length, error, sizeof(error));
+        if (n < 0) {
+            // Report each broken log once
+            if (i < job->count) {
+                atomic_fetch_add(&job->failures, 1);
+                fprintf(stderr, "Match %d: %s\n", log->match_id, error);
+            }
+        } else {
+            actions += n;
+        }
+    }
+
+    atomic_fetch_add(&job->actions, actions);
+    return NULL;
+}
+
+static int validate(Database* db, int threads, int rounds) {
+    int* ids = NULL;
+    int count = 0;
+    if (db_get_match_log_ids(db, &ids, &count) != 0) return -1;
+    if (count == 0) {
+        fprintf(stderr, "No stored move logs\n");
+        return 0;
+    }
+
+    // Load everything first so the timed part is pure replay
+    StoredLog* logs = calloc(count, sizeof(StoredLog));
+    int loaded = 0;
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++) {
+        if (db_load_match_log(db, ids[i], &logs[loaded].data, &logs[loaded].length) == 0) {
+            logs[loaded].match_id = ids[i];
+            bytes += logs[loaded].length;
+            loaded++;
+        }
+    }
+    free(ids);
+
+    ValidateJob job = { .logs = logs, .count = loaded, .rounds = rounds };
+    atomic_init(&job.next, 0);
+    atomic_init(&job.actions, 0);
+    atomic_init(&job.failures, 0);
+
+    pthread_t* workers = malloc(sizeof(pthread_t) * threads);
+    double start = now_sec();
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&workers[i], NULL, validate_worker, &job);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    long replayed = (long)loaded * rounds;
+    int failures = atomic_load(&job.failures);
+    fprintf(stderr, "Validated %d matches (%zu bytes of logs) x %d rounds on %d threads\n",
+            loaded, bytes, rounds, threads);
+    fprintf(stderr, "%d failed, %.3f s, %.0f matches/s, %.0f actions/s\n", failures, elapsed,
+            replayed / elapsed, atomic_load(&job.actions) / elapsed);
+
+    for (int i = 0; i < loaded; i++) free(logs[i].data);
+    free(logs);
+    free(workers);
+    return failures == 0 ? 0 : -1;
+}
+
+int main(int argc, char* argv[]) {
+    const char* db_file = "monopoly.db";
+    int match_id = 0;
+    int actions = -1;
+    int do_validate = 0;
+    int generate_count = 0;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int rounds = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) db_file = argv[++i];
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) match_id = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) actions = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-v") == 0) do_validate = 1;
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) rounds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) generate_count = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-d file] (-m match_id [-a actions] | -v [-t threads] [-r rounds] | -g matches)\n",
+                   argv[0]);
+            return 0;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (rounds < 1) rounds = 1;
+    if (!match_id && !do_validate && generate_count <= 0) {
+        printf("Nothing to do (use -m, -v or -g)\n");
+        return 0;
+    }
+
+    // The rules and the database layer log to stdout; keep the report readable
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    Database db;
+    if (db_init(&db, db_file) != 0) {
+        fprintf(stderr, "Cannot open %s\n", db_file);
+        return 1;
+    }
+
+    int rc = 0;
+    if (generate_count > 0 && generate(&db, generate_count) != 0) rc = 1;
+    if (match_id && show(&db, match_id, actions) != 0) rc = 1;
+    if (do_validate && validate(&db, threads, rounds) != 0) rc = 1;
+
+    db_close(&db);
+    return rc;
+}
@@ -0,0 +1,488 @@
+/*
+ * Matchmaking Simulator
+ *
+ * Runs the matchmaking engine (match_queue.c with the ranges of elo.c) on
+ * a virtual clock, following the matchmaking thread's policy: a player
+ * who starts searching takes the best acceptable opponent already waiting
+ * or joins the queue, and the queue is paired again whenever someone's
+ * range widens (and, with -b, bots take whoever waited BOT_MATCH_AFTER).
+ * Players arrive at a fixed rate with ratings from a chosen distribution,
+ * and give up after an exponentially distributed patience. The queue
+ * starts with -n players who have been searching for up to a minute, as
+ * after a restart, and is paired on a tick of its own. That tick pairs
+ * off most of it, and in a queue that large nearly every arrival finds an
+ * opponent at once, so arrivals alone keep it small. With -S (sustained
+ * load) the queue is held at -n instead: every second the searchers who
+ * bring it back to -n join without looking for an opponent, as when the
+ * matchmaking thread falls behind, and the queue is paired each second;
+ * patience then barely matters, since a second is all anyone waits.
+ * Reports:
+ * - Queue size over the run (each second, before pairing)
+ * - Wait until matched (virtual seconds): percentiles and how many gave up
+ * - Rating gap of the matches: percentiles and a histogram
+ * - CPU time of the first tick (the prefilled queue), per later pairing
+ *   tick with the queue size they ran on, and per arrival (real time)
+ *
+ * Range changes are compile-time constants of elo.h; build a copy of the
+ * simulator with others through SIM_DEFS, e.g.
+ *   make sim SIM_DEFS="-DELO_MATCHMAKING_RANGE=100 -DELO_RANGE_STEP=50"
+ *
+ * Usage: match_sim [-n players] [-l arrivals_per_sec] [-t seconds]
+ *                  [-d normal|uniform|bimodal] [-m mean] [-s spread]
+ *                  [-a patience] [-p greedy|batch] [-b] [-S] [-r seed]
+ */
+
+#include "match_queue.h"
+#include "elo.h"
+#include "bot.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_START 1000000           // Virtual time the run starts at
+#define SIM_PREFILL_WAIT 60         // Longest wait of the players queued at the start
+#define GAP_BUCKET 25               // Rating points per gap histogram bucket
+#define GAP_BUCKETS (ELO_MATCHMAKING_RANGE_MAX / GAP_BUCKET + 1)
+
+typedef enum {
+    DIST_NORMAL,
+    DIST_UNIFORM,
+    DIST_BIMODAL
+} RatingDist;
+
+typedef struct {
+    int players;                    // Queued at the start (and held with sustain)
+    double arrivals;                // Per virtual second
+    int seconds;
+    RatingDist dist;
+    int mean;
+    int spread;
+    double patience;                // Mean seconds before giving up (0: never)
+    int batch;
+    int bots;
+    int sustain;                    // Refill the queue to players every second
+    unsigned int seed;
+} SimConfig;
+
+// A player who will give up at a time, unless matched first
+typedef struct {
+    int at;
+    int user_id;
+    int elo_rating;
+} Abandon;
+
+typedef struct {
+    Abandon* items;
+    int count;
+    int capacity;
+} AbandonHeap;
+
+// Growable array of ints
+typedef struct {
+    int* items;
+    int count;
+    int capacity;
+} IntList;
+
+typedef struct {
+    IntList waits;                  // Matched players' waits
+    IntList gaps;                   // Rating gap per match
+    IntList bot_waits;
+    IntList queue_sizes;            // At every virtual second, before pairing
+    IntList tick_us;                // CPU time per pairing tick after the first
+    IntList tick_sizes;             // Queue size those ticks started with
+    long gap_hist[GAP_BUCKETS];
+    long abandoned;
+    long arrivals;
+    long top_ups;                   // Arrivals that held the queue at its size
+    double arrival_seconds;         // CPU time of all arrivals
+    int ticks;
+    int prefill_us;                 // The first tick, on the prefilled queue
+    int prefill_size;
+    int prefill_pairs;
+} SimStats;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int list_push(IntList* list, int value) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 1024;
+        int* items = realloc(list->items, sizeof(int) * capacity);
+        if (!items) return -1;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = value;
+    return 0;
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Value below which a fraction of a sorted list lies
+static int percentile(const IntList* sorted, double fraction) {
+    if (sorted->count == 0) return 0;
+    int i = (int)(fraction * (sorted->count - 1) + 0.5);
+    return sorted->items[i];
+}
+
+// ============ Population ============
+
+static double uniform(unsigned int* seed) {
+    return (rand_r(seed) + 1.0) / (RAND_MAX + 2.0);
+}
+
+static double gaussian(unsigned int* seed) {
+    return sqrt(-2 * log(uniform(seed))) * cos(2 * M_PI * uniform(seed));
+}
+
+static int random_rating(const SimConfig* config, unsigned int* seed) {
+    double rating;
+    switch (config->dist) {
+        case DIST_UNIFORM:
+            rating = config->mean + config->spread * sqrt(3) * (2 * uniform(seed) - 1);
+            break;
+        case DIST_BIMODAL:
+            // Two equal groups a spread apart on either side of the mean
+            rating = config->mean + (rand_r(seed) % 2 ? config->spread : -config->spread) +
+                     config->spread / 3.0 * gaussian(seed);
+            break;
+        default:
+            rating = config->mean + config->spread * gaussian(seed);
+            break;
+    }
+    return rating < ELO_MIN_RATING ? ELO_MIN_RATING : (int)rating;
+}
+
+// Arrivals in one second: Poisson with the configured rate
+static int arrivals_this_second(double rate, unsigned int* seed) {
+    if (rate > 50) {
+        int count = (int)(rate + sqrt(rate) * gaussian(seed) + 0.5);
+        return count < 0 ? 0 : count;
+    }
+    int count = 0;
+    for (double p = uniform(seed), limit = exp(-rate); p > limit; p *= uniform(seed)) count++;
+    return count;
+}
+
+// ============ Abandons ============
+
+static int abandon_push(AbandonHeap* heap, Abandon item) {
+    if (heap->count == heap->capacity) {
+        int capacity = heap->capacity ? heap->capacity * 2 : 1024;
+        Abandon* items = realloc(heap->items, sizeof(Abandon) * capacity);
+        if (!items) return -1;
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+    int i = heap->count++;
+    while (i > 0 && item.at < heap->items[(i - 1) / 2].at) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i] = item;
+    return 0;
+}
+
+static Abandon abandon_pop(AbandonHeap* heap) {
+    Abandon top = heap->items[0];
+    Abandon last = heap->items[--heap->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && heap->items[child + 1].at < heap->items[child].at) child++;
+        if (last.at <= heap->items[child].at) break;
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count > 0) heap->items[i] = last;
+    return top;
+}
+
+// ============ Simulation ============
+
+static void record_match(SimStats* stats, const MatchmakingPlayer* a, const MatchmakingPlayer* b, int now) {
+    int gap = abs(a->elo_rating - b->elo_rating);
+    list_push(&stats->gaps, gap);
+    stats->gap_hist[gap / GAP_BUCKET < GAP_BUCKETS ? gap / GAP_BUCKET : GAP_BUCKETS - 1]++;
+    list_push(&stats->waits, now - a->search_start_time);
+    list_push(&stats->waits, now - b->search_start_time);
+}
+
+static void schedule(int* tick, int at) {
+    if (at >= 0 && (*tick < 0 || at < *tick)) *tick = at;
+}
+
+// Queue a player who started searching at started, who gives up after
+// their patience; returns the first time the queue should be paired for them
+static int enqueue(MatchQueue* queue, AbandonHeap* abandons, const SimConfig* config,
+                   int user_id, int elo_rating, int started, int now, unsigned int* seed) {
+    match_queue_add(queue, user_id, "", elo_rating, (int64_t)started * 1000, -1);
+    if (config->patience > 0) {
+        int gives_up = started + (int)(-config->patience * log(uniform(seed)));
+        abandon_push(abandons, (Abandon){ gives_up > now ? gives_up : now, user_id, elo_rating });
+    }
+    int tick = -1;
+    int change = elo_next_range_change(now - started);
+    if (change >= 0) schedule(&tick, started + change);
+    if (config->bots) schedule(&tick, started + BOT_MATCH_AFTER);
+    return tick;
+}
+
+// A player starts searching: best waiting opponent, or the queue
+static void arrive(MatchQueue* queue, AbandonHeap* abandons, SimStats* stats, const SimConfig* config,
+                   int* tick, int user_id, int elo_rating, int now, unsigned int* seed) {
+    MatchmakingPlayer partner;
+    if (match_queue_take_partner(queue, elo_rating, -1, now, &partner) == 0) {
+        MatchmakingPlayer self = { .user_id = user_id, .elo_rating = elo_rating, .search_start_time = now,
+                                   .search_started_ms = (int64_t)now * 1000 };
+        record_match(stats, &partner, &self, now);
+        return;
+    }
+    schedule(tick, enqueue(queue, abandons, config, user_id, elo_rating, now, now, seed));
+}
+
+// Pair the queue; the first tick of a prefilled run is kept apart from
+// the others, which run on whatever the arrivals left
+static void pair_tick(MatchQueue* queue, MatchPair* pairs, SimStats* stats, const SimConfig* config,
+                      int now, int prefill) {
+    int size = match_queue_size(queue);
+    double start = now_sec();
+    int count = config->batch ? match_queue_pair_batch(queue, now, pairs)
+                              : match_queue_pair(queue, now, pairs);
+    int us = (int)((now_sec() - start) * 1e6);
+    if (prefill) {
+        stats->prefill_us = us;
+        stats->prefill_size = size;
+        stats->prefill_pairs = count;
+    } else {
+        list_push(&stats->tick_us, us);
+        list_push(&stats->tick_sizes, size);
+        stats->ticks++;
+    }
+
+    for (int i = 0; i < count; i++) {
+        record_match(stats, &pairs[i].first, &pairs[i].second, now);
+    }
+    if (!config->bots) return;
+    for (int i = 0; i < queue->count; i++) {
+        MatchmakingPlayer player = queue->players[i];
+        if (player.user_id != 0 && now - player.search_start_time >= BOT_MATCH_AFTER) {
+            list_push(&stats->bot_waits, now - player.search_start_time);
+            match_queue_remove(queue, player.user_id, player.elo_rating);
+        }
+    }
+}
+
+// When the queue is next worth pairing, as the matchmaking thread works it
+// out (-1: not until someone arrives)
+static int next_tick(const MatchQueue* queue, const SimConfig* config, int now) {
+    int next = match_queue_next_change(queue, now);
+    for (int i = 0; config->bots && i < queue->count; i++) {
+        int due = queue->players[i].search_start_time + BOT_MATCH_AFTER;
+        if (queue->players[i].user_id != 0 && (next < 0 || due < next)) next = due;
+    }
+    return next >= 0 && next <= now ? now + 1 : next;
+}
+
+// Room for pairing a queue of size players
+static MatchPair* grow_pairs(MatchPair* pairs, int* capacity, int size) {
+    if (size / 2 + 1 <= *capacity) return pairs;
+    MatchPair* grown = realloc(pairs, sizeof(MatchPair) * (size / 2 + 1));
+    if (grown) *capacity = size / 2 + 1;
+    return grown;
+}
+
+static void simulate(const SimConfig* config, SimStats* stats) {
+    MatchQueue queue;
+    AbandonHeap abandons = { 0 };
+    unsigned int seed = config->seed;
+    int user_id = 0;
+    int now = SIM_START;
+    match_queue_init(&queue);
+    MatchPair* pairs = NULL;
+    int pairs_capacity = 0;
+    int tick = -1;
+
+    // Searchers carried over from before the run, paired at once on a tick
+    // of their own
+    for (int i = 0; i < config->players; i++) {
+        int waited = rand_r(&seed) % (SIM_PREFILL_WAIT + 1);
+        enqueue(&queue, &abandons, config, ++user_id, random_rating(config, &seed), now - waited, now, &seed);
+    }
+    if (config->players > 0) {
+        pairs = grow_pairs(pairs, &pairs_capacity, match_queue_size(&queue));
+        if (!pairs) {
+            match_queue_free(&queue);
+            return;
+        }
+        pair_tick(&queue, pairs, stats, config, now, 1);
+        tick = next_tick(&queue, config, now);
+    }
+
+    for (; now < SIM_START + config->seconds; now++) {
+        // Everyone who gave up by now leaves (a no-op if they were matched)
+        while (abandons.count > 0 && abandons.items[0].at <= now) {
+            Abandon gone = abandon_pop(&abandons);
+            if (match_queue_remove(&queue, gone.user_id, gone.elo_rating) == 0) stats->abandoned++;
+        }
+
+        int arrivals = arrivals_this_second(config->arrivals, &seed);
+        double start = now_sec();
+        for (int i = 0; i < arrivals; i++) {
+            arrive(&queue, &abandons, stats, config, &tick, ++user_id, random_rating(config, &seed), now, &seed);
+        }
+        // Sustained load: the searchers who bring the queue back to its size
+        // join it without looking for an opponent first, and are paired on
+        // this second's tick
+        while (config->sustain && match_queue_size(&queue) < config->players) {
+            schedule(&tick, enqueue(&queue, &abandons, config, ++user_id, random_rating(config, &seed),
+                                    now, now, &seed));
+            stats->top_ups++;
+            arrivals++;
+        }
+        if (config->sustain) schedule(&tick, now);
+        stats->arrival_seconds += now_sec() - start;
+        stats->arrivals += arrivals;
+        list_push(&stats->queue_sizes, match_queue_size(&queue));
+
+        if (tick >= 0 && now >= tick) {
+            pairs = grow_pairs(pairs, &pairs_capacity, match_queue_size(&queue));
+            if (!pairs) break;
+            pair_tick(&queue, pairs, stats, config, now, 0);
+            tick = next_tick(&queue, config, now);
+        }
+    }
+
+    free(pairs);
+    free(abandons.items);
+    match_queue_free(&queue);
+}
+
+// ============ Report ============
+
+static void report(const SimConfig* config, SimStats* stats) {
+    static const char* dist_names[] = { "normal", "uniform", "bimodal" };
+    fprintf(stderr, "%d queued%s, %.0f arrivals/s, %ds, %s ratings %d +- %d, patience %.0fs, %s%s:\n",
+            config->players, config->sustain ? " (sustained)" : "", config->arrivals, config->seconds,
+            dist_names[config->dist], config->mean, config->spread, config->patience,
+            config->batch ? "batch" : "greedy", config->bots ? ", bots" : "");
+
+    qsort(stats->queue_sizes.items, stats->queue_sizes.count, sizeof(int), compare_int);
+    qsort(stats->waits.items, stats->waits.count, sizeof(int), compare_int);
+    qsort(stats->gaps.items, stats->gaps.count, sizeof(int), compare_int);
+    qsort(stats->tick_us.items, stats->tick_us.count, sizeof(int), compare_int);
+    qsort(stats->tick_sizes.items, stats->tick_sizes.count, sizeof(int), compare_int);
+    qsort(stats->bot_waits.items, stats->bot_waits.count, sizeof(int), compare_int);
+
+    long searches = stats->arrivals + config->players;
+    fprintf(stderr, "  queue:   median %d, p99 %d, max %d players\n",
+            percentile(&stats->queue_sizes, 0.5), percentile(&stats->queue_sizes, 0.99),
+            percentile(&stats->queue_sizes, 1.0));
+    fprintf(stderr, "  arrived: %.1f/s, %.1f/s of them holding the queue at its size\n",
+            (double)stats->arrivals / config->seconds, (double)stats->top_ups / config->seconds);
+    fprintf(stderr, "  matched: %d of %ld searches (%.1f%%), %d to bots, %ld gave up (%.1f%%)\n",
+            stats->waits.count, searches, 100.0 * stats->waits.count / (searches ? searches : 1),
+            stats->bot_waits.count, stats->abandoned, 100.0 * stats->abandoned / (searches ? searches : 1));
+    fprintf(stderr, "  wait:    p50 %ds, p90 %ds, p99 %ds, max %ds\n",
+            percentile(&stats->waits, 0.5), percentile(&stats->waits, 0.9),
+            percentile(&stats->waits, 0.99), percentile(&stats->waits, 1.0));
+    fprintf(stderr, "  gap:     p50 %d, p90 %d, p99 %d, max %d\n",
+            percentile(&stats->gaps, 0.5), percentile(&stats->gaps, 0.9),
+            percentile(&stats->gaps, 0.99), percentile(&stats->gaps, 1.0));
+    for (int i = 0; i < GAP_BUCKETS; i++) {
+        if (stats->gap_hist[i] == 0) continue;
+        fprintf(stderr, "    %3d-%-3d %8ld  %5.1f%%\n", i * GAP_BUCKET, (i + 1) * GAP_BUCKET - 1,
+                stats->gap_hist[i], 100.0 * stats->gap_hist[i] / (stats->gaps.count ? stats->gaps.count : 1));
+    }
+
+    double tick_total = 0;
+    for (int i = 0; i < stats->tick_us.count; i++) tick_total += stats->tick_us.items[i];
+    if (config->players > 0) {
+        fprintf(stderr, "  prefill: first tick %.3f ms on %d players, %d pairs\n",
+                stats->prefill_us / 1000.0, stats->prefill_size, stats->prefill_pairs);
+    }
+    fprintf(stderr, "  cpu:     %d ticks on a queue of median %d (p99 %d), mean %.3f ms, p99 %.3f ms, "
+            "max %.3f ms; %.2f us per arrival\n",
+            stats->ticks, percentile(&stats->tick_sizes, 0.5), percentile(&stats->tick_sizes, 0.99),
+            stats->ticks ? tick_total / stats->ticks / 1000 : 0,
+            percentile(&stats->tick_us, 0.99) / 1000.0, percentile(&stats->tick_us, 1.0) / 1000.0,
+            stats->arrivals ? stats->arrival_seconds * 1e6 / stats->arrivals : 0);
+}
+
+static void free_stats(SimStats* stats) {
+    free(stats->waits.items);
+    free(stats->gaps.items);
+    free(stats->bot_waits.items);
+    free(stats->queue_sizes.items);
+    free(stats->tick_us.items);
+    free(stats->tick_sizes.items);
+}
+
+static void run(const SimConfig* config) {
+    SimStats stats;
+    memset(&stats, 0, sizeof(stats));
+    simulate(config, &stats);
+    report(config, &stats);
+    free_stats(&stats);
+}
+
+int main(int argc, char* argv[]) {
+    SimConfig config = {
+        .players = 0,
+        .arrivals = -1,
+        .seconds = 300,
+        .dist = DIST_NORMAL,
+        .mean = 1200,
+        .spread = 300,
+        .patience = 120,
+        .seed = 42,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) config.players = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) config.arrivals = atof(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) config.seconds = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) config.mean = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) config.spread = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) config.patience = atof(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) config.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-b") == 0) config.bots = 1;
+        else if (strcmp(argv[i], "-S") == 0) config.sustain = 1;
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) config.batch = strcmp(argv[++i], "batch") == 0;
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            const char* dist = argv[++i];
+            config.dist = strcmp(dist, "uniform") == 0 ? DIST_UNIFORM
+                        : strcmp(dist, "bimodal") == 0 ? DIST_BIMODAL : DIST_NORMAL;
+        } else {
+            printf("Usage: %s [-n players] [-l arrivals_per_sec] [-t seconds] [-d normal|uniform|bimodal]\n"
+                   "       [-m mean] [-s spread] [-a patience] [-p greedy|batch] [-b] [-S] [-r seed]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (config.seconds < 1) config.seconds = 1;
+
+    // Without -n: 1k, 10k and 100k searchers, with arrivals at a thirtieth
+    // of the queue per second unless -l says otherwise (sustained: only
+    // those the queue needs to stay at its size)
+    int sizes[] = { 1000, 10000, 100000 };
+    int runs = config.players > 0 ? 1 : 3;
+    for (int i = 0; i < runs; i++) {
+        SimConfig sized = config;
+        if (config.players <= 0) sized.players = sizes[i];
+        if (sized.arrivals < 0) sized.arrivals = sized.sustain ? 0 : sized.players / 30.0;
+        run(&sized);
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+/*
+ * Monte Carlo Game Simulator
+ *
+ * Plays complete games through the server rules (game_state.c) with
+ * scripted policies on all cores, without sockets, database or move logs,
+ * and reports:
+ * - Win rates per seat, with the policy each seat played
+ * - Game length distribution (dice rolls until a bankruptcy)
+ * - How often each square ends a roll, next to the long-run share from
+ *   the Markov chain (landing_table.h); short games stay closer to their
+ *   start on GO with no jail cards
+ * - Games per second
+ *
+ * Policies:
+ *   always   buys everything it can afford, never builds
+ *   reserve  buys only while keeping a cash reserve
+ *   builder  buys like always, then builds on its streets (monopolies first)
+ *            while keeping a cash reserve
+ *   never    never buys
+ *
+ * Balance values are compile-time constants of the rules; build a copy of
+ * the simulator with others through SIM_DEFS, e.g.
+ *   make sim SIM_DEFS="-DSTARTING_MONEY=2000 -DGO_BONUS=150"
+ *
+ * Usage: monopoly_sim [-n games] [-t threads] [-a policy] [-b policy]
+ *                     [-m max_rolls] [-s seed]
+ */
+
+#include "game_state.h"
+#include "landing_table.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_BATCH 256           // Games a worker claims at a time
+#define SIM_RESERVE 200         // Cash the cautious policies keep
+#define SIM_BUILDS_PER_TURN 3   // Houses a builder adds before rolling
+#define LENGTH_BUCKET 10        // Rolls per game length histogram bucket
+#define LENGTH_BUCKETS 51       // Last bucket collects everything longer
+
+typedef enum {
+    POLICY_ALWAYS,
+    POLICY_RESERVE,
+    POLICY_BUILDER,
+    POLICY_NEVER,
+    POLICY_COUNT
+} Policy;
+
+static const char* policy_names[POLICY_COUNT] = { "always", "reserve", "builder", "never" };
+
+static const char* square_names[TOTAL_PROPERTIES] = {
+    "GO", "Mediterranean", "Community Chest", "Baltic", "Income Tax",
+    "Reading RR", "Oriental", "Chance", "Vermont", "Connecticut",
+    "Jail", "St. Charles", "Electric Co", "States", "Virginia",
+    "Pennsylvania RR", "St. James", "Community Chest", "Tennessee", "New York",
+    "Free Parking", "Kentucky", "Chance", "Indiana", "Illinois",
+    "B&O RR", "Atlantic", "Ventnor", "Water Works", "Marvin Gardens",
+    "Go to Jail", "Pacific", "North Carolina", "Community Chest", "Pennsylvania",
+    "Short Line RR", "Chance", "Park Place", "Luxury Tax", "Boardwalk"
+};
+
+// Per-worker totals, merged at the end
+typedef struct {
+    _Alignas(64) long games;
+    long wins[2];
+    long unfinished;
+    long rolls;
+    long finished_rolls;
+    long length_hist[LENGTH_BUCKETS];
+    long landings[TOTAL_PROPERTIES];
+} SimStats;
+
+typedef struct {
+    int games;
+    int max_rolls;
+    unsigned int seed;
+    Policy policy[2];
+    atomic_int next;
+} SimJob;
+
+typedef struct {
+    SimJob* job;
+    SimStats stats;
+} SimWorker;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int parse_policy(const char* name) {
+    for (int i = 0; i < POLICY_COUNT; i++) {
+        if (strcmp(name, policy_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+// ============ Policies ============
+
+static int wants_to_buy(ActiveGame* game, int player, Policy policy) {
+    int price = game_property_price(game->players[player].position);
+    int money = game->players[player].money;
+    switch (policy) {
+        case POLICY_ALWAYS:
+        case POLICY_BUILDER:
+            return money >= price;
+        case POLICY_RESERVE:
+            return money - price >= SIM_RESERVE;
+        default:
+            return 0;
+    }
+}
+
+// Street to build on next: the least built one, complete groups first
+static int pick_build(ActiveGame* game, int player) {
+    BoardMask monopolies = board_monopolies(game->owned[player]);
+    BoardMask candidates = monopolies ? monopolies : game->owned[player];
+    int best = -1;
+    while (candidates) {
+        int pos = board_pop_lowest(&candidates);
+        const PropertyState* prop = &game->properties[pos];
+        int cost = game_upgrade_cost(pos);
+        if (cost == 0 || prop->mortgaged || prop->upgrades >= 5) continue;
+        if (game->players[player].money - cost < SIM_RESERVE) continue;
+        if (best < 0 || prop->upgrades < game->properties[best].upgrades) best = pos;
+    }
+    return best;
+}
+
+// One action by whoever is to move; returns 1 if it was a dice roll
+static int play_action(ActiveGame* game, const Policy policy[2]) {
+    int player = game->current_player;
+
+    switch (game->state) {
+        case GSTATE_WAITING_BUY:
+            if (wants_to_buy(game, player, policy[player])) game_buy_property(game, player);
+            else game_skip_property(game, player);
+            return 0;
+        case GSTATE_WAITING_DEBT:
+            // The policies do not raise money: bankrupt at once
+            game_declare_bankrupt(game, player);
+            return 0;
+        default:
+            if (policy[player] == POLICY_BUILDER) {
+                for (int i = 0; i < SIM_BUILDS_PER_TURN; i++) {
+                    int pos = pick_build(game, player);
+                    if (pos < 0) break;
+                    game_upgrade_property(game, player, pos);
+                }
+            }
+            game_roll_dice(game, player);
+            return 1;
+    }
+}
+
+// ============ Workers ============
+
+static void play_game(ActiveGame* game, int index, SimJob* job, SimStats* stats) {
+    // Spread consecutive indices over the seed space
+    unsigned int seed = (job->seed + (unsigned int)index) * 2654435761u;
+    game_init_state(game, index + 1, 1, "a", 2, "b", seed);
+    game->active = 1;
+
+    int rolls = 0;
+    while (game->state != GSTATE_ENDED && rolls < job->max_rolls) {
+        int roller = game->current_player;
+        if (play_action(game, job->policy)) {
+            rolls++;
+            stats->landings[game->players[roller].position]++;
+        }
+    }
+
+    stats->games++;
+    stats->rolls += rolls;
+    if (game->state == GSTATE_ENDED) {
+        stats->wins[game->players[0].money >= 0 ? 0 : 1]++;
+        stats->finished_rolls += rolls;
+        int bucket = rolls / LENGTH_BUCKET;
+        stats->length_hist[bucket < LENGTH_BUCKETS ? bucket : LENGTH_BUCKETS - 1]++;
+    } else {
+        stats->unfinished++;
+    }
+}
+
+static void* sim_worker(void* arg) {
+    SimWorker* worker = arg;
+    SimJob* job = worker->job;
+
+    ActiveGame* game = aligned_alloc(_Alignof(ActiveGame), sizeof(ActiveGame));
+    if (!game) return NULL;
+    memset(game, 0, sizeof(*game));
+    pthread_mutex_init(&game->mutex, NULL);
+
+    for (;;) {
+        int first = atomic_fetch_add(&job->next, SIM_BATCH);
+        if (first >= job->games) break;
+        int last = first + SIM_BATCH < job->games ? first + SIM_BATCH : job->games;
+        for (int i = first; i < last; i++) {
+            play_game(game, i, job, &worker->stats);
+        }
+    }
+
+    pthread_mutex_destroy(&game->mutex);
+    free(game);
+    return NULL;
+}
+
+// ============ Report ============
+
+// Smallest game length (in rolls) reached by the given share of finished games
+static int length_percentile(const SimStats* total, double share) {
+    long finished = total->wins[0] + total->wins[1];
+    long seen = 0;
+    for (int b = 0; b < LENGTH_BUCKETS; b++) {
+        seen += total->length_hist[b];
+        if (seen >= share * finished) return (b + 1) * LENGTH_BUCKET;
+    }
+    return LENGTH_BUCKETS * LENGTH_BUCKET;
+}
+
+static void report(const SimJob* job, const SimStats* total, int threads, double elapsed) {
+    long finished = total->wins[0] + total->wins[1];
+
+    fprintf(stderr, "%ld games on %d threads in %.2f s: %.0f games/s, %.1f M rolls/s\n",
+            total->games, threads, elapsed, total->games / elapsed, total->rolls / elapsed / 1e6);
+    fprintf(stderr, "Rules: STARTING_MONEY=%d GO_BONUS=%d JAIL_FINE=%d MAX_JAIL_TURNS=%d\n\n",
+            STARTING_MONEY, GO_BONUS, JAIL_FINE, MAX_JAIL_TURNS);
+
+    fprintf(stderr, "Win rates:\n");
+    for (int p = 0; p < 2; p++) {
+        fprintf(stderr, "  seat %d (%-7s) %6.2f%%\n", p + 1, policy_names[job->policy[p]],
+                total->games ? 100.0 * total->wins[p] / total->games : 0.0);
+    }
+    fprintf(stderr, "  unfinished after %d rolls: %.2f%%\n\n", job->max_rolls,
+            total->games ? 100.0 * total->unfinished / total->games : 0.0);
+
+    if (finished > 0) {
+        fprintf(stderr, "Game length (rolls, finished games): mean %.1f, p10 <%d, p50 <%d, p90 <%d\n",
+                (double)total->finished_rolls / finished, length_percentile(total, 0.1),
+                length_percentile(total, 0.5), length_percentile(total, 0.9));
+        long peak = 1;
+        for (int b = 0; b < LENGTH_BUCKETS; b++) {
+            if (total->length_hist[b] > peak) peak = total->length_hist[b];
+        }
+        for (int b = 0; b < LENGTH_BUCKETS; b++) {
+            if (total->length_hist[b] == 0) continue;
+            int bar = (int)(40 * total->length_hist[b] / peak);
+            fprintf(stderr, "  %4d-%-5d %6.2f%% %.*s\n", b * LENGTH_BUCKET,
+                    b == LENGTH_BUCKETS - 1 ? 0 : (b + 1) * LENGTH_BUCKET - 1,
+                    100.0 * total->length_hist[b] / finished, bar,
+                    "########################################");
+        }
+        fprintf(stderr, "\n");
+    }
+
+    fprintf(stderr, "Where rolls end (%% of %ld rolls, long-run share in brackets):\n", total->rolls);
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        fprintf(stderr, "  %2d %-16s %5.2f%% (%5.2f)%s", i, square_names[i],
+                total->rolls ? 100.0 * total->landings[i] / total->rolls : 0.0,
+                100.0 * landing_per_roll[i], i % 2 == 1 ? "\n" : "   ");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int games = 1000000;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int max_rolls = 1000;
+    unsigned int seed = 1;
+    int policy[2] = { POLICY_BUILDER, POLICY_BUILDER };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) policy[0] = parse_policy(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) policy[1] = parse_policy(argv[++i]);
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) max_rolls = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else {
+            printf("Usage: %s [-n games] [-t threads] [-a policy] [-b policy] [-m max_rolls] [-s seed]\n"
+                   "Policies: always, reserve, builder, never\n", argv[0]);
+            return 0;
+        }
+    }
+    if (policy[0] < 0 || policy[1] < 0) {
+        fprintf(stderr, "Unknown policy (always, reserve, builder, never)\n");
+        return 1;
+    }
+    if (games < 1) games = 1;
+    if (threads < 1) threads = 1;
+    if (max_rolls < 1) max_rolls = 1;
+
+    // The rules log some actions to stdout; keep the report readable
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    SimJob job = { .games = games, .max_rolls = max_rolls, .seed = seed,
+                   .policy = { (Policy)policy[0], (Policy)policy[1] } };
+    atomic_init(&job.next, 0);
+
+    SimWorker* workers = aligned_alloc(_Alignof(SimWorker), sizeof(SimWorker) * threads);
+    pthread_t* ids = malloc(sizeof(pthread_t) * threads);
+    if (!workers || !ids) return 1;
+    memset(workers, 0, sizeof(SimWorker) * threads);
+
+    double start = now_sec();
+    for (int i = 0; i < threads; i++) {
+        workers[i].job = &job;
+        pthread_create(&ids[i], NULL, sim_worker, &workers[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    SimStats total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < threads; i++) {
+        const SimStats* s = &workers[i].stats;
+        total.games += s->games;
+        total.wins[0] += s->wins[0];
+        total.wins[1] += s->wins[1];
+        total.unfinished += s->unfinished;
+        total.rolls += s->rolls;
+        total.finished_rolls += s->finished_rolls;
+        for (int b = 0; b < LENGTH_BUCKETS; b++) total.length_hist[b] += s->length_hist[b];
+        for (int q = 0; q < TOTAL_PROPERTIES; q++) total.landings[q] += s->landings[q];
+    }
+
+    report(&job, &total, threads, elapsed);
+
+    free(ids);
+    free(workers);
+    return 0;
+}
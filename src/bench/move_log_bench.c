@@ -0,0 +1,207 @@
+/*
+ * Move Log Benchmark
+ *
+ * Compares recording moves as one match_moves row each (db_log_move with a
+ * JSON payload, one implicit transaction per move) against the binary
+ * move log: events appended in memory and persisted as one blob per match,
+ * many matches per transaction. Reports insert throughput, database size
+ * and how fast the streaming reader decodes the stored logs.
+ *
+ * Usage: move_log_bench [-d prefix] [-n matches] [-m moves] [-b batch]
+ */
+
+#include "database.h"
+#include "move_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+// A plausible action mix: mostly rolls, then buys/skips, some building
+static void random_event(MoveEvent* event, int move) {
+    int r = rand() % 100;
+    event->player = move & 1;
+    event->a = 0;
+    event->b = 0;
+    if (r < 55) {
+        event->type = MOVE_ROLL;
+        event->a = 1 + rand() % 6;
+        event->b = 1 + rand() % 6;
+    } else if (r < 65) {
+        event->type = MOVE_CARD;
+        event->a = (rand() % 200) - 50;
+    } else if (r < 78) {
+        event->type = MOVE_BUY;
+    } else if (r < 88) {
+        event->type = MOVE_SKIP;
+    } else if (r < 94) {
+        event->type = MOVE_UPGRADE;
+        event->a = rand() % 40;
+    } else if (r < 97) {
+        event->type = MOVE_MORTGAGE;
+        event->a = rand() % 40;
+    } else {
+        event->type = MOVE_PAY_FINE;
+    }
+}
+
+static int open_fresh(Database* db, const char* path) {
+    unlink(path);
+    if (db_open(db, DB_BACKEND_SQLITE, path) != 0) return -1;
+    db_create_user(db, "bench_a", "x", NULL);
+    db_create_user(db, "bench_b", "x", NULL);
+    return 0;
+}
+
+static double run_rows(const char* path, int matches, int moves) {
+    Database db;
+    if (open_fresh(&db, path) != 0) return -1;
+
+    srand(42);
+    double start = now_sec();
+    for (int m = 0; m < matches; m++) {
+        int match_id = db_create_match(&db, 1, 2, 1200, 1200);
+        for (int i = 0; i < moves; i++) {
+            MoveEvent event;
+            random_event(&event, i);
+            char data[64];
+            snprintf(data, sizeof(data), "{\"a\":%d,\"b\":%d}", event.a, event.b);
+            db_log_move(&db, match_id, 1 + event.player, i + 1, move_type_name(event.type), data);
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    db_close(&db);
+    return elapsed;
+}
+
+static double run_blobs(const char* path, int matches, int moves, int batch) {
+    Database db;
+    if (open_fresh(&db, path) != 0) return -1;
+
+    MoveLog* logs = calloc(batch, sizeof(MoveLog));
+    MatchLogBlob* blobs = calloc(batch, sizeof(MatchLogBlob));
+    int pending = 0;
+
+    srand(42);
+    double start = now_sec();
+    for (int m = 0; m < matches; m++) {
+        int match_id = db_create_match(&db, 1, 2, 1200, 1200);
+        MoveLog* log = &logs[pending];
+        move_log_start(log, match_id, 1, 2, (unsigned int)m);
+        for (int i = 0; i < moves; i++) {
+            MoveEvent event;
+            random_event(&event, i);
+            move_log_append(log, event.type, event.player, event.a, event.b);
+        }
+
+        blobs[pending].match_id = match_id;
+        blobs[pending].data = log->data;
+        blobs[pending].length = log->length;
+        blobs[pending].event_count = log->event_count;
+        pending++;
+
+        if (pending == batch || m == matches - 1) {
+            db_save_match_logs(&db, blobs, pending);
+            for (int i = 0; i < pending; i++) move_log_free(&logs[i]);
+            pending = 0;
+        }
+    }
+    double elapsed = now_sec() - start;
+
+    free(blobs);
+    free(logs);
+    db_close(&db);
+    return elapsed;
+}
+
+// Load every blob back and stream its events; returns events decoded
+static long read_blobs(const char* path, int matches, double* elapsed) {
+    Database db;
+    if (db_open(&db, DB_BACKEND_SQLITE, path) != 0) return -1;
+
+    long events = 0;
+    double start = now_sec();
+    for (int match_id = 1; match_id <= matches; match_id++) {
+        uint8_t* data;
+        size_t length;
+        if (db_load_match_log(&db, match_id, &data, &length) != 0) continue;
+
+        MoveLogReader reader;
+        MoveEvent event;
+        if (move_log_reader_init(&reader, data, length) == 0) {
+            while (move_log_reader_next(&reader, &event) == 1) events++;
+        }
+        free(data);
+    }
+    *elapsed = now_sec() - start;
+
+    db_close(&db);
+    return events;
+}
+
+int main(int argc, char* argv[]) {
+    const char* prefix = "move_log_bench";
+    int matches = 100;
+    int moves = 300;
+    int batch = 25;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) prefix = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) matches = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) moves = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) batch = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [-d prefix] [-n matches] [-m moves] [-b batch]\n", argv[0]);
+            return 0;
+        }
+    }
+    if (matches < 1 || moves < 1 || batch < 1) return 1;
+
+    char rows_path[256], blobs_path[256];
+    snprintf(rows_path, sizeof(rows_path), "%s_rows.db", prefix);
+    snprintf(blobs_path, sizeof(blobs_path), "%s_blobs.db", prefix);
+
+    // The database layer logs every user it creates; keep the report readable
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    double rows_s = run_rows(rows_path, matches, moves);
+    double blobs_s = run_blobs(blobs_path, matches, moves, batch);
+    if (rows_s < 0 || blobs_s < 0) {
+        fprintf(stderr, "Failed to open benchmark databases\n");
+        return 1;
+    }
+
+    double read_s = 0;
+    long decoded = read_blobs(blobs_path, matches, &read_s);
+
+    long rows_size = file_size(rows_path);
+    long blobs_size = file_size(blobs_path);
+    long events = (long)matches * moves;
+
+    fprintf(stderr, "%d matches x %d moves, blob batch of %d matches\n\n", matches, moves, batch);
+    fprintf(stderr, "%-22s %-10s %-14s %-12s\n", "mode", "total_s", "events_per_s", "db_bytes");
+    fprintf(stderr, "%-22s %-10.3f %-14.0f %-12ld\n", "row per move (JSON)", rows_s, events / rows_s, rows_size);
+    fprintf(stderr, "%-22s %-10.3f %-14.0f %-12ld\n", "blob per match", blobs_s, events / blobs_s, blobs_size);
+    fprintf(stderr, "\nSpeedup: %.1fx, size ratio: %.1fx\n", rows_s / blobs_s,
+            blobs_size > 0 ? (double)rows_size / blobs_size : 0.0);
+    fprintf(stderr, "Streaming read: %ld/%ld events in %.3f s (%.0f events/s)\n",
+            decoded, events, read_s, read_s > 0 ? decoded / read_s : 0.0);
+
+    unlink(rows_path);
+    unlink(blobs_path);
+    return decoded == events ? 0 : 1;
+}
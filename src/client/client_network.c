@@ -343,6 +343,10 @@ int client_send_heartbeat(ClientState* state) {
     return client_send(state, MSG_HEARTBEAT, NULL);
 }
 
+int client_answer_heartbeat(ClientState* state, const char* payload) {
+    return client_send(state, MSG_HEARTBEAT_ACK, payload);
+}
+
 const char* client_get_error(const char* payload) {
     static char error_msg[256];
     error_msg[0] = '\0';
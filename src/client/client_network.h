@@ -93,6 +93,10 @@ int client_decline_challenge(ClientState* state, int challenge_id);
 // Send heartbeat
 int client_send_heartbeat(ClientState* state);
 
+// Answer a heartbeat from the server, echoing its payload (the server
+// measures the round trip from it)
+int client_answer_heartbeat(ClientState* state, const char* payload);
+
 // Parse login response and update state
 int client_parse_login_response(ClientState* state, const char* payload);
 
@@ -350,6 +350,11 @@ int NetGame_processMessages(ClientState* client) {
                 case MSG_HEARTBEAT_ACK:
                     // Heartbeat acknowledged
                     break;
+                    
+                case MSG_HEARTBEAT:
+                    // Round trip probe from the server
+                    client_answer_heartbeat(client, msg.payload);
+                    break;
                 
                 case MSG_DRAW_OFFER:
                 case MSG_GAME_END:
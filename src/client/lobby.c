@@ -690,6 +690,11 @@ static void processServerMessages(ClientState* client, LobbyState* state) {
                     setStatus("Your challenge was declined", 0);
                     break;
                     
+                case MSG_HEARTBEAT:
+                    // Round trip probe from the server
+                    client_answer_heartbeat(client, msg.payload);
+                    break;
+                    
                 case MSG_ERROR:
                     {
                         cJSON* json = cJSON_Parse(msg.payload);
@@ -1,4 +1,8 @@
 #include "server.h"
+#include "game_state.h"
+#include "drain.h"
+#include "matchmaking.h"
+#include "hibernate.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,15 +21,6 @@ void hash_password(const char* password, char* output) {
     output[SHA256_DIGEST_LENGTH * 2] = '\0';
 }
 
-// Generate random session ID (64 hex characters)
-void generate_session_id(char* output) {
-    static const char hex_chars[] = "0123456789abcdef";
-    for (int i = 0; i < SESSION_ID_LENGTH; i++) {
-        output[i] = hex_chars[rand() % 16];
-    }
-    output[SESSION_ID_LENGTH] = '\0';
-}
-
 // Send a message to client
 int send_message(ConnectedClient* client, MessageType type, const char* payload) {
     if (!client || client->socket_fd < 0) return -1;
@@ -147,7 +142,113 @@ void handle_register(GameServer* server, ConnectedClient* client, NetworkMessage
     cJSON_Delete(json);
 }
 
+// Put a player who logs in while one of their games is still running (after
+// a dropped connection or a server restart) back into it: MSG_MATCH_FOUND
+// with "resumed" set, followed by the current MSG_GAME_STATE
+static void rejoin_game(GameServer* server, ConnectedClient* client) {
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
+    if (!game || game->state == GSTATE_ENDED) return;
+    
+    int me = (game->players[0].user_id == client->user_id) ? 0 : 1;
+    GamePlayerState* opponent = &game->players[1 - me];
+    
+    client->status = PLAYER_IN_GAME;
+    client->current_match_id = game->match_id;
+    db_set_player_online(&server->db, client->user_id, "in_game");
+    db_set_player_game(&server->db, client->user_id, game->match_id);
+    
+    UserInfo opponent_info;
+    int opponent_elo = 0;
+    if (db_get_user_info(&server->db, opponent->user_id, &opponent_info) == 0) {
+        opponent_elo = opponent_info.elo_rating;
+    }
+    
+    cJSON* msg = cJSON_CreateObject();
+    cJSON_AddNumberToObject(msg, "match_id", game->match_id);
+    cJSON_AddNumberToObject(msg, "opponent_id", opponent->user_id);
+    cJSON_AddStringToObject(msg, "opponent_name", game->usernames[1 - me]);
+    cJSON_AddNumberToObject(msg, "opponent_elo", opponent_elo);
+    cJSON_AddNumberToObject(msg, "your_player_num", me + 1);
+    cJSON_AddBoolToObject(msg, "resumed", 1);
+    cJSON_AddStringToObject(msg, "message", "Rejoined your match in progress");
+    
+    char* msg_str = cJSON_PrintUnformatted(msg);
+    send_message(client, MSG_MATCH_FOUND, msg_str);
+    free(msg_str);
+    cJSON_Delete(msg);
+    
+    char* state_json = game_serialize_state(game);
+    if (state_json) {
+        send_message(client, MSG_GAME_STATE, state_json);
+        free(state_json);
+    }
+    
+    printf("[AUTH] %s rejoined match %d\n", client->username, game->match_id);
+}
+
+// Finish a successful login: bind the user to this connection and send
+// MSG_LOGIN_RESPONSE. resume_session is the session being resumed, or NULL
+// to issue a new one.
+static void complete_login(GameServer* server, ConnectedClient* client,
+                           const UserInfo* info, const char* resume_session) {
+    if (resume_session) {
+        strncpy(client->session_id, resume_session, SESSION_ID_LENGTH);
+        client->session_id[SESSION_ID_LENGTH] = '\0';
+    } else {
+        session_store_create(&server->sessions, info->user_id, client->session_id);
+    }
+    client->user_id = info->user_id;
+    client->elo_rating = info->elo_rating;
+    strncpy(client->username, info->username, sizeof(client->username) - 1);
+    client->status = PLAYER_IDLE;
+    
+    // Mark player as online
+    db_set_player_online(&server->db, info->user_id, "idle");
+    
+    // Update last login
+    db_update_last_login(&server->db, info->user_id);
+    
+    // Send response
+    cJSON* response = cJSON_CreateObject();
+    cJSON_AddBoolToObject(response, "success", 1);
+    cJSON_AddNumberToObject(response, "user_id", info->user_id);
+    cJSON_AddStringToObject(response, "username", info->username);
+    cJSON_AddNumberToObject(response, "elo_rating", info->elo_rating);
+    cJSON_AddNumberToObject(response, "total_matches", info->total_matches);
+    cJSON_AddNumberToObject(response, "wins", info->wins);
+    cJSON_AddNumberToObject(response, "losses", info->losses);
+    cJSON_AddStringToObject(response, "session_id", client->session_id);
+    
+    char* response_str = cJSON_PrintUnformatted(response);
+    send_message(client, MSG_LOGIN_RESPONSE, response_str);
+    
+    free(response_str);
+    cJSON_Delete(response);
+    
+    printf("[AUTH] User %s: %s (id=%d, elo=%d)\n", resume_session ? "resumed session" : "logged in",
+           info->username, info->user_id, info->elo_rating);
+    
+    rejoin_game(server, client);
+}
+
+// Check if user is already logged in from another connection
+static int logged_in_elsewhere(GameServer* server, ConnectedClient* client, int user_id) {
+    pthread_mutex_lock(&server->clients_mutex);
+    ConnectedClient* existing = find_client_by_id(server, user_id);
+    pthread_mutex_unlock(&server->clients_mutex);
+    return existing && existing != client;
+}
+
+// While draining only players finishing a game here may log in
+static int refused_by_drain(GameServer* server, ConnectedClient* client, int user_id) {
+    ActiveGame* game = game_find_by_player(user_id);
+    if ((game && game->state != GSTATE_ENDED) || hibernate_find_player(user_id)) return 0;
+    return drain_reject(server, client, "please log in to another server");
+}
+
 // Handle login request
+// Payload is either {"username", "password"} or {"session_id"} to resume a
+// session after a reconnect (validated in memory, no database query)
 void handle_login(GameServer* server, ConnectedClient* client, NetworkMessage* msg) {
     printf("[AUTH] Login request from socket %d\n", client->socket_fd);
     
@@ -164,6 +265,24 @@ void handle_login(GameServer* server, ConnectedClient* client, NetworkMessage* m
         return;
     }
     
+    cJSON* session_item = cJSON_GetObjectItem(json, "session_id");
+    if (session_item && cJSON_IsString(session_item)) {
+        int user_id;
+        UserInfo info;
+        
+        if (session_store_validate(&server->sessions, session_item->valuestring, &user_id) != 0 ||
+            db_get_user_info(&server->db, user_id, &info) != 0) {
+            send_error(client, "Session expired, please login again");
+        } else if (logged_in_elsewhere(server, client, user_id)) {
+            send_error(client, "Already logged in from another location");
+        } else if (!refused_by_drain(server, client, user_id)) {
+            complete_login(server, client, &info, session_item->valuestring);
+        }
+        
+        cJSON_Delete(json);
+        return;
+    }
+    
     cJSON* username_item = cJSON_GetObjectItem(json, "username");
     cJSON* password_item = cJSON_GetObjectItem(json, "password");
     
@@ -188,56 +307,22 @@ void handle_login(GameServer* server, ConnectedClient* client, NetworkMessage* m
     
     int result = db_get_user_by_username(&server->db, username, &user_id, stored_hash, &elo);
     
-    if (result == 0 && strcmp(password_hash, stored_hash) == 0) {
-        // Check if user is already logged in from another connection
-        pthread_mutex_lock(&server->clients_mutex);
-        ConnectedClient* existing = find_client_by_id(server, user_id);
-        if (existing && existing != client) {
-            pthread_mutex_unlock(&server->clients_mutex);
+    UserInfo info;
+    if (result == 0 && strcmp(password_hash, stored_hash) == 0 &&
+        db_get_user_info(&server->db, user_id, &info) == 0) {
+        if (logged_in_elsewhere(server, client, user_id)) {
             send_error(client, "Already logged in from another location");
             cJSON_Delete(json);
             return;
         }
-        pthread_mutex_unlock(&server->clients_mutex);
-        
-        // Login successful
-        generate_session_id(client->session_id);
-        client->user_id = user_id;
-        client->elo_rating = elo;
-        strncpy(client->username, username, sizeof(client->username) - 1);
-        client->status = PLAYER_IDLE;
-        
-        // Create session in database
-        db_create_session(&server->db, user_id, client->session_id);
-        
-        // Mark player as online
-        db_set_player_online(&server->db, user_id, "idle");
-        
-        // Update last login
-        db_update_last_login(&server->db, user_id);
         
-        // Get full user info
-        UserInfo info;
-        db_get_user_info(&server->db, user_id, &info);
-        
-        // Send response
-        cJSON* response = cJSON_CreateObject();
-        cJSON_AddBoolToObject(response, "success", 1);
-        cJSON_AddNumberToObject(response, "user_id", user_id);
-        cJSON_AddStringToObject(response, "username", username);
-        cJSON_AddNumberToObject(response, "elo_rating", elo);
-        cJSON_AddNumberToObject(response, "total_matches", info.total_matches);
-        cJSON_AddNumberToObject(response, "wins", info.wins);
-        cJSON_AddNumberToObject(response, "losses", info.losses);
-        cJSON_AddStringToObject(response, "session_id", client->session_id);
-        
-        char* response_str = cJSON_PrintUnformatted(response);
-        send_message(client, MSG_LOGIN_RESPONSE, response_str);
-        
-        free(response_str);
-        cJSON_Delete(response);
+        if (refused_by_drain(server, client, user_id)) {
+            cJSON_Delete(json);
+            return;
+        }
         
-        printf("[AUTH] User logged in: %s (id=%d, elo=%d)\n", username, user_id, elo);
+        // Login successful
+        complete_login(server, client, &info, NULL);
     } else {
         send_error(client, "Invalid username or password");
         printf("[AUTH] Failed login attempt for: %s\n", username);
@@ -252,9 +337,10 @@ void handle_logout(GameServer* server, ConnectedClient* client) {
         printf("[AUTH] User logging out: %s\n", client->username);
         
         // Delete session
-        db_delete_session(&server->db, client->session_id);
+        session_store_remove(&server->sessions, client->session_id);
         
         // Mark player as offline
+        matchmaking_leave(server, client);
         db_set_player_offline(&server->db, client->user_id);
         
         // Send confirmation
@@ -0,0 +1,694 @@
+/*
+ * Server Bots Implementation
+ *
+ * Decision flow:
+ * - bot_poll (main loop) finds games where a bot is to move, lists the
+ *   legal actions and queues a request holding a copy of the game; the
+ *   request is taken by every worker, which all run playouts until the
+ *   deadline and add their results to shared per-action totals
+ * - The last worker to finish moves the request to the done list and
+ *   writes a byte to the wake pipe; the next bot_poll checks that the game
+ *   has not changed meanwhile and plays the chosen action
+ * - A request that waited in the queue past its deadline gets no playouts
+ *   and falls back to the first candidate, which is always the simple
+ *   policy's choice, so the time budget holds under load
+ */
+
+#include "bot.h"
+#include "game_handler.h"
+#include "game_state.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BOT_PASSWORD_HASH "!"       // Not a SHA256 hex digest: nobody can log in as a bot
+#define PLAYOUT_RESERVE 150         // Cash the playout policy keeps when buying or building
+#define PLAYOUT_SCALE 1000          // Fixed-point scale of playout results
+
+typedef struct {
+    const char* username;
+    int start_elo;          // Rating the account is created with
+    int budget_ms;          // Search time per decision
+    int horizon;            // Rolls per playout before scoring by net worth
+    int blunder_percent;    // Chance of playing a random candidate instead
+} BotLevelInfo;
+
+static const BotLevelInfo bot_levels[BOT_LEVEL_COUNT] = {
+    { "bot_easy",   1000,  20,  40, 25 },
+    { "bot_medium", 1200, 100, 100,  5 },
+    { "bot_hard",   1400, 400, 250,  0 }
+};
+
+typedef enum {
+    BOT_ACT_ROLL,
+    BOT_ACT_BUY,
+    BOT_ACT_SKIP,
+    BOT_ACT_UPGRADE,
+    BOT_ACT_UNMORTGAGE,
+    BOT_ACT_MORTGAGE,
+    BOT_ACT_SELL,
+    BOT_ACT_PAY_FINE,
+    BOT_ACT_BANKRUPT
+} BotActionType;
+
+static const char* bot_action_names[] = {
+    "roll", "buy", "skip", "build", "unmortgage", "mortgage", "sell house", "pay fine", "bankrupt"
+};
+
+typedef struct {
+    uint8_t type;           // BotActionType
+    int8_t prop;            // UPGRADE / UNMORTGAGE / MORTGAGE / SELL: property
+} BotAction;
+
+// One decision in flight (allocated 64-aligned for the game copy)
+typedef struct BotRequest {
+    ActiveGame game;                    // Hot part, rents and decks only
+    int slot;                           // Index in active_games
+    int match_id;
+    unsigned int revision;              // Game revision the request was made at
+    int player;
+    BotLevel level;
+    int64_t deadline_ms;                // Monotonic
+    int count;
+    BotAction actions[BOT_MAX_CANDIDATES];
+    atomic_long score[BOT_MAX_CANDIDATES];
+    atomic_int plays[BOT_MAX_CANDIDATES];
+    atomic_int next_action;             // Round robin over the candidates
+    atomic_int workers_left;
+    struct BotRequest* next;            // Queue or done list
+} BotRequest;
+
+// Per game slot bookkeeping (main thread only)
+typedef struct {
+    int match_id;
+    int pending;            // A request is in flight
+    int turn;               // move_count when actions was last reset
+    int actions;            // Builds, mortgages and unmortgages this turn
+} BotSeat;
+
+static struct {
+    int enabled;
+    int user_ids[BOT_LEVEL_COUNT];      // 0 if the level is unavailable
+    ConnectedClient seats[BOT_LEVEL_COUNT];
+
+    pthread_t* threads;
+    int worker_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    BotRequest* queue_head;             // Requests not yet taken by every worker
+    BotRequest* queue_tail;
+    int queue_taken;                    // Workers that took the head request
+    BotRequest* done;
+    int stopping;
+    int wake_pipe[2];
+
+    BotSeat games[MAX_ACTIVE_GAMES];
+    unsigned int rng;                   // Blunders (main thread)
+} bots = { .wake_pipe = { -1, -1 } };
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Size of the part of ActiveGame a playout needs (everything before the
+// display strings, move log and lock)
+#define GAME_COPY_SIZE offsetof(ActiveGame, last_activity)
+
+// ============ Actions ============
+
+// Street of a complete group to build on next (the least built one) or -1.
+// The caller checks that the player can pay for it
+static int pick_upgrade(const ActiveGame* game, BoardMask group) {
+    int best = -1;
+    BoardMask streets = group;
+    while (streets) {
+        int pos = board_pop_lowest(&streets);
+        const PropertyState* prop = &game->properties[pos];
+        if (prop->mortgaged || prop->upgrades >= 5) return -1;   // Mortgaged groups cannot build
+        if (best < 0 || prop->upgrades < game->properties[best].upgrades) best = pos;
+    }
+    return best;
+}
+
+// Cheapest property outside the player's complete groups whose mortgage
+// raises at least `needed`, or -1
+static int pick_mortgage(const ActiveGame* game, int player, int needed) {
+    int best = -1;
+    BoardMask owned = game->owned[player] & ~board_monopolies(game->owned[player]);
+    while (owned) {
+        int pos = board_pop_lowest(&owned);
+        const PropertyState* prop = &game->properties[pos];
+        if (prop->mortgaged || prop->upgrades > 0 || game_property_price(pos) / 2 < needed) continue;
+        if (best < 0 || game_property_price(pos) < game_property_price(best)) best = pos;
+    }
+    return best;
+}
+
+// The simple policy's next step out of debt: mortgage the cheapest unbuilt
+// property, else sell a house from the most built street. Gives up at once
+// when selling and mortgaging everything would not cover the debt
+static BotAction raise_cash(const ActiveGame* game, int player) {
+    const GamePlayerState* me = &game->players[player];
+    int owed = me->jailed ? JAIL_FINE : 0;
+    if (me->money + game->mortgage_value[player] < owed) return (BotAction){ BOT_ACT_BANKRUPT, -1 };
+
+    int mortgage = -1;
+    int sell = -1;
+    BoardMask owned = game->owned[player];
+    while (owned) {
+        int pos = board_pop_lowest(&owned);
+        const PropertyState* prop = &game->properties[pos];
+        if (prop->upgrades > 0) {
+            if (sell < 0 || prop->upgrades > game->properties[sell].upgrades) sell = pos;
+        } else if (!prop->mortgaged) {
+            if (mortgage < 0 || game_property_price(pos) < game_property_price(mortgage)) mortgage = pos;
+        }
+    }
+    if (mortgage >= 0) return (BotAction){ BOT_ACT_MORTGAGE, (int8_t)mortgage };
+    if (sell >= 0) return (BotAction){ BOT_ACT_SELL, (int8_t)sell };
+    return (BotAction){ BOT_ACT_BANKRUPT, -1 };
+}
+
+static int has_action(const BotAction* actions, int count, BotAction action) {
+    for (int i = 0; i < count; i++) {
+        if (actions[i].type == action.type && actions[i].prop == action.prop) return 1;
+    }
+    return 0;
+}
+
+static void apply_action(ActiveGame* game, int player, BotAction action) {
+    switch (action.type) {
+        case BOT_ACT_ROLL: game_roll_dice(game, player); break;
+        case BOT_ACT_BUY: game_buy_property(game, player); break;
+        case BOT_ACT_SKIP: game_skip_property(game, player); break;
+        case BOT_ACT_UPGRADE: game_upgrade_property(game, player, action.prop); break;
+        case BOT_ACT_UNMORTGAGE: game_mortgage_property(game, player, action.prop); break;
+        case BOT_ACT_MORTGAGE: game_mortgage_property(game, player, action.prop); break;
+        case BOT_ACT_SELL: game_downgrade_property(game, player, action.prop); break;
+        case BOT_ACT_PAY_FINE: game_pay_jail_fine(game, player); break;
+        case BOT_ACT_BANKRUPT: game_declare_bankrupt(game, player); break;
+    }
+}
+
+// Legal actions of the player to move, the simple policy's choice first.
+// actions_left limits builds, mortgages and unmortgages so that a turn
+// ends; raising cash in debt is not limited
+static int list_actions(ActiveGame* game, int player, int actions_left, BotAction* out) {
+    GamePlayerState* me = &game->players[player];
+    int count = 0;
+
+    switch (game->state) {
+        case GSTATE_WAITING_BUY: {
+            int price = game_property_price(me->position);
+            int buy_first = me->money - price >= PLAYOUT_RESERVE;
+            out[count++] = (BotAction){ buy_first ? BOT_ACT_BUY : BOT_ACT_SKIP, -1 };
+            out[count++] = (BotAction){ buy_first ? BOT_ACT_SKIP : BOT_ACT_BUY, -1 };
+            return count;
+        }
+        case GSTATE_WAITING_DEBT: {
+            // Every mortgage and house sale that could go towards the debt;
+            // bankruptcy only when they cannot cover it
+            out[count++] = raise_cash(game, player);
+            if (out[0].type == BOT_ACT_BANKRUPT) return count;
+            BoardMask owned = game->owned[player];
+            while (owned && count < BOT_MAX_CANDIDATES) {
+                int pos = board_pop_lowest(&owned);
+                const PropertyState* prop = &game->properties[pos];
+                BotAction action = { BOT_ACT_SELL, (int8_t)pos };
+                if (prop->upgrades == 0) {
+                    if (prop->mortgaged) continue;
+                    action.type = BOT_ACT_MORTGAGE;
+                }
+                if (!has_action(out, count, action)) out[count++] = action;
+            }
+            return count;
+        }
+        case GSTATE_WAITING_ROLL:
+            break;
+        default:
+            return 0;
+    }
+
+    out[count++] = (BotAction){ BOT_ACT_ROLL, -1 };
+    if (me->jailed && me->money >= JAIL_FINE) {
+        out[count++] = (BotAction){ BOT_ACT_PAY_FINE, -1 };
+    }
+    if (actions_left <= 0) return count;
+
+    // One build per complete group (building evenly), or the mortgage
+    // that would pay for it
+    for (int g = 0; g < BOARD_STREET_GROUPS && count < BOT_MAX_CANDIDATES; g++) {
+        BoardMask group = board_group_masks[g];
+        if ((game->owned[player] & group) != group) continue;
+        int pos = pick_upgrade(game, group);
+        if (pos < 0) continue;
+        int cost = game_upgrade_cost(pos);
+        if (me->money >= cost) {
+            out[count++] = (BotAction){ BOT_ACT_UPGRADE, (int8_t)pos };
+            continue;
+        }
+        BotAction fund = { BOT_ACT_MORTGAGE, (int8_t)pick_mortgage(game, player, cost - me->money) };
+        if (fund.prop >= 0 && !has_action(out, count, fund)) out[count++] = fund;
+    }
+
+    BoardMask owned = game->owned[player];
+    while (owned && count < BOT_MAX_CANDIDATES) {
+        int pos = board_pop_lowest(&owned);
+        if (game->properties[pos].mortgaged &&
+            me->money >= (int)(game_property_price(pos) * 0.55)) {
+            out[count++] = (BotAction){ BOT_ACT_UNMORTGAGE, (int8_t)pos };
+        }
+    }
+    return count;
+}
+
+// ============ Playouts ============
+
+static unsigned int xorshift(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Play on with the simple policy for both players (buy and build while
+// keeping a reserve, raise cash when in debt); returns the bot's result scaled to PLAYOUT_SCALE:
+// a win, a loss, or its share of the net worth at the horizon
+static long playout(ActiveGame* game, int bot, int horizon) {
+    int rolls = 0;
+    while (game->state != GSTATE_ENDED && rolls < horizon) {
+        int player = game->current_player;
+        GamePlayerState* me = &game->players[player];
+        switch (game->state) {
+            case GSTATE_WAITING_BUY:
+                if (me->money - game_property_price(me->position) >= PLAYOUT_RESERVE) {
+                    game_buy_property(game, player);
+                } else {
+                    game_skip_property(game, player);
+                }
+                break;
+            case GSTATE_WAITING_DEBT:
+                apply_action(game, player, raise_cash(game, player));
+                break;
+            case GSTATE_WAITING_ROLL: {
+                BoardMask monopolies = board_monopolies(game->owned[player]);
+                for (int g = 0; g < BOARD_STREET_GROUPS && monopolies; g++) {
+                    if (!(monopolies & board_group_masks[g])) continue;
+                    int pos = pick_upgrade(game, board_group_masks[g]);
+                    if (pos >= 0 && me->money - game_upgrade_cost(pos) >= PLAYOUT_RESERVE) {
+                        game_upgrade_property(game, player, pos);
+                        break;
+                    }
+                }
+                game_roll_dice(game, player);
+                rolls++;
+                break;
+            }
+            default:
+                return PLAYOUT_SCALE / 2;
+        }
+    }
+
+    if (game->state == GSTATE_ENDED) {
+        return game->players[bot].money >= 0 ? PLAYOUT_SCALE : 0;
+    }
+    long mine = game_net_worth(game, bot);
+    long theirs = game_net_worth(game, 1 - bot);
+    if (mine <= 0) return 0;
+    if (theirs <= 0) return PLAYOUT_SCALE;
+    return PLAYOUT_SCALE * mine / (mine + theirs);
+}
+
+// Playouts for a request until its deadline, cycling through the actions
+static void search(BotRequest* request, ActiveGame* scratch, unsigned int* rng) {
+    int horizon = bot_levels[request->level].horizon;
+    while (monotonic_ms() < request->deadline_ms) {
+        int i = atomic_fetch_add(&request->next_action, 1) % request->count;
+
+        // Fresh dice and decks: the real ones are not the bot's to know
+        memcpy(scratch, &request->game, GAME_COPY_SIZE);
+        scratch->rng = xorshift(rng);
+        for (int d = 0; d < DECK_COUNT; d++) {
+            card_deck_shuffle(&scratch->decks[d], rng);
+        }
+
+        apply_action(scratch, request->player, request->actions[i]);
+        long result = playout(scratch, request->player, horizon);
+        atomic_fetch_add(&request->score[i], result);
+        atomic_fetch_add(&request->plays[i], 1);
+    }
+}
+
+// ============ Workers ============
+
+static void* bot_worker(void* arg) {
+    unsigned int rng = (unsigned int)(uintptr_t)arg * 2654435761u ^ (unsigned int)monotonic_ms();
+    if (rng == 0) rng = 1;
+
+    ActiveGame* scratch = aligned_alloc(_Alignof(ActiveGame), sizeof(ActiveGame));
+    if (!scratch) return NULL;
+    memset(scratch, 0, sizeof(*scratch));
+    pthread_mutex_init(&scratch->mutex, NULL);   // The log stays empty: appends are ignored
+
+    pthread_mutex_lock(&bots.mutex);
+    for (;;) {
+        // Every worker takes the head request once
+        while (!bots.stopping && !bots.queue_head) {
+            pthread_cond_wait(&bots.cond, &bots.mutex);
+        }
+        if (bots.stopping) break;
+
+        BotRequest* request = bots.queue_head;
+        if (++bots.queue_taken == bots.worker_count) {
+            bots.queue_head = request->next;
+            if (!bots.queue_head) bots.queue_tail = NULL;
+            bots.queue_taken = 0;
+            pthread_cond_broadcast(&bots.cond);
+        }
+        pthread_mutex_unlock(&bots.mutex);
+
+        search(request, scratch, &rng);
+
+        pthread_mutex_lock(&bots.mutex);
+        if (atomic_fetch_sub(&request->workers_left, 1) == 1) {
+            request->next = bots.done;
+            bots.done = request;
+            char byte = 1;
+            if (write(bots.wake_pipe[1], &byte, 1) < 0 && errno != EAGAIN) {
+                perror("[BOT] wake");
+            }
+        }
+        // Wait until the others took the head request before looking again
+        while (!bots.stopping && bots.queue_head == request) {
+            pthread_cond_wait(&bots.cond, &bots.mutex);
+        }
+    }
+    pthread_mutex_unlock(&bots.mutex);
+
+    pthread_mutex_destroy(&scratch->mutex);
+    free(scratch);
+    return NULL;
+}
+
+static void submit(BotRequest* request) {
+    atomic_init(&request->workers_left, bots.worker_count);
+    request->next = NULL;
+
+    pthread_mutex_lock(&bots.mutex);
+    if (bots.queue_tail) bots.queue_tail->next = request;
+    else bots.queue_head = request;
+    bots.queue_tail = request;
+    pthread_cond_broadcast(&bots.cond);
+    pthread_mutex_unlock(&bots.mutex);
+}
+
+// ============ Lifecycle ============
+
+// Find or create the account of a level; returns its user id or 0
+static int load_account(Database* db, BotLevel level) {
+    const BotLevelInfo* info = &bot_levels[level];
+    char hash[65];
+    int user_id;
+    int elo;
+
+    if (db_get_user_by_username(db, info->username, &user_id, hash, &elo) == 0) {
+        if (strcmp(hash, BOT_PASSWORD_HASH) != 0) {
+            fprintf(stderr, "[BOT] Username %s belongs to a player; level disabled\n", info->username);
+            return 0;
+        }
+        return user_id;
+    }
+
+    user_id = db_create_user(db, info->username, BOT_PASSWORD_HASH, NULL);
+    if (user_id < 0) {
+        fprintf(stderr, "[BOT] Failed to create account %s\n", info->username);
+        return 0;
+    }
+    db_update_user_elo(db, user_id, info->start_elo);
+    printf("[BOT] Created account %s (ELO %d)\n", info->username, info->start_elo);
+    return user_id;
+}
+
+int bot_init(Database* db, int workers) {
+    if (bots.enabled || workers < 1) return -1;
+
+    int levels = 0;
+    for (int i = 0; i < BOT_LEVEL_COUNT; i++) {
+        bots.user_ids[i] = load_account(db, (BotLevel)i);
+        ConnectedClient* seat = &bots.seats[i];
+        memset(seat, 0, sizeof(*seat));
+        seat->socket_fd = -1;
+        seat->user_id = bots.user_ids[i];
+        snprintf(seat->username, sizeof(seat->username), "%s", bot_levels[i].username);
+        if (bots.user_ids[i]) levels++;
+    }
+    if (levels == 0) return -1;
+
+    if (pipe(bots.wake_pipe) != 0) {
+        perror("[BOT] pipe");
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(bots.wake_pipe[i], F_SETFL, fcntl(bots.wake_pipe[i], F_GETFL) | O_NONBLOCK);
+        fcntl(bots.wake_pipe[i], F_SETFD, FD_CLOEXEC);
+    }
+
+    pthread_mutex_init(&bots.mutex, NULL);
+    pthread_cond_init(&bots.cond, NULL);
+    bots.stopping = 0;
+    bots.rng = (unsigned int)time(NULL) | 1;
+    memset(bots.games, 0, sizeof(bots.games));
+
+    bots.threads = malloc(sizeof(pthread_t) * workers);
+    if (!bots.threads) {
+        close(bots.wake_pipe[0]);
+        close(bots.wake_pipe[1]);
+        bots.wake_pipe[0] = bots.wake_pipe[1] = -1;
+        return -1;
+    }
+    bots.worker_count = 0;
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&bots.threads[i], NULL, bot_worker, (void*)(uintptr_t)(i + 1)) != 0) break;
+        bots.worker_count++;
+    }
+    if (bots.worker_count == 0) {
+        bot_shutdown();
+        return -1;
+    }
+
+    bots.enabled = 1;
+    printf("[BOT] %d bot levels, %d search threads\n", levels, bots.worker_count);
+    return 0;
+}
+
+void bot_shutdown(void) {
+    if (bots.threads) {
+        pthread_mutex_lock(&bots.mutex);
+        bots.stopping = 1;
+        pthread_cond_broadcast(&bots.cond);
+        pthread_mutex_unlock(&bots.mutex);
+        for (int i = 0; i < bots.worker_count; i++) {
+            pthread_join(bots.threads[i], NULL);
+        }
+        free(bots.threads);
+        bots.threads = NULL;
+
+        // Requests taken by every worker are on the done list; the queue
+        // holds the rest
+        while (bots.queue_head) {
+            BotRequest* next = bots.queue_head->next;
+            free(bots.queue_head);
+            bots.queue_head = next;
+        }
+        bots.queue_tail = NULL;
+        while (bots.done) {
+            BotRequest* next = bots.done->next;
+            free(bots.done);
+            bots.done = next;
+        }
+        pthread_cond_destroy(&bots.cond);
+        pthread_mutex_destroy(&bots.mutex);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (bots.wake_pipe[i] >= 0) close(bots.wake_pipe[i]);
+        bots.wake_pipe[i] = -1;
+    }
+    bots.enabled = 0;
+}
+
+int bot_wake_fd(void) {
+    return bots.enabled ? bots.wake_pipe[0] : -1;
+}
+
+int bot_level_of(int user_id) {
+    if (user_id <= 0) return -1;
+    for (int i = 0; i < BOT_LEVEL_COUNT; i++) {
+        if (bots.user_ids[i] == user_id) return i;
+    }
+    return -1;
+}
+
+ConnectedClient* bot_for_rating(Database* db, int elo) {
+    if (!bots.enabled) return NULL;
+
+    ConnectedClient* best = NULL;
+    for (int i = 0; i < BOT_LEVEL_COUNT; i++) {
+        ConnectedClient* seat = &bots.seats[i];
+        if (!seat->user_id) continue;
+
+        // Ratings change with every match; the database has the current one
+        UserInfo info;
+        seat->elo_rating = db_get_user_info(db, seat->user_id, &info) == 0 ? info.elo_rating
+                                                                           : bot_levels[i].start_elo;
+        seat->status = PLAYER_IDLE;
+        if (!best || abs(seat->elo_rating - elo) < abs(best->elo_rating - elo)) best = seat;
+    }
+    return best;
+}
+
+// ============ Main Loop ============
+
+// Candidate to play: the best average result (the first candidate if
+// nothing was searched), or a random one when the level blunders
+static int choose(BotRequest* request) {
+    if (request->count > 1 && (int)(xorshift(&bots.rng) % 100) < bot_levels[request->level].blunder_percent) {
+        return (int)(xorshift(&bots.rng) % request->count);
+    }
+    int best = 0;
+    double best_mean = -1;
+    for (int i = 0; i < request->count; i++) {
+        int plays = atomic_load(&request->plays[i]);
+        if (plays == 0) continue;
+        double mean = (double)atomic_load(&request->score[i]) / plays;
+        if (mean > best_mean) {
+            best_mean = mean;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Play an action for the bot and send the new state (the game may end and
+// be freed)
+static void play(GameServer* server, ActiveGame* game, int player, BotAction action) {
+    if (action.type == BOT_ACT_UPGRADE || action.type == BOT_ACT_UNMORTGAGE ||
+        action.type == BOT_ACT_MORTGAGE) {
+        bots.games[game - active_games].actions++;
+    }
+    apply_action(game, player, action);
+    broadcast_game_state(server, game);
+}
+
+static void finish_request(GameServer* server, BotRequest* request) {
+    BotSeat* seat = &bots.games[request->slot];
+    ActiveGame* game = &active_games[request->slot];
+    seat->pending = 0;
+
+    // The game moved on (ended, hibernated, pause) without the bot
+    if (!game->active || game->match_id != request->match_id || game->revision != request->revision) {
+        return;
+    }
+
+    int chosen = choose(request);
+    BotAction action = request->actions[chosen];
+    int plays = 0;
+    for (int i = 0; i < request->count; i++) plays += atomic_load(&request->plays[i]);
+    int chosen_plays = atomic_load(&request->plays[chosen]);
+    printf("[BOT] %s in match %d: %s", bot_levels[request->level].username, request->match_id,
+           bot_action_names[action.type]);
+    if (action.prop >= 0) printf(" %d", action.prop);
+    printf(" (%d candidates, %d playouts, %.0f%%)\n", request->count, plays,
+           chosen_plays ? 100.0 * atomic_load(&request->score[chosen]) / chosen_plays / PLAYOUT_SCALE : 0.0);
+    play(server, game, request->player, action);
+}
+
+// Request a decision for a game if a bot is to move; actions with only one
+// candidate are played right away. Returns 1 if an action was played
+static int step_game(GameServer* server, int slot) {
+    ActiveGame* game = &active_games[slot];
+    BotSeat* seat = &bots.games[slot];
+    if (!game->active || game->paused || game->state == GSTATE_ENDED) return 0;
+
+    int player = game->current_player;
+    int level = bot_level_of(game->players[player].user_id);
+    if (level < 0) return 0;
+
+    if (seat->match_id != game->match_id) {
+        memset(seat, 0, sizeof(*seat));
+        seat->match_id = game->match_id;
+    }
+    if (seat->pending) return 0;
+    if (seat->turn != game->move_count) {
+        seat->turn = game->move_count;
+        seat->actions = 0;
+    }
+
+    BotRequest* request = aligned_alloc(_Alignof(BotRequest), sizeof(BotRequest));
+    if (!request) return 0;
+    memset(request, 0, sizeof(*request));
+
+    pthread_mutex_lock(&game->mutex);
+    request->count = list_actions(game, player, BOT_ACTIONS_PER_TURN - seat->actions, request->actions);
+    memcpy(&request->game, game, GAME_COPY_SIZE);
+    pthread_mutex_unlock(&game->mutex);
+
+    if (request->count <= 1) {
+        int count = request->count;
+        BotAction action = request->actions[0];
+        free(request);
+        if (count == 0) return 0;
+        play(server, game, player, action);
+        return 1;
+    }
+
+    request->slot = slot;
+    request->match_id = game->match_id;
+    request->revision = request->game.revision;
+    request->player = player;
+    request->level = (BotLevel)level;
+    request->deadline_ms = monotonic_ms() + bot_levels[level].budget_ms;
+    for (int i = 0; i < request->count; i++) {
+        atomic_init(&request->score[i], 0);
+        atomic_init(&request->plays[i], 0);
+    }
+    atomic_init(&request->next_action, 0);
+    seat->pending = 1;
+    submit(request);
+    return 0;
+}
+
+void bot_poll(GameServer* server) {
+    if (!bots.enabled) return;
+
+    char buffer[64];
+    while (read(bots.wake_pipe[0], buffer, sizeof(buffer)) > 0) {
+    }
+
+    pthread_mutex_lock(&bots.mutex);
+    BotRequest* done = bots.done;
+    bots.done = NULL;
+    pthread_mutex_unlock(&bots.mutex);
+
+    while (done) {
+        BotRequest* next = done->next;
+        finish_request(server, done);
+        free(done);
+        done = next;
+    }
+
+    // Forced moves (a roll with nothing to decide, bankruptcy) are played
+    // at once; a few per game keep one busy game from starving the loop
+    for (int slot = 0; slot < MAX_ACTIVE_GAMES; slot++) {
+        for (int moves = 0; moves < 8 && step_game(server, slot); moves++) {
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Server Bots
+ *
+ * Built-in opponents the server seats in a match when nobody else is
+ * searching:
+ * - One bot account per difficulty level (bot_easy, bot_medium, bot_hard),
+ *   created on first start with a password hash no login can produce. Bots
+ *   are rated like everyone else; a player gets the bot closest to their
+ *   rating
+ * - A player still searching after BOT_MATCH_AFTER seconds is matched with
+ *   a bot
+ * - Every choice (buy or skip, build, mortgage or unmortgage, pay the jail
+ *   fine, roll, and in debt which property to mortgage or house to sell)
+ *   is a Monte Carlo search: each legal action is followed by random
+ *   playouts of the rest of the game on a pool of worker threads until the
+ *   level's time budget runs out, and the action with the best average
+ *   result is played. Playouts run on a copy without the move log, with
+ *   fresh dice and reshuffled decks, so a bot cannot see what comes next
+ * - The network thread only copies the game into a request and applies the
+ *   decision once it is back; workers report through a pipe that the main
+ *   loop selects on, so a search never blocks it
+ */
+
+#ifndef BOT_H
+#define BOT_H
+
+#include "server.h"
+
+#define BOT_MATCH_AFTER 20          // Seconds a player searches before getting a bot
+#define BOT_ACTIONS_PER_TURN 4      // Builds, mortgages and unmortgages before the bot must roll
+#define BOT_MAX_CANDIDATES 12       // Actions compared in one decision
+
+typedef enum {
+    BOT_EASY,
+    BOT_MEDIUM,
+    BOT_HARD,
+    BOT_LEVEL_COUNT
+} BotLevel;
+
+// Create or load the bot accounts and start the search workers
+// Returns 0 on success, -1 if bots are unavailable
+int bot_init(Database* db, int workers);
+
+// Stop the workers (decisions in flight are dropped; the games wait for
+// the next start)
+void bot_shutdown(void);
+
+// Descriptor that becomes readable when decisions are ready (-1 if bots
+// are disabled)
+int bot_wake_fd(void);
+
+// Level of a bot account, or -1 for players
+int bot_level_of(int user_id);
+
+// Seat for a match against the bot closest to a rating (NULL if bots are
+// disabled). The seat is not a connection: messages to it are dropped
+ConnectedClient* bot_for_rating(Database* db, int elo);
+
+// Apply finished decisions and start searches for every game waiting on
+// a bot. Called from the main loop
+void bot_poll(GameServer* server);
+
+#endif // BOT_H
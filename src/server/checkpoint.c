@@ -0,0 +1,439 @@
+/*
+ * Game Checkpoints Implementation
+ */
+
+#include "checkpoint.h"
+#include "game_state.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHECKPOINT_MAGIC "MGCK"
+#define CHECKPOINT_VERSION 4   // 2: card decks, 3: rules version, 4: log event count
+
+_Static_assert(CHECKPOINT_SLOTS == MAX_ACTIVE_GAMES, "one checkpoint slot per game");
+
+// On-disk layout: fixed-width fields only, independent of ActiveGame
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_size;
+} CheckpointHeader;
+
+typedef struct {
+    int32_t user_id;
+    char username[50];
+    int32_t money;
+    int32_t position;
+    int32_t jailed;
+    int32_t turns_in_jail;
+    int32_t consecutive_doubles;
+} PlayerImage;
+
+typedef struct {
+    uint32_t sequence;      // Odd while the slot is being written
+    uint32_t in_use;
+    int32_t match_id;
+    PlayerImage players[2];
+    int8_t owner[TOTAL_PROPERTIES];
+    int8_t upgrades[TOTAL_PROPERTIES];
+    int8_t mortgaged[TOTAL_PROPERTIES];
+    int32_t current_player;
+    int32_t state;
+    int32_t state_before_pause;
+    int32_t paused;
+    int32_t paused_by;
+    int32_t last_roll[2];
+    int32_t just_left_jail;
+    int32_t move_count;
+    uint32_t rng;
+    CardDeck decks[DECK_COUNT];
+    uint8_t jail_free[2];
+    uint8_t rules_version;
+    char message[128];
+    char message2[128];
+    uint32_t log_length;    // 0 if the log outgrew the slot
+    uint32_t log_events;    // Events in the log at this state
+    uint8_t log[CHECKPOINT_LOG_CAPACITY];
+} CheckpointSlot;
+
+#define SLOTS_OFFSET 64     // Header, padded
+
+static CheckpointSlot* slot_at(Checkpoint* cp, int index) {
+    return (CheckpointSlot*)(cp->map + SLOTS_OFFSET) + index;
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// ============ Game <-> Slot ============
+
+static void capture_state(CheckpointSlot* slot, const ActiveGame* game) {
+    slot->match_id = game->match_id;
+    for (int p = 0; p < 2; p++) {
+        const GamePlayerState* src = &game->players[p];
+        PlayerImage* dst = &slot->players[p];
+        dst->user_id = src->user_id;
+        memcpy(dst->username, game->usernames[p], sizeof(dst->username));
+        dst->money = src->money;
+        dst->position = src->position;
+        dst->jailed = src->jailed;
+        dst->turns_in_jail = src->turns_in_jail;
+        dst->consecutive_doubles = src->consecutive_doubles;
+    }
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        slot->owner[i] = (int8_t)game->properties[i].owner;
+        slot->upgrades[i] = (int8_t)game->properties[i].upgrades;
+        slot->mortgaged[i] = (int8_t)game->properties[i].mortgaged;
+    }
+    slot->current_player = game->current_player;
+    slot->state = game->state;
+    slot->state_before_pause = game->state_before_pause;
+    slot->paused = game->paused;
+    slot->paused_by = game->paused_by;
+    slot->last_roll[0] = game->last_roll[0];
+    slot->last_roll[1] = game->last_roll[1];
+    slot->just_left_jail = game->just_left_jail;
+    slot->move_count = game->move_count;
+    slot->rng = game->rng;
+    memcpy(slot->decks, game->decks, sizeof(slot->decks));
+    memcpy(slot->jail_free, game->jail_free, sizeof(slot->jail_free));
+    slot->rules_version = game->rules_version;
+    slot->log_events = (uint32_t)game->log.event_count;
+    memcpy(slot->message, game->message, sizeof(slot->message));
+    memcpy(slot->message2, game->message2, sizeof(slot->message2));
+}
+
+static void restore_state(ActiveGame* game, const CheckpointSlot* slot) {
+    game->match_id = slot->match_id;
+    for (int p = 0; p < 2; p++) {
+        const PlayerImage* src = &slot->players[p];
+        GamePlayerState* dst = &game->players[p];
+        dst->user_id = src->user_id;
+        memcpy(game->usernames[p], src->username, sizeof(game->usernames[p]));
+        game->usernames[p][sizeof(game->usernames[p]) - 1] = '\0';
+        dst->money = src->money;
+        dst->position = src->position;
+        dst->jailed = src->jailed;
+        dst->turns_in_jail = src->turns_in_jail;
+        dst->consecutive_doubles = src->consecutive_doubles;
+    }
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        game->properties[i].owner = slot->owner[i];
+        game->properties[i].upgrades = slot->upgrades[i];
+        game->properties[i].mortgaged = slot->mortgaged[i];
+    }
+    game->current_player = slot->current_player;
+    game->state = (GameStateType)slot->state;
+    game->state_before_pause = (GameStateType)slot->state_before_pause;
+    game->paused = slot->paused;
+    game->paused_by = slot->paused_by;
+    game->last_roll[0] = slot->last_roll[0];
+    game->last_roll[1] = slot->last_roll[1];
+    game->just_left_jail = slot->just_left_jail;
+    game->move_count = slot->move_count;
+    game->rng = slot->rng;
+    memcpy(game->decks, slot->decks, sizeof(game->decks));
+    memcpy(game->jail_free, slot->jail_free, sizeof(game->jail_free));
+    game->rules_version = slot->rules_version;
+    memcpy(game->message, slot->message, sizeof(game->message));
+    game->message[sizeof(game->message) - 1] = '\0';
+    memcpy(game->message2, slot->message2, sizeof(game->message2));
+    game->message2[sizeof(game->message2) - 1] = '\0';
+}
+
+// ============ Open / Close ============
+
+int checkpoint_open(Checkpoint* cp, const char* path) {
+    memset(cp, 0, sizeof(*cp));
+    cp->fd = -1;
+
+    size_t size = SLOTS_OFFSET + sizeof(CheckpointSlot) * CHECKPOINT_SLOTS;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        perror("[CHECKPOINT] open");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size != size && ftruncate(fd, size) != 0)) {
+        perror("[CHECKPOINT] resize");
+        close(fd);
+        return -1;
+    }
+
+    uint8_t* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("[CHECKPOINT] mmap");
+        close(fd);
+        return -1;
+    }
+
+    cp->fd = fd;
+    cp->map = map;
+    cp->size = size;
+
+    // A snapshot from another layout (or a new file) starts out empty
+    CheckpointHeader* header = (CheckpointHeader*)map;
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, 4) != 0 || header->version != CHECKPOINT_VERSION ||
+        header->slot_count != CHECKPOINT_SLOTS || header->slot_size != sizeof(CheckpointSlot)) {
+        memset(map, 0, size);
+        memcpy(header->magic, CHECKPOINT_MAGIC, 4);
+        header->version = CHECKPOINT_VERSION;
+        header->slot_count = CHECKPOINT_SLOTS;
+        header->slot_size = sizeof(CheckpointSlot);
+        msync(map, size, MS_ASYNC);
+    }
+
+    printf("[CHECKPOINT] Snapshot %s (%zu KB)\n", path, size / 1024);
+    return 0;
+}
+
+void checkpoint_close(Checkpoint* cp) {
+    if (cp->fd < 0) return;
+
+    if (cp->passes > 0) {
+        printf("[CHECKPOINT] %llu passes, %llu games written (%llu KB), avg %.1f us, max %.1f us per pass\n",
+               (unsigned long long)cp->passes, (unsigned long long)cp->games_written,
+               (unsigned long long)(cp->bytes_written / 1024), cp->total_us / cp->passes, cp->max_us);
+    }
+
+    msync(cp->map, cp->size, MS_SYNC);
+    munmap(cp->map, cp->size);
+    close(cp->fd);
+    cp->fd = -1;
+    cp->map = NULL;
+}
+
+// ============ Restore ============
+
+// Load one slot image into active_games[index]. saved says whether the
+// snapshot file already holds this image (restore) or not (hot upgrade)
+static void restore_game(Checkpoint* cp, int index, const CheckpointSlot* slot, Database* db, int saved) {
+    ActiveGame* game = &active_games[index];
+    pthread_mutex_lock(&game->mutex);
+
+    restore_state(game, slot);
+
+    int log_ok = game_restore_log(game, db, slot->log, slot->log_length, (int)slot->log_events) == 0;
+    if (!log_ok) {
+        fprintf(stderr, "[CHECKPOINT] Match %d: move log lost, starting a new one\n", slot->match_id);
+    }
+
+    game->active = 1;
+    game->revision++;
+    game->last_activity = time(NULL);
+    if (saved && log_ok) {
+        cp->saved_revision[index] = game->revision;
+        cp->saved_match_id[index] = game->match_id;
+        cp->saved_log_length[index] = slot->log_length;
+    } else {
+        // Not in the file yet (hot upgrade), or the slot's log is not the
+        // one the game goes on with: write it whole
+        cp->saved_revision[index] = game->revision - 1;  // Dirty: written by the next pass
+        cp->saved_match_id[index] = 0;
+        cp->saved_log_length[index] = 0;
+    }
+
+    printf("[CHECKPOINT] Restored match %d: %s vs %s (%d moves)\n", game->match_id,
+           game->usernames[0], game->usernames[1], game->move_count);
+
+    pthread_mutex_unlock(&game->mutex);
+}
+
+int checkpoint_restore(Checkpoint* cp, Database* db) {
+    if (cp->fd < 0) return 0;
+
+    int restored = 0;
+    pthread_mutex_lock(&games_mutex);
+
+    for (int i = 0; i < CHECKPOINT_SLOTS; i++) {
+        CheckpointSlot* slot = slot_at(cp, i);
+        if (!slot->in_use) continue;
+        if ((slot->sequence & 1) || slot->match_id <= 0 || slot->state == GSTATE_ENDED) {
+            slot->in_use = 0;  // Torn or finished: drop it
+            continue;
+        }
+
+        restore_game(cp, i, slot, db, 1);
+        restored++;
+    }
+
+    pthread_mutex_unlock(&games_mutex);
+    return restored;
+}
+
+// ============ Export / Import ============
+
+// Export record: slot index (4 bytes) | image size (4 bytes) | image
+// (the slot up to the end of its log), padded to 8 bytes
+#define RECORD_SIZE(image_size) (8 + (((size_t)(image_size) + 7) & ~(size_t)7))
+
+uint8_t* checkpoint_export_games(size_t* length, int* count) {
+    size_t capacity = 0;
+    size_t used = 0;
+    uint8_t* out = NULL;
+    *count = 0;
+
+    pthread_mutex_lock(&games_mutex);
+    for (int i = 0; i < CHECKPOINT_SLOTS; i++) {
+        ActiveGame* game = &active_games[i];
+        pthread_mutex_lock(&game->mutex);
+        if (!game->active || game->state == GSTATE_ENDED) {
+            pthread_mutex_unlock(&game->mutex);
+            continue;
+        }
+
+        size_t log_length = (game->log.data && game->log.length <= CHECKPOINT_LOG_CAPACITY)
+                            ? game->log.length : 0;
+        uint32_t image_size = (uint32_t)(offsetof(CheckpointSlot, log) + log_length);
+        if (used + RECORD_SIZE(image_size) > capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 64 * 1024;
+            while (new_capacity < used + RECORD_SIZE(image_size)) new_capacity *= 2;
+            uint8_t* grown = realloc(out, new_capacity);
+            if (!grown) {
+                pthread_mutex_unlock(&game->mutex);
+                pthread_mutex_unlock(&games_mutex);
+                free(out);
+                return NULL;
+            }
+            out = grown;
+            capacity = new_capacity;
+        }
+
+        uint32_t index = (uint32_t)i;
+        memcpy(out + used, &index, 4);
+        memcpy(out + used + 4, &image_size, 4);
+
+        CheckpointSlot* slot = (CheckpointSlot*)(out + used + 8);
+        memset(slot, 0, RECORD_SIZE(image_size) - 8);
+        capture_state(slot, game);
+        slot->in_use = 1;
+        slot->log_length = (uint32_t)log_length;
+        if (log_length > 0) memcpy(slot->log, game->log.data, log_length);
+
+        used += RECORD_SIZE(image_size);
+        (*count)++;
+        pthread_mutex_unlock(&game->mutex);
+    }
+    pthread_mutex_unlock(&games_mutex);
+
+    *length = used;
+    return out ? out : malloc(1);
+}
+
+int checkpoint_import_games(Checkpoint* cp, const uint8_t* data, size_t length, Database* db) {
+    CheckpointSlot* slot = malloc(sizeof(CheckpointSlot));
+    if (!slot) return -1;
+
+    int imported = 0;
+    size_t pos = 0;
+    pthread_mutex_lock(&games_mutex);
+    while (pos + 8 <= length) {
+        uint32_t index, image_size;
+        memcpy(&index, data + pos, 4);
+        memcpy(&image_size, data + pos + 4, 4);
+        if (index >= CHECKPOINT_SLOTS || image_size < offsetof(CheckpointSlot, log) ||
+            image_size > sizeof(CheckpointSlot) || pos + RECORD_SIZE(image_size) > length) {
+            break;
+        }
+
+        memcpy(slot, data + pos + 8, image_size);
+        pos += RECORD_SIZE(image_size);
+        if (slot->log_length != image_size - offsetof(CheckpointSlot, log)) break;
+
+        restore_game(cp, (int)index, slot, db, 0);
+        imported++;
+    }
+    pthread_mutex_unlock(&games_mutex);
+
+    free(slot);
+    return pos == length ? imported : -1;
+}
+
+// ============ Write ============
+
+int checkpoint_write(Checkpoint* cp, Database* db) {
+    if (cp->fd < 0) return 0;
+
+    double start = now_us();
+    int written = 0;
+
+    for (int i = 0; i < CHECKPOINT_SLOTS; i++) {
+        ActiveGame* game = &active_games[i];
+        pthread_mutex_lock(&game->mutex);
+
+        if (game->revision == cp->saved_revision[i]) {
+            pthread_mutex_unlock(&game->mutex);
+            continue;
+        }
+
+        CheckpointSlot* slot = slot_at(cp, i);
+        slot->sequence |= 1;
+        __sync_synchronize();
+
+        if (game->active) {
+            capture_state(slot, game);
+            cp->bytes_written += offsetof(CheckpointSlot, log);
+
+            // The log only grows: copy the new tail if the slot holds its head
+            size_t length = game->log.length;
+            size_t from = (cp->saved_match_id[i] == game->match_id &&
+                           cp->saved_log_length[i] <= length) ? cp->saved_log_length[i] : 0;
+            if (game->log.data && length <= CHECKPOINT_LOG_CAPACITY) {
+                memcpy(slot->log + from, game->log.data + from, length - from);
+                slot->log_length = (uint32_t)length;
+                cp->bytes_written += length - from;
+            } else {
+                slot->log_length = 0;
+                length = 0;
+                
+                // Only the database has the log: bring it up to this state,
+                // or restore finds it behind and drops it
+                if (game->log.data && game->log.flushed_length < game->log.length) {
+                    MatchLogBlob blob = { game->match_id, game->log.data, game->log.length,
+                                          game->log.event_count };
+                    if (db_save_match_logs(db, &blob, 1) == 0) {
+                        game->log.flushed_length = game->log.length;
+                    }
+                }
+            }
+            slot->in_use = 1;
+            cp->saved_match_id[i] = game->match_id;
+            cp->saved_log_length[i] = length;
+        } else {
+            slot->in_use = 0;
+            cp->saved_match_id[i] = 0;
+            cp->saved_log_length[i] = 0;
+        }
+
+        __sync_synchronize();
+        slot->sequence++;
+
+        cp->saved_revision[i] = game->revision;
+        pthread_mutex_unlock(&game->mutex);
+        written++;
+    }
+
+    if (written > 0) {
+        msync(cp->map, cp->size, MS_ASYNC);
+    }
+
+    double elapsed = now_us() - start;
+    cp->passes++;
+    cp->games_written += written;
+    cp->total_us += elapsed;
+    if (elapsed > cp->max_us) cp->max_us = elapsed;
+    return written;
+}
@@ -0,0 +1,72 @@
+/*
+ * Game Checkpoints
+ *
+ * Keeps a copy of every active game in a memory-mapped snapshot file so
+ * that games in progress survive a restart or a crash:
+ * - One fixed-size slot per active_games entry (state + move log)
+ * - A pass from the server loop copies only games whose revision changed
+ *   since the last pass, and only the new move log bytes; the kernel
+ *   writes the pages back in the background (msync MS_ASYNC)
+ * - Each slot carries a sequence number that is odd while it is being
+ *   written, so a slot torn by a crash is skipped on restore
+ * - At startup the snapshot is loaded back into active_games and players
+ *   rejoin their game when they log in again
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "database.h"
+
+#define CHECKPOINT_SLOTS 25                 // One per active game (MAX_ACTIVE_GAMES)
+#define CHECKPOINT_LOG_CAPACITY (64 * 1024) // Move log bytes kept per game
+#define CHECKPOINT_INTERVAL 1               // Seconds between checkpoint passes
+
+typedef struct {
+    int fd;                 // -1 if checkpoints are disabled
+    uint8_t* map;
+    size_t size;
+
+    // What each slot holds, to find dirty games and new log bytes
+    unsigned int saved_revision[CHECKPOINT_SLOTS];
+    int saved_match_id[CHECKPOINT_SLOTS];
+    size_t saved_log_length[CHECKPOINT_SLOTS];
+
+    // Statistics
+    uint64_t passes;
+    uint64_t games_written;
+    uint64_t bytes_written;
+    double total_us;
+    double max_us;
+} Checkpoint;
+
+// Map (creating or resetting if needed) the snapshot file
+// Returns 0 on success, -1 on error (checkpoints stay disabled)
+int checkpoint_open(Checkpoint* cp, const char* path);
+
+// Load the snapshot into active_games (call after game_state_init). Games
+// whose log outgrew the slot take it from the database instead (lost if
+// it does not match the state)
+// Returns the number of games restored
+int checkpoint_restore(Checkpoint* cp, Database* db);
+
+// Serialize every running game (state + move log) into one buffer, for a
+// hot upgrade. Returns the buffer (caller frees) or NULL on error
+uint8_t* checkpoint_export_games(size_t* length, int* count);
+
+// Load games serialized by checkpoint_export_games into active_games;
+// the next pass writes them to this process's snapshot
+// Returns the number of games imported, or -1 if the data is corrupt
+int checkpoint_import_games(Checkpoint* cp, const uint8_t* data, size_t length, Database* db);
+
+// Copy dirty games into the snapshot. Logs too long for their slot are
+// saved to db in the same pass
+// Returns the number of games written
+int checkpoint_write(Checkpoint* cp, Database* db);
+
+// Flush and unmap the snapshot
+void checkpoint_close(Checkpoint* cp);
+
+#endif // CHECKPOINT_H
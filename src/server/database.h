@@ -1,13 +1,24 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
-#include <sqlite3.h>
-#include <pthread.h>
+#include <time.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "elo.h"
+#include "user_cache.h"
 
-// Database handle with thread safety
+// Storage engine vtable (see storage.h)
+typedef struct StorageOps StorageOps;
+
+typedef enum {
+    DB_BACKEND_SQLITE,      // Persistent SQLite file (default)
+    DB_BACKEND_MEMORY       // In-process tables, lost on exit
+} DatabaseBackend;
+
+// Database handle; every backend is thread safe
 typedef struct {
-    sqlite3* db;
-    pthread_mutex_t mutex;
+    const StorageOps* ops;
+    void* store;            // Backend state
 } Database;
 
 // User info structure
@@ -22,31 +33,45 @@ typedef struct {
 
 // ============ Initialization ============
 
-// Initialize database connection and create tables if needed
+// Open a database on the given backend (filename is ignored by the memory
+// backend). Returns 0 on success, -1 on error
+int db_open(Database* db, DatabaseBackend backend, const char* filename);
+
+// Initialize a SQLite database and create tables if needed
 // Returns 0 on success, -1 on error
 int db_init(Database* db, const char* filename);
 
 // Close database connection
 void db_close(Database* db);
 
+// Parse a backend name ("sqlite" / "memory"); returns 0 on success
+int db_backend_from_name(const char* name, DatabaseBackend* backend);
+
+// Name of the backend a database is running on
+const char* db_backend_name(Database* db);
+
+// User cache counters; returns -1 if the backend has no cache
+int db_get_cache_stats(Database* db, UserCacheStats* stats);
+
 // ============ User Operations ============
 
 // Create a new user
 // Returns user_id on success, -1 on error (e.g., username exists)
 int db_create_user(Database* db, const char* username, const char* password_hash, const char* email);
 
-// Get user by username
+// Get user by username (served from the user cache when possible; a miss
+// loads the full row, so this also warms the cache at login)
 // Returns 0 on success, -1 if not found
 int db_get_user_by_username(Database* db, const char* username, int* user_id, char* password_hash, int* elo);
 
-// Get user info by user_id
+// Get user info by user_id (served from the user cache when possible)
 // Returns 0 on success, -1 if not found
 int db_get_user_info(Database* db, int user_id, UserInfo* info);
 
-// Update user ELO rating
+// Update user ELO rating (invalidates the cached row)
 int db_update_user_elo(Database* db, int user_id, int new_elo);
 
-// Update user stats (wins/losses)
+// Update user stats (wins/losses) (invalidates the cached row)
 int db_update_user_stats(Database* db, int user_id, int is_win);
 
 // Update last login time
@@ -68,6 +93,12 @@ int db_delete_session(Database* db, const char* session_id);
 // Delete all sessions for a user
 int db_delete_user_sessions(Database* db, int user_id);
 
+// Visit every active, unexpired session (used to warm the in-memory store)
+// Returns number of sessions visited, or -1 on error
+int db_load_active_sessions(Database* db,
+                            void (*visit)(void* ctx, const char* session_id, int user_id, time_t expires_at),
+                            void* ctx);
+
 // ============ Online Players ============
 
 // Set player online with status
@@ -100,13 +131,84 @@ int db_create_match(Database* db, int player1_id, int player2_id, int p1_elo, in
 // Update match result
 int db_update_match_result(Database* db, int match_id, int winner_id, int p1_elo_after, int p2_elo_after);
 
-// Get match history for a user
+// Match history page sizes (a page must fit in one MSG_HISTORY_LIST payload)
+#define MATCH_HISTORY_PAGE_SIZE 20
+#define MATCH_HISTORY_MAX_PAGE 25
+
+// Get one page of completed matches for a user, newest first
+// before_match_id: cursor from the last entry of the previous page (0 = first page)
+// limit: page size (<= 0 uses MATCH_HISTORY_PAGE_SIZE, capped at MATCH_HISTORY_MAX_PAGE)
+// Returns 0 on success, -1 on error or unknown cursor
 // Caller must free the returned array
-int db_get_user_match_history(Database* db, int user_id, MatchHistoryEntry** history, int* count);
+int db_get_user_match_history(Database* db, int user_id, int before_match_id, int limit,
+                              MatchHistoryEntry** history, int* count);
 
-// Log a game move
+// Outcome of db_commit_match_result
+typedef struct {
+    int player1_id;
+    int player2_id;
+    EloResult elo;          // For a draw, "winner" is player1 and "loser" is player2
+    int draw_change;        // Draw only: ELO change for player1 (player2 gets the negative)
+    char winner_name[50];
+    char loser_name[50];
+} MatchCommit;
+
+// Commit a finished match in a single transaction: read both ratings,
+// compute the ELO change, update both users (rating + stats), close the
+// match row and reset both online_players rows to idle.
+// winner_id == 0 records a draw (players are taken from the match row).
+// Returns 0 on success, -1 on error, if the match is no longer ongoing or
+// if winner and loser are not its players (nothing is written)
+int db_commit_match_result(Database* db, int match_id, int winner_id, int loser_id, MatchCommit* out);
+
+// Mark every ongoing match except keep_ids (ascending) as abandoned, in a
+// single transaction: at startup, the matches no game came back for
+// Returns the number of matches marked, or -1 on error (nothing is written)
+int db_abandon_matches(Database* db, const int* keep_ids, int keep_count);
+
+// Log a game move as one game_moves row (per-row JSON format; live games
+// write the binary match log below instead)
 int db_log_move(Database* db, int match_id, int player_id, int move_num, const char* move_type, const char* move_data);
 
+// One serialized move log (see move_log.h)
+typedef struct {
+    int match_id;
+    const uint8_t* data;
+    size_t length;
+    int event_count;
+} MatchLogBlob;
+
+// Store (insert or replace) a batch of match logs in one transaction
+// Returns 0 on success, -1 on error (nothing is written)
+int db_save_match_logs(Database* db, const MatchLogBlob* logs, int count);
+
+// Load the stored log of a match
+// Returns 0 on success, -1 if there is none. Caller must free *data
+int db_load_match_log(Database* db, int match_id, uint8_t** data, size_t* length);
+
+// Ids of all matches with a stored log, ascending
+// Caller must free *match_ids
+int db_get_match_log_ids(Database* db, int** match_ids, int* count);
+
+// ============ Hibernated Games ============
+
+// Store (insert or replace) the encoded state of a hibernated game
+// Returns 0 on success, -1 on error
+int db_save_hibernated_game(Database* db, int match_id, const uint8_t* data, size_t length);
+
+// Load the encoded state of a hibernated game
+// Returns 0 on success, -1 if there is none. Caller must free *data
+int db_load_hibernated_game(Database* db, int match_id, uint8_t** data, size_t* length);
+
+// Drop a hibernated game (after it was woken up)
+int db_delete_hibernated_game(Database* db, int match_id);
+
+// Call visit for every hibernated game
+// Returns the number of games visited, or -1 on error
+int db_load_hibernated_games(Database* db,
+                             void (*visit)(void* ctx, int match_id, const uint8_t* data, size_t length),
+                             void* ctx);
+
 // ============ Challenge Operations ============
 
 // Create a new challenge request, returns challenge_id or -1 on error
@@ -154,6 +256,8 @@ typedef struct {
     char username[50];
     int elo_rating;
     int search_start_time;  // Unix timestamp when search started
+    int64_t search_started_ms;  // The same in wall clock ms (tells one search of a player from the next)
+    int rtt_ms;             // Round trip to the server (-1 if not measured)
 } MatchmakingPlayer;
 
 // Add player to matchmaking queue (status becomes 'searching')
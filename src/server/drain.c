@@ -0,0 +1,96 @@
+/*
+ * Drain Mode Implementation
+ */
+
+#include "drain.h"
+#include "matchmaking.h"
+#include "game_state.h"
+#include "hibernate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+
+// Error carrying the redirect hint, so clients can reconnect elsewhere
+static void send_drain_error(GameServer* server, ConnectedClient* client, const char* error) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "success", 0);
+    cJSON_AddStringToObject(json, "error", error);
+    cJSON_AddBoolToObject(json, "draining", 1);
+    if (server->redirect[0]) {
+        cJSON_AddStringToObject(json, "redirect", server->redirect);
+    }
+    
+    char* str = cJSON_PrintUnformatted(json);
+    send_message(client, MSG_ERROR, str);
+    free(str);
+    cJSON_Delete(json);
+}
+
+void drain_begin(GameServer* server) {
+    if (server->draining) return;
+    
+    server->draining = 1;
+    server->drain_started = time(NULL);
+    server->drain_games_at_start = drain_games_remaining();
+    
+    // Nobody waiting in the queue will be matched here any more
+    int cancelled = 0;
+    pthread_mutex_lock(&server->clients_mutex);
+    for (int i = 0; i < server->client_count; i++) {
+        ConnectedClient* client = server->clients[i];
+        if (client->is_connected && client->status == PLAYER_SEARCHING) {
+            matchmaking_leave(server, client);
+            send_drain_error(server, client, "Server is going down for maintenance, search cancelled");
+            cancelled++;
+        }
+    }
+    int clients = server->client_count;
+    pthread_mutex_unlock(&server->clients_mutex);
+    
+    printf("[DRAIN] Draining: %d games in progress, %d clients, %d searches cancelled%s%s\n",
+           server->drain_games_at_start, clients, cancelled,
+           server->redirect[0] ? ", redirecting to " : "", server->redirect);
+}
+
+int drain_reject(GameServer* server, ConnectedClient* client, const char* what) {
+    if (!server->draining) return 0;
+    
+    char error[128];
+    snprintf(error, sizeof(error), "Server is going down for maintenance, %s", what);
+    send_drain_error(server, client, error);
+    return 1;
+}
+
+int drain_games_remaining(void) {
+    int remaining = 0;
+    pthread_mutex_lock(&games_mutex);
+    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
+        if (active_games[i].active && active_games[i].state != GSTATE_ENDED) {
+            remaining++;
+        }
+    }
+    pthread_mutex_unlock(&games_mutex);
+    return remaining;
+}
+
+int drain_report(GameServer* server) {
+    int remaining = drain_games_remaining();
+    int paused = 0;
+    pthread_mutex_lock(&games_mutex);
+    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
+        if (active_games[i].active && active_games[i].state == GSTATE_PAUSED) paused++;
+    }
+    pthread_mutex_unlock(&games_mutex);
+    
+    pthread_mutex_lock(&server->clients_mutex);
+    int clients = server->client_count;
+    pthread_mutex_unlock(&server->clients_mutex);
+    
+    int finished = server->drain_games_at_start - remaining;
+    printf("[DRAIN] %d/%d games finished, %d in progress (%d paused), %d hibernated, %d clients, %ld s elapsed\n",
+           finished > 0 ? finished : 0, server->drain_games_at_start, remaining, paused,
+           hibernate_count(), clients,
+           (long)(time(NULL) - server->drain_started));
+    return remaining == 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * Drain Mode
+ *
+ * Takes a server out of rotation for planned maintenance without costing
+ * any match:
+ * - Started by SIGUSR1
+ * - Matchmaking stops, searching players are told to go elsewhere, and new
+ *   searches, challenges and rematches are refused
+ * - Logins are refused with a redirect hint (-r), except for players who
+ *   still have a game in progress here
+ * - Running games play on to completion; progress is reported periodically
+ *   and the server shuts down once the last one ends. Hibernated games
+ *   (see hibernate.h) are already in the database and do not hold it up
+ */
+
+#ifndef DRAIN_H
+#define DRAIN_H
+
+#include "server.h"
+
+#define DRAIN_REPORT_INTERVAL 10    // Seconds between progress reports
+
+// Enter drain mode (no-op if already draining)
+void drain_begin(GameServer* server);
+
+// If the server is draining, refuse the client's request with a redirect
+// hint and return 1; otherwise return 0
+int drain_reject(GameServer* server, ConnectedClient* client, const char* what);
+
+// Number of games still being played
+int drain_games_remaining(void);
+
+// Report progress. Returns 1 once no games remain
+int drain_report(GameServer* server);
+
+#endif // DRAIN_H
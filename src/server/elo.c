@@ -100,30 +100,42 @@ int elo_calculate_draw(int player1_elo, int player2_elo) {
 }
 
 // Get matchmaking range based on search time
-// Starts at ELO_MATCHMAKING_RANGE and expands by 25 every 10 seconds
+// Starts at ELO_MATCHMAKING_RANGE and expands by ELO_RANGE_STEP (25) every
+// ELO_RANGE_STEP_SECONDS (10)
 // Minimum 10 second wait before range starts expanding
 int elo_get_matchmaking_range(int search_time_seconds) {
     int base_range = ELO_MATCHMAKING_RANGE;
     
     // Minimum 10 seconds before expanding range at all
     // This ensures players have time to find a good ELO match
-    if (search_time_seconds < 10) {
+    if (search_time_seconds < ELO_RANGE_STEP_SECONDS) {
         return base_range;
     }
     
     // Expand range by 25 ELO every 10 seconds after initial wait
-    int expansions = (search_time_seconds - 10) / 10;
-    int expansion = expansions * 25;
+    int expansions = (search_time_seconds - ELO_RANGE_STEP_SECONDS) / ELO_RANGE_STEP_SECONDS;
+    int expansion = expansions * ELO_RANGE_STEP;
     
-    // Cap at 500 ELO difference max
+    // Cap at ELO_MATCHMAKING_RANGE_MAX difference max
     int total_range = base_range + expansion;
-    if (total_range > 500) {
-        total_range = 500;
+    if (total_range > ELO_MATCHMAKING_RANGE_MAX) {
+        total_range = ELO_MATCHMAKING_RANGE_MAX;
     }
     
     return total_range;
 }
 
+// Next step of the schedule above: 20 seconds, then every 10
+int elo_next_range_change(int search_time_seconds) {
+    if (elo_get_matchmaking_range(search_time_seconds) >= ELO_MATCHMAKING_RANGE_MAX) {
+        return -1;
+    }
+    if (search_time_seconds < 2 * ELO_RANGE_STEP_SECONDS) {
+        return 2 * ELO_RANGE_STEP_SECONDS;
+    }
+    return (search_time_seconds / ELO_RANGE_STEP_SECONDS + 1) * ELO_RANGE_STEP_SECONDS;
+}
+
 // Check if two players are good match based on ELO difference
 int elo_is_good_match(int elo1, int elo2, int search_time_seconds) {
     int elo_diff = abs(elo1 - elo2);
@@ -7,7 +7,21 @@
 #define ELO_K_FACTOR_NORMAL 32    // Standard K factor
 #define ELO_K_FACTOR_MASTER 16    // Lower K for high-rated players (> 2000)
 #define ELO_MIN_RATING 100        // Minimum ELO floor
+
+// Matchmaking range (overridable at build time, e.g. by the matchmaking
+// simulator)
+#ifndef ELO_MATCHMAKING_RANGE
 #define ELO_MATCHMAKING_RANGE 150 // Initial ELO range for matchmaking
+#endif
+#ifndef ELO_MATCHMAKING_RANGE_MAX
+#define ELO_MATCHMAKING_RANGE_MAX 500 // Widest range, however long the search
+#endif
+#ifndef ELO_RANGE_STEP
+#define ELO_RANGE_STEP 25         // Range added every ELO_RANGE_STEP_SECONDS
+#endif
+#ifndef ELO_RANGE_STEP_SECONDS
+#define ELO_RANGE_STEP_SECONDS 10
+#endif
 
 // ELO change result
 typedef struct {
@@ -48,5 +62,8 @@ int elo_is_good_match(int elo1, int elo2, int search_time_seconds);
 // Range expands over time to ensure matches happen
 int elo_get_matchmaking_range(int search_time_seconds);
 
+// Search time at which the range next widens, or -1 if it is at its widest
+int elo_next_range_change(int search_time_seconds);
+
 #endif // ELO_H
 
@@ -8,6 +8,9 @@
  */
 
 #include "game_handler.h"
+#include "matchmaking.h"
+#include "game_state.h"
+#include "drain.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,6 +19,38 @@
 
 // ============ Match Result Handling ============
 
+void broadcast_game_state(GameServer* server, ActiveGame* game) {
+    if (!game) return;
+    
+    char* state_json = game_serialize_state(game);
+    if (!state_json) return;
+    
+    pthread_mutex_lock(&server->clients_mutex);
+    
+    for (int i = 0; i < 2; i++) {
+        ConnectedClient* client = find_client_by_id(server, game->players[i].user_id);
+        if (client && client->is_connected) {
+            send_message(client, MSG_GAME_STATE, state_json);
+        }
+    }
+    
+    pthread_mutex_unlock(&server->clients_mutex);
+    
+    free(state_json);
+    
+    // Check if game ended
+    if (game->state == GSTATE_ENDED) {
+        int winner_id = game_get_winner(game);
+        int loser_id = game_get_loser(game);
+        int match_id = game->match_id;
+        
+        if (winner_id > 0 && loser_id > 0) {
+            handle_game_end(server, match_id, winner_id, loser_id, "bankruptcy");
+            game_destroy(match_id);
+        }
+    }
+}
+
 void handle_game_end(GameServer* server, int match_id, int winner_id, int loser_id, const char* reason) {
     printf("[GAME] Match %d ended: winner=%d, loser=%d, reason=%s\n", 
            match_id, winner_id, loser_id, reason);
@@ -26,32 +61,22 @@ void handle_game_end(GameServer* server, int match_id, int winner_id, int loser_
     ConnectedClient* loser = find_client_by_id(server, loser_id);
     pthread_mutex_unlock(&server->clients_mutex);
     
-    // Get game counts for K-factor calculation
-    UserInfo winner_info, loser_info;
-    db_get_user_info(&server->db, winner_id, &winner_info);
-    db_get_user_info(&server->db, loser_id, &loser_info);
-    
-    // Calculate ELO changes
-    EloResult elo_result;
-    elo_calculate_match(
-        winner_info.elo_rating, 
-        loser_info.elo_rating,
-        winner_info.total_matches,
-        loser_info.total_matches,
-        &elo_result
-    );
-    
-    // Update database with new ELOs
-    db_update_user_elo(&server->db, winner_id, elo_result.winner_new_elo);
-    db_update_user_elo(&server->db, loser_id, elo_result.loser_new_elo);
-    
-    // Update match result in database
-    db_update_match_result(&server->db, match_id, winner_id, 
-                           elo_result.winner_new_elo, elo_result.loser_new_elo);
-    
-    // Update player stats
-    db_update_user_stats(&server->db, winner_id, 1);  // Win
-    db_update_user_stats(&server->db, loser_id, 0);   // Loss
+    // The final events go out with the last write of the match's log
+    ActiveGame* game = game_find(match_id);
+    if (game) {
+        game_save_move_log(&server->db, game);
+    }
+    
+    // Ratings, stats, match row and online status in one transaction
+    MatchCommit commit;
+    if (db_commit_match_result(&server->db, match_id, winner_id, loser_id, &commit) != 0) {
+        fprintf(stderr, "[GAME] Failed to record result for match %d\n", match_id);
+        if (winner) send_error(winner, "Failed to record match result");
+        if (loser) send_error(loser, "Failed to record match result");
+        cleanup_match(server, match_id);
+        return;
+    }
+    EloResult elo_result = commit.elo;
     
     // Send results to players
     if (winner || loser) {
@@ -60,91 +85,72 @@ void handle_game_end(GameServer* server, int match_id, int winner_id, int loser_
     
     // Update client states if connected
     if (winner) {
-        winner->elo_rating = elo_result.winner_new_elo;
+        matchmaking_set_rating(winner, elo_result.winner_new_elo);
         winner->status = PLAYER_IDLE;
         winner->current_match_id = 0;
-        db_set_player_online(&server->db, winner_id, "idle");
     }
     
     if (loser) {
-        loser->elo_rating = elo_result.loser_new_elo;
+        matchmaking_set_rating(loser, elo_result.loser_new_elo);
         loser->status = PLAYER_IDLE;
         loser->current_match_id = 0;
-        db_set_player_online(&server->db, loser_id, "idle");
     }
     
     printf("[GAME] ELO updated: %s %d -> %d (%+d), %s %d -> %d (%+d)\n",
-           winner_info.username, elo_result.winner_old_elo, elo_result.winner_new_elo, elo_result.winner_change,
-           loser_info.username, elo_result.loser_old_elo, elo_result.loser_new_elo, elo_result.loser_change);
+           commit.winner_name, elo_result.winner_old_elo, elo_result.winner_new_elo, elo_result.winner_change,
+           commit.loser_name, elo_result.loser_old_elo, elo_result.loser_new_elo, elo_result.loser_change);
 }
 
 void handle_game_draw(GameServer* server, int match_id, int requesting_player_id, int other_player_id) {
     printf("[GAME] Match %d ended in a draw\n", match_id);
-    
-    // Look up the actual player1_id and player2_id from the match
-    // This is critical because the requesting player might not be player1
-    int actual_p1_id = 0, actual_p2_id = 0;
-    {
-        sqlite3_stmt* stmt;
-        const char* sql = "SELECT player1_id, player2_id FROM matches WHERE match_id = ?";
-        if (sqlite3_prepare_v2(server->db.db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-            sqlite3_bind_int(stmt, 1, match_id);
-            if (sqlite3_step(stmt) == SQLITE_ROW) {
-                actual_p1_id = sqlite3_column_int(stmt, 0);
-                actual_p2_id = sqlite3_column_int(stmt, 1);
-            }
-            sqlite3_finalize(stmt);
-        }
+    (void)other_player_id;
+    
+    ActiveGame* game = game_find(match_id);
+    if (game) {
+        pthread_mutex_lock(&game->mutex);
+        move_log_append(&game->log, MOVE_DRAW,
+                        game->players[1].user_id == requesting_player_id, 0, 0);
+        pthread_mutex_unlock(&game->mutex);
+        game_save_move_log(&server->db, game);
+        
+        // Over for good: players logging in again must not rejoin it
+        game_destroy(match_id);
     }
     
-    // Fallback if lookup fails - use passed parameters
-    if (actual_p1_id == 0 || actual_p2_id == 0) {
-        actual_p1_id = requesting_player_id;
-        actual_p2_id = other_player_id;
+    // The commit resolves the match's real player1/player2 (the requesting
+    // player might not be player1) and records everything in one transaction
+    MatchCommit commit;
+    if (db_commit_match_result(&server->db, match_id, 0, 0, &commit) != 0) {
+        fprintf(stderr, "[GAME] Failed to record draw for match %d\n", match_id);
+        cleanup_match(server, match_id);
+        return;
     }
     
+    int actual_p1_id = commit.player1_id;
+    int actual_p2_id = commit.player2_id;
+    int elo_change = commit.draw_change;
+    int p1_old_elo = commit.elo.winner_old_elo;
+    int p2_old_elo = commit.elo.loser_old_elo;
+    int p1_new_elo = commit.elo.winner_new_elo;
+    int p2_new_elo = commit.elo.loser_new_elo;
+    
     // Find both players by their actual IDs
     pthread_mutex_lock(&server->clients_mutex);
     ConnectedClient* player1 = find_client_by_id(server, actual_p1_id);
     ConnectedClient* player2 = find_client_by_id(server, actual_p2_id);
     pthread_mutex_unlock(&server->clients_mutex);
     
-    // Get current ELOs
-    UserInfo info1, info2;
-    db_get_user_info(&server->db, actual_p1_id, &info1);
-    db_get_user_info(&server->db, actual_p2_id, &info2);
-    
-    // Calculate draw ELO change (positive means player1 gains)
-    int elo_change = elo_calculate_draw(info1.elo_rating, info2.elo_rating);
-    
-    int p1_new_elo = info1.elo_rating + elo_change;
-    int p2_new_elo = info2.elo_rating - elo_change;
-    
-    // Update database - ELOs for each user
-    db_update_user_elo(&server->db, actual_p1_id, p1_new_elo);
-    db_update_user_elo(&server->db, actual_p2_id, p2_new_elo);
-    
-    // Update player stats (draw = -1, increments total_matches only)
-    db_update_user_stats(&server->db, actual_p1_id, -1);
-    db_update_user_stats(&server->db, actual_p2_id, -1);
-    
-    // Update match result (winner_id = 0 for draw)
-    // Now p1_new_elo corresponds to actual player1, p2_new_elo to actual player2
-    db_update_match_result(&server->db, match_id, 0, p1_new_elo, p2_new_elo);
-    
     // Update client states
     if (player1) {
-        player1->elo_rating = p1_new_elo;
+        matchmaking_set_rating(player1, p1_new_elo);
         player1->status = PLAYER_IDLE;
         player1->current_match_id = 0;
-        db_set_player_online(&server->db, actual_p1_id, "idle");
     }
     
     if (player2) {
-        player2->elo_rating = p2_new_elo;
+        matchmaking_set_rating(player2, p2_new_elo);
         player2->status = PLAYER_IDLE;
         player2->current_match_id = 0;
-        db_set_player_online(&server->db, actual_p2_id, "idle");
     }
     
     // Send draw result to both players
@@ -155,21 +161,21 @@ void handle_game_draw(GameServer* server, int match_id, int requesting_player_id
     
     // Player 1 info
     cJSON_AddNumberToObject(result, "player1_id", actual_p1_id);
-    cJSON_AddStringToObject(result, "player1_name", player1 ? player1->username : info1.username);
-    cJSON_AddNumberToObject(result, "player1_old_elo", info1.elo_rating);
+    cJSON_AddStringToObject(result, "player1_name", player1 ? player1->username : commit.winner_name);
+    cJSON_AddNumberToObject(result, "player1_old_elo", p1_old_elo);
     cJSON_AddNumberToObject(result, "player1_new_elo", p1_new_elo);
     cJSON_AddNumberToObject(result, "player1_elo_change", elo_change);
     
     // Player 2 info
     cJSON_AddNumberToObject(result, "player2_id", actual_p2_id);
-    cJSON_AddStringToObject(result, "player2_name", player2 ? player2->username : info2.username);
-    cJSON_AddNumberToObject(result, "player2_old_elo", info2.elo_rating);
+    cJSON_AddStringToObject(result, "player2_name", player2 ? player2->username : commit.loser_name);
+    cJSON_AddNumberToObject(result, "player2_old_elo", p2_old_elo);
     cJSON_AddNumberToObject(result, "player2_new_elo", p2_new_elo);
     cJSON_AddNumberToObject(result, "player2_elo_change", -elo_change);
     
     printf("[GAME] Draw ELO: %s %d -> %d (%+d), %s %d -> %d (%+d)\n",
-           player1 ? player1->username : "P1", info1.elo_rating, p1_new_elo, elo_change,
-           player2 ? player2->username : "P2", info2.elo_rating, p2_new_elo, -elo_change);
+           commit.winner_name, p1_old_elo, p1_new_elo, elo_change,
+           commit.loser_name, p2_old_elo, p2_new_elo, -elo_change);
     
     char* result_str = cJSON_PrintUnformatted(result);
     
@@ -329,6 +335,10 @@ void handle_rematch_request(GameServer* server, ConnectedClient* client, Network
         return;
     }
     
+    if (drain_reject(server, client, "no rematches")) {
+        return;
+    }
+    
     // Parse target from last match
     cJSON* json = cJSON_Parse(msg->payload);
     if (!json) {
@@ -412,6 +422,10 @@ void handle_rematch_response(GameServer* server, ConnectedClient* client, Networ
     }
     
     if (accept) {
+        if (drain_reject(server, client, "no rematches")) {
+            return;
+        }
+        
         // Create new match
         if (client->status == PLAYER_IN_GAME || opponent->status == PLAYER_IN_GAME) {
             send_error(client, "One player is already in a game");
@@ -3,9 +3,14 @@
 
 #include "server.h"
 #include "elo.h"
+#include "game_state.h"
 
 // ============ Match Result Handling ============
 
+// Send the game state to both players; ends the match (results, ELO,
+// freeing the game) once someone went bankrupt
+void broadcast_game_state(GameServer* server, ActiveGame* game);
+
 // Handle game end and calculate ELO changes
 // winner_id: The user_id of the winner
 // loser_id: The user_id of the loser
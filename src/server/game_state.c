@@ -103,28 +103,8 @@ void game_state_init(void) {
     printf("[GAME_STATE] Initialized game state manager\n");
 }
 
-ActiveGame* game_create(int match_id, int p1_user_id, const char* p1_name,
-                        int p2_user_id, const char* p2_name) {
-    pthread_mutex_lock(&games_mutex);
-    
-    ActiveGame* game = NULL;
-    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
-        if (!active_games[i].active) {
-            game = &active_games[i];
-            break;
-        }
-    }
-    
-    if (!game) {
-        pthread_mutex_unlock(&games_mutex);
-        fprintf(stderr, "[GAME_STATE] No free game slots!\n");
-        return NULL;
-    }
-    
-    // Initialize game
-    pthread_mutex_lock(&game->mutex);
-    
-    game->active = 1;
+void game_init_state(ActiveGame* game, int match_id, int p1_user_id, const char* p1_name,
+                     int p2_user_id, const char* p2_name, unsigned int seed) {
     game->match_id = match_id;
     game->current_player = 0;  // Player 1 goes first
     game->state = GSTATE_WAITING_ROLL;
@@ -134,13 +114,25 @@ ActiveGame* game_create(int match_id, int p1_user_id, const char* p1_name,
     game->last_roll[0] = 0;
     game->last_roll[1] = 0;
     game->just_left_jail = 0;
+    game->rules_version = MOVE_LOG_VERSION;
     game->move_count = 0;
     game->message[0] = '\0';
     game->message2[0] = '\0';
+    game->rng = seed;
+    game->last_activity = time(NULL);
+    
+    // Decks are shuffled from their own copy of the seed, so the dice of
+    // games recorded before card decks existed stay the same
+    unsigned int deck_rng = seed ^ 0x5bd1e995u;
+    for (int d = 0; d < DECK_COUNT; d++) {
+        card_deck_shuffle(&game->decks[d], &deck_rng);
+    }
+    game->jail_free[0] = 0;
+    game->jail_free[1] = 0;
     
     // Initialize players
     game->players[0].user_id = p1_user_id;
-    strncpy(game->players[0].username, p1_name, sizeof(game->players[0].username) - 1);
+    snprintf(game->usernames[0], sizeof(game->usernames[0]), "%s", p1_name);
     game->players[0].money = STARTING_MONEY;
     game->players[0].position = 0;
     game->players[0].jailed = 0;
@@ -148,7 +140,7 @@ ActiveGame* game_create(int match_id, int p1_user_id, const char* p1_name,
     game->players[0].consecutive_doubles = 0;
     
     game->players[1].user_id = p2_user_id;
-    strncpy(game->players[1].username, p2_name, sizeof(game->players[1].username) - 1);
+    snprintf(game->usernames[1], sizeof(game->usernames[1]), "%s", p2_name);
     game->players[1].money = STARTING_MONEY;
     game->players[1].position = 0;
     game->players[1].jailed = 0;
@@ -161,6 +153,48 @@ ActiveGame* game_create(int match_id, int p1_user_id, const char* p1_name,
         game->properties[i].upgrades = 0;
         game->properties[i].mortgaged = 0;
     }
+    game_rebuild_derived(game);
+}
+
+int game_property_price(int prop_id) {
+    return (prop_id >= 0 && prop_id < TOTAL_PROPERTIES) ? property_prices[prop_id] : 0;
+}
+
+int game_upgrade_cost(int prop_id) {
+    return (prop_id >= 0 && prop_id < TOTAL_PROPERTIES) ? upgrade_costs[prop_id] : 0;
+}
+
+int game_table_rent(int prop_id, int level) {
+    if (prop_id < 0 || prop_id >= TOTAL_PROPERTIES || level < 0 || level > 5) return 0;
+    return property_rents[prop_id][level];
+}
+
+ActiveGame* game_create(int match_id, int p1_user_id, const char* p1_name,
+                        int p2_user_id, const char* p2_name) {
+    pthread_mutex_lock(&games_mutex);
+    
+    ActiveGame* game = NULL;
+    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
+        if (!active_games[i].active) {
+            game = &active_games[i];
+            break;
+        }
+    }
+    
+    if (!game) {
+        pthread_mutex_unlock(&games_mutex);
+        fprintf(stderr, "[GAME_STATE] No free game slots!\n");
+        return NULL;
+    }
+    
+    // Initialize game
+    pthread_mutex_lock(&game->mutex);
+    
+    unsigned int seed = (unsigned int)time(NULL) ^ ((unsigned int)match_id * 2654435761u);
+    game_init_state(game, match_id, p1_user_id, p1_name, p2_user_id, p2_name, seed);
+    game->active = 1;
+    game->revision++;
+    move_log_start(&game->log, match_id, p1_user_id, p2_user_id, seed);
     
     pthread_mutex_unlock(&game->mutex);
     pthread_mutex_unlock(&games_mutex);
@@ -199,6 +233,8 @@ void game_destroy(int match_id) {
             pthread_mutex_lock(&active_games[i].mutex);
             active_games[i].active = 0;
             active_games[i].match_id = 0;
+            active_games[i].revision++;
+            move_log_free(&active_games[i].log);
             pthread_mutex_unlock(&active_games[i].mutex);
             printf("[GAME_STATE] Destroyed game for match %d\n", match_id);
             break;
@@ -207,14 +243,28 @@ void game_destroy(int match_id) {
     pthread_mutex_unlock(&games_mutex);
 }
 
+// Helper: record an accepted action or outcome
+static void record_move(ActiveGame* game, MoveType type, int player_idx, int a, int b) {
+    move_log_append(&game->log, type, player_idx, a, b);
+    game->revision++;
+    game->last_activity = time(NULL);
+}
+
 // Helper: send player to jail
 static void send_to_jail(ActiveGame* game, int player_idx) {
+    if (game->jail_free[player_idx] > 0) {
+        game->jail_free[player_idx]--;
+        game->players[player_idx].consecutive_doubles = 0;
+        snprintf(game->message, sizeof(game->message), "%s used a Get Out of Jail Free card",
+                 game->usernames[player_idx]);
+        return;
+    }
     game->players[player_idx].jailed = 1;
     game->players[player_idx].position = JAIL_POSITION;
     game->players[player_idx].turns_in_jail = 0;
     game->players[player_idx].consecutive_doubles = 0;
     snprintf(game->message, sizeof(game->message), "%s sent to jail!", 
-             game->players[player_idx].username);
+             game->usernames[player_idx]);
 }
 
 // Helper: next player's turn
@@ -227,10 +277,196 @@ static void next_player(ActiveGame* game) {
 
 // Helper: check if player owns all of a color group
 static int owns_monopoly(ActiveGame* game, int player_idx, int prop_id) {
-    // Simplified check - would need full color group data
-    // For now, just return 0 (no monopoly bonus)
-    (void)game; (void)player_idx; (void)prop_id;
-    return 0;
+    return board_owns_group(game->owned[player_idx], prop_id);
+}
+
+// Helper: rent owed for landing on an owned property (utilities under
+// group rents: the multiplier for the dice)
+static int property_rent(ActiveGame* game, int owner, int position) {
+    int upgrades = game->properties[position].upgrades;
+    
+    // Matches started before version 3 logs pay the flat table rent
+    if (game->rules_version < 3) {
+        return property_rents[position][upgrades];
+    }
+    
+    // Mortgaged squares collect no rent
+    if (game->properties[position].mortgaged) {
+        return 0;
+    }
+    
+    switch (get_property_type(position)) {
+        case PROP_RAILROAD:
+            // 25/50/100/200 for 1-4 railroads
+            return property_rents[position][board_count(game->owned[owner], BOARD_RAILROADS) - 1];
+        case PROP_UTILITY:
+            // 4x or 10x the dice
+            return property_rents[position][board_count(game->owned[owner], BOARD_UTILITIES) - 1];
+        default: {
+            // Double rent for monopoly (no houses)
+            int rent = property_rents[position][upgrades];
+            if (upgrades == 0 && owns_monopoly(game, owner, position)) {
+                rent *= 2;
+            }
+            return rent;
+        }
+    }
+}
+
+// ============ Derived Tables ============
+
+// Helper: add (sign 1) or remove (sign -1) a property's share of its
+// owner's asset and mortgage value
+static void account_property(ActiveGame* game, int pos, int sign) {
+    const PropertyState* prop = &game->properties[pos];
+    int owner = prop->owner;
+    if (owner < 0) return;
+    
+    int buildings = prop->upgrades * upgrade_costs[pos];
+    int price = property_prices[pos];
+    if (prop->mortgaged) {
+        game->asset_value[owner] += sign * (price / 2 + buildings);
+        game->mortgage_value[owner] += sign * (buildings / 2);
+    } else {
+        game->asset_value[owner] += sign * (price + buildings);
+        game->mortgage_value[owner] += sign * (price / 2 + buildings / 2);
+    }
+}
+
+// Helper: recompute the rents of the group pos belongs to (ownership and
+// buildings of one square can change the rent of the whole group)
+static void refresh_rents(ActiveGame* game, int pos) {
+    BoardMask group = board_group_mask(pos);
+    while (group) {
+        int i = board_pop_lowest(&group);
+        int owner = game->properties[i].owner;
+        game->rent[i] = owner < 0 ? 0 : (uint16_t)property_rent(game, owner, i);
+    }
+}
+
+void game_rebuild_derived(ActiveGame* game) {
+    game->owned[0] = 0;
+    game->owned[1] = 0;
+    for (int p = 0; p < 2; p++) {
+        game->asset_value[p] = 0;
+        game->mortgage_value[p] = 0;
+    }
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        int owner = game->properties[i].owner;
+        if (owner == 0 || owner == 1) {
+            game->owned[owner] |= BOARD_BIT(i);
+            account_property(game, i, 1);
+        }
+    }
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        int owner = game->properties[i].owner;
+        game->rent[i] = owner < 0 ? 0 : (uint16_t)property_rent(game, owner, i);
+    }
+}
+
+int game_net_worth(ActiveGame* game, int player_idx) {
+    return game->players[player_idx].money + game->asset_value[player_idx];
+}
+
+// Helper: record what a player in debt owes and could still raise
+static void note_debt(ActiveGame* game, int player_idx, int owed) {
+    snprintf(game->message2, sizeof(game->message2), "Owes $%d, mortgages raise up to $%d",
+             owed, game->mortgage_value[player_idx]);
+}
+
+// Helper: a player in debt who raised enough goes on: a jailed one pays
+// the fine and leaves jail, and the turn passes
+static void settle_debt(ActiveGame* game, int player_idx) {
+    if (game->state != GSTATE_WAITING_DEBT || game->current_player != player_idx) return;
+    
+    GamePlayerState* player = &game->players[player_idx];
+    int owed = player->jailed ? JAIL_FINE : 0;
+    if (player->money < owed) {
+        note_debt(game, player_idx, owed - player->money);
+        return;
+    }
+    if (player->jailed) {
+        player->money -= JAIL_FINE;
+        player->jailed = 0;
+        player->turns_in_jail = 0;
+    }
+    snprintf(game->message2, sizeof(game->message2), "%s paid off the debt", game->usernames[player_idx]);
+    next_player(game);
+}
+
+static void handle_landing(ActiveGame* game, int player_idx, int position);
+
+// Helper: move a player forward to a square (collecting GO salary when
+// passing it) and resolve the landing
+static void advance_to(ActiveGame* game, int player_idx, int position) {
+    GamePlayerState* player = &game->players[player_idx];
+    if (position < player->position && position != 0) {
+        player->money += GO_BONUS;
+    }
+    player->position = position;
+    handle_landing(game, player_idx, position);
+}
+
+// Helper: draw the next card of a deck and apply it
+static void draw_card(ActiveGame* game, int player_idx, DeckKind kind) {
+    GamePlayerState* player = &game->players[player_idx];
+    GamePlayerState* other = &game->players[1 - player_idx];
+    const CardDef* card = card_def(kind, card_deck_draw(&game->decks[kind]));
+    
+    // Money the card itself moves (not rent or salary from moving)
+    int amount = 0;
+    switch (card->action) {
+        case CARD_ACT_MONEY:
+            amount = card->amount;
+            break;
+        case CARD_ACT_REPAIRS: {
+            BoardMask owned = game->owned[player_idx];
+            while (owned) {
+                int upgrades = game->properties[board_pop_lowest(&owned)].upgrades;
+                amount -= upgrades == 5 ? card->hotel : upgrades * card->amount;
+            }
+            break;
+        }
+        case CARD_ACT_EACH_PLAYER:
+            amount = card->amount;
+            if (amount > 0 && amount > other->money) {
+                amount = other->money > 0 ? other->money : 0;  // Collect what they have
+            }
+            other->money -= amount;
+            break;
+        default:
+            break;
+    }
+    player->money += amount;
+    record_move(game, MOVE_CARD, player_idx, amount, 0);
+    snprintf(game->message2, sizeof(game->message2), "%s: %s", card_deck_name(kind), card->text);
+    snprintf(game->message, sizeof(game->message), "%s", card->text);
+    
+    switch (card->action) {
+        case CARD_ACT_ADVANCE:
+            advance_to(game, player_idx, card->target);
+            break;
+        case CARD_ACT_NEAREST:
+            advance_to(game, player_idx,
+                       board_next_in(board_group_masks[card->target], player->position));
+            break;
+        case CARD_ACT_BACK:
+            player->position = (player->position + TOTAL_PROPERTIES - card->amount) % TOTAL_PROPERTIES;
+            handle_landing(game, player_idx, player->position);
+            break;
+        case CARD_ACT_JAIL:
+            send_to_jail(game, player_idx);
+            break;
+        case CARD_ACT_JAIL_FREE:
+            game->jail_free[player_idx]++;
+            break;
+        default:
+            if (player->money < 0) {
+                game->state = GSTATE_WAITING_DEBT;
+                note_debt(game, player_idx, -player->money);
+            }
+            break;
+    }
 }
 
 // Helper: handle landing on a property
@@ -241,7 +477,7 @@ static void handle_landing(ActiveGame* game, int player_idx, int position) {
     switch (type) {
         case PROP_GO:
             player->money += GO_BONUS;
-            snprintf(game->message, sizeof(game->message), "Landed on GO! Collect $200");
+            snprintf(game->message, sizeof(game->message), "Landed on GO! Collect $%d", GO_BONUS);
             break;
             
         case PROP_STREET:
@@ -254,24 +490,26 @@ static void handle_landing(ActiveGame* game, int player_idx, int position) {
                     snprintf(game->message, sizeof(game->message), 
                              "Buy for $%d? (SPACE=buy, N=skip)", property_prices[position]);
                 }
+            } else if (game->properties[position].owner != player_idx &&
+                       game->properties[position].mortgaged && game->rules_version >= 3) {
+                snprintf(game->message, sizeof(game->message), "%s's property is mortgaged - no rent",
+                         game->usernames[game->properties[position].owner]);
             } else if (game->properties[position].owner != player_idx) {
                 // Owned by opponent - pay rent
                 int owner = game->properties[position].owner;
-                int rent = property_rents[position][game->properties[position].upgrades];
-                
-                // Double rent for monopoly (no houses)
-                if (owns_monopoly(game, owner, position) && 
-                    game->properties[position].upgrades == 0) {
-                    rent *= 2;
+                int rent = game->rent[position];
+                if (type == PROP_UTILITY && game->rules_version >= 3) {
+                    rent *= game->last_roll[0] + game->last_roll[1];
                 }
                 
                 player->money -= rent;
                 game->players[owner].money += rent;
                 snprintf(game->message, sizeof(game->message), 
-                         "Paid $%d rent to %s", rent, game->players[owner].username);
+                         "Paid $%d rent to %s", rent, game->usernames[owner]);
                 
                 if (player->money < 0) {
                     game->state = GSTATE_WAITING_DEBT;
+                    note_debt(game, player_idx, -player->money);
                 }
             }
             break;
@@ -286,6 +524,7 @@ static void handle_landing(ActiveGame* game, int player_idx, int position) {
             }
             if (player->money < 0) {
                 game->state = GSTATE_WAITING_DEBT;
+                note_debt(game, player_idx, -player->money);
             }
             break;
             
@@ -299,10 +538,15 @@ static void handle_landing(ActiveGame* game, int player_idx, int position) {
             
         case PROP_CHANCE:
         case PROP_COMMUNITY_CHEST:
-            // Simplified - just give/take random amount
+            if (game->rules_version >= 4) {
+                draw_card(game, player_idx, type == PROP_CHANCE ? DECK_CHANCE : DECK_COMMUNITY_CHEST);
+                break;
+            }
+            // Before version 4 logs: just give/take random amount
             {
-                int amount = (rand() % 200) - 50;
+                int amount = (rand_r(&game->rng) % 200) - 50;
                 player->money += amount;
+                record_move(game, MOVE_CARD, player_idx, amount, 0);
                 if (amount >= 0) {
                     snprintf(game->message, sizeof(game->message), 
                              "Card: Received $%d", amount);
@@ -331,14 +575,15 @@ int game_roll_dice(ActiveGame* game, int player_idx) {
     pthread_mutex_lock(&game->mutex);
     
     // Roll dice
-    int die1 = (rand() % 6) + 1;
-    int die2 = (rand() % 6) + 1;
+    int die1 = (rand_r(&game->rng) % 6) + 1;
+    int die2 = (rand_r(&game->rng) % 6) + 1;
     int total = die1 + die2;
     int is_doubles = (die1 == die2);
     
     game->last_roll[0] = die1;
     game->last_roll[1] = die2;
     game->move_count++;
+    record_move(game, MOVE_ROLL, player_idx, die1, die2);
     
     GamePlayerState* player = &game->players[player_idx];
     
@@ -359,17 +604,18 @@ int game_roll_dice(ActiveGame* game, int player_idx) {
                 player->jailed = 0;
                 player->turns_in_jail = 0;
                 game->just_left_jail = 1;
-                snprintf(game->message, sizeof(game->message), "3rd turn - paid $50 fine");
+                snprintf(game->message, sizeof(game->message), "3rd turn - paid $%d fine", JAIL_FINE);
             } else {
                 game->state = GSTATE_WAITING_DEBT;
-                snprintf(game->message, sizeof(game->message), "Can't afford $50 fine!");
+                snprintf(game->message, sizeof(game->message), "Can't afford $%d fine!", JAIL_FINE);
+                note_debt(game, player_idx, JAIL_FINE - player->money);
                 pthread_mutex_unlock(&game->mutex);
                 return 0;
             }
         } else {
             // Still in jail
             snprintf(game->message, sizeof(game->message), 
-                     "In jail %d/3 turns. P to pay $50", player->turns_in_jail);
+                     "In jail %d/%d turns. P to pay $%d", player->turns_in_jail, MAX_JAIL_TURNS, JAIL_FINE);
             next_player(game);
             pthread_mutex_unlock(&game->mutex);
             return 0;
@@ -418,6 +664,7 @@ int game_buy_property(ActiveGame* game, int player_idx) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_BUY, player_idx, 0, 0);
     
     GamePlayerState* player = &game->players[player_idx];
     int pos = player->position;
@@ -426,6 +673,9 @@ int game_buy_property(ActiveGame* game, int player_idx) {
     if (player->money >= price && game->properties[pos].owner == -1) {
         player->money -= price;
         game->properties[pos].owner = player_idx;
+        game->owned[player_idx] |= BOARD_BIT(pos);
+        account_property(game, pos, 1);
+        refresh_rents(game, pos);
         snprintf(game->message, sizeof(game->message), "Bought property for $%d", price);
     }
     
@@ -446,6 +696,7 @@ int game_skip_property(ActiveGame* game, int player_idx) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_SKIP, player_idx, 0, 0);
     
     snprintf(game->message, sizeof(game->message), "Declined to buy");
     game->state = GSTATE_WAITING_ROLL;
@@ -464,6 +715,7 @@ int game_pay_jail_fine(ActiveGame* game, int player_idx) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_PAY_FINE, player_idx, 0, 0);
     
     GamePlayerState* player = &game->players[player_idx];
     
@@ -471,7 +723,7 @@ int game_pay_jail_fine(ActiveGame* game, int player_idx) {
         player->money -= JAIL_FINE;
         player->jailed = 0;
         player->turns_in_jail = 0;
-        snprintf(game->message, sizeof(game->message), "Paid $50 fine - out of jail!");
+        snprintf(game->message, sizeof(game->message), "Paid $%d fine - out of jail!", JAIL_FINE);
     }
     
     pthread_mutex_unlock(&game->mutex);
@@ -484,13 +736,27 @@ int game_declare_bankrupt(ActiveGame* game, int player_idx) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_BANKRUPT, player_idx, 0, 0);
     
     game->state = GSTATE_ENDED;
     game->players[player_idx].money = -1;  // Mark as bankrupt
+    
+    // Everything the bankrupt player owned goes back to the bank
+    BoardMask owned = game->owned[player_idx];
+    while (owned) {
+        int pos = board_pop_lowest(&owned);
+        game->properties[pos].owner = -1;
+        game->properties[pos].upgrades = 0;
+        game->properties[pos].mortgaged = 0;
+        game->rent[pos] = 0;
+    }
+    game->owned[player_idx] = 0;
+    game->asset_value[player_idx] = 0;
+    game->mortgage_value[player_idx] = 0;
     snprintf(game->message, sizeof(game->message), 
              "%s is bankrupt! %s wins!", 
-             game->players[player_idx].username,
-             game->players[1 - player_idx].username);
+             game->usernames[player_idx],
+             game->usernames[1 - player_idx]);
     
     pthread_mutex_unlock(&game->mutex);
     return 0;
@@ -502,6 +768,7 @@ int game_upgrade_property(ActiveGame* game, int player_idx, int prop_id) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_UPGRADE, player_idx, prop_id, 0);
     
     PropertyState* prop = &game->properties[prop_id];
     GamePlayerState* player = &game->players[player_idx];
@@ -509,8 +776,11 @@ int game_upgrade_property(ActiveGame* game, int player_idx, int prop_id) {
     
     if (prop->owner == player_idx && !prop->mortgaged && 
         prop->upgrades < 5 && player->money >= cost && cost > 0) {
+        account_property(game, prop_id, -1);
         player->money -= cost;
         prop->upgrades++;
+        account_property(game, prop_id, 1);
+        refresh_rents(game, prop_id);
         snprintf(game->message, sizeof(game->message), "Built house for $%d", cost);
     }
     
@@ -524,15 +794,20 @@ int game_downgrade_property(ActiveGame* game, int player_idx, int prop_id) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_DOWNGRADE, player_idx, prop_id, 0);
     
     PropertyState* prop = &game->properties[prop_id];
     GamePlayerState* player = &game->players[player_idx];
     int cost = upgrade_costs[prop_id];
     
     if (prop->owner == player_idx && prop->upgrades > 0) {
+        account_property(game, prop_id, -1);
         player->money += cost / 2;
         prop->upgrades--;
+        account_property(game, prop_id, 1);
+        refresh_rents(game, prop_id);
         snprintf(game->message, sizeof(game->message), "Sold house for $%d", cost / 2);
+        settle_debt(game, player_idx);
     }
     
     pthread_mutex_unlock(&game->mutex);
@@ -545,6 +820,7 @@ int game_mortgage_property(ActiveGame* game, int player_idx, int prop_id) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_MORTGAGE, player_idx, prop_id, 0);
     
     PropertyState* prop = &game->properties[prop_id];
     GamePlayerState* player = &game->players[player_idx];
@@ -553,14 +829,21 @@ int game_mortgage_property(ActiveGame* game, int player_idx, int prop_id) {
     if (prop->owner == player_idx) {
         if (!prop->mortgaged && prop->upgrades == 0) {
             // Mortgage
+            account_property(game, prop_id, -1);
             player->money += price / 2;
             prop->mortgaged = 1;
+            account_property(game, prop_id, 1);
+            refresh_rents(game, prop_id);
             snprintf(game->message, sizeof(game->message), "Mortgaged for $%d", price / 2);
+            settle_debt(game, player_idx);
         } else if (prop->mortgaged && player->money >= (int)(price * 0.55)) {
             // Unmortgage
             int cost = (int)(price * 0.55);
+            account_property(game, prop_id, -1);
             player->money -= cost;
             prop->mortgaged = 0;
+            account_property(game, prop_id, 1);
+            refresh_rents(game, prop_id);
             snprintf(game->message, sizeof(game->message), "Unmortgaged for $%d", cost);
         }
     }
@@ -575,13 +858,14 @@ int game_pause(ActiveGame* game, int player_idx) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_PAUSE, player_idx, 0, 0);
     
     game->paused = 1;
     game->paused_by = player_idx;
     game->state_before_pause = game->state;
     game->state = GSTATE_PAUSED;
     snprintf(game->message, sizeof(game->message), "Game paused by %s",
-             game->players[player_idx].username);
+             game->usernames[player_idx]);
     
     printf("[GAME_STATE] Game %d paused by player %d\n", game->match_id, player_idx);
     
@@ -600,6 +884,7 @@ int game_resume(ActiveGame* game, int player_idx) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_RESUME, player_idx, 0, 0);
     
     game->paused = 0;
     game->state = game->state_before_pause;
@@ -617,22 +902,135 @@ int game_surrender(ActiveGame* game, int player_idx) {
     }
     
     pthread_mutex_lock(&game->mutex);
+    record_move(game, MOVE_SURRENDER, player_idx, 0, 0);
     
     game->state = GSTATE_ENDED;
     game->paused = 0;
     game->players[player_idx].money = -1;  // Mark as loser
     snprintf(game->message, sizeof(game->message), 
              "%s surrendered! %s wins!", 
-             game->players[player_idx].username,
-             game->players[1 - player_idx].username);
+             game->usernames[player_idx],
+             game->usernames[1 - player_idx]);
     
     printf("[GAME_STATE] Game %d: %s surrendered\n", game->match_id, 
-           game->players[player_idx].username);
+           game->usernames[player_idx]);
     
     pthread_mutex_unlock(&game->mutex);
     return 0;
 }
 
+// ============ Move Log ============
+
+int game_flush_move_logs(Database* db) {
+    MatchLogBlob blobs[MAX_ACTIVE_GAMES];
+    int count = 0;
+    
+    // Snapshot the dirty logs so no game lock is held across the write
+    pthread_mutex_lock(&games_mutex);
+    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
+        ActiveGame* game = &active_games[i];
+        pthread_mutex_lock(&game->mutex);
+        if (game->active && game->log.data && game->log.length > game->log.flushed_length) {
+            uint8_t* copy = malloc(game->log.length);
+            if (copy) {
+                memcpy(copy, game->log.data, game->log.length);
+                blobs[count].match_id = game->match_id;
+                blobs[count].data = copy;
+                blobs[count].length = game->log.length;
+                blobs[count].event_count = game->log.event_count;
+                count++;
+            }
+        }
+        pthread_mutex_unlock(&game->mutex);
+    }
+    pthread_mutex_unlock(&games_mutex);
+    
+    if (count == 0) return 0;
+    
+    int result = db_save_match_logs(db, blobs, count);
+    
+    if (result == 0) {
+        pthread_mutex_lock(&games_mutex);
+        for (int i = 0; i < count; i++) {
+            ActiveGame* game = game_find(blobs[i].match_id);
+            if (!game) continue;  // Ended meanwhile (saved in full then)
+            pthread_mutex_lock(&game->mutex);
+            if (game->log.flushed_length < blobs[i].length) {
+                game->log.flushed_length = blobs[i].length;
+            }
+            pthread_mutex_unlock(&game->mutex);
+        }
+        pthread_mutex_unlock(&games_mutex);
+    } else {
+        fprintf(stderr, "[GAME_STATE] Failed to flush %d move logs\n", count);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        free((void*)blobs[i].data);
+    }
+    
+    return result == 0 ? count : -1;
+}
+
+int game_save_move_log(Database* db, ActiveGame* game) {
+    if (!game) return -1;
+    
+    pthread_mutex_lock(&game->mutex);
+    
+    if (!game->log.data) {
+        pthread_mutex_unlock(&game->mutex);
+        return -1;
+    }
+    
+    MatchLogBlob blob;
+    blob.match_id = game->match_id;
+    blob.data = game->log.data;
+    blob.length = game->log.length;
+    blob.event_count = game->log.event_count;
+    
+    int result = db_save_match_logs(db, &blob, 1);
+    if (result == 0) {
+        game->log.flushed_length = game->log.length;
+    } else {
+        fprintf(stderr, "[GAME_STATE] Failed to save move log for match %d\n", game->match_id);
+    }
+    
+    pthread_mutex_unlock(&game->mutex);
+    return result;
+}
+
+int game_restore_log(ActiveGame* game, Database* db, const uint8_t* log, size_t length, int event_count) {
+    int log_ok = 0;
+    if (length > 0) {
+        log_ok = move_log_load(&game->log, log, length) == 0;
+    } else {
+        uint8_t* data;
+        if (db_load_match_log(db, game->match_id, &data, &length) == 0) {
+            log_ok = move_log_load(&game->log, data, length) == 0;
+            free(data);
+        }
+    }
+    if (log_ok && event_count >= 0 && game->log.event_count != event_count) {
+        // Saved before (or after) the snapshot: replaying it would not
+        // reach this state
+        move_log_free(&game->log);
+        log_ok = 0;
+    }
+    if (!log_ok) {
+        move_log_start(&game->log, game->match_id, game->players[0].user_id,
+                       game->players[1].user_id, game->rng);
+    }
+    
+    // A new log is written under the current version, but the match goes
+    // on under the rules it started with (snapshots that did not record
+    // them take the log's)
+    if (game->rules_version == 0) {
+        game->rules_version = (uint8_t)move_log_version(&game->log);
+    }
+    game_rebuild_derived(game);
+    return log_ok ? 0 : -1;
+}
+
 char* game_serialize_state(ActiveGame* game) {
     if (!game) return NULL;
     
@@ -662,11 +1060,13 @@ char* game_serialize_state(ActiveGame* game) {
     for (int i = 0; i < 2; i++) {
         cJSON* p = cJSON_CreateObject();
         cJSON_AddNumberToObject(p, "user_id", game->players[i].user_id);
-        cJSON_AddStringToObject(p, "username", game->players[i].username);
+        cJSON_AddStringToObject(p, "username", game->usernames[i]);
         cJSON_AddNumberToObject(p, "money", game->players[i].money);
         cJSON_AddNumberToObject(p, "position", game->players[i].position);
         cJSON_AddBoolToObject(p, "jailed", game->players[i].jailed);
         cJSON_AddNumberToObject(p, "turns_in_jail", game->players[i].turns_in_jail);
+        cJSON_AddNumberToObject(p, "net_worth", game_net_worth(game, i));
+        cJSON_AddNumberToObject(p, "mortgage_value", game->mortgage_value[i]);
         cJSON_AddItemToArray(players, p);
     }
     cJSON_AddItemToObject(json, "players", players);
@@ -678,6 +1078,7 @@ char* game_serialize_state(ActiveGame* game) {
         cJSON_AddNumberToObject(prop, "owner", game->properties[i].owner);
         cJSON_AddNumberToObject(prop, "upgrades", game->properties[i].upgrades);
         cJSON_AddBoolToObject(prop, "mortgaged", game->properties[i].mortgaged);
+        cJSON_AddNumberToObject(prop, "rent", game->rent[i]);
         cJSON_AddItemToArray(properties, prop);
     }
     cJSON_AddItemToObject(json, "properties", properties);
@@ -12,16 +12,31 @@
 #define GAME_STATE_H
 
 #include "server.h"
+#include "move_log.h"
+#include "bitboard.h"
+#include "card_deck.h"
 #include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
 
 // Constants
 #define MAX_ACTIVE_GAMES 25
 #define TOTAL_PROPERTIES 40
+#define JAIL_POSITION 10
+
+// Balance values (overridable at build time, e.g. by the simulator)
+#ifndef STARTING_MONEY
 #define STARTING_MONEY 1500
+#endif
+#ifndef GO_BONUS
 #define GO_BONUS 200
-#define JAIL_POSITION 10
+#endif
+#ifndef JAIL_FINE
 #define JAIL_FINE 50
+#endif
+#ifndef MAX_JAIL_TURNS
 #define MAX_JAIL_TURNS 3
+#endif
 
 // Property types
 typedef enum {
@@ -37,22 +52,21 @@ typedef enum {
     PROP_GOTO_JAIL
 } PropertyType;
 
-// Property state
+// Property state, packed into one byte
 typedef struct {
-    int owner;        // -1 = unowned, 0 = player1, 1 = player2
-    int upgrades;     // 0-5 (5 = hotel)
-    int mortgaged;    // 0 or 1
+    int8_t owner : 2;       // -1 = unowned, 0 = player1, 1 = player2
+    uint8_t upgrades : 3;   // 0-5 (5 = hotel)
+    uint8_t mortgaged : 1;  // 0 or 1
 } PropertyState;
 
-// Player state in a game
+// Player state in a game (the username lives in ActiveGame.usernames)
 typedef struct {
-    int user_id;
-    char username[50];
-    int money;
-    int position;
-    int jailed;
-    int turns_in_jail;
-    int consecutive_doubles;
+    int32_t user_id;
+    int32_t money;
+    uint8_t position;
+    uint8_t jailed;
+    uint8_t turns_in_jail;
+    uint8_t consecutive_doubles;
 } GamePlayerState;
 
 // Game state
@@ -65,28 +79,53 @@ typedef enum {
 } GameStateType;
 
 // Active game structure
+// The first part is everything a turn reads or writes, packed into the
+// first two cache lines; the rent table, display strings, the move log and
+// the lock follow
 typedef struct {
-    int match_id;
-    int active;
+    // ---- Hot ----
+    _Alignas(64) int match_id;
+    uint8_t active;
+    uint8_t current_player;        // 0 or 1
+    uint8_t state;                 // GameStateType
+    uint8_t state_before_pause;    // State before pausing
+    uint8_t paused;
+    int8_t paused_by;              // Which player paused (0 or 1)
+    uint8_t last_roll[2];
+    uint8_t just_left_jail;
+    uint8_t rules_version;         // Move log version the match started under (rent rules)
+    int move_count;
+    unsigned int rng;              // rand_r state for dice and cards (seeded per match)
+    unsigned int revision;         // Bumped on every change (checkpoint dirty tracking)
     
     GamePlayerState players[2];
     PropertyState properties[TOTAL_PROPERTIES];
+    BoardMask owned[2];            // Properties of each player (mirrors properties[].owner)
+    int32_t asset_value[2];        // Properties (mortgaged at half) and buildings at cost
+    int32_t mortgage_value[2];     // Cash from selling every building and mortgaging everything
     
-    int current_player;    // 0 or 1
-    GameStateType state;
-    GameStateType state_before_pause;  // State before pausing
-    int paused;
-    int paused_by;         // Which player paused (0 or 1)
-    int last_roll[2];
-    int just_left_jail;
-    int move_count;
+    // ---- Rents (read on landing) ----
+    uint16_t rent[TOTAL_PROPERTIES];   // Current rent of owned squares (utilities under group
+                                       // rents: multiplier of the dice)
     
+    // ---- Cards ----
+    CardDeck decks[DECK_COUNT];
+    uint8_t jail_free[2];          // Get Out of Jail Free cards held
+    
+    // ---- Cold ----
+    time_t last_activity;          // Last accepted action (hibernation of idle games)
+    char usernames[2][50];
     char message[128];
     char message2[128];
     
+    MoveLog log;                   // Every accepted action, persisted as one blob
+    
     pthread_mutex_t mutex;
 } ActiveGame;
 
+// The hot part must stay within two cache lines
+_Static_assert(offsetof(ActiveGame, rent) <= 128, "ActiveGame hot fields exceed two cache lines");
+
 // Global games array
 extern ActiveGame active_games[MAX_ACTIVE_GAMES];
 extern pthread_mutex_t games_mutex;
@@ -101,6 +140,26 @@ void game_state_init(void);
 ActiveGame* game_create(int match_id, int p1_user_id, const char* p1_name, 
                         int p2_user_id, const char* p2_name);
 
+// Reset a game to the starting position with the given RNG seed (no slot
+// bookkeeping and no move log; used by game_create and by replays)
+void game_init_state(ActiveGame* game, int match_id, int p1_user_id, const char* p1_name,
+                     int p2_user_id, const char* p2_name, unsigned int seed);
+
+// Recompute the ownership masks, values and rents from properties[]
+// (after restoring a game; needs rules_version)
+void game_rebuild_derived(ActiveGame* game);
+
+// Money plus asset value (maintained on every buy, build, mortgage and bankruptcy)
+int game_net_worth(ActiveGame* game, int player_idx);
+
+// Board data: purchase price and cost per house (0 if not for sale)
+int game_property_price(int prop_id);
+int game_upgrade_cost(int prop_id);
+
+// Table rent for a level: houses for streets, railroads or utilities owned
+// minus one for those (utilities: the dice multiplier)
+int game_table_rent(int prop_id, int level);
+
 // Find game by match_id
 ActiveGame* game_find(int match_id);
 
@@ -125,7 +184,9 @@ int game_skip_property(ActiveGame* game, int player_idx);
 // Upgrade property (build house/hotel)
 int game_upgrade_property(ActiveGame* game, int player_idx, int prop_id);
 
-// Downgrade property (sell house)
+// Downgrade property (sell house). Selling or mortgaging is also the way
+// out of GSTATE_WAITING_DEBT: once the player is out of debt (and can pay
+// the fine, if jailed), the turn passes
 int game_downgrade_property(ActiveGame* game, int player_idx, int prop_id);
 
 // Mortgage/unmortgage property
@@ -146,6 +207,25 @@ int game_resume(ActiveGame* game, int player_idx);
 // Surrender - opponent wins immediately
 int game_surrender(ActiveGame* game, int player_idx);
 
+// ============ Move Log ============
+
+// Persist the unflushed logs of all live games in one batch
+// Returns the number of logs written, or -1 on error
+int game_flush_move_logs(Database* db);
+
+// Persist one game's complete log (at match end)
+int game_save_move_log(Database* db, ActiveGame* game);
+
+// Give a game restored from a snapshot its move log: the serialized log
+// (length > 0) if there is one, else the one last saved to db. A log whose
+// event count differs from the snapshot's (event_count, -1 if unknown)
+// does not match the state and counts as lost. If none loads, a new log is
+// started, so recording goes on but the match can no longer be replayed.
+// The game keeps the rules version of its snapshot (0: not recorded, take
+// the log's), and its derived tables are rebuilt
+// Returns 0 if the log was recovered, -1 if a new one was started
+int game_restore_log(ActiveGame* game, Database* db, const uint8_t* log, size_t length, int event_count);
+
 // ============ State Serialization ============
 
 // Serialize game state to JSON string
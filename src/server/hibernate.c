@@ -0,0 +1,454 @@
+/*
+ * Game Hibernation Implementation
+ */
+
+#include "hibernate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIBERNATE_FORMAT 3   // 2: card decks, 3: rules version
+
+// What the server keeps per hibernated game
+typedef struct {
+    int match_id;
+    int user_ids[2];
+} HibernatedGame;
+
+static HibernatedGame* hibernated = NULL;
+static int hibernated_count = 0;
+static int hibernated_capacity = 0;
+static pthread_mutex_t hibernated_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// ============ Encoding ============
+
+static size_t put_varint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static int get_varint(const uint8_t* data, size_t length, size_t* pos, uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*pos >= length) return -1;
+        uint8_t byte = data[(*pos)++];
+        result |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Money can go negative while a player is in debt
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/*
+ * Layout:
+ *   format, match_id, player ids, move_count      (varints)
+ *   rng                                           (4 bytes, little endian)
+ *   current_player | paused | just_left_jail | paused_by + 1
+ *   state | state_before_pause
+ *   last_roll[0] | last_roll[1]
+ *   per player: money (zigzag varint), position, jailed | turns_in_jail | doubles
+ *   owned-property bitmap (5 bytes), then one byte per owned property:
+ *   owner | mortgaged | upgrades
+ *   per deck (format 2+): card order (8 bytes, two cards per byte), next card
+ *   jail_free[0] | jail_free[1] << 4
+ *   rules version (format 3+)
+ */
+size_t hibernate_encode(const ActiveGame* game, uint8_t* out, size_t capacity) {
+    if (capacity < HIBERNATE_MAX_ENCODED) return 0;
+
+    for (int i = 0; i < 2; i++) {
+        const GamePlayerState* p = &game->players[i];
+        if (p->turns_in_jail > 7 || p->consecutive_doubles > 7 || game->jail_free[i] > 15) {
+            return 0;
+        }
+    }
+
+    size_t n = 0;
+    n += put_varint(out + n, HIBERNATE_FORMAT);
+    n += put_varint(out + n, (uint32_t)game->match_id);
+    n += put_varint(out + n, (uint32_t)game->players[0].user_id);
+    n += put_varint(out + n, (uint32_t)game->players[1].user_id);
+    n += put_varint(out + n, (uint32_t)game->move_count);
+
+    for (int i = 0; i < 4; i++) {
+        out[n++] = (uint8_t)(game->rng >> (8 * i));
+    }
+
+    out[n++] = (uint8_t)((game->current_player & 1) | (game->paused ? 2 : 0) |
+                         (game->just_left_jail ? 4 : 0) | (((game->paused_by + 1) & 3) << 3));
+    out[n++] = (uint8_t)((game->state & 7) | ((game->state_before_pause & 7) << 3));
+    out[n++] = (uint8_t)((game->last_roll[0] & 7) | ((game->last_roll[1] & 7) << 3));
+
+    for (int i = 0; i < 2; i++) {
+        const GamePlayerState* p = &game->players[i];
+        n += put_varint(out + n, zigzag(p->money));
+        out[n++] = (uint8_t)p->position;
+        out[n++] = (uint8_t)((p->jailed ? 1 : 0) | (p->turns_in_jail << 1) | (p->consecutive_doubles << 4));
+    }
+
+    uint8_t* bitmap = out + n;
+    memset(bitmap, 0, (TOTAL_PROPERTIES + 7) / 8);
+    n += (TOTAL_PROPERTIES + 7) / 8;
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        const PropertyState* prop = &game->properties[i];
+        if (prop->owner < 0) continue;
+        bitmap[i / 8] |= (uint8_t)(1 << (i % 8));
+        out[n++] = (uint8_t)((prop->owner & 1) | (prop->mortgaged ? 2 : 0) | ((prop->upgrades & 7) << 2));
+    }
+
+    for (int d = 0; d < DECK_COUNT; d++) {
+        const CardDeck* deck = &game->decks[d];
+        for (int i = 0; i < CARD_DECK_SIZE; i += 2) {
+            out[n++] = (uint8_t)((deck->order[i] & 15) | (deck->order[i + 1] << 4));
+        }
+        out[n++] = deck->next;
+    }
+    out[n++] = (uint8_t)((game->jail_free[0] & 15) | (game->jail_free[1] << 4));
+    out[n++] = game->rules_version;
+
+    return n;
+}
+
+int hibernate_decode(ActiveGame* game, const uint8_t* data, size_t length) {
+    size_t pos = 0;
+    uint32_t format, match_id, user_ids[2], move_count;
+    if (get_varint(data, length, &pos, &format) != 0 || format < 1 || format > HIBERNATE_FORMAT ||
+        get_varint(data, length, &pos, &match_id) != 0 ||
+        get_varint(data, length, &pos, &user_ids[0]) != 0 ||
+        get_varint(data, length, &pos, &user_ids[1]) != 0 ||
+        get_varint(data, length, &pos, &move_count) != 0 ||
+        pos + 7 > length) {
+        return -1;
+    }
+
+    game_init_state(game, (int)match_id, (int)user_ids[0], "", (int)user_ids[1], "", 0);
+    game->move_count = (int)move_count;
+
+    game->rng = 0;
+    for (int i = 0; i < 4; i++) {
+        game->rng |= (unsigned int)data[pos++] << (8 * i);
+    }
+
+    uint8_t flags = data[pos++];
+    game->current_player = flags & 1;
+    game->paused = (flags >> 1) & 1;
+    game->just_left_jail = (flags >> 2) & 1;
+    game->paused_by = ((flags >> 3) & 3) - 1;
+
+    uint8_t states = data[pos++];
+    game->state = (GameStateType)(states & 7);
+    game->state_before_pause = (GameStateType)((states >> 3) & 7);
+    if (game->state > GSTATE_ENDED || game->state_before_pause > GSTATE_ENDED) return -1;
+
+    uint8_t roll = data[pos++];
+    game->last_roll[0] = roll & 7;
+    game->last_roll[1] = (roll >> 3) & 7;
+
+    for (int i = 0; i < 2; i++) {
+        GamePlayerState* p = &game->players[i];
+        uint32_t money;
+        if (get_varint(data, length, &pos, &money) != 0 || pos + 2 > length) return -1;
+        p->money = unzigzag(money);
+        p->position = data[pos++];
+        uint8_t jail = data[pos++];
+        p->jailed = jail & 1;
+        p->turns_in_jail = (jail >> 1) & 7;
+        p->consecutive_doubles = (jail >> 4) & 7;
+        if (p->position >= TOTAL_PROPERTIES) return -1;
+    }
+
+    size_t bitmap_size = (TOTAL_PROPERTIES + 7) / 8;
+    if (pos + bitmap_size > length) return -1;
+    const uint8_t* bitmap = data + pos;
+    pos += bitmap_size;
+    for (int i = 0; i < TOTAL_PROPERTIES; i++) {
+        if (!(bitmap[i / 8] & (1 << (i % 8)))) continue;
+        if (pos >= length) return -1;
+        uint8_t prop = data[pos++];
+        game->properties[i].owner = prop & 1;
+        game->properties[i].mortgaged = (prop >> 1) & 1;
+        game->properties[i].upgrades = (prop >> 2) & 7;
+    }
+
+    // Format 1 games predate card decks and keep the initial ones
+    if (format >= 2) {
+        if (pos + DECK_COUNT * (CARD_DECK_SIZE / 2 + 1) + 1 > length) return -1;
+        for (int d = 0; d < DECK_COUNT; d++) {
+            CardDeck* deck = &game->decks[d];
+            for (int i = 0; i < CARD_DECK_SIZE; i += 2) {
+                deck->order[i] = data[pos] & 15;
+                deck->order[i + 1] = data[pos++] >> 4;
+            }
+            deck->next = data[pos++];
+            if (!card_deck_valid(deck)) return -1;
+        }
+        game->jail_free[0] = data[pos] & 15;
+        game->jail_free[1] = data[pos++] >> 4;
+    }
+
+    // Earlier formats take the rules version from the move log
+    game->rules_version = 0;
+    if (format >= 3) {
+        if (pos >= length) return -1;
+        game->rules_version = data[pos++];
+    }
+
+    return pos == length ? 0 : -1;
+}
+
+// ============ Index ============
+
+static int index_add(int match_id, int p1, int p2) {
+    pthread_mutex_lock(&hibernated_mutex);
+    if (hibernated_count == hibernated_capacity) {
+        int new_capacity = hibernated_capacity ? hibernated_capacity * 2 : 64;
+        HibernatedGame* grown = realloc(hibernated, sizeof(HibernatedGame) * new_capacity);
+        if (!grown) {
+            pthread_mutex_unlock(&hibernated_mutex);
+            return -1;
+        }
+        hibernated = grown;
+        hibernated_capacity = new_capacity;
+    }
+    HibernatedGame* entry = &hibernated[hibernated_count++];
+    entry->match_id = match_id;
+    entry->user_ids[0] = p1;
+    entry->user_ids[1] = p2;
+    pthread_mutex_unlock(&hibernated_mutex);
+    return 0;
+}
+
+static void index_remove(int match_id) {
+    pthread_mutex_lock(&hibernated_mutex);
+    for (int i = 0; i < hibernated_count; i++) {
+        if (hibernated[i].match_id == match_id) {
+            hibernated[i] = hibernated[--hibernated_count];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&hibernated_mutex);
+}
+
+typedef struct {
+    Database* db;
+    int* stale;         // Hibernated games that are also resident
+    int stale_count;
+} LoadContext;
+
+static void load_entry(void* ctx, int match_id, const uint8_t* data, size_t length) {
+    LoadContext* load = ctx;
+    ActiveGame decoded;
+    ActiveGame* game = &decoded;
+    memset(game, 0, sizeof(*game));
+
+    if (hibernate_decode(game, data, length) != 0) {
+        fprintf(stderr, "[HIBERNATE] Match %d: corrupt state, ignored\n", match_id);
+    } else if (game_find(match_id)) {
+        // Restored from a checkpoint taken before it was hibernated
+        int* grown = realloc(load->stale, sizeof(int) * (load->stale_count + 1));
+        if (grown) {
+            load->stale = grown;
+            load->stale[load->stale_count++] = match_id;
+        }
+    } else {
+        index_add(match_id, game->players[0].user_id, game->players[1].user_id);
+    }
+}
+
+int hibernate_init(Database* db) {
+    LoadContext load = { .db = db, .stale = NULL, .stale_count = 0 };
+    db_load_hibernated_games(db, load_entry, &load);
+
+    for (int i = 0; i < load.stale_count; i++) {
+        db_delete_hibernated_game(db, load.stale[i]);
+    }
+    free(load.stale);
+
+    if (hibernated_count > 0) {
+        printf("[HIBERNATE] %d hibernated games\n", hibernated_count);
+    }
+    return hibernated_count;
+}
+
+void hibernate_shutdown(void) {
+    pthread_mutex_lock(&hibernated_mutex);
+    free(hibernated);
+    hibernated = NULL;
+    hibernated_count = 0;
+    hibernated_capacity = 0;
+    pthread_mutex_unlock(&hibernated_mutex);
+}
+
+int hibernate_find_player(int user_id) {
+    int match_id = 0;
+    pthread_mutex_lock(&hibernated_mutex);
+    for (int i = 0; i < hibernated_count; i++) {
+        if (hibernated[i].user_ids[0] == user_id || hibernated[i].user_ids[1] == user_id) {
+            match_id = hibernated[i].match_id;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&hibernated_mutex);
+    return match_id;
+}
+
+int hibernate_count(void) {
+    pthread_mutex_lock(&hibernated_mutex);
+    int count = hibernated_count;
+    pthread_mutex_unlock(&hibernated_mutex);
+    return count;
+}
+
+int hibernate_match_ids(int* ids, int capacity) {
+    pthread_mutex_lock(&hibernated_mutex);
+    int count = hibernated_count < capacity ? hibernated_count : capacity;
+    for (int i = 0; i < count; i++) {
+        ids[i] = hibernated[i].match_id;
+    }
+    pthread_mutex_unlock(&hibernated_mutex);
+    return count;
+}
+
+// ============ Hibernate ============
+
+int hibernate_game(Database* db, ActiveGame* game) {
+    if (!game || !game->active || game->state == GSTATE_ENDED) return -1;
+
+    // The move log goes to match_logs, where it is loaded back on wake up
+    if (game_save_move_log(db, game) != 0) return -1;
+
+    uint8_t encoded[HIBERNATE_MAX_ENCODED];
+    pthread_mutex_lock(&game->mutex);
+    size_t length = hibernate_encode(game, encoded, sizeof(encoded));
+    int match_id = game->match_id;
+    int p1 = game->players[0].user_id;
+    int p2 = game->players[1].user_id;
+    int paused = game->paused;
+    pthread_mutex_unlock(&game->mutex);
+
+    if (length == 0 || db_save_hibernated_game(db, match_id, encoded, length) != 0) {
+        fprintf(stderr, "[HIBERNATE] Failed to hibernate match %d\n", match_id);
+        return -1;
+    }
+    if (index_add(match_id, p1, p2) != 0) {
+        db_delete_hibernated_game(db, match_id);
+        return -1;
+    }
+
+    game_destroy(match_id);
+    printf("[HIBERNATE] Match %d hibernated (%s, %zu bytes)\n", match_id,
+           paused ? "paused" : "idle", length);
+    return 0;
+}
+
+int hibernate_sweep(Database* db, time_t now) {
+    int candidates[MAX_ACTIVE_GAMES];
+    int count = 0;
+
+    pthread_mutex_lock(&games_mutex);
+    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
+        ActiveGame* game = &active_games[i];
+        if (!game->active || game->state == GSTATE_ENDED) continue;
+
+        time_t idle = now - game->last_activity;
+        if ((game->state == GSTATE_PAUSED && idle >= HIBERNATE_PAUSED_AFTER) ||
+            idle >= HIBERNATE_IDLE_AFTER) {
+            candidates[count++] = game->match_id;
+        }
+    }
+    pthread_mutex_unlock(&games_mutex);
+
+    int hibernated_now = 0;
+    for (int i = 0; i < count; i++) {
+        if (hibernate_game(db, game_find(candidates[i])) == 0) hibernated_now++;
+    }
+    return hibernated_now;
+}
+
+// ============ Wake Up ============
+
+ActiveGame* hibernate_wake(Database* db, int match_id) {
+    uint8_t* data;
+    size_t length;
+    if (db_load_hibernated_game(db, match_id, &data, &length) != 0) return NULL;
+
+    pthread_mutex_lock(&games_mutex);
+
+    ActiveGame* game = NULL;
+    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
+        if (!active_games[i].active) {
+            game = &active_games[i];
+            break;
+        }
+    }
+    if (!game) {
+        pthread_mutex_unlock(&games_mutex);
+        free(data);
+        fprintf(stderr, "[HIBERNATE] No free game slot to wake match %d\n", match_id);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&game->mutex);
+
+    if (hibernate_decode(game, data, length) != 0) {
+        pthread_mutex_unlock(&game->mutex);
+        pthread_mutex_unlock(&games_mutex);
+        free(data);
+        fprintf(stderr, "[HIBERNATE] Match %d: corrupt state\n", match_id);
+        return NULL;
+    }
+    free(data);
+
+    for (int i = 0; i < 2; i++) {
+        UserInfo info;
+        if (db_get_user_info(db, game->players[i].user_id, &info) == 0) {
+            snprintf(game->usernames[i], sizeof(game->usernames[i]), "%s", info.username);
+        }
+    }
+    if (game->paused && game->paused_by >= 0) {
+        snprintf(game->message, sizeof(game->message), "Game paused by %s",
+                 game->usernames[game->paused_by]);
+    }
+
+    if (game_restore_log(game, db, NULL, 0, -1) != 0) {
+        fprintf(stderr, "[HIBERNATE] Match %d: move log lost, starting a new one\n", match_id);
+    }
+
+    game->active = 1;
+    game->revision++;
+    game->last_activity = time(NULL);
+
+    pthread_mutex_unlock(&game->mutex);
+    pthread_mutex_unlock(&games_mutex);
+
+    index_remove(match_id);
+    db_delete_hibernated_game(db, match_id);
+
+    printf("[HIBERNATE] Match %d woken up: %s vs %s (%d moves)\n", match_id,
+           game->usernames[0], game->usernames[1], game->move_count);
+    return game;
+}
+
+ActiveGame* hibernate_find_or_wake(Database* db, int user_id) {
+    ActiveGame* game = game_find_by_player(user_id);
+    if (game) return game;
+
+    int match_id = hibernate_find_player(user_id);
+    return match_id ? hibernate_wake(db, match_id) : NULL;
+}
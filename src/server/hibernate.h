@@ -0,0 +1,65 @@
+/*
+ * Game Hibernation
+ *
+ * Moves games nobody is playing out of active_games:
+ * - A game paused for HIBERNATE_PAUSED_AFTER seconds, or without any action
+ *   for HIBERNATE_IDLE_AFTER seconds, is encoded into a few tens of bytes
+ *   (players, owned properties, turn state and RNG; no usernames or
+ *   messages) and stored in the database's hibernated_games table. Its move
+ *   log is saved to match_logs and freed with the slot
+ * - The server keeps only a small index (match and player ids) to find
+ *   hibernated games again
+ * - A hibernated game is woken up when one of its players logs in, resumes
+ *   it or sends any game action, and continues where it stopped
+ */
+
+#ifndef HIBERNATE_H
+#define HIBERNATE_H
+
+#include "server.h"
+#include "game_state.h"
+
+#define HIBERNATE_PAUSED_AFTER 60       // Seconds a paused game stays resident
+#define HIBERNATE_IDLE_AFTER 300        // Seconds without any action
+#define HIBERNATE_SWEEP_INTERVAL 10     // Seconds between sweeps
+
+// Load the index of hibernated games (call after game_state_init)
+// Returns the number of hibernated games
+int hibernate_init(Database* db);
+
+// Free the index
+void hibernate_shutdown(void);
+
+// Hibernate one game and free its slot
+// Returns 0 on success, -1 if the game stays resident
+int hibernate_game(Database* db, ActiveGame* game);
+
+// Hibernate every paused or idle game
+// Returns the number of games hibernated
+int hibernate_sweep(Database* db, time_t now);
+
+// Match id of the hibernated game of a player, or 0
+int hibernate_find_player(int user_id);
+
+// Wake a hibernated game up into a free slot
+// Returns the game, or NULL if it is not hibernated or no slot is free
+ActiveGame* hibernate_wake(Database* db, int match_id);
+
+// The resident game of a player, woken up if it is hibernated
+ActiveGame* hibernate_find_or_wake(Database* db, int user_id);
+
+// Number of hibernated games
+int hibernate_count(void);
+
+// Append the match ids of the hibernated games to ids (capacity entries)
+// Returns the number appended
+int hibernate_match_ids(int* ids, int capacity);
+
+// Encode / decode one game (the hibernated_games format)
+// Encode returns the encoded length, or 0 if the buffer is too small
+size_t hibernate_encode(const ActiveGame* game, uint8_t* out, size_t capacity);
+int hibernate_decode(ActiveGame* game, const uint8_t* data, size_t length);
+
+#define HIBERNATE_MAX_ENCODED 128       // Worst case of hibernate_encode
+
+#endif // HIBERNATE_H
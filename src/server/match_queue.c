@@ -0,0 +1,462 @@
+/*
+ * Matchmaking Queue Implementation
+ */
+
+#include "match_queue.h"
+#include "elo.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Candidate pair of nearby players in the sorted order
+typedef struct {
+    int cost;               // See pair_cost
+    int left;               // Indices into the queue, left < right
+    int right;
+} QueueEdge;
+
+void match_queue_init(MatchQueue* queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+void match_queue_free(MatchQueue* queue) {
+    free(queue->players);
+    match_queue_init(queue);
+}
+
+int match_queue_size(const MatchQueue* queue) {
+    return queue->count - queue->left;
+}
+
+// Whether a sorts before b: by rating, then longest search first
+static int before(const MatchmakingPlayer* a, const MatchmakingPlayer* b) {
+    if (a->elo_rating != b->elo_rating) return a->elo_rating < b->elo_rating;
+    return a->search_start_time < b->search_start_time;
+}
+
+static int compare_players(const void* a, const void* b) {
+    const MatchmakingPlayer* pa = a;
+    const MatchmakingPlayer* pb = b;
+    return before(pa, pb) ? -1 : before(pb, pa) ? 1 : 0;
+}
+
+// First sorted entry whose rating is at least elo_rating
+static int lower_bound(const MatchQueue* queue, int elo_rating) {
+    int low = 0, high = queue->sorted;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (queue->players[mid].elo_rating < elo_rating) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+int match_queue_add(MatchQueue* queue, int user_id, const char* username,
+                    int elo_rating, int64_t search_started_ms, int rtt_ms) {
+    if (queue->count == queue->capacity) {
+        int capacity = queue->capacity ? queue->capacity * 2 : 64;
+        MatchmakingPlayer* players = realloc(queue->players, sizeof(MatchmakingPlayer) * capacity);
+        if (!players) return -1;
+        queue->players = players;
+        queue->capacity = capacity;
+    }
+
+    MatchmakingPlayer* player = &queue->players[queue->count++];
+    memset(player, 0, sizeof(*player));
+    player->user_id = user_id;
+    snprintf(player->username, sizeof(player->username), "%s", username ? username : "");
+    player->elo_rating = elo_rating;
+    player->search_start_time = (int)(search_started_ms / 1000);
+    player->search_started_ms = search_started_ms;
+    player->rtt_ms = rtt_ms;
+
+    // A failed settle only leaves the queue unsorted for longer
+    if (queue->count - queue->sorted > MATCH_QUEUE_UNSORTED_MAX) {
+        match_queue_settle(queue);
+    }
+    return 0;
+}
+
+// Round trip a player may have over their opponent after searching this
+// long: widened by MATCH_RTT_GAP_STEP with every step of the rating range,
+// and unlimited once the range is at its widest
+static int rtt_gap_allowed(int search_time_seconds) {
+    int range = elo_get_matchmaking_range(search_time_seconds);
+    if (range >= ELO_MATCHMAKING_RANGE_MAX) return INT_MAX;
+    return MATCH_RTT_GAP + MATCH_RTT_GAP_STEP * ((range - ELO_MATCHMAKING_RANGE) / ELO_RANGE_STEP);
+}
+
+// Whether players at these ratings and round trips may play after
+// searching this long (an unmeasured round trip, -1, fits any)
+static int may_play(int elo1, int rtt1, int elo2, int rtt2, int search_time_seconds) {
+    if (!elo_is_good_match(elo1, elo2, search_time_seconds)) return 0;
+    return rtt1 < 0 || rtt2 < 0 || abs(rtt1 - rtt2) <= rtt_gap_allowed(search_time_seconds);
+}
+
+// Cost of a pair: the rating gap, plus a point per MATCH_RTT_PER_POINT ms
+// of their combined round trip when both are measured
+static int pair_cost(int elo1, int rtt1, int elo2, int rtt2) {
+    int cost = abs(elo1 - elo2);
+    if (rtt1 >= 0 && rtt2 >= 0) cost += (rtt1 + rtt2) / MATCH_RTT_PER_POINT;
+    return cost;
+}
+
+// Make queued player i the best opponent for a newcomer at elo_rating if
+// their range and allowance (the wider ones, as they searched longer)
+// accept the pair and it beats *best
+static void offer(const MatchQueue* queue, int i, int elo_rating, int rtt_ms, int now,
+                  int* best, int* best_cost) {
+    const MatchmakingPlayer* player = &queue->players[i];
+    if (player->user_id == 0 ||
+        !may_play(player->elo_rating, player->rtt_ms, elo_rating, rtt_ms, now - player->search_start_time)) {
+        return;
+    }
+    int cost = pair_cost(player->elo_rating, player->rtt_ms, elo_rating, rtt_ms);
+    if (*best < 0 || cost < *best_cost ||
+        (cost == *best_cost && player->search_start_time < queue->players[*best].search_start_time)) {
+        *best = i;
+        *best_cost = cost;
+    }
+}
+
+int match_queue_take_partner(MatchQueue* queue, int elo_rating, int rtt_ms, int now,
+                             MatchmakingPlayer* partner) {
+    int best = -1, best_cost = 0;
+
+    // Sorted part: outwards from the rating, until the gap is too wide for
+    // anyone or costs more than the best so far on its own (the round trip
+    // adds nothing against an unmeasured opponent, so it bounds nothing)
+    int pos = lower_bound(queue, elo_rating);
+    for (int i = pos; i < queue->sorted; i++) {
+        int gap = queue->players[i].elo_rating - elo_rating;
+        if (gap > ELO_MATCHMAKING_RANGE_MAX || (best >= 0 && gap > best_cost)) break;
+        offer(queue, i, elo_rating, rtt_ms, now, &best, &best_cost);
+    }
+    for (int i = pos - 1; i >= 0; i--) {
+        int gap = elo_rating - queue->players[i].elo_rating;
+        if (gap > ELO_MATCHMAKING_RANGE_MAX || (best >= 0 && gap > best_cost)) break;
+        offer(queue, i, elo_rating, rtt_ms, now, &best, &best_cost);
+    }
+
+    // Joined since the last settle
+    for (int i = queue->sorted; i < queue->count; i++) {
+        offer(queue, i, elo_rating, rtt_ms, now, &best, &best_cost);
+    }
+
+    if (best < 0) return -1;
+    *partner = queue->players[best];
+    queue->players[best].user_id = 0;
+    queue->left++;
+    return 0;
+}
+
+int match_queue_next_change(const MatchQueue* queue, int now) {
+    int next = -1;
+    for (int i = 0; i < queue->count; i++) {
+        const MatchmakingPlayer* player = &queue->players[i];
+        if (player->user_id == 0) continue;
+        int change = elo_next_range_change(now - player->search_start_time);
+        if (change < 0) continue;
+        int at = player->search_start_time + change;
+        if (next < 0 || at < next) next = at;
+    }
+    return next;
+}
+
+int match_queue_remove(MatchQueue* queue, int user_id, int elo_rating) {
+    if (user_id == 0) return -1;
+
+    // Sorted part: the entries with this rating
+    int pos = lower_bound(queue, elo_rating);
+    while (pos < queue->sorted && queue->players[pos].elo_rating == elo_rating &&
+           queue->players[pos].user_id != user_id) {
+        pos++;
+    }
+
+    // Joined since the last pairing
+    if (pos == queue->sorted || queue->players[pos].user_id != user_id) {
+        for (pos = queue->count - 1; pos >= queue->sorted && queue->players[pos].user_id != user_id; pos--) {
+        }
+        if (pos < queue->sorted) return -1;
+    }
+    queue->players[pos].user_id = 0;
+    queue->left++;
+    return 0;
+}
+
+int match_queue_settle(MatchQueue* queue) {
+    if (queue->sorted == queue->count && queue->left == 0) return 0;
+
+    MatchmakingPlayer* merged = malloc(sizeof(MatchmakingPlayer) * (queue->capacity ? queue->capacity : 1));
+    if (!merged) return -1;
+
+    MatchmakingPlayer* joined = queue->players + queue->sorted;
+    int joined_count = queue->count - queue->sorted;
+    qsort(joined, joined_count, sizeof(MatchmakingPlayer), compare_players);
+
+    int a = 0, b = 0, out = 0;
+    while (a < queue->sorted || b < joined_count) {
+        const MatchmakingPlayer* next;
+        if (b == joined_count || (a < queue->sorted && !before(&joined[b], &queue->players[a]))) {
+            next = &queue->players[a++];
+        } else {
+            next = &joined[b++];
+        }
+        if (next->user_id != 0) merged[out++] = *next;
+    }
+
+    free(queue->players);
+    queue->players = merged;
+    queue->count = queue->sorted = out;
+    queue->left = 0;
+    return 0;
+}
+
+// ============ Pairing ============
+
+static int edge_less(const QueueEdge* a, const QueueEdge* b) {
+    if (a->cost != b->cost) return a->cost < b->cost;
+    return a->left < b->left;
+}
+
+static void heap_push(QueueEdge* heap, int* size, QueueEdge edge) {
+    int i = (*size)++;
+    while (i > 0 && edge_less(&edge, &heap[(i - 1) / 2])) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = edge;
+}
+
+static QueueEdge heap_pop(QueueEdge* heap, int* size) {
+    QueueEdge top = heap[0];
+    QueueEdge last = heap[--(*size)];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && edge_less(&heap[child + 1], &heap[child])) child++;
+        if (!edge_less(&heap[child], &last)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (*size > 0) heap[i] = last;
+    return top;
+}
+
+// Whether a and b may play, after the longer of their two searches
+static int acceptable(const MatchmakingPlayer* a, const MatchmakingPlayer* b, int now) {
+    int started = a->search_start_time < b->search_start_time ? a->search_start_time : b->search_start_time;
+    return may_play(a->elo_rating, a->rtt_ms, b->elo_rating, b->rtt_ms, now - started);
+}
+
+static void set_pair(MatchPair* pair, const MatchmakingPlayer* a, const MatchmakingPlayer* b) {
+    int a_first = a->search_start_time <= b->search_start_time;
+    pair->first = a_first ? *a : *b;
+    pair->second = a_first ? *b : *a;
+}
+
+// Keep the players not taken, in order
+static void drop_taken(MatchQueue* queue, const char* taken) {
+    int kept = 0;
+    for (int i = 0; i < queue->count; i++) {
+        if (!taken[i]) queue->players[kept++] = queue->players[i];
+    }
+    queue->count = queue->sorted = kept;
+}
+
+// Push a and b as a candidate if they may play
+static void consider(const MatchQueue* queue, int now, int a, int b, QueueEdge* heap, int* size) {
+    const MatchmakingPlayer* pa = &queue->players[a];
+    const MatchmakingPlayer* pb = &queue->players[b];
+    if (acceptable(pa, pb, now)) {
+        heap_push(heap, size, (QueueEdge){ pair_cost(pa->elo_rating, pa->rtt_ms, pb->elo_rating, pb->rtt_ms), a, b });
+    }
+}
+
+int match_queue_pair(MatchQueue* queue, int now, MatchPair* pairs) {
+    if (match_queue_settle(queue) != 0) return -1;
+    int n = queue->count;
+    if (n < 2) return 0;
+
+    // Remaining players as a linked list over the sorted order, and the
+    // candidates: up to MATCH_GREEDY_REACH per player, plus one per pair
+    // for the neighbours it leaves
+    int* prev = malloc(sizeof(int) * n * 2);
+    char* taken = calloc(n, 1);
+    QueueEdge* heap = malloc(sizeof(QueueEdge) * n * (MATCH_GREEDY_REACH + 1));
+    if (!prev || !taken || !heap) {
+        free(prev);
+        free(taken);
+        free(heap);
+        return -1;
+    }
+    int* next = prev + n;
+    int size = 0;
+    for (int i = 0; i < n; i++) {
+        prev[i] = i - 1;
+        next[i] = i + 1;
+    }
+    for (int i = 0; i + 1 < n; i++) {
+        for (int j = i + 1; j <= i + MATCH_GREEDY_REACH && j < n; j++) {
+            consider(queue, now, i, j, heap, &size);
+        }
+    }
+
+    int count = 0;
+    while (size > 0) {
+        QueueEdge edge = heap_pop(heap, &size);
+        if (taken[edge.left] || taken[edge.right]) continue;
+        taken[edge.left] = taken[edge.right] = 1;
+
+        set_pair(&pairs[count++], &queue->players[edge.left], &queue->players[edge.right]);
+
+        // The players on either side of each are neighbours now (the
+        // pair need not have been)
+        int ends[2] = { edge.left, edge.right };
+        for (int k = 0; k < 2; k++) {
+            int left = prev[ends[k]];
+            int right = next[ends[k]];
+            if (left >= 0) next[left] = right;
+            if (right < n) prev[right] = left;
+            if (left >= 0 && right < n && right != edge.right) consider(queue, now, left, right, heap, &size);
+        }
+    }
+
+    drop_taken(queue, taken);
+
+    free(prev);
+    free(taken);
+    free(heap);
+    return count;
+}
+
+// ============ Batch Pairing ============
+
+static int64_t waiting_cost(const MatchmakingPlayer* player, int now) {
+    return ELO_MATCHMAKING_RANGE_MAX / 2 + (int64_t)MATCH_WAIT_WEIGHT * (now - player->search_start_time);
+}
+
+// The batch pairing scans the sorted queue keeping, for every choice of
+// which of the last MATCH_BATCH_WINDOW - 1 players are still open (waiting
+// for a partner further on), the least cost so far. Bit d of a state is
+// the player d places back; at most MATCH_BATCH_OPEN bits are set
+#define BATCH_STATE_BITS (MATCH_BATCH_WINDOW - 1)
+
+static int popcount(unsigned int mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) count++;
+    return count;
+}
+
+int match_queue_pair_batch(MatchQueue* queue, int now, MatchPair* pairs) {
+    if (match_queue_settle(queue) != 0) return -1;
+    int n = queue->count;
+    if (n < 2) return 0;
+
+    // The states, and a state's index by its mask (-1 if not a state)
+    int state_count = 0;
+    short* index = malloc(sizeof(short) << BATCH_STATE_BITS);
+    unsigned short* masks = malloc(sizeof(unsigned short) << BATCH_STATE_BITS);
+    if (index && masks) {
+        for (unsigned int mask = 0; mask < 1u << BATCH_STATE_BITS; mask++) {
+            index[mask] = -1;
+            if (popcount(mask) <= MATCH_BATCH_OPEN) {
+                index[mask] = (short)state_count;
+                masks[state_count++] = (unsigned short)mask;
+            }
+        }
+    }
+
+    // cost: least cost per state before and after the current player;
+    // from[i * state_count + s]: the state before player i of the best way
+    // to state s after them
+    int64_t* cost = malloc(sizeof(int64_t) * state_count * 2);
+    unsigned char* from = malloc((size_t)n * state_count);
+    char* taken = calloc(n, 1);
+    if (!index || !masks || !cost || !from || !taken) {
+        free(index);
+        free(masks);
+        free(cost);
+        free(from);
+        free(taken);
+        return -1;
+    }
+
+    const MatchmakingPlayer* players = queue->players;
+    int64_t* before = cost;
+    int64_t* after = cost + state_count;
+    for (int s = 0; s < state_count; s++) before[s] = INT64_MAX;
+    before[index[0]] = 0;
+
+    for (int i = 0; i < n; i++) {
+        for (int s = 0; s < state_count; s++) after[s] = INT64_MAX;
+        unsigned char* came = from + (size_t)i * state_count;
+
+        for (int s = 0; s < state_count; s++) {
+            if (before[s] == INT64_MAX) continue;
+            unsigned int shifted = (unsigned int)masks[s] << 1;   // Bit d: d places before player i
+
+            // Player i waits, or stays open for a later partner; both need
+            // the oldest open player to have been paired by now
+            int choices = 0;
+            unsigned int next[MATCH_BATCH_OPEN + 2];
+            int64_t add[MATCH_BATCH_OPEN + 2];
+            if (!(shifted >> BATCH_STATE_BITS)) {
+                next[choices] = shifted;
+                add[choices++] = waiting_cost(&players[i], now);
+                if (popcount(shifted) < MATCH_BATCH_OPEN) {
+                    next[choices] = shifted | 1;
+                    add[choices++] = 0;
+                }
+            }
+            // Player i pairs with an open player
+            for (unsigned int open = shifted; open; open &= open - 1) {
+                int d = __builtin_ctz(open);
+                unsigned int rest = shifted & ~(1u << d);
+                if (rest >> BATCH_STATE_BITS) continue;
+                const MatchmakingPlayer* partner = &players[i - d];
+                if (!acceptable(partner, &players[i], now)) continue;
+                next[choices] = rest;
+                add[choices++] = pair_cost(partner->elo_rating, partner->rtt_ms,
+                                           players[i].elo_rating, players[i].rtt_ms);
+            }
+
+            for (int c = 0; c < choices; c++) {
+                int t = index[next[c]];
+                if (before[s] + add[c] < after[t]) {
+                    after[t] = before[s] + add[c];
+                    came[t] = (unsigned char)s;
+                }
+            }
+        }
+        int64_t* swap = before;
+        before = after;
+        after = swap;
+    }
+
+    // Walk back from nobody open after the last player
+    int count = 0;
+    int s = index[0];
+    for (int i = n - 1; i >= 0; i--) {
+        int prev = from[(size_t)i * state_count + s];
+        unsigned int shifted = (unsigned int)masks[prev] << 1;
+        unsigned int gone = shifted & ~(unsigned int)masks[s];
+        if (gone) {
+            int d = __builtin_ctz(gone);
+            taken[i - d] = taken[i] = 1;
+            set_pair(&pairs[count++], &players[i - d], &players[i]);
+        }
+        s = prev;
+    }
+    drop_taken(queue, taken);
+
+    free(index);
+    free(masks);
+    free(cost);
+    free(from);
+    free(taken);
+    return count;
+}
@@ -0,0 +1,117 @@
+/*
+ * Matchmaking Queue
+ *
+ * Players searching for a match, kept sorted by rating:
+ * - Entries carry the time the search started, so the allowed rating gap
+ *   widens with the real wait (see elo_get_matchmaking_range)
+ * - Two players may play when their rating gap is within the range of the
+ *   longer wait, and the round trip to the server the slower one adds to
+ *   the faster one's game within an allowance that widens on the same
+ *   schedule (MATCH_RTT_GAP, MATCH_RTT_GAP_STEP). Among those, a pair
+ *   costs its rating gap plus a point per MATCH_RTT_PER_POINT ms of
+ *   combined round trip, so players on fast links end up together and a
+ *   slow link does not make the game sluggish for both
+ * - Good opponents are close in rating, so pairing only weighs each entry
+ *   against the next MATCH_GREEDY_REACH in the sorted order: the cheapest
+ *   acceptable pair is taken first from a heap, and the neighbours of a
+ *   taken pair become a new candidate
+ * - A player who starts searching is first offered the best acceptable
+ *   opponent already waiting (match_queue_take_partner), found by walking
+ *   out from their rating; only when there is none do they join
+ * - Joining appends and leaving marks the entry; both are settled by one
+ *   sort and merge when the next pairing starts (or when too many joined
+ *   since), so queue changes are O(1) / O(log n) and a pairing O(n log n)
+ * - Batch pairing (match_queue_pair_batch) instead finds the pairing of
+ *   least total cost: the costs of the pairs plus, for everyone left
+ *   waiting, a cost that grows with their wait. Ranges depend on the wait,
+ *   so the best pairs can cross or nest in rating order; a dynamic program
+ *   over the sorted order tracks which of the last few players are still
+ *   open, in O(n * MATCH_BATCH_WINDOW^MATCH_BATCH_OPEN)
+ * - Players are identified by user id only, so the queue works without
+ *   connections (offline tools, a matchmaking thread)
+ */
+
+#ifndef MATCH_QUEUE_H
+#define MATCH_QUEUE_H
+
+#include "database.h"
+
+#define MATCH_QUEUE_UNSORTED_MAX 256    // Joins kept unsorted before settling
+#define MATCH_BATCH_WINDOW 16           // Batch pairs are fewer than this many places apart in rating order
+#define MATCH_BATCH_OPEN 2              // Batch pairs that may overlap in rating order
+#define MATCH_WAIT_WEIGHT 10            // Batch cost per second a player is left waiting
+#define MATCH_GREEDY_REACH 4            // Greedy candidates per player, the next ones in rating order
+#define MATCH_RTT_GAP 200               // Round trip (ms) a player may have over their opponent at first
+#define MATCH_RTT_GAP_STEP 50           // Added each time the rating range widens
+#define MATCH_RTT_PER_POINT 4           // Combined round trip (ms) costing as much as a rating point
+
+typedef struct {
+    MatchmakingPlayer* players;     // Sorted by rating, then by search start, up to sorted
+    int count;                      // Entries, including left ones (user_id 0)
+    int sorted;                     // Entries in order; the rest joined since
+    int left;                       // Entries marked as left
+    int capacity;
+} MatchQueue;
+
+// Two players to match; first has been searching longer
+typedef struct {
+    MatchmakingPlayer first;
+    MatchmakingPlayer second;
+} MatchPair;
+
+// Empty queue
+void match_queue_init(MatchQueue* queue);
+
+// Free the entries
+void match_queue_free(MatchQueue* queue);
+
+// Players in the queue
+int match_queue_size(const MatchQueue* queue);
+
+// Add a player who started searching at search_started_ms (wall clock),
+// with their round trip to the server (-1 if not measured)
+// Returns 0 on success, -1 if out of memory
+int match_queue_add(MatchQueue* queue, int user_id, const char* username,
+                    int elo_rating, int64_t search_started_ms, int rtt_ms);
+
+// Remove a player (elo_rating is the rating they were added with)
+// Returns 0 if removed, -1 if not queued
+int match_queue_remove(MatchQueue* queue, int user_id, int elo_rating);
+
+// Take the best opponent for a player starting to search at time now: the
+// cheapest pair among those whose (wider) range and round trip allowance
+// accept them, the longest search on a tie. Returns 0 and removes the
+// opponent if there is one, -1 otherwise
+int match_queue_take_partner(MatchQueue* queue, int elo_rating, int rtt_ms, int now,
+                             MatchmakingPlayer* partner);
+
+// Earliest time after now at which a queued player's range (and round trip
+// allowance) widens, or -1 if every range is at its widest
+int match_queue_next_change(const MatchQueue* queue, int now);
+
+// Sort in the players who joined and drop the ones who left; afterwards
+// players[0 .. count) are exactly the queue, in order
+// Returns 0 on success, -1 if out of memory
+int match_queue_settle(MatchQueue* queue);
+
+// Pair the players who have an acceptable opponent at time now, cheapest
+// pair first, and remove them from the queue (settling it first). Only
+// opponents fewer than MATCH_GREEDY_REACH places apart in rating order (or
+// neighbours once those between are taken) are weighed. pairs must hold
+// size / 2 entries
+// Returns the number of pairs, or -1 if out of memory
+int match_queue_pair(MatchQueue* queue, int now, MatchPair* pairs);
+
+// Same, but choose the acceptable pairs of least total cost: the sum of
+// their pair costs plus, for each player left unpaired,
+// ELO_MATCHMAKING_RANGE_MAX / 2 + MATCH_WAIT_WEIGHT * seconds waited. Short
+// of round trips over a second, any acceptable pair beats leaving both
+// waiting, so the long waiters are the ones who get paired when players
+// compete for an opponent. The result is
+// the best among pairings whose pairs are fewer than MATCH_BATCH_WINDOW
+// places apart, with at most MATCH_BATCH_OPEN of them overlapping at any
+// point of the rating order
+// Returns the number of pairs, or -1 if out of memory
+int match_queue_pair_batch(MatchQueue* queue, int now, MatchPair* pairs);
+
+#endif // MATCH_QUEUE_H
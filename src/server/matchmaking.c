@@ -3,21 +3,391 @@
  * 
  * Handles:
  * - Online player list requests
- * - Match searching with ELO-based matchmaking
+ * - Match searching with ELO-based matchmaking (players wait in a queue
+ *   sorted by rating, see match_queue.h). A search is paired on arrival
+ *   when an acceptable opponent is waiting; otherwise the queue is only
+ *   paired again when someone's range widens or a bot becomes due
  * - Direct player challenges
  * - Match creation and notifications
+ * - Time-to-match histogram, reported at shutdown
+ *
+ * The queue belongs to a matchmaking thread. The network thread posts
+ * join, leave and rating-change events to it; the matchmaking thread posts
+ * back the players to seat, and the main loop creates the matches. Both
+ * directions are lock-free stacks with a wake pipe, so neither side waits
+ * on the other and no lock is held while pairing. A result can be stale by
+ * the time it arrives (the player left, or searched again), so players are
+ * checked against their current search before they are seated
  */
 
 #include "matchmaking.h"
+#include "match_queue.h"
 #include "elo.h"
 #include "game_state.h"
+#include "drain.h"
+#include "bot.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include <sys/socket.h>
 #include "cJSON.h"
 
+#define LATENCY_BUCKETS 20          // Under 1ms, under 2ms, ... under 2^18ms, longer
+
+typedef enum {
+    EVENT_JOIN,
+    EVENT_LEAVE,
+    EVENT_RATING
+} MatchEventType;
+
+// Change to the queue, posted to the matchmaking thread
+typedef struct MatchEvent {
+    struct MatchEvent* next;
+    MatchEventType type;
+    MatchmakingPlayer player;       // The queue entry (for a rating change, as queued)
+    int new_rating;                 // EVENT_RATING
+} MatchEvent;
+
+// Players to seat, posted back to the main loop
+typedef struct MatchResult {
+    struct MatchResult* next;
+    int with_bot;                   // Only pair.first is set
+    MatchPair pair;
+} MatchResult;
+
+static struct {
+    MatchQueue queue;               // Players searching (matchmaking thread only)
+    int next_tick;                  // When the queue is next worth pairing (-1: not until someone joins)
+    int last_tick;
+    int bots;                       // Whether players who wait too long get a bot
+    int batch;                      // Pair by least total cost (match_queue_pair_batch)
+    _Atomic(MatchEvent*) events;    // Newest first
+    _Atomic(MatchResult*) results;  // Newest first
+    atomic_int stopping;
+    int event_pipe[2];              // Wakes the matchmaking thread
+    int result_pipe[2];             // Wakes the main loop
+    pthread_t thread;
+    int running;
+} matcher = { .next_tick = -1, .event_pipe = { -1, -1 }, .result_pipe = { -1, -1 } };
+
+// Searches that ended in a match, by wait in milliseconds (main thread only)
+static uint64_t latency_hist[LATENCY_BUCKETS];
+
+static int64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void record_wait(const ConnectedClient* client) {
+    int64_t waited = wall_ms() - client->search_started_ms;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && waited >= ((int64_t)1 << bucket)) bucket++;
+    latency_hist[bucket]++;
+}
+
+// Wait in milliseconds below which a fraction of the recorded searches
+// ended (the bucket's upper bound; -1 for the overflow bucket)
+static int64_t wait_percentile(uint64_t total, double fraction) {
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += latency_hist[i];
+        if (seen >= total * fraction) return i < LATENCY_BUCKETS - 1 ? (int64_t)1 << i : -1;
+    }
+    return -1;
+}
+
+static void report_latency(void) {
+    uint64_t total = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) total += latency_hist[i];
+    if (total == 0) return;
+    
+    printf("[MATCHMAKING] Time to match over %llu searches: p50 < %lldms, p90 < %lldms, p99 < %lldms\n",
+           (unsigned long long)total, (long long)wait_percentile(total, 0.50),
+           (long long)wait_percentile(total, 0.90), (long long)wait_percentile(total, 0.99));
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        if (latency_hist[i] == 0) continue;
+        if (i < LATENCY_BUCKETS - 1) {
+            printf("[MATCHMAKING]   < %7lldms %llu\n", (long long)1 << i, (unsigned long long)latency_hist[i]);
+        } else {
+            printf("[MATCHMAKING]   longer    %llu\n", (unsigned long long)latency_hist[i]);
+        }
+    }
+}
+
+// ============ Event Queues ============
+
+static void wake(int fd) {
+    char byte = 1;
+    if (fd >= 0 && write(fd, &byte, 1) < 0 && errno != EAGAIN) {
+        perror("[MATCHMAKING] wake");
+    }
+}
+
+static void drain_pipe(int fd) {
+    char buf[64];
+    while (read(fd, buf, sizeof(buf)) > 0) {
+    }
+}
+
+// Post a change to the matchmaking thread (any thread)
+// Returns 0 on success, -1 if out of memory
+static int post_event(MatchEventType type, const MatchmakingPlayer* player, int new_rating) {
+    MatchEvent* event = malloc(sizeof(MatchEvent));
+    if (!event) return -1;
+    event->type = type;
+    event->player = *player;
+    event->new_rating = new_rating;
+    
+    MatchEvent* head = atomic_load(&matcher.events);
+    do {
+        event->next = head;
+    } while (!atomic_compare_exchange_weak(&matcher.events, &head, event));
+    if (!head) wake(matcher.event_pipe[1]);  // Taken as a whole: only the first needs a wake
+    return 0;
+}
+
+// Events in the order they were posted
+static MatchEvent* take_events(void) {
+    MatchEvent* list = atomic_exchange(&matcher.events, NULL);
+    MatchEvent* ordered = NULL;
+    while (list) {
+        MatchEvent* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    return ordered;
+}
+
+static int post_result(int with_bot, const MatchmakingPlayer* first, const MatchmakingPlayer* second) {
+    MatchResult* result = malloc(sizeof(MatchResult));
+    if (!result) return -1;
+    memset(result, 0, sizeof(*result));
+    result->with_bot = with_bot;
+    result->pair.first = *first;
+    if (second) result->pair.second = *second;
+    
+    MatchResult* head = atomic_load(&matcher.results);
+    do {
+        result->next = head;
+    } while (!atomic_compare_exchange_weak(&matcher.results, &head, result));
+    if (!head) wake(matcher.result_pipe[1]);
+    return 0;
+}
+
+static MatchResult* take_results(void) {
+    MatchResult* list = atomic_exchange(&matcher.results, NULL);
+    MatchResult* ordered = NULL;
+    while (list) {
+        MatchResult* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    return ordered;
+}
+
+// ============ Matchmaking Thread ============
+
+static void schedule_tick(int at) {
+    if (at < 0) return;
+    if (at <= matcher.last_tick) at = matcher.last_tick + 1;  // At most one pairing a second
+    if (matcher.next_tick < 0 || at < matcher.next_tick) matcher.next_tick = at;
+}
+
+// Queue a player, keeping the time their search started
+static void enqueue(const MatchmakingPlayer* player, int now) {
+    if (match_queue_add(&matcher.queue, player->user_id, player->username,
+                        player->elo_rating, player->search_started_ms, player->rtt_ms) != 0) {
+        fprintf(stderr, "[MATCHMAKING] Lost %s from the queue\n", player->username);
+        return;
+    }
+    int change = elo_next_range_change(now - player->search_start_time);
+    if (change >= 0) schedule_tick(player->search_start_time + change);
+    if (matcher.bots) schedule_tick(player->search_start_time + BOT_MATCH_AFTER);
+}
+
+// Seat two players; the one who searched longer goes first. If the result
+// cannot be posted they stay in the queue
+static void post_pair(const MatchmakingPlayer* a, const MatchmakingPlayer* b, int now) {
+    int a_first = a->search_start_time <= b->search_start_time;
+    if (post_result(0, a_first ? a : b, a_first ? b : a) != 0) {
+        enqueue(a, now);
+        enqueue(b, now);
+    }
+}
+
+// A player (re)joining is paired with the best opponent already waiting,
+// or waits in the queue
+static void join(const MatchmakingPlayer* player, int now) {
+    MatchmakingPlayer partner;
+    if (match_queue_take_partner(&matcher.queue, player->elo_rating, player->rtt_ms, now, &partner) == 0) {
+        post_pair(&partner, player, now);
+    } else {
+        enqueue(player, now);
+    }
+}
+
+static void apply_event(MatchEvent* event, int now) {
+    switch (event->type) {
+        case EVENT_JOIN:
+            join(&event->player, now);
+            break;
+        case EVENT_LEAVE:
+            match_queue_remove(&matcher.queue, event->player.user_id, event->player.elo_rating);
+            break;
+        case EVENT_RATING:
+            if (match_queue_remove(&matcher.queue, event->player.user_id, event->player.elo_rating) == 0) {
+                event->player.elo_rating = event->new_rating;
+                join(&event->player, now);
+            }
+            break;
+    }
+}
+
+// Pair everyone who has an acceptable opponent, give a bot to whoever
+// waited too long, and work out when to look again
+static void pair_queue(int now) {
+    matcher.next_tick = -1;
+    matcher.last_tick = now;
+    if (match_queue_size(&matcher.queue) == 0) return;
+    
+    MatchPair* pairs = malloc(sizeof(MatchPair) * (matcher.queue.count / 2 + 1));
+    int pair_count = !pairs ? -1
+                   : matcher.batch ? match_queue_pair_batch(&matcher.queue, now, pairs)
+                   : match_queue_pair(&matcher.queue, now, pairs);
+    if (pair_count < 0) {
+        free(pairs);
+        schedule_tick(now + 1);
+        return;
+    }
+    for (int i = 0; i < pair_count; i++) {
+        post_pair(&pairs[i].first, &pairs[i].second, now);
+    }
+    free(pairs);
+    
+    // Nobody suitable turned up in time: play a bot instead. The queue is
+    // sorted by rating, not by wait, so every entry is checked
+    for (int i = 0; matcher.bots && i < matcher.queue.count; i++) {
+        MatchmakingPlayer player = matcher.queue.players[i];
+        if (player.user_id != 0 && now - player.search_start_time >= BOT_MATCH_AFTER &&
+            post_result(1, &player, NULL) == 0) {
+            match_queue_remove(&matcher.queue, player.user_id, player.elo_rating);
+        }
+    }
+    
+    // Pair again when a range widens or the next bot is due
+    schedule_tick(match_queue_next_change(&matcher.queue, now));
+    for (int i = 0; matcher.bots && i < matcher.queue.count; i++) {
+        const MatchmakingPlayer* player = &matcher.queue.players[i];
+        if (player->user_id != 0) schedule_tick(player->search_start_time + BOT_MATCH_AFTER);
+    }
+}
+
+static void* matcher_main(void* arg) {
+    (void)arg;
+    while (!atomic_load(&matcher.stopping)) {
+        int timeout = -1;
+        if (matcher.next_tick >= 0) {
+            int64_t wait = (int64_t)matcher.next_tick * 1000 - wall_ms();
+            timeout = wait > 0 ? (int)wait : 0;
+        }
+        struct pollfd pfd = { .fd = matcher.event_pipe[0], .events = POLLIN };
+        if (poll(&pfd, 1, timeout) < 0 && errno != EINTR) {
+            perror("[MATCHMAKING] poll");
+            break;
+        }
+        drain_pipe(matcher.event_pipe[0]);
+        
+        int now = (int)time(NULL);
+        MatchEvent* event = take_events();
+        while (event) {
+            MatchEvent* next = event->next;
+            apply_event(event, now);
+            free(event);
+            event = next;
+        }
+        if (matcher.next_tick >= 0 && now >= matcher.next_tick) {
+            pair_queue(now);
+        }
+    }
+    return NULL;
+}
+
+int matchmaking_init(int bots, int batch) {
+    if (pipe(matcher.event_pipe) != 0) {
+        perror("[MATCHMAKING] pipe");
+        return -1;
+    }
+    if (pipe(matcher.result_pipe) != 0) {
+        perror("[MATCHMAKING] pipe");
+        close(matcher.event_pipe[0]);
+        close(matcher.event_pipe[1]);
+        matcher.event_pipe[0] = matcher.event_pipe[1] = -1;
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        int fds[2] = { matcher.event_pipe[i], matcher.result_pipe[i] };
+        for (int j = 0; j < 2; j++) {
+            fcntl(fds[j], F_SETFL, fcntl(fds[j], F_GETFL) | O_NONBLOCK);
+            fcntl(fds[j], F_SETFD, FD_CLOEXEC);
+        }
+    }
+    
+    matcher.bots = bots;
+    matcher.batch = batch;
+    atomic_store(&matcher.stopping, 0);
+    if (pthread_create(&matcher.thread, NULL, matcher_main, NULL) != 0) {
+        matchmaking_shutdown();
+        return -1;
+    }
+    matcher.running = 1;
+    
+    // Searches restored by a hot upgrade were posted before the pipe existed
+    wake(matcher.event_pipe[1]);
+    return 0;
+}
+
+int matchmaking_wake_fd(void) {
+    return matcher.running ? matcher.result_pipe[0] : -1;
+}
+
+void matchmaking_shutdown(void) {
+    if (matcher.running) {
+        atomic_store(&matcher.stopping, 1);
+        wake(matcher.event_pipe[1]);
+        pthread_join(matcher.thread, NULL);
+        matcher.running = 0;
+    }
+    
+    MatchEvent* event = take_events();
+    while (event) {
+        MatchEvent* next = event->next;
+        free(event);
+        event = next;
+    }
+    MatchResult* result = take_results();
+    while (result) {
+        MatchResult* next = result->next;
+        free(result);
+        result = next;
+    }
+    match_queue_free(&matcher.queue);
+    for (int i = 0; i < 2; i++) {
+        if (matcher.event_pipe[i] >= 0) close(matcher.event_pipe[i]);
+        if (matcher.result_pipe[i] >= 0) close(matcher.result_pipe[i]);
+        matcher.event_pipe[i] = matcher.result_pipe[i] = -1;
+    }
+    report_latency();
+}
+
 // ============ Online Players ============
 
 void handle_get_online_players(GameServer* server, ConnectedClient* client) {
@@ -63,12 +433,52 @@ void handle_get_online_players(GameServer* server, ConnectedClient* client) {
 
 // ============ Match Searching ============
 
+// The queue entry for a client's current search
+static MatchmakingPlayer search_entry(const ConnectedClient* client) {
+    MatchmakingPlayer entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.user_id = client->user_id;
+    snprintf(entry.username, sizeof(entry.username), "%s", client->username);
+    entry.elo_rating = client->elo_rating;
+    entry.search_start_time = (int)(client->search_started_ms / 1000);
+    entry.search_started_ms = client->search_started_ms;
+    entry.rtt_ms = client->rtt_ms;
+    return entry;
+}
+
+// Put a player taken from the queue back (their opponent left, or the
+// match could not be created), keeping their place in the wait
+static void requeue_entry(const MatchmakingPlayer* player) {
+    if (post_event(EVENT_JOIN, player, 0) != 0) {
+        fprintf(stderr, "[MATCHMAKING] Lost %s from the queue\n", player->username);
+    }
+}
+
+// Create a match between a queued player and an opponent (another queued
+// player or a bot); the queued players go back in the queue on failure
+static void start_queued_match(GameServer* server, ConnectedClient* player1, ConnectedClient* player2,
+                               const MatchmakingPlayer* queued1, const MatchmakingPlayer* queued2) {
+    int match_id = create_match(server, player1, player2);
+    if (match_id >= 0) {
+        record_wait(player1);
+        if (queued2) record_wait(player2);
+        send_match_found(player1, player2, match_id);
+        return;
+    }
+    requeue_entry(queued1);
+    if (queued2) requeue_entry(queued2);
+}
+
 void handle_search_match(GameServer* server, ConnectedClient* client) {
     if (!client->user_id) {
         send_error(client, "Not logged in");
         return;
     }
     
+    if (drain_reject(server, client, "search for a match elsewhere")) {
+        return;
+    }
+    
     if (client->status == PLAYER_IN_GAME) {
         send_error(client, "Already in a game");
         return;
@@ -79,12 +489,23 @@ void handle_search_match(GameServer* server, ConnectedClient* client) {
         return;
     }
     
-    printf("[MATCHMAKING] %s started searching for match (ELO: %d)\n", 
-           client->username, client->elo_rating);
+    if (client->rtt_ms >= 0) {
+        printf("[MATCHMAKING] %s started searching for match (ELO: %d, RTT: %d ms)\n", 
+               client->username, client->elo_rating, client->rtt_ms);
+    } else {
+        printf("[MATCHMAKING] %s started searching for match (ELO: %d, RTT: not measured)\n", 
+               client->username, client->elo_rating);
+    }
     
-    // Mark as searching
+    // Mark as searching; the matchmaking thread pairs the player at once
+    // if an acceptable opponent is waiting
+    client->search_started_ms = wall_ms();
+    MatchmakingPlayer entry = search_entry(client);
+    if (post_event(EVENT_JOIN, &entry, 0) != 0) {
+        send_error(client, "Failed to join matchmaking");
+        return;
+    }
     client->status = PLAYER_SEARCHING;
-    client->last_heartbeat = time(NULL);  // Use as search start time
     db_join_matchmaking(&server->db, client->user_id);
     
     // Send confirmation
@@ -98,9 +519,6 @@ void handle_search_match(GameServer* server, ConnectedClient* client) {
     
     free(response_str);
     cJSON_Delete(response);
-    
-    // Try to match immediately
-    matchmaking_try_match_players(server);
 }
 
 void handle_cancel_search(GameServer* server, ConnectedClient* client) {
@@ -117,13 +535,39 @@ void handle_cancel_search(GameServer* server, ConnectedClient* client) {
     printf("[MATCHMAKING] %s cancelled match search\n", client->username);
     
     // Stop searching
-    client->status = PLAYER_IDLE;
-    db_leave_matchmaking(&server->db, client->user_id);
+    matchmaking_leave(server, client);
     
     // Send confirmation
     send_success(client, "Match search cancelled");
 }
 
+void matchmaking_leave(GameServer* server, ConnectedClient* client) {
+    if (client->status != PLAYER_SEARCHING) return;
+    
+    // If the event is lost, the entry is stale and is dropped when it pairs
+    MatchmakingPlayer entry = search_entry(client);
+    post_event(EVENT_LEAVE, &entry, 0);
+    client->status = PLAYER_IDLE;
+    db_leave_matchmaking(&server->db, client->user_id);
+}
+
+void matchmaking_requeue(ConnectedClient* client) {
+    if (client->status != PLAYER_SEARCHING) return;
+    
+    MatchmakingPlayer entry = search_entry(client);
+    if (post_event(EVENT_JOIN, &entry, 0) != 0) {
+        client->status = PLAYER_IDLE;
+    }
+}
+
+void matchmaking_set_rating(ConnectedClient* client, int elo_rating) {
+    if (client->status == PLAYER_SEARCHING && client->elo_rating != elo_rating) {
+        MatchmakingPlayer entry = search_entry(client);
+        post_event(EVENT_RATING, &entry, elo_rating);
+    }
+    client->elo_rating = elo_rating;
+}
+
 // ============ Challenge System ============
 
 void handle_send_challenge(GameServer* server, ConnectedClient* client, NetworkMessage* msg) {
@@ -132,6 +576,10 @@ void handle_send_challenge(GameServer* server, ConnectedClient* client, NetworkM
         return;
     }
     
+    if (drain_reject(server, client, "no new challenges")) {
+        return;
+    }
+    
     if (client->status == PLAYER_IN_GAME) {
         send_error(client, "You are already in a game");
         return;
@@ -217,6 +665,10 @@ void handle_accept_challenge(GameServer* server, ConnectedClient* client, Networ
         return;
     }
     
+    if (drain_reject(server, client, "no new challenges")) {
+        return;
+    }
+    
     if (client->status == PLAYER_IN_GAME) {
         send_error(client, "You are already in a game");
         return;
@@ -391,6 +843,17 @@ int create_match(GameServer* server, ConnectedClient* player1, ConnectedClient*
         return -1;
     }
     
+    // Challenges can pick players who are also searching (for a queued
+    // match the players are out of the queue already and this is a no-op)
+    if (player1->status == PLAYER_SEARCHING) {
+        MatchmakingPlayer entry = search_entry(player1);
+        post_event(EVENT_LEAVE, &entry, 0);
+    }
+    if (player2->status == PLAYER_SEARCHING) {
+        MatchmakingPlayer entry = search_entry(player2);
+        post_event(EVENT_LEAVE, &entry, 0);
+    }
+    
     // Update player statuses
     player1->status = PLAYER_IN_GAME;
     player2->status = PLAYER_IN_GAME;
@@ -441,60 +904,82 @@ void send_match_found(ConnectedClient* player1, ConnectedClient* player2, int ma
 
 // ============ Matchmaking Engine ============
 
-void matchmaking_try_match_players(GameServer* server) {
-    // Get all searching clients
+// Order for looking searching clients up by user id
+static int compare_user_id(const void* a, const void* b) {
+    const ConnectedClient* ca = *(ConnectedClient* const*)a;
+    const ConnectedClient* cb = *(ConnectedClient* const*)b;
+    return (ca->user_id > cb->user_id) - (ca->user_id < cb->user_id);
+}
+
+static ConnectedClient* find_searching(ConnectedClient** index, int count, int user_id) {
+    ConnectedClient key;
+    key.user_id = user_id;
+    ConnectedClient* key_ptr = &key;
+    ConnectedClient** found = bsearch(&key_ptr, index, count, sizeof(*index), compare_user_id);
+    return found ? *found : NULL;
+}
+
+// The client of a queue entry, if they are still searching and on that
+// very search (a search cancelled and restarted within the same second is
+// a different one)
+static ConnectedClient* find_entry(ConnectedClient** index, int count, const MatchmakingPlayer* entry) {
+    ConnectedClient* client = find_searching(index, count, entry->user_id);
+    if (!client || client->status != PLAYER_SEARCHING ||
+        client->search_started_ms != entry->search_started_ms) {
+        return NULL;
+    }
+    return client;
+}
+
+void matchmaking_poll(GameServer* server) {
+    if (!matcher.running) return;
+    drain_pipe(matcher.result_pipe[0]);
+    MatchResult* results = take_results();
+    if (!results) return;
+    
+    // Resolve the results' user ids to connections in one pass
+    ConnectedClient** index = malloc(sizeof(ConnectedClient*) * (MAX_CLIENTS + 1));
+    int searching = 0;
     pthread_mutex_lock(&server->clients_mutex);
-    
-    // Find pairs of searching players
-    for (int i = 0; i < server->client_count; i++) {
-        ConnectedClient* player1 = server->clients[i];
-        
-        if (!player1->is_connected || player1->status != PLAYER_SEARCHING) {
-            continue;
+    for (int i = 0; index && i < server->client_count; i++) {
+        ConnectedClient* client = server->clients[i];
+        if (client->is_connected && client->status == PLAYER_SEARCHING) {
+            index[searching++] = client;
         }
+    }
+    pthread_mutex_unlock(&server->clients_mutex);
+    if (index) qsort(index, searching, sizeof(*index), compare_user_id);
+    
+    while (results) {
+        MatchResult* result = results;
+        results = result->next;
         
-        time_t now = time(NULL);
-        int search_time = (int)(now - player1->last_heartbeat);
-        
-        // Look for opponent
-        ConnectedClient* best_match = NULL;
-        int best_elo_diff = 99999;
-        
-        for (int j = i + 1; j < server->client_count; j++) {
-            ConnectedClient* player2 = server->clients[j];
-            
-            if (!player2->is_connected || player2->status != PLAYER_SEARCHING) {
-                continue;
-            }
-            
-            int elo_diff = abs(player1->elo_rating - player2->elo_rating);
-            int p2_search_time = (int)(now - player2->last_heartbeat);
-            int max_search_time = (search_time > p2_search_time) ? search_time : p2_search_time;
-            
-            // Check if within allowed range
-            if (elo_is_good_match(player1->elo_rating, player2->elo_rating, max_search_time)) {
-                if (elo_diff < best_elo_diff) {
-                    best_match = player2;
-                    best_elo_diff = elo_diff;
-                }
-            }
+        // No new games while draining (the searches were cancelled)
+        ConnectedClient* player1 = NULL;
+        ConnectedClient* player2 = NULL;
+        if (!index) {
+            requeue_entry(&result->pair.first);
+            if (!result->with_bot) requeue_entry(&result->pair.second);
+        } else if (!server->draining) {
+            player1 = find_entry(index, searching, &result->pair.first);
+            if (!result->with_bot) player2 = find_entry(index, searching, &result->pair.second);
         }
         
-        // If we found a match, create it
-        if (best_match) {
-            pthread_mutex_unlock(&server->clients_mutex);
-            
-            int match_id = create_match(server, player1, best_match);
-            if (match_id >= 0) {
-                send_match_found(player1, best_match, match_id);
+        if (result->with_bot) {
+            ConnectedClient* bot = player1 ? bot_for_rating(&server->db, result->pair.first.elo_rating) : NULL;
+            if (bot) {
+                start_queued_match(server, player1, bot, &result->pair.first, NULL);
+            } else if (player1) {
+                requeue_entry(&result->pair.first);
             }
-            
-            // Restart search from beginning since array may have changed
-            pthread_mutex_lock(&server->clients_mutex);
-            i = -1;  // Will be incremented to 0
+        } else if (player1 && player2) {
+            start_queued_match(server, player1, player2, &result->pair.first, &result->pair.second);
+        } else if (player1) {
+            requeue_entry(&result->pair.first);
+        } else if (player2) {
+            requeue_entry(&result->pair.second);
         }
+        free(result);
     }
-    
-    pthread_mutex_unlock(&server->clients_mutex);
+    free(index);
 }
-
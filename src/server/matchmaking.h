@@ -17,6 +17,32 @@ void handle_search_match(GameServer* server, ConnectedClient* client);
 // Handle request to cancel match search
 void handle_cancel_search(GameServer* server, ConnectedClient* client);
 
+// Take a player out of the search queue (cancel, drain, logout,
+// disconnect); does nothing if they are not searching
+void matchmaking_leave(GameServer* server, ConnectedClient* client);
+
+// Queue a client restored as searching (hot upgrade)
+void matchmaking_requeue(ConnectedClient* client);
+
+// Change a client's rating, moving them in the queue if they are searching
+void matchmaking_set_rating(ConnectedClient* client, int elo_rating);
+
+// ============ Matchmaking Thread ============
+
+// Start the matchmaking thread (bots: whether players who wait too long
+// get a bot; batch: pair by least total cost instead of closest first,
+// see match_queue.h). Searches posted before are queued when it starts
+// Returns 0 on success, -1 on error
+int matchmaking_init(int bots, int batch);
+
+// Descriptor that becomes readable when players are ready to be seated
+// (-1 if the thread is not running)
+int matchmaking_wake_fd(void);
+
+// Stop the thread, free the search queue and report the time-to-match
+// histogram
+void matchmaking_shutdown(void);
+
 // ============ Challenge Handlers ============
 
 // Handle sending a challenge to another player
@@ -36,9 +62,9 @@ int create_match(GameServer* server, ConnectedClient* player1, ConnectedClient*
 
 // ============ Matchmaking Engine ============
 
-// Attempt to find and create matches for all searching players
-// Called periodically from server main loop
-void matchmaking_try_match_players(GameServer* server);
+// Create the matches the matchmaking thread paired (and bot matches for
+// players who waited too long). Called from the server main loop
+void matchmaking_poll(GameServer* server);
 
 // Send match found notification to both players
 void send_match_found(ConnectedClient* player1, ConnectedClient* player2, int match_id);
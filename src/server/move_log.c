@@ -0,0 +1,250 @@
+/*
+ * Match Move Log Implementation
+ */
+
+#include "move_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MOVE_LOG_INITIAL_CAPACITY 1024
+#define MOVE_LOG_MAX_EVENT 16       // type + 10-byte varint + 5-byte argument
+
+static int64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// ============ Encoding ============
+
+static size_t put_varint(uint8_t* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static int get_varint(MoveLogReader* r, uint64_t* v) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->length) return -1;
+        uint8_t byte = r->data[r->pos++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *v = result;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static int reserve(MoveLog* log, size_t extra) {
+    if (log->length + extra <= log->capacity) return 0;
+
+    size_t new_capacity = log->capacity * 2;
+    while (new_capacity < log->length + extra) new_capacity *= 2;
+
+    uint8_t* grown = realloc(log->data, new_capacity);
+    if (!grown) return -1;
+
+    log->data = grown;
+    log->capacity = new_capacity;
+    return 0;
+}
+
+// ============ Writer ============
+
+int move_log_start(MoveLog* log, int match_id, int player1_id, int player2_id, unsigned int seed) {
+    memset(log, 0, sizeof(*log));
+
+    log->data = malloc(MOVE_LOG_INITIAL_CAPACITY);
+    if (!log->data) return -1;
+    log->capacity = MOVE_LOG_INITIAL_CAPACITY;
+    log->last_ms = wall_ms();
+
+    uint8_t* p = log->data;
+    memcpy(p, MOVE_LOG_MAGIC, 4);
+    p += 4;
+    *p++ = MOVE_LOG_VERSION;
+    p += put_varint(p, (uint32_t)match_id);
+    p += put_varint(p, (uint32_t)player1_id);
+    p += put_varint(p, (uint32_t)player2_id);
+    p += put_varint(p, seed);
+    for (int i = 0; i < 8; i++) {
+        *p++ = (uint8_t)((uint64_t)log->last_ms >> (8 * i));
+    }
+    log->length = p - log->data;
+    return 0;
+}
+
+void move_log_append(MoveLog* log, MoveType type, int player, int a, int b) {
+    if (!log->data || reserve(log, MOVE_LOG_MAX_EVENT) != 0) return;
+
+    int64_t now = wall_ms();
+    int64_t delta = now - log->last_ms;
+    if (delta < 0) delta = 0;  // Wall clock stepped back
+    log->last_ms += delta;
+
+    uint8_t* p = log->data + log->length;
+    *p++ = (uint8_t)((type << 1) | (player & 1));
+    p += put_varint(p, (uint64_t)delta);
+
+    switch (type) {
+        case MOVE_ROLL:
+            *p++ = (uint8_t)((a << 4) | (b & 0x0F));
+            break;
+        case MOVE_CARD:
+            p += put_varint(p, zigzag(a));
+            break;
+        case MOVE_UPGRADE:
+        case MOVE_DOWNGRADE:
+        case MOVE_MORTGAGE:
+            *p++ = (uint8_t)a;
+            break;
+        default:
+            break;
+    }
+
+    log->length = p - log->data;
+    log->event_count++;
+}
+
+int move_log_load(MoveLog* log, const uint8_t* data, size_t length) {
+    MoveLogReader reader;
+    MoveEvent event;
+    int count = 0;
+    int rc;
+
+    memset(log, 0, sizeof(*log));
+    if (move_log_reader_init(&reader, data, length) != 0) return -1;
+    while ((rc = move_log_reader_next(&reader, &event)) == 1) count++;
+    if (rc < 0) return -1;
+
+    size_t capacity = MOVE_LOG_INITIAL_CAPACITY;
+    while (capacity < length + MOVE_LOG_MAX_EVENT) capacity *= 2;
+
+    log->data = malloc(capacity);
+    if (!log->data) return -1;
+    memcpy(log->data, data, length);
+    log->length = length;
+    log->capacity = capacity;
+    log->event_count = count;
+    log->last_ms = reader.time_ms;
+    log->flushed_length = length;
+    return 0;
+}
+
+int move_log_version(const MoveLog* log) {
+    return (log->data && log->length > 4) ? log->data[4] : 0;
+}
+
+void move_log_free(MoveLog* log) {
+    free(log->data);
+    memset(log, 0, sizeof(*log));
+}
+
+// ============ Reader ============
+
+int move_log_reader_init(MoveLogReader* reader, const uint8_t* data, size_t length) {
+    memset(reader, 0, sizeof(*reader));
+    reader->data = data;
+    reader->length = length;
+
+    if (!data || length < 5 || memcmp(data, MOVE_LOG_MAGIC, 4) != 0 ||
+        data[4] < 1 || data[4] > MOVE_LOG_VERSION) {
+        return -1;
+    }
+    reader->header.version = data[4];
+    reader->pos = 5;
+
+    uint64_t match_id, p1, p2, seed = 0;
+    if (get_varint(reader, &match_id) != 0 || get_varint(reader, &p1) != 0 ||
+        get_varint(reader, &p2) != 0 ||
+        (reader->header.version >= 2 && get_varint(reader, &seed) != 0) ||
+        reader->pos + 8 > length) {
+        return -1;
+    }
+
+    uint64_t start = 0;
+    for (int i = 0; i < 8; i++) {
+        start |= (uint64_t)data[reader->pos++] << (8 * i);
+    }
+
+    reader->header.match_id = (int)match_id;
+    reader->header.player1_id = (int)p1;
+    reader->header.player2_id = (int)p2;
+    reader->header.seed = (unsigned int)seed;
+    reader->header.start_ms = (int64_t)start;
+    reader->time_ms = (int64_t)start;
+    return 0;
+}
+
+int move_log_reader_next(MoveLogReader* reader, MoveEvent* event) {
+    if (reader->pos >= reader->length) return 0;
+
+    uint8_t head = reader->data[reader->pos++];
+    uint64_t delta;
+    if (get_varint(reader, &delta) != 0) return -1;
+
+    memset(event, 0, sizeof(*event));
+    event->type = (MoveType)(head >> 1);
+    event->player = head & 1;
+    reader->time_ms += (int64_t)delta;
+    event->time_ms = reader->time_ms;
+
+    uint64_t v;
+    switch (event->type) {
+        case MOVE_ROLL:
+            if (reader->pos >= reader->length) return -1;
+            event->a = reader->data[reader->pos] >> 4;
+            event->b = reader->data[reader->pos] & 0x0F;
+            reader->pos++;
+            break;
+        case MOVE_CARD:
+            if (get_varint(reader, &v) != 0) return -1;
+            event->a = (int)unzigzag(v);
+            break;
+        case MOVE_UPGRADE:
+        case MOVE_DOWNGRADE:
+        case MOVE_MORTGAGE:
+            if (reader->pos >= reader->length) return -1;
+            event->a = reader->data[reader->pos++];
+            break;
+        default:
+            if (event->type < MOVE_ROLL || event->type >= MOVE_TYPE_COUNT) return -1;
+            break;
+    }
+    return 1;
+}
+
+const char* move_type_name(MoveType type) {
+    static const char* names[MOVE_TYPE_COUNT] = {
+        [MOVE_ROLL] = "roll",
+        [MOVE_CARD] = "card",
+        [MOVE_BUY] = "buy",
+        [MOVE_SKIP] = "skip",
+        [MOVE_UPGRADE] = "upgrade",
+        [MOVE_DOWNGRADE] = "downgrade",
+        [MOVE_MORTGAGE] = "mortgage",
+        [MOVE_PAY_FINE] = "pay_fine",
+        [MOVE_BANKRUPT] = "bankrupt",
+        [MOVE_PAUSE] = "pause",
+        [MOVE_RESUME] = "resume",
+        [MOVE_SURRENDER] = "surrender",
+        [MOVE_DRAW] = "draw"
+    };
+    if (type < MOVE_ROLL || type >= MOVE_TYPE_COUNT) return "unknown";
+    return names[type];
+}
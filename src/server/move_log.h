@@ -0,0 +1,120 @@
+/*
+ * Match Move Log
+ *
+ * Append-only, per-match event log in a compact binary encoding:
+ * - Every accepted game action is one event (plus the random outcomes the
+ *   rules drew: dice and card amounts), so the log alone can rebuild a game
+ * - A typical event is 2-3 bytes; a whole match fits in a few KB
+ * - The server persists each log as a single blob (match_logs table), in
+ *   periodic batches and once more when the match ends
+ *
+ * Blob layout (integers are LEB128 varints unless noted):
+ *   "MVLG" | version (1 byte) | match_id | player1_id | player2_id |
+ *   rng seed (version 2+) | start time (unix ms, 8 bytes little endian) |
+ *   events...
+ * Event:
+ *   (type << 1 | player) (1 byte) | ms since previous event | arguments
+ *   ROLL: (die1 << 4 | die2) (1 byte)
+ *   CARD: amount (zigzag varint)
+ *   UPGRADE / DOWNGRADE / MORTGAGE: property (1 byte)
+ */
+
+#ifndef MOVE_LOG_H
+#define MOVE_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MOVE_LOG_MAGIC "MVLG"
+#define MOVE_LOG_VERSION 4   // 2: adds the rules RNG seed, 3: group and count based rents
+                             // (none on mortgaged squares), 4: Chance and Community Chest decks
+#define MOVE_LOG_FLUSH_INTERVAL 30   // Seconds between batch flushes of live games
+
+typedef enum {
+    MOVE_ROLL = 1,          // a = die1, b = die2
+    MOVE_CARD,              // a = money received (negative = paid)
+    MOVE_BUY,
+    MOVE_SKIP,
+    MOVE_UPGRADE,           // a = property
+    MOVE_DOWNGRADE,         // a = property
+    MOVE_MORTGAGE,          // a = property (mortgage or unmortgage)
+    MOVE_PAY_FINE,
+    MOVE_BANKRUPT,
+    MOVE_PAUSE,
+    MOVE_RESUME,
+    MOVE_SURRENDER,
+    MOVE_DRAW,
+    MOVE_TYPE_COUNT
+} MoveType;
+
+// One decoded event
+typedef struct {
+    MoveType type;
+    int player;             // 0 or 1
+    int64_t time_ms;        // Unix ms
+    int a;
+    int b;
+} MoveEvent;
+
+// Writer side: owned by one ActiveGame, protected by the game mutex
+typedef struct {
+    uint8_t* data;          // NULL if the log could not be allocated
+    size_t length;
+    size_t capacity;
+    int event_count;
+    int64_t last_ms;
+    size_t flushed_length;  // Bytes already persisted (dirty if < length)
+} MoveLog;
+
+// Header fields of a serialized log
+typedef struct {
+    int match_id;
+    int player1_id;
+    int player2_id;
+    unsigned int seed;      // 0 in version 1 logs (not replayable)
+    int version;
+    int64_t start_ms;
+} MoveLogHeader;
+
+// Streaming reader over a serialized log (does not copy the buffer)
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+    size_t pos;
+    int64_t time_ms;
+    MoveLogHeader header;
+} MoveLogReader;
+
+// ============ Writer ============
+
+// Start a log for a match (writes the header). Returns 0 on success; on
+// allocation failure the log stays disabled and appends are ignored
+int move_log_start(MoveLog* log, int match_id, int player1_id, int player2_id, unsigned int seed);
+
+// Append one event (a/b are ignored by types that take no arguments)
+void move_log_append(MoveLog* log, MoveType type, int player, int a, int b);
+
+// Continue a serialized log (copied; counted as already persisted)
+// Returns 0 on success, -1 if the log is corrupt or allocation fails
+int move_log_load(MoveLog* log, const uint8_t* data, size_t length);
+
+// Format version of a started or loaded log (0 if it has none)
+int move_log_version(const MoveLog* log);
+
+// Release the buffer
+void move_log_free(MoveLog* log);
+
+// ============ Reader ============
+
+// Parse the header (any version up to MOVE_LOG_VERSION). Returns 0 on
+// success, -1 on a bad magic/version
+int move_log_reader_init(MoveLogReader* reader, const uint8_t* data, size_t length);
+
+// Decode the next event. Returns 1 if an event was read, 0 at the end of
+// the log, -1 on a truncated or corrupt event
+int move_log_reader_next(MoveLogReader* reader, MoveEvent* event);
+
+// Short lowercase name of an event type ("roll", "buy", ...)
+const char* move_type_name(MoveType type);
+
+#endif // MOVE_LOG_H
@@ -0,0 +1,154 @@
+/*
+ * Match Replay Implementation
+ */
+
+#include "replay.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int fail(Replay* replay, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(replay->error, sizeof(replay->error), fmt, args);
+    va_end(args);
+    replay->failed = 1;
+    return -1;
+}
+
+static int same_event(const MoveEvent* a, const MoveEvent* b) {
+    return a->type == b->type && a->player == b->player && a->a == b->a && a->b == b->b;
+}
+
+// Re-execute one recorded action (the same calls the server handlers make)
+static int apply(ActiveGame* game, const MoveEvent* event) {
+    switch (event->type) {
+        case MOVE_ROLL:      return game_roll_dice(game, event->player);
+        case MOVE_BUY:       return game_buy_property(game, event->player);
+        case MOVE_SKIP:      return game_skip_property(game, event->player);
+        case MOVE_UPGRADE:   return game_upgrade_property(game, event->player, event->a);
+        case MOVE_DOWNGRADE: return game_downgrade_property(game, event->player, event->a);
+        case MOVE_MORTGAGE:  return game_mortgage_property(game, event->player, event->a);
+        case MOVE_PAY_FINE:  return game_pay_jail_fine(game, event->player);
+        case MOVE_BANKRUPT:  return game_declare_bankrupt(game, event->player);
+        case MOVE_PAUSE:     return game_pause(game, event->player);
+        case MOVE_RESUME:    return game_resume(game, event->player);
+        case MOVE_SURRENDER: return game_surrender(game, event->player);
+        case MOVE_DRAW:
+            // Agreed between the players outside the rules; no state change
+            pthread_mutex_lock(&game->mutex);
+            move_log_append(&game->log, MOVE_DRAW, event->player, 0, 0);
+            pthread_mutex_unlock(&game->mutex);
+            return 0;
+        default:
+            return -1;  // Outcome events (cards) only follow their action
+    }
+}
+
+int replay_open(Replay* replay, const uint8_t* data, size_t length) {
+    memset(replay, 0, sizeof(*replay));
+
+    if (move_log_reader_init(&replay->recorded, data, length) != 0) {
+        return fail(replay, "bad log header");
+    }
+
+    MoveLogHeader* header = &replay->recorded.header;
+    if (header->version < 2) {
+        return fail(replay, "log version %d has no seed", header->version);
+    }
+
+    char p1_name[16], p2_name[16];
+    snprintf(p1_name, sizeof(p1_name), "%d", header->player1_id);
+    snprintf(p2_name, sizeof(p2_name), "%d", header->player2_id);
+
+    ActiveGame* game = &replay->game;
+    pthread_mutex_init(&game->mutex, NULL);
+    game_init_state(game, header->match_id, header->player1_id, p1_name,
+                    header->player2_id, p2_name, header->seed);
+    game->rules_version = (uint8_t)header->version;
+    game->active = 1;
+
+    if (move_log_start(&game->log, header->match_id, header->player1_id,
+                       header->player2_id, header->seed) != 0 ||
+        move_log_reader_init(&replay->produced, game->log.data, game->log.length) != 0) {
+        replay_close(replay);
+        return fail(replay, "out of memory");
+    }
+    return 0;
+}
+
+int replay_step(Replay* replay) {
+    if (replay->failed) return -1;
+
+    MoveEvent expected;
+    int rc = move_log_reader_next(&replay->recorded, &expected);
+    if (rc == 0) return 0;
+    if (rc < 0) return fail(replay, "corrupt event at byte %zu", replay->recorded.pos);
+
+    int action = replay->actions_applied + 1;
+    if (apply(&replay->game, &expected) != 0) {
+        return fail(replay, "action %d (%s by player %d) rejected",
+                    action, move_type_name(expected.type), expected.player);
+    }
+
+    // The first emitted event is the action itself, the rest its outcomes;
+    // each must match the next recorded event
+    replay->produced.data = replay->game.log.data;
+    replay->produced.length = replay->game.log.length;
+
+    MoveEvent actual;
+    int emitted = 0;
+    while (move_log_reader_next(&replay->produced, &actual) == 1) {
+        if (emitted > 0 && move_log_reader_next(&replay->recorded, &expected) != 1) {
+            return fail(replay, "action %d: log ends before its %s outcome",
+                        action, move_type_name(actual.type));
+        }
+        if (!same_event(&actual, &expected)) {
+            return fail(replay, "action %d: rules produced %s(%d,%d), log has %s(%d,%d)", action,
+                        move_type_name(actual.type), actual.a, actual.b,
+                        move_type_name(expected.type), expected.a, expected.b);
+        }
+        emitted++;
+    }
+    if (emitted == 0) {
+        return fail(replay, "action %d (%s) produced no event", action, move_type_name(expected.type));
+    }
+
+    replay->actions_applied++;
+    return 1;
+}
+
+int replay_run(Replay* replay, int actions) {
+    while (actions < 0 || replay->actions_applied < actions) {
+        int rc = replay_step(replay);
+        if (rc < 0) return -1;
+        if (rc == 0) break;
+    }
+    return replay->actions_applied;
+}
+
+void replay_close(Replay* replay) {
+    move_log_free(&replay->game.log);
+    if (replay->game.active) {
+        pthread_mutex_destroy(&replay->game.mutex);
+        replay->game.active = 0;
+    }
+}
+
+int replay_validate(const uint8_t* data, size_t length, char* error, size_t error_size) {
+    Replay* replay = aligned_alloc(_Alignof(Replay), sizeof(Replay));
+    if (!replay) return -1;
+
+    int result = -1;
+    if (replay_open(replay, data, length) == 0) {
+        result = replay_run(replay, -1);
+        replay_close(replay);
+    }
+    if (result < 0 && error && error_size > 0) {
+        snprintf(error, error_size, "%s", replay->error);
+    }
+
+    free(replay);
+    return result;
+}
@@ -0,0 +1,48 @@
+/*
+ * Match Replay
+ *
+ * Rebuilds a match from its stored move log by re-executing every recorded
+ * action through the game_state.c rules, starting from the log's RNG seed.
+ * The rules re-emit the events they produce (including the dice and card
+ * amounts they draw); any difference from the recorded stream means the
+ * log and the rules disagree, and the replay stops there.
+ *
+ * Replays are independent of the active games table and of each other, so
+ * any number can run in parallel.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "game_state.h"
+
+typedef struct {
+    ActiveGame game;            // Detached game the actions are applied to
+    MoveLogReader recorded;     // Stored log
+    MoveLogReader produced;     // Events the rules emitted during the replay
+    int actions_applied;        // Recorded actions replayed so far
+    int failed;
+    char error[128];
+} Replay;
+
+// Start a replay at the initial position of a stored log
+// Returns 0 on success, -1 if the log is corrupt or has no seed (version 1)
+int replay_open(Replay* replay, const uint8_t* data, size_t length);
+
+// Replay the next action and check its outcomes
+// Returns 1 if an action was applied, 0 at the end of the log, -1 if the
+// log is corrupt or diverges from the rules (see replay->error)
+int replay_step(Replay* replay);
+
+// Replay until `actions` actions have been applied (or to the end if < 0)
+// Returns the number of actions applied, or -1 on failure
+int replay_run(Replay* replay, int actions);
+
+// Release the replay
+void replay_close(Replay* replay);
+
+// Replay a whole log. Returns the number of actions, or -1 on failure with
+// the reason copied to error (if given)
+int replay_validate(const uint8_t* data, size_t length, char* error, size_t error_size);
+
+#endif // REPLAY_H
@@ -5,11 +5,13 @@
 #include <time.h>
 #include "../shared/protocol.h"
 #include "database.h"
+#include "session_store.h"
+#include "checkpoint.h"
 
 #define MAX_CLIENTS 100
 #define MAX_MATCHES 50
-#define SESSION_ID_LENGTH 64
 #define HEARTBEAT_TIMEOUT 60  // seconds
+#define RTT_PROBE_INTERVAL 10 // Seconds between round trip probes to a logged-in client
 
 // Player status
 typedef enum {
@@ -29,6 +31,10 @@ typedef struct {
     PlayerStatus status;
     int current_match_id;
     time_t last_heartbeat;
+    int64_t search_started_ms;      // When the current match search began (wall clock)
+    int rtt_ms;                     // Smoothed round trip from heartbeat probes (-1 until measured)
+    int64_t rtt_probe_ms;           // When the last probe was sent (monotonic, 0 before the first)
+    int rtt_probe_pending;          // The last probe is unanswered
     int is_connected;
 } ConnectedClient;
 
@@ -43,12 +49,26 @@ typedef struct {
     pthread_mutex_t clients_mutex;
     
     Database db;
+    SessionStore sessions;
+    Checkpoint checkpoint;
+    
+    // Hot upgrade control socket (see upgrade.h)
+    int upgrade_socket;             // -1 if disabled
+    char upgrade_path[256];
+    int handed_off;                 // Another process took over our clients
+    
+    // Drain mode (see drain.h)
+    int draining;
+    time_t drain_started;
+    int drain_games_at_start;
+    char redirect[128];             // Where refused clients should go (host:port)
 } GameServer;
 
 // ============ Server Core ============
 
-// Initialize server on given port
-int server_init(GameServer* server, int port, const char* db_file);
+// Initialize server on given port, or take over the sockets and games of
+// the server running on the same database (takeover)
+int server_init(GameServer* server, int port, DatabaseBackend backend, const char* db_file, int takeover);
 
 // Main server loop (blocking)
 void server_run(GameServer* server);
@@ -92,9 +112,6 @@ ConnectedClient* find_client_by_id(GameServer* server, int user_id);
 // Find client by socket fd
 ConnectedClient* find_client_by_socket(GameServer* server, int socket_fd);
 
-// Generate a random session ID
-void generate_session_id(char* output);
-
 // Simple password hashing (SHA256)
 void hash_password(const char* password, char* output);
 
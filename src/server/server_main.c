@@ -2,6 +2,11 @@
 #include "matchmaking.h"
 #include "game_handler.h"
 #include "game_state.h"
+#include "upgrade.h"
+#include "drain.h"
+#include "hibernate.h"
+#include "bot.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +14,7 @@
 #include <signal.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/select.h>
 #include <time.h>
@@ -25,10 +31,11 @@ static void handle_pay_jail_fine(GameServer* server, ConnectedClient* client);
 static void handle_pause_game(GameServer* server, ConnectedClient* client);
 static void handle_resume_game(GameServer* server, ConnectedClient* client);
 static void handle_surrender_game(GameServer* server, ConnectedClient* client);
-static void handle_get_history(GameServer* server, ConnectedClient* client);
-static void broadcast_game_state(GameServer* server, ActiveGame* game);
+static void handle_get_history(GameServer* server, ConnectedClient* client, NetworkMessage* msg);
+static void handle_heartbeat_ack(ConnectedClient* client, NetworkMessage* msg);
 
 static GameServer* global_server = NULL;
+static volatile sig_atomic_t drain_requested = 0;
 
 // Signal handler for graceful shutdown
 static void signal_handler(int sig) {
@@ -39,7 +46,83 @@ static void signal_handler(int sig) {
     }
 }
 
-int server_init(GameServer* server, int port, const char* db_file) {
+// SIGUSR1: finish running games, then shut down (see drain.h)
+static void drain_signal_handler(int sig) {
+    (void)sig;
+    drain_requested = 1;
+}
+
+// Create the listening TCP socket
+static int create_listen_socket(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    
+    // Set socket options
+    int opt = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        perror("setsockopt");
+        close(fd);
+        return -1;
+    }
+    
+    // Bind to port
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    
+    // Listen
+    if (listen(fd, MAX_CLIENTS) < 0) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    
+    return fd;
+}
+
+static int compare_match_ids(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Matches still ongoing in the database that no resident or hibernated game
+// came back for (a torn or unsaved checkpoint slot) can never finish:
+// record them as abandoned
+static void abandon_lost_matches(GameServer* server) {
+    int capacity = MAX_ACTIVE_GAMES + hibernate_count();
+    int* keep = malloc(sizeof(int) * capacity);
+    if (!keep) return;
+    
+    int count = 0;
+    pthread_mutex_lock(&games_mutex);
+    for (int i = 0; i < MAX_ACTIVE_GAMES; i++) {
+        if (active_games[i].active && active_games[i].state != GSTATE_ENDED) {
+            keep[count++] = active_games[i].match_id;
+        }
+    }
+    pthread_mutex_unlock(&games_mutex);
+    count += hibernate_match_ids(keep + count, capacity - count);
+    qsort(keep, count, sizeof(int), compare_match_ids);
+    
+    int abandoned = db_abandon_matches(&server->db, keep, count);
+    if (abandoned > 0) {
+        printf("[SERVER] %d matches lost in a restart marked abandoned\n", abandoned);
+    }
+    free(keep);
+}
+
+int server_init(GameServer* server, int port, DatabaseBackend backend, const char* db_file, int takeover) {
     if (!server) return -1;
     
     // Initialize server structure
@@ -47,65 +130,98 @@ int server_init(GameServer* server, int port, const char* db_file) {
     server->running = 1;
     server->port = port;
     server->client_count = 0;
+    server->upgrade_socket = -1;
     
     // Initialize mutex
     pthread_mutex_init(&server->clients_mutex, NULL);
     
+    // Games only carry over through the database the old server writes to
+    if (takeover && backend != DB_BACKEND_SQLITE) {
+        fprintf(stderr, "Takeover needs the sqlite backend\n");
+        return -1;
+    }
+    
     // Initialize database
-    if (db_init(&server->db, db_file) != 0) {
+    if (db_open(&server->db, backend, db_file) != 0) {
         fprintf(stderr, "Failed to initialize database\n");
         return -1;
     }
     
-    // Initialize game state manager
-    game_state_init();
-    
-    // Seed random number generator
-    srand(time(NULL));
+    char upgrade_path[256];
+    upgrade_socket_path(db_file, upgrade_path, sizeof(upgrade_path));
     
-    // Create TCP socket
-    server->server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (server->server_socket < 0) {
-        perror("socket");
+    // Stop the running server first: it flushes its sessions and move logs
+    // before handing over, so everything below sees them
+    UpgradeImage image;
+    if (takeover && upgrade_receive(upgrade_path, &image) != 0) {
+        fprintf(stderr, "Failed to take over from the running server\n");
+        upgrade_finish(&image, 0);
         db_close(&server->db);
         return -1;
     }
     
-    // Set socket options
-    int opt = 1;
-    if (setsockopt(server->server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        perror("setsockopt");
-        close(server->server_socket);
+    // Initialize in-memory session store (restores unexpired sessions)
+    if (session_store_init(&server->sessions, &server->db) != 0) {
+        fprintf(stderr, "Failed to initialize session store\n");
+        if (takeover) upgrade_finish(&image, 0);
         db_close(&server->db);
         return -1;
     }
     
-    // Bind to port
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(port);
+    // Initialize game state manager
+    game_state_init();
     
-    if (bind(server->server_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        perror("bind");
-        close(server->server_socket);
-        db_close(&server->db);
-        return -1;
+    // Restore games in progress from the last checkpoint. The in-memory
+    // backend starts without matches, so it has nothing to resume against.
+    // On takeover the games come from the old server instead
+    server->checkpoint.fd = -1;
+    if (backend == DB_BACKEND_SQLITE) {
+        char checkpoint_file[512];
+        snprintf(checkpoint_file, sizeof(checkpoint_file), "%s.checkpoint", db_file);
+        if (checkpoint_open(&server->checkpoint, checkpoint_file) == 0 && !takeover) {
+            int restored = checkpoint_restore(&server->checkpoint, &server->db);
+            if (restored > 0) {
+                printf("[SERVER] Restored %d games in progress\n", restored);
+            }
+        }
     }
     
-    // Listen
-    if (listen(server->server_socket, MAX_CLIENTS) < 0) {
-        perror("listen");
-        close(server->server_socket);
-        db_close(&server->db);
-        return -1;
+    // Seed random number generator
+    srand(time(NULL));
+    
+    if (takeover) {
+        int ok = upgrade_apply(server, &image) == 0;
+        upgrade_finish(&image, ok);
+        if (!ok) {
+            checkpoint_close(&server->checkpoint);
+            session_store_shutdown(&server->sessions);
+            db_close(&server->db);
+            return -1;
+        }
+    } else {
+        server->server_socket = create_listen_socket(port);
+        if (server->server_socket < 0) {
+            checkpoint_close(&server->checkpoint);
+            session_store_shutdown(&server->sessions);
+            db_close(&server->db);
+            return -1;
+        }
+    }
+    
+    // Games hibernated by this or an earlier process
+    hibernate_init(&server->db);
+    abandon_lost_matches(server);
+    
+    // Accept the next upgrade
+    if (backend == DB_BACKEND_SQLITE && upgrade_listen(server, upgrade_path) != 0) {
+        printf("[SERVER] Hot upgrade unavailable (no control socket)\n");
     }
     
     // Set up signal handlers
     global_server = server;
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
+    signal(SIGUSR1, drain_signal_handler);
     
     printf("=================================\n");
     printf("  MONOPOLY GAME SERVER\n");
@@ -131,6 +247,11 @@ void server_accept_connection(GameServer* server) {
         return;
     }
     
+    // Small messages (moves, round trip probes) go out at once instead of
+    // waiting for the previous one to be acknowledged
+    int nodelay = 1;
+    setsockopt(client_sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    
     pthread_mutex_lock(&server->clients_mutex);
     
     if (server->client_count >= MAX_CLIENTS) {
@@ -147,6 +268,7 @@ void server_accept_connection(GameServer* server) {
     client->user_id = 0;  // Not logged in yet
     client->status = PLAYER_DISCONNECTED;
     client->last_heartbeat = time(NULL);
+    client->rtt_ms = -1;
     client->is_connected = 1;
     
     server->clients[server->client_count++] = client;
@@ -297,7 +419,7 @@ void server_handle_message(GameServer* server, ConnectedClient* client) {
             break;
 
         case MSG_GET_HISTORY:
-            handle_get_history(server, client);
+            handle_get_history(server, client, &msg);
             break;
             
         // === Heartbeat ===
@@ -305,6 +427,10 @@ void server_handle_message(GameServer* server, ConnectedClient* client) {
             send_message(client, MSG_HEARTBEAT_ACK, NULL);
             break;
             
+        case MSG_HEARTBEAT_ACK:
+            handle_heartbeat_ack(client, &msg);
+            break;
+            
 default:
             printf("[SERVER] Unknown message type: %d from socket %d\n", msg.type, client->socket_fd);
             send_error(client, "Unknown message type");
@@ -319,9 +445,10 @@ void server_disconnect_client(GameServer* server, ConnectedClient* client) {
     if (client->user_id > 0) {
         printf(" (user: %s)", client->username);
         
-        // Clean up user state
+        // Clean up user state. The session stays valid (until logout or
+        // expiry) so the player can resume it after reconnecting.
+        matchmaking_leave(server, client);
         db_set_player_offline(&server->db, client->user_id);
-        db_delete_session(&server->db, client->session_id);
     }
     printf("\n");
     
@@ -365,6 +492,52 @@ ConnectedClient* find_client_by_socket(GameServer* server, int socket_fd) {
     return NULL;
 }
 
+// ============ Round Trip Probes ============
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Send logged-in clients a heartbeat carrying the time, which they echo
+// back in the acknowledgement
+static void probe_round_trips(GameServer* server) {
+    int64_t now_ms = monotonic_ms();
+    char payload[64];
+    
+    pthread_mutex_lock(&server->clients_mutex);
+    for (int i = 0; i < server->client_count; i++) {
+        ConnectedClient* client = server->clients[i];
+        if (!client->is_connected || client->user_id <= 0 || client->socket_fd < 0) continue;
+        if (client->rtt_probe_ms != 0 && now_ms - client->rtt_probe_ms < RTT_PROBE_INTERVAL * 1000) continue;
+        
+        snprintf(payload, sizeof(payload), "{\"t\":%lld}", (long long)now_ms);
+        if (send_message(client, MSG_HEARTBEAT, payload) > 0) {
+            client->rtt_probe_ms = now_ms;
+            client->rtt_probe_pending = 1;
+        }
+    }
+    pthread_mutex_unlock(&server->clients_mutex);
+}
+
+// The answer to a probe: only the latest one counts, so a client cannot
+// report a shorter round trip than it has
+static void handle_heartbeat_ack(ConnectedClient* client, NetworkMessage* msg) {
+    cJSON* json = cJSON_Parse(msg->payload);
+    if (!json) return;
+    cJSON* sent = cJSON_GetObjectItem(json, "t");
+    if (client->rtt_probe_pending && cJSON_IsNumber(sent) && (int64_t)sent->valuedouble == client->rtt_probe_ms) {
+        int sample = (int)(monotonic_ms() - client->rtt_probe_ms);
+        client->rtt_probe_pending = 0;
+        
+        // Smoothed like TCP's SRTT, weighing new samples more as they are rare
+        if (client->rtt_ms < 0) client->rtt_ms = sample;
+        else client->rtt_ms += (sample - client->rtt_ms) / 4;
+    }
+    cJSON_Delete(json);
+}
+
 // Check for timed out clients
 static void check_client_timeouts(GameServer* server) {
     time_t now = time(NULL);
@@ -394,6 +567,20 @@ void server_run(GameServer* server) {
         FD_ZERO(&read_fds);
         FD_SET(server->server_socket, &read_fds);
         max_fd = server->server_socket;
+        if (server->upgrade_socket >= 0) {
+            FD_SET(server->upgrade_socket, &read_fds);
+            if (server->upgrade_socket > max_fd) max_fd = server->upgrade_socket;
+        }
+        int bot_fd = bot_wake_fd();
+        if (bot_fd >= 0) {
+            FD_SET(bot_fd, &read_fds);
+            if (bot_fd > max_fd) max_fd = bot_fd;
+        }
+        int match_fd = matchmaking_wake_fd();
+        if (match_fd >= 0) {
+            FD_SET(match_fd, &read_fds);
+            if (match_fd > max_fd) max_fd = match_fd;
+        }
         
         // Add all client sockets
         pthread_mutex_lock(&server->clients_mutex);
@@ -413,12 +600,20 @@ void server_run(GameServer* server) {
         int activity = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
         
         if (activity < 0) {
+            // Interrupted by a signal that does not stop the server (drain)
+            if (errno == EINTR && server->running) continue;
             if (server->running) {
                 perror("select");
             }
             break;
         }
         
+        // A new binary is taking over
+        if (server->upgrade_socket >= 0 && FD_ISSET(server->upgrade_socket, &read_fds)) {
+            if (upgrade_handoff(server) == 0) break;
+            continue;
+        }
+        
         // New connection
         if (FD_ISSET(server->server_socket, &read_fds)) {
             server_accept_connection(server);
@@ -436,15 +631,67 @@ void server_run(GameServer* server) {
         }
         pthread_mutex_unlock(&server->clients_mutex);
         
+        // Seat the players the matchmaking thread paired
+        matchmaking_poll(server);
+        
+        // Play finished bot decisions and start searches for games waiting
+        // on a bot (also after the players' moves above)
+        bot_poll(server);
+        
         // Periodically check for timeouts
         check_client_timeouts(server);
         
-        // Periodically try to match searching players
-        static time_t last_matchmaking = 0;
+        // Measure the clients' round trips for matchmaking
+        probe_round_trips(server);
+        
         time_t now = time(NULL);
-        if (now - last_matchmaking >= 2) {  // Every 2 seconds
-            matchmaking_try_match_players(server);
-            last_matchmaking = now;
+        
+        // Periodically drop expired sessions
+        static time_t last_session_sweep = 0;
+        if (now - last_session_sweep >= SESSION_SWEEP_INTERVAL) {
+            int expired = session_store_expire(&server->sessions, now);
+            if (expired > 0) {
+                printf("[SERVER] Expired %d sessions (%d active)\n", expired,
+                       session_store_count(&server->sessions));
+            }
+            last_session_sweep = now;
+        }
+        
+        // Periodically persist the move logs of games in progress
+        static time_t last_move_log_flush = 0;
+        if (now - last_move_log_flush >= MOVE_LOG_FLUSH_INTERVAL) {
+            game_flush_move_logs(&server->db);
+            last_move_log_flush = now;
+        }
+        
+        // Periodically snapshot games that changed
+        static time_t last_checkpoint = 0;
+        if (now - last_checkpoint >= CHECKPOINT_INTERVAL) {
+            checkpoint_write(&server->checkpoint, &server->db);
+            last_checkpoint = now;
+        }
+        
+        // Periodically move paused and idle games out of memory
+        static time_t last_hibernate_sweep = 0;
+        if (now - last_hibernate_sweep >= HIBERNATE_SWEEP_INTERVAL) {
+            hibernate_sweep(&server->db, now);
+            last_hibernate_sweep = now;
+        }
+        
+        // Drain: report progress and stop once the last game is over
+        if (drain_requested && !server->draining) {
+            drain_begin(server);
+        }
+        if (server->draining) {
+            static time_t last_drain_report = 0;
+            if (drain_games_remaining() == 0) {
+                drain_report(server);
+                printf("[DRAIN] All games finished\n");
+                server->running = 0;
+            } else if (now - last_drain_report >= DRAIN_REPORT_INTERVAL) {
+                drain_report(server);
+                last_drain_report = now;
+            }
         }
     }
 }
@@ -454,18 +701,51 @@ void server_shutdown(GameServer* server) {
     
     server->running = 0;
     
-    // Disconnect all clients
+    // Searches in flight are dropped; bots pick up their games after a restart
+    bot_shutdown();
+    
+    // Disconnect all clients (after a handoff the connections belong to
+    // the new process; closing our copies does not affect them)
     pthread_mutex_lock(&server->clients_mutex);
     for (int i = server->client_count - 1; i >= 0; i--) {
         ConnectedClient* client = server->clients[i];
         if (client->is_connected) {
-            send_error(client, "Server shutting down");
+            if (!server->handed_off) send_error(client, "Server shutting down");
             close(client->socket_fd);
         }
         free(client);
     }
     server->client_count = 0;
     pthread_mutex_unlock(&server->clients_mutex);
+    matchmaking_shutdown();
+    
+    if (server->upgrade_socket >= 0) {
+        close(server->upgrade_socket);
+        if (!server->handed_off) unlink(server->upgrade_path);
+    }
+    
+    if (!server->handed_off) {
+        // Flush pending session writes and unsaved move logs while the
+        // database is still open
+        session_store_shutdown(&server->sessions);
+        game_flush_move_logs(&server->db);
+        
+        // Final snapshot: running games resume after the restart
+        checkpoint_write(&server->checkpoint, &server->db);
+    }
+    // Sessions and move logs were flushed before the handoff, and the
+    // snapshot now belongs to the new process
+    checkpoint_close(&server->checkpoint);
+    
+    // Report user cache effectiveness before the cache goes away
+    UserCacheStats cache_stats;
+    if (db_get_cache_stats(&server->db, &cache_stats) == 0) {
+        uint64_t lookups = cache_stats.hits + cache_stats.misses;
+        printf("[SERVER] User cache: %llu hits, %llu misses (%.1f%% hit rate), %llu invalidations, %llu evictions\n",
+               (unsigned long long)cache_stats.hits, (unsigned long long)cache_stats.misses,
+               lookups ? 100.0 * cache_stats.hits / lookups : 0.0,
+               (unsigned long long)cache_stats.invalidations, (unsigned long long)cache_stats.evictions);
+    }
     
     // Close database
     db_close(&server->db);
@@ -485,6 +765,11 @@ int main(int argc, char* argv[]) {
 
     int port = 8888;
     const char* db_file = "monopoly.db";
+    DatabaseBackend backend = DB_BACKEND_SQLITE;
+    int takeover = 0;
+    const char* redirect = NULL;
+    int bot_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int batch_pairing = 0;
     
     // Parse arguments
     for (int i = 1; i < argc; i++) {
@@ -492,20 +777,54 @@ int main(int argc, char* argv[]) {
             port = atoi(argv[++i]);
         } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
             db_file = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            if (db_backend_from_name(argv[++i], &backend) != 0) {
+                fprintf(stderr, "Unknown storage backend: %s (use sqlite or memory)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            redirect = argv[++i];
+        } else if (strcmp(argv[i], "-u") == 0) {
+            takeover = 1;
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            bot_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "greedy") != 0 && strcmp(mode, "batch") != 0) {
+                fprintf(stderr, "Unknown pairing mode: %s (use greedy or batch)\n", mode);
+                return 1;
+            }
+            batch_pairing = strcmp(mode, "batch") == 0;
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            printf("Usage: %s [-p port] [-d database]\n", argv[0]);
+            printf("Usage: %s [-p port] [-d database] [-s storage] [-r host:port] [-u] [-b threads] [-m pairing]\n", argv[0]);
             printf("  -p port      Server port (default: 8888)\n");
             printf("  -d database  SQLite database file (default: monopoly.db)\n");
+            printf("  -s storage   Storage backend: sqlite or memory (default: sqlite)\n");
+            printf("  -r host:port Where to send players while draining (SIGUSR1)\n");
+            printf("  -u           Take over clients and games from the server running on the database\n");
+            printf("  -b threads   Bot search threads (default: one per core, 0 disables bots)\n");
+            printf("  -m pairing   Matchmaking pairing: greedy (closest first) or batch (least total cost) (default: greedy)\n");
             return 0;
         }
     }
     
     GameServer server;
     
-    if (server_init(&server, port, db_file) < 0) {
+    if (server_init(&server, port, backend, db_file, takeover) < 0) {
         fprintf(stderr, "Failed to initialize server\n");
         return 1;
     }
+    if (redirect) {
+        snprintf(server.redirect, sizeof(server.redirect), "%s", redirect);
+    }
+    if (bot_threads > 0 && bot_init(&server.db, bot_threads) != 0) {
+        printf("[SERVER] Bots unavailable\n");
+    }
+    if (matchmaking_init(bot_wake_fd() >= 0, batch_pairing) != 0) {
+        fprintf(stderr, "Failed to start matchmaking\n");
+        server_shutdown(&server);
+        return 1;
+    }
     
     server_run(&server);
     server_shutdown(&server);
@@ -522,46 +841,13 @@ static int get_player_index(ActiveGame* game, int user_id) {
     return -1;
 }
 
-// Broadcast game state to both players
-static void broadcast_game_state(GameServer* server, ActiveGame* game) {
-    if (!game) return;
-    
-    char* state_json = game_serialize_state(game);
-    if (!state_json) return;
-    
-    pthread_mutex_lock(&server->clients_mutex);
-    
-    for (int i = 0; i < 2; i++) {
-        ConnectedClient* client = find_client_by_id(server, game->players[i].user_id);
-        if (client && client->is_connected) {
-            send_message(client, MSG_GAME_STATE, state_json);
-        }
-    }
-    
-    pthread_mutex_unlock(&server->clients_mutex);
-    
-    free(state_json);
-    
-    // Check if game ended
-    if (game->state == GSTATE_ENDED) {
-        int winner_id = game_get_winner(game);
-        int loser_id = game_get_loser(game);
-        int match_id = game->match_id;
-        
-        if (winner_id > 0 && loser_id > 0) {
-            handle_game_end(server, match_id, winner_id, loser_id, "bankruptcy");
-            game_destroy(match_id);
-        }
-    }
-}
-
 static void handle_roll_dice(GameServer* server, ConnectedClient* client) {
     if (!client->user_id || client->status != PLAYER_IN_GAME) {
         send_error(client, "Not in a game");
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -596,7 +882,7 @@ static void handle_buy_property(GameServer* server, ConnectedClient* client) {
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -623,7 +909,7 @@ static void handle_skip_property(GameServer* server, ConnectedClient* client) {
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -650,7 +936,7 @@ static void handle_upgrade_property(GameServer* server, ConnectedClient* client,
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -686,7 +972,7 @@ static void handle_downgrade_property(GameServer* server, ConnectedClient* clien
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -721,7 +1007,7 @@ static void handle_mortgage_property(GameServer* server, ConnectedClient* client
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -756,7 +1042,7 @@ static void handle_pay_jail_fine(GameServer* server, ConnectedClient* client) {
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -783,7 +1069,7 @@ static void handle_pause_game(GameServer* server, ConnectedClient* client) {
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -810,7 +1096,7 @@ static void handle_resume_game(GameServer* server, ConnectedClient* client) {
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -837,7 +1123,7 @@ static void handle_surrender_game(GameServer* server, ConnectedClient* client) {
         return;
     }
     
-    ActiveGame* game = game_find_by_player(client->user_id);
+    ActiveGame* game = hibernate_find_or_wake(&server->db, client->user_id);
     if (!game) {
         send_error(client, "Game not found");
         return;
@@ -864,11 +1150,25 @@ static void handle_surrender_game(GameServer* server, ConnectedClient* client) {
     }
 }
 
-static void handle_get_history(GameServer* server, ConnectedClient* client) {
+static void handle_get_history(GameServer* server, ConnectedClient* client, NetworkMessage* msg) {
     MatchHistoryEntry* history = NULL;
     int count = 0;
     
-    if (db_get_user_match_history(&server->db, client->user_id, &history, &count) != 0) {
+    // Optional paging: {"before_match_id": <last match_id seen>, "limit": <n>}
+    int before_match_id = 0;
+    int limit = MATCH_HISTORY_PAGE_SIZE;
+    
+    cJSON* json = cJSON_Parse(msg->payload);
+    if (json) {
+        cJSON* before_item = cJSON_GetObjectItem(json, "before_match_id");
+        cJSON* limit_item = cJSON_GetObjectItem(json, "limit");
+        if (before_item && cJSON_IsNumber(before_item)) before_match_id = before_item->valueint;
+        if (limit_item && cJSON_IsNumber(limit_item)) limit = limit_item->valueint;
+        cJSON_Delete(json);
+    }
+    
+    if (db_get_user_match_history(&server->db, client->user_id, before_match_id, limit,
+                                  &history, &count) != 0) {
         send_error(client, "Failed to fetch history");
         return;
     }
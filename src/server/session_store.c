@@ -0,0 +1,323 @@
+/*
+ * Session Store Implementation
+ */
+
+#include "session_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <openssl/rand.h>
+
+struct SessionEntry {
+    char session_id[SESSION_ID_LENGTH + 1];
+    int user_id;
+    time_t expires_at;
+    SessionEntry* next;
+};
+
+typedef enum {
+    SESSION_WRITE_CREATE,
+    SESSION_WRITE_DELETE
+} SessionWriteType;
+
+struct SessionWrite {
+    SessionWriteType type;
+    char session_id[SESSION_ID_LENGTH + 1];
+    int user_id;
+    SessionWrite* next;
+};
+
+#define SESSION_INITIAL_BUCKETS 256
+#define RANDOM_POOL_SIZE 4096
+
+// ============ Buffered CSPRNG ============
+
+static unsigned char random_pool[RANDOM_POOL_SIZE];
+static size_t random_pool_pos = RANDOM_POOL_SIZE;
+static pthread_mutex_t random_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+void session_generate_id(char* output) {
+    static const char hex_chars[] = "0123456789abcdef";
+    unsigned char bytes[SESSION_ID_LENGTH / 2];
+
+    pthread_mutex_lock(&random_mutex);
+    if (random_pool_pos + sizeof(bytes) > RANDOM_POOL_SIZE) {
+        if (RAND_bytes(random_pool, RANDOM_POOL_SIZE) != 1) {
+            // Never hand out predictable IDs
+            fprintf(stderr, "[SESSION] CSPRNG failure\n");
+            abort();
+        }
+        random_pool_pos = 0;
+    }
+    memcpy(bytes, random_pool + random_pool_pos, sizeof(bytes));
+    // Wipe consumed bytes so they cannot be recovered from the pool
+    memset(random_pool + random_pool_pos, 0, sizeof(bytes));
+    random_pool_pos += sizeof(bytes);
+    pthread_mutex_unlock(&random_mutex);
+
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        output[i * 2] = hex_chars[bytes[i] >> 4];
+        output[i * 2 + 1] = hex_chars[bytes[i] & 0x0F];
+    }
+    output[SESSION_ID_LENGTH] = '\0';
+}
+
+// ============ Hash Table (store mutex held) ============
+
+static uint32_t hash_session_id(const char* session_id) {
+    // IDs are uniformly random, so FNV-1a over the whole ID spreads them evenly
+    uint32_t h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)session_id; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static SessionEntry** find_link(SessionStore* store, const char* session_id) {
+    uint32_t bucket = hash_session_id(session_id) & (store->bucket_count - 1);
+    SessionEntry** link = &store->buckets[bucket];
+    while (*link && strcmp((*link)->session_id, session_id) != 0) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+static void grow_table(SessionStore* store) {
+    int new_count = store->bucket_count * 2;
+    SessionEntry** new_buckets = calloc(new_count, sizeof(SessionEntry*));
+    if (!new_buckets) return;  // Keep working with longer chains
+
+    for (int i = 0; i < store->bucket_count; i++) {
+        SessionEntry* e = store->buckets[i];
+        while (e) {
+            SessionEntry* next = e->next;
+            uint32_t bucket = hash_session_id(e->session_id) & (new_count - 1);
+            e->next = new_buckets[bucket];
+            new_buckets[bucket] = e;
+            e = next;
+        }
+    }
+
+    free(store->buckets);
+    store->buckets = new_buckets;
+    store->bucket_count = new_count;
+}
+
+static int insert_entry(SessionStore* store, const char* session_id, int user_id, time_t expires_at) {
+    SessionEntry** link = find_link(store, session_id);
+    if (*link) {
+        (*link)->user_id = user_id;
+        (*link)->expires_at = expires_at;
+        return 0;
+    }
+
+    SessionEntry* e = malloc(sizeof(SessionEntry));
+    if (!e) return -1;
+
+    strncpy(e->session_id, session_id, SESSION_ID_LENGTH);
+    e->session_id[SESSION_ID_LENGTH] = '\0';
+    e->user_id = user_id;
+    e->expires_at = expires_at;
+    e->next = NULL;
+    *link = e;
+    store->count++;
+
+    if (store->count > store->bucket_count) {
+        grow_table(store);
+    }
+    return 0;
+}
+
+// ============ Asynchronous Persistence ============
+
+static void enqueue_write(SessionStore* store, SessionWriteType type, const char* session_id, int user_id) {
+    SessionWrite* w = calloc(1, sizeof(SessionWrite));
+    if (!w) return;
+
+    w->type = type;
+    w->user_id = user_id;
+    strncpy(w->session_id, session_id, SESSION_ID_LENGTH);
+
+    pthread_mutex_lock(&store->queue_mutex);
+    if (store->queue_tail) store->queue_tail->next = w;
+    else store->queue_head = w;
+    store->queue_tail = w;
+    store->queue_length++;
+    pthread_cond_signal(&store->queue_cond);
+    pthread_mutex_unlock(&store->queue_mutex);
+}
+
+static void* writer_thread(void* arg) {
+    SessionStore* store = arg;
+
+    pthread_mutex_lock(&store->queue_mutex);
+    for (;;) {
+        while (!store->queue_head && !store->stopping) {
+            pthread_cond_wait(&store->queue_cond, &store->queue_mutex);
+        }
+        if (!store->queue_head && store->stopping) break;
+
+        // Take the whole backlog and write it without holding the queue lock
+        SessionWrite* batch = store->queue_head;
+        store->queue_head = store->queue_tail = NULL;
+        store->queue_length = 0;
+        pthread_mutex_unlock(&store->queue_mutex);
+
+        while (batch) {
+            SessionWrite* next = batch->next;
+            switch (batch->type) {
+                case SESSION_WRITE_CREATE:
+                    db_create_session(store->db, batch->user_id, batch->session_id);
+                    break;
+                case SESSION_WRITE_DELETE:
+                    db_delete_session(store->db, batch->session_id);
+                    break;
+            }
+            free(batch);
+            batch = next;
+        }
+
+        pthread_mutex_lock(&store->queue_mutex);
+    }
+    pthread_mutex_unlock(&store->queue_mutex);
+    return NULL;
+}
+
+// ============ Public API ============
+
+static void load_visit(void* ctx, const char* session_id, int user_id, time_t expires_at) {
+    insert_entry((SessionStore*)ctx, session_id, user_id, expires_at);
+}
+
+int session_store_init(SessionStore* store, Database* db) {
+    if (!store || !db) return -1;
+
+    memset(store, 0, sizeof(*store));
+    store->db = db;
+    store->bucket_count = SESSION_INITIAL_BUCKETS;
+    store->buckets = calloc(store->bucket_count, sizeof(SessionEntry*));
+    if (!store->buckets) return -1;
+
+    pthread_mutex_init(&store->mutex, NULL);
+    pthread_mutex_init(&store->queue_mutex, NULL);
+    pthread_cond_init(&store->queue_cond, NULL);
+
+    // Single-threaded at this point; no lock needed
+    int loaded = db_load_active_sessions(db, load_visit, store);
+
+    if (pthread_create(&store->writer, NULL, writer_thread, store) != 0) {
+        free(store->buckets);
+        store->buckets = NULL;
+        return -1;
+    }
+
+    printf("[SESSION] Session store ready (%d sessions restored)\n", loaded > 0 ? loaded : 0);
+    return 0;
+}
+
+void session_store_shutdown(SessionStore* store) {
+    if (!store || !store->buckets) return;
+
+    pthread_mutex_lock(&store->queue_mutex);
+    store->stopping = 1;
+    pthread_cond_signal(&store->queue_cond);
+    pthread_mutex_unlock(&store->queue_mutex);
+    pthread_join(store->writer, NULL);
+
+    for (int i = 0; i < store->bucket_count; i++) {
+        SessionEntry* e = store->buckets[i];
+        while (e) {
+            SessionEntry* next = e->next;
+            free(e);
+            e = next;
+        }
+    }
+    free(store->buckets);
+    store->buckets = NULL;
+    store->count = 0;
+
+    pthread_mutex_destroy(&store->mutex);
+    pthread_mutex_destroy(&store->queue_mutex);
+    pthread_cond_destroy(&store->queue_cond);
+}
+
+int session_store_create(SessionStore* store, int user_id, char* session_id) {
+    if (!store || !session_id) return -1;
+
+    session_generate_id(session_id);
+
+    pthread_mutex_lock(&store->mutex);
+    int rc = insert_entry(store, session_id, user_id, time(NULL) + SESSION_TTL_SECONDS);
+    pthread_mutex_unlock(&store->mutex);
+
+    if (rc == 0) {
+        enqueue_write(store, SESSION_WRITE_CREATE, session_id, user_id);
+    }
+    return rc;
+}
+
+int session_store_validate(SessionStore* store, const char* session_id, int* user_id) {
+    if (!store || !session_id || strlen(session_id) != SESSION_ID_LENGTH) return -1;
+
+    pthread_mutex_lock(&store->mutex);
+    SessionEntry* e = *find_link(store, session_id);
+    int valid = e && e->expires_at > time(NULL);
+    if (valid && user_id) *user_id = e->user_id;
+    pthread_mutex_unlock(&store->mutex);
+
+    return valid ? 0 : -1;
+}
+
+void session_store_remove(SessionStore* store, const char* session_id) {
+    if (!store || !session_id || !session_id[0]) return;
+
+    pthread_mutex_lock(&store->mutex);
+    SessionEntry** link = find_link(store, session_id);
+    SessionEntry* e = *link;
+    if (e) {
+        *link = e->next;
+        free(e);
+        store->count--;
+    }
+    pthread_mutex_unlock(&store->mutex);
+
+    if (e) {
+        enqueue_write(store, SESSION_WRITE_DELETE, session_id, 0);
+    }
+}
+
+int session_store_expire(SessionStore* store, time_t now) {
+    if (!store) return 0;
+
+    // The sessions table carries its own expires_at, so expiry needs no write
+    int removed = 0;
+    pthread_mutex_lock(&store->mutex);
+    for (int i = 0; i < store->bucket_count; i++) {
+        SessionEntry** link = &store->buckets[i];
+        while (*link) {
+            if ((*link)->expires_at <= now) {
+                SessionEntry* dead = *link;
+                *link = dead->next;
+                free(dead);
+                store->count--;
+                removed++;
+            } else {
+                link = &(*link)->next;
+            }
+        }
+    }
+    pthread_mutex_unlock(&store->mutex);
+
+    return removed;
+}
+
+int session_store_count(SessionStore* store) {
+    if (!store) return 0;
+
+    pthread_mutex_lock(&store->mutex);
+    int count = store->count;
+    pthread_mutex_unlock(&store->mutex);
+    return count;
+}
@@ -0,0 +1,69 @@
+/*
+ * Session Store
+ *
+ * In-memory table of login sessions keyed by session ID:
+ * - Validation is a single hash lookup (no database round-trip)
+ * - Expired sessions are dropped by a periodic sweep from the server loop
+ * - Writes to the sessions table happen on a background thread
+ */
+
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <pthread.h>
+#include <time.h>
+#include "database.h"
+
+#define SESSION_ID_LENGTH 64
+#define SESSION_TTL_SECONDS (24 * 60 * 60)  // Matches the sessions.expires_at default
+#define SESSION_SWEEP_INTERVAL 60           // Seconds between expiry sweeps
+
+typedef struct SessionEntry SessionEntry;
+typedef struct SessionWrite SessionWrite;
+
+typedef struct {
+    pthread_mutex_t mutex;
+    SessionEntry** buckets;
+    int bucket_count;       // Power of two
+    int count;
+
+    // Asynchronous persistence queue (FIFO) and its writer thread
+    Database* db;
+    pthread_t writer;
+    pthread_mutex_t queue_mutex;
+    pthread_cond_t queue_cond;
+    SessionWrite* queue_head;
+    SessionWrite* queue_tail;
+    int queue_length;
+    int stopping;
+} SessionStore;
+
+// Initialize the store, load unexpired sessions from the database and
+// start the writer thread. Returns 0 on success, -1 on error
+int session_store_init(SessionStore* store, Database* db);
+
+// Flush pending writes, stop the writer thread and free all sessions
+void session_store_shutdown(SessionStore* store);
+
+// Fill output with SESSION_ID_LENGTH random hex chars + NUL, drawn from a
+// buffered CSPRNG (OpenSSL RAND_bytes, refilled in blocks)
+void session_generate_id(char* output);
+
+// Create a session for user_id; writes the new ID (SESSION_ID_LENGTH hex
+// chars + NUL) into session_id. Returns 0 on success
+int session_store_create(SessionStore* store, int user_id, char* session_id);
+
+// Validate a session and get its user_id
+// Returns 0 if the session exists and has not expired, -1 otherwise
+int session_store_validate(SessionStore* store, const char* session_id, int* user_id);
+
+// Invalidate a session
+void session_store_remove(SessionStore* store, const char* session_id);
+
+// Drop sessions that expired before `now`; returns how many were removed
+int session_store_expire(SessionStore* store, time_t now);
+
+// Number of live sessions
+int session_store_count(SessionStore* store);
+
+#endif // SESSION_STORE_H
@@ -0,0 +1,90 @@
+/*
+ * Storage Backends
+ *
+ * Every Database dispatches through a StorageOps table. Backends own their
+ * state (the opaque `store` pointer) and their own locking; the db_* layer
+ * in database.c validates arguments and clears outputs before dispatching.
+ *
+ * - sqlite: persistent, the default
+ * - memory: process-local tables, nothing survives a restart (tests,
+ *           benchmarks, throwaway servers)
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <sqlite3.h>
+#include "database.h"
+
+struct StorageOps {
+    const char* name;
+
+    // Returns the backend state, or NULL on error
+    void* (*open)(const char* filename);
+    void (*close)(void* store);
+
+    // Users (rows are returned as CachedUser)
+    int (*create_user)(void* store, const char* username, const char* password_hash, const char* email);
+    int (*get_user_by_name)(void* store, const char* username, CachedUser* user);
+    int (*get_user_by_id)(void* store, int user_id, CachedUser* user);
+    int (*update_user_elo)(void* store, int user_id, int new_elo);
+    int (*update_user_stats)(void* store, int user_id, int is_win);
+    int (*update_last_login)(void* store, int user_id);
+
+    // Sessions
+    int (*create_session)(void* store, int user_id, const char* session_id);
+    int (*validate_session)(void* store, const char* session_id, int* user_id);
+    int (*delete_session)(void* store, const char* session_id);
+    int (*delete_user_sessions)(void* store, int user_id);
+    int (*load_active_sessions)(void* store,
+                                void (*visit)(void* ctx, const char* session_id, int user_id, time_t expires_at),
+                                void* ctx);
+
+    // Online players
+    int (*set_player_online)(void* store, int user_id, const char* status);
+    int (*set_player_offline)(void* store, int user_id);
+    int (*update_heartbeat)(void* store, int user_id);
+    int (*get_online_count)(void* store);
+    int (*get_online_players)(void* store, OnlinePlayerInfo** players, int* count);
+    int (*get_searching_players)(void* store, OnlinePlayerInfo** players, int* count);
+    int (*set_player_game)(void* store, int user_id, int game_id);
+
+    // Matches (history limit is already clamped)
+    int (*create_match)(void* store, int player1_id, int player2_id, int p1_elo, int p2_elo);
+    int (*update_match_result)(void* store, int match_id, int winner_id, int winner_elo_after, int loser_elo_after);
+    int (*commit_match_result)(void* store, int match_id, int winner_id, int loser_id, MatchCommit* out);
+    int (*abandon_matches)(void* store, const int* keep_ids, int keep_count);
+    int (*log_move)(void* store, int match_id, int player_id, int move_num, const char* move_type, const char* move_data);
+    int (*get_user_match_history)(void* store, int user_id, int before_match_id, int limit,
+                                  MatchHistoryEntry** history, int* count);
+    int (*save_match_logs)(void* store, const MatchLogBlob* logs, int count);
+    int (*load_match_log)(void* store, int match_id, uint8_t** data, size_t* length);
+    int (*get_match_log_ids)(void* store, int** match_ids, int* count);
+
+    // Hibernated games
+    int (*save_hibernated_game)(void* store, int match_id, const uint8_t* data, size_t length);
+    int (*load_hibernated_game)(void* store, int match_id, uint8_t** data, size_t* length);
+    int (*delete_hibernated_game)(void* store, int match_id);
+    int (*load_hibernated_games)(void* store,
+                                 void (*visit)(void* ctx, int match_id, const uint8_t* data, size_t length),
+                                 void* ctx);
+
+    // Challenges
+    int (*create_challenge)(void* store, int challenger_id, int challenged_id);
+    int (*respond_challenge)(void* store, int challenge_id, const char* status);
+    int (*get_challenge)(void* store, int challenge_id, int* challenger_id, int* challenged_id, char* status);
+    int (*get_pending_challenges)(void* store, int user_id, int** challenge_ids, int* count);
+    int (*expire_old_challenges)(void* store, int timeout_seconds);
+
+    // Optional (NULL if the backend has no user cache)
+    int (*get_cache_stats)(void* store, UserCacheStats* stats);
+};
+
+extern const StorageOps sqlite_storage_ops;
+extern const StorageOps memory_storage_ops;
+
+// Raw connection of a SQLite-backed Database (benchmarks that bulk-load
+// fixtures), or NULL for any other backend
+sqlite3* storage_sqlite_handle(Database* db);
+
+#endif // STORAGE_H
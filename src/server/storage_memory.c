@@ -0,0 +1,1224 @@
+/*
+ * In-Memory Storage Backend
+ *
+ * Same tables as the SQLite schema, kept in process memory behind one
+ * mutex. Row IDs are dense (id = index + 1), text keys (username, email,
+ * session_id) go through open-addressing indexes, and each user keeps
+ * their completed matches in completion order so history pages are a
+ * binary search plus a backwards walk. Nothing is persisted.
+ */
+
+#include "storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#define MEMORY_SESSION_TTL (24 * 60 * 60)  // Same as the SQLite '+24 hours'
+#define KEY_INDEX_INITIAL 64
+
+typedef struct {
+    CachedUser row;
+    char email[100];            // Empty if none
+    time_t last_login;
+
+    // online_players row
+    int online;
+    int online_slot;            // Position in MemoryStore.online_ids
+    char status[20];
+    int current_game_id;
+    time_t last_heartbeat;
+
+    // Completed match_ids, oldest first
+    int* history;
+    int history_count;
+    int history_capacity;
+} MemUser;
+
+typedef struct {
+    char session_id[65];
+    int user_id;
+    time_t expires_at;
+    int is_active;
+} MemSession;
+
+typedef struct {
+    int player1_id;
+    int player2_id;
+    int winner_id;
+    int p1_elo_before, p2_elo_before;
+    int p1_elo_after, p2_elo_after;
+    time_t start_time;
+    time_t end_time;
+    int completed;
+    int abandoned;              // Ongoing when the server restarted, never resumed
+    long long completion_seq;   // History order (end_time, then commit order)
+} MemMatch;
+
+typedef struct {
+    int match_id;
+    int player_id;
+    int move_number;
+    char* move_type;
+    char* move_data;
+    time_t timestamp;
+} MemMove;
+
+typedef struct {
+    uint8_t* data;              // NULL if the match has no stored log
+    size_t length;
+    int event_count;
+} MemMatchLog;
+
+typedef struct {
+    int match_id;
+    uint8_t* data;
+    size_t length;
+} MemHibernatedGame;
+
+typedef struct {
+    int challenger_id;
+    int challenged_id;
+    char status[20];
+    time_t created_at;
+    time_t responded_at;
+} MemChallenge;
+
+// Open-addressing index from a text column to a 1-based row number
+typedef struct {
+    int* slots;                 // 0 = empty
+    int capacity;               // Power of two
+    int count;
+    size_t stride;              // Row size of the indexed table
+    size_t key_offset;          // Offset of the key column in a row
+} KeyIndex;
+
+typedef struct {
+    pthread_mutex_t mutex;
+
+    MemUser* users;
+    int user_count, user_capacity;
+    KeyIndex by_username;
+    KeyIndex by_email;
+
+    int* online_ids;
+    int online_count;
+
+    MemSession* sessions;
+    int session_count, session_capacity;
+    KeyIndex by_session_id;
+
+    MemMatch* matches;
+    int match_count, match_capacity;
+    long long completions;
+
+    MemMove* moves;
+    int move_count, move_capacity;
+
+    MemMatchLog* match_logs;    // Indexed by match_id
+    int match_log_capacity;
+
+    MemHibernatedGame* hibernated;
+    int hibernated_count, hibernated_capacity;
+
+    MemChallenge* challenges;
+    int challenge_count, challenge_capacity;
+    int pending_floor;          // No pending challenge below this index
+} MemoryStore;
+
+// Grow a table so that one more row fits
+static int reserve_row(void** rows, int* capacity, int count, size_t row_size) {
+    if (count < *capacity) return 0;
+
+    int new_capacity = *capacity ? *capacity * 2 : 64;
+    void* grown = realloc(*rows, (size_t)new_capacity * row_size);
+    if (!grown) return -1;
+
+    *rows = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+#define RESERVE(rows, capacity, count) \
+    reserve_row((void**)&(rows), &(capacity), (count), sizeof(*(rows)))
+
+// ============ Key Index ============
+
+static uint32_t hash_key(const char* key) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static const char* key_at(const KeyIndex* idx, const void* rows, int row) {
+    return (const char*)rows + (size_t)(row - 1) * idx->stride + idx->key_offset;
+}
+
+static int key_index_init(KeyIndex* idx, size_t stride, size_t key_offset) {
+    idx->slots = calloc(KEY_INDEX_INITIAL, sizeof(int));
+    idx->capacity = KEY_INDEX_INITIAL;
+    idx->count = 0;
+    idx->stride = stride;
+    idx->key_offset = key_offset;
+    return idx->slots ? 0 : -1;
+}
+
+// Returns the row holding `key`, or 0
+static int key_index_find(const KeyIndex* idx, const void* rows, const char* key) {
+    uint32_t mask = idx->capacity - 1;
+    for (uint32_t i = hash_key(key) & mask; idx->slots[i]; i = (i + 1) & mask) {
+        if (strcmp(key_at(idx, rows, idx->slots[i]), key) == 0) return idx->slots[i];
+    }
+    return 0;
+}
+
+static void key_index_place(int* slots, int capacity, const char* key, int row) {
+    uint32_t mask = capacity - 1;
+    uint32_t i = hash_key(key) & mask;
+    while (slots[i]) i = (i + 1) & mask;
+    slots[i] = row;
+}
+
+// Make room for one more key (load kept at or below 1/2)
+static int key_index_reserve(KeyIndex* idx, const void* rows) {
+    if ((idx->count + 1) * 2 <= idx->capacity) return 0;
+
+    int new_capacity = idx->capacity * 2;
+    int* new_slots = calloc(new_capacity, sizeof(int));
+    if (!new_slots) return -1;
+
+    for (int i = 0; i < idx->capacity; i++) {
+        if (idx->slots[i]) {
+            key_index_place(new_slots, new_capacity, key_at(idx, rows, idx->slots[i]), idx->slots[i]);
+        }
+    }
+    free(idx->slots);
+    idx->slots = new_slots;
+    idx->capacity = new_capacity;
+    return 0;
+}
+
+// Index a row whose key is not present yet (after key_index_reserve)
+static void key_index_add(KeyIndex* idx, const void* rows, int row) {
+    key_index_place(idx->slots, idx->capacity, key_at(idx, rows, row), row);
+    idx->count++;
+}
+
+// ============ Helpers (store mutex held) ============
+
+static MemUser* find_user(MemoryStore* m, int user_id) {
+    if (user_id < 1 || user_id > m->user_count) return NULL;
+    return &m->users[user_id - 1];
+}
+
+static MemMatch* find_match(MemoryStore* m, int match_id) {
+    if (match_id < 1 || match_id > m->match_count) return NULL;
+    return &m->matches[match_id - 1];
+}
+
+static int append_history(MemUser* user, int match_id) {
+    if (RESERVE(user->history, user->history_capacity, user->history_count) != 0) return -1;
+    user->history[user->history_count++] = match_id;
+    return 0;
+}
+
+// Close a match row and index it into both players' histories
+static int complete_match(MemoryStore* m, int match_id, int winner_id, int p1_elo_after, int p2_elo_after) {
+    MemMatch* match = find_match(m, match_id);
+    if (!match) return -1;
+
+    MemUser* p1 = find_user(m, match->player1_id);
+    MemUser* p2 = find_user(m, match->player2_id);
+
+    // Reserve both history slots first so a failure leaves the row untouched
+    if (!match->completed) {
+        if ((p1 && RESERVE(p1->history, p1->history_capacity, p1->history_count) != 0) ||
+            (p2 && RESERVE(p2->history, p2->history_capacity, p2->history_count) != 0)) {
+            return -1;
+        }
+    }
+
+    match->winner_id = winner_id;
+    match->p1_elo_after = p1_elo_after;
+    match->p2_elo_after = p2_elo_after;
+    match->end_time = time(NULL);
+
+    if (!match->completed) {
+        match->completed = 1;
+        match->completion_seq = ++m->completions;
+        if (p1) append_history(p1, match_id);
+        if (p2) append_history(p2, match_id);
+    }
+    return 0;
+}
+
+static void set_online(MemoryStore* m, MemUser* user, int user_id, const char* status) {
+    if (!user->online) {
+        user->online = 1;
+        user->online_slot = m->online_count;
+        m->online_ids[m->online_count++] = user_id;
+    }
+    strncpy(user->status, status, sizeof(user->status) - 1);
+    user->status[sizeof(user->status) - 1] = '\0';
+    user->current_game_id = 0;
+    user->last_heartbeat = time(NULL);
+}
+
+// ============ Lifecycle ============
+
+static void memory_close(void* store);
+
+static void* memory_open(const char* filename) {
+    (void)filename;
+
+    MemoryStore* m = calloc(1, sizeof(MemoryStore));
+    if (!m) return NULL;
+
+    pthread_mutex_init(&m->mutex, NULL);
+
+    if (key_index_init(&m->by_username, sizeof(MemUser), offsetof(MemUser, row.username)) != 0 ||
+        key_index_init(&m->by_email, sizeof(MemUser), offsetof(MemUser, email)) != 0 ||
+        key_index_init(&m->by_session_id, sizeof(MemSession), offsetof(MemSession, session_id)) != 0) {
+        memory_close(m);
+        return NULL;
+    }
+
+    printf("Database initialized successfully: in-memory (nothing is persisted)\n");
+    return m;
+}
+
+static void memory_close(void* store) {
+    MemoryStore* m = store;
+
+    for (int i = 0; i < m->user_count; i++) {
+        free(m->users[i].history);
+    }
+    for (int i = 0; i < m->move_count; i++) {
+        free(m->moves[i].move_type);
+        free(m->moves[i].move_data);
+    }
+    for (int i = 0; i < m->match_log_capacity; i++) {
+        free(m->match_logs[i].data);
+    }
+    free(m->match_logs);
+    for (int i = 0; i < m->hibernated_count; i++) {
+        free(m->hibernated[i].data);
+    }
+    free(m->hibernated);
+    free(m->users);
+    free(m->online_ids);
+    free(m->sessions);
+    free(m->matches);
+    free(m->moves);
+    free(m->challenges);
+    free(m->by_username.slots);
+    free(m->by_email.slots);
+    free(m->by_session_id.slots);
+    pthread_mutex_destroy(&m->mutex);
+    free(m);
+}
+
+// ============ User Operations ============
+
+static int memory_create_user(void* store, const char* username, const char* password_hash, const char* email) {
+    MemoryStore* m = store;
+
+    if (strlen(username) >= sizeof(((CachedUser*)0)->username) ||
+        strlen(password_hash) >= sizeof(((CachedUser*)0)->password_hash) ||
+        (email && strlen(email) >= sizeof(((MemUser*)0)->email))) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&m->mutex);
+
+    // UNIQUE(username), UNIQUE(email)
+    if (key_index_find(&m->by_username, m->users, username) ||
+        (email && key_index_find(&m->by_email, m->users, email))) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    if (RESERVE(m->users, m->user_capacity, m->user_count) != 0 ||
+        key_index_reserve(&m->by_username, m->users) != 0 ||
+        (email && key_index_reserve(&m->by_email, m->users) != 0)) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    // online_ids holds at most one slot per user
+    int* online_ids = realloc(m->online_ids, sizeof(int) * m->user_capacity);
+    if (!online_ids) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+    m->online_ids = online_ids;
+
+    int user_id = m->user_count + 1;
+    MemUser* user = &m->users[user_id - 1];
+    memset(user, 0, sizeof(*user));
+    user->row.user_id = user_id;
+    strcpy(user->row.username, username);
+    strcpy(user->row.password_hash, password_hash);
+    user->row.elo_rating = ELO_DEFAULT_RATING;
+    if (email) strcpy(user->email, email);
+
+    key_index_add(&m->by_username, m->users, user_id);
+    if (email) key_index_add(&m->by_email, m->users, user_id);
+    m->user_count++;
+
+    pthread_mutex_unlock(&m->mutex);
+    return user_id;
+}
+
+static int memory_get_user_by_name(void* store, const char* username, CachedUser* user) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    int user_id = key_index_find(&m->by_username, m->users, username);
+    if (user_id) *user = m->users[user_id - 1].row;
+    pthread_mutex_unlock(&m->mutex);
+
+    return user_id ? 0 : -1;
+}
+
+static int memory_get_user_by_id(void* store, int user_id, CachedUser* user) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u) *user = u->row;
+    pthread_mutex_unlock(&m->mutex);
+
+    return u ? 0 : -1;
+}
+
+// Updates of a missing row succeed without effect, as an SQL UPDATE would
+
+static int memory_update_user_elo(void* store, int user_id, int new_elo) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u) u->row.elo_rating = new_elo;
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static void apply_result(CachedUser* row, int is_win) {
+    row->total_matches++;
+    if (is_win == 1) row->wins++;
+    else if (is_win == 0) row->losses++;
+}
+
+static int memory_update_user_stats(void* store, int user_id, int is_win) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u) apply_result(&u->row, is_win);
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_update_last_login(void* store, int user_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u) u->last_login = time(NULL);
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+// ============ Session Operations ============
+
+static int memory_create_session(void* store, int user_id, const char* session_id) {
+    MemoryStore* m = store;
+
+    if (strlen(session_id) >= sizeof(((MemSession*)0)->session_id)) return -1;
+
+    pthread_mutex_lock(&m->mutex);
+
+    if (key_index_find(&m->by_session_id, m->sessions, session_id) ||
+        RESERVE(m->sessions, m->session_capacity, m->session_count) != 0 ||
+        key_index_reserve(&m->by_session_id, m->sessions) != 0) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    MemSession* s = &m->sessions[m->session_count];
+    strcpy(s->session_id, session_id);
+    s->user_id = user_id;
+    s->expires_at = time(NULL) + MEMORY_SESSION_TTL;
+    s->is_active = 1;
+
+    key_index_add(&m->by_session_id, m->sessions, ++m->session_count);
+
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_validate_session(void* store, const char* session_id, int* user_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    int row = key_index_find(&m->by_session_id, m->sessions, session_id);
+    MemSession* s = row ? &m->sessions[row - 1] : NULL;
+    int valid = s && s->is_active && s->expires_at > time(NULL);
+    if (valid && user_id) *user_id = s->user_id;
+    pthread_mutex_unlock(&m->mutex);
+
+    return valid ? 0 : -1;
+}
+
+static int memory_delete_session(void* store, const char* session_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    int row = key_index_find(&m->by_session_id, m->sessions, session_id);
+    if (row) m->sessions[row - 1].is_active = 0;
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_delete_user_sessions(void* store, int user_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    for (int i = 0; i < m->session_count; i++) {
+        if (m->sessions[i].user_id == user_id) m->sessions[i].is_active = 0;
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_load_active_sessions(void* store,
+                                       void (*visit)(void* ctx, const char* session_id, int user_id, time_t expires_at),
+                                       void* ctx) {
+    MemoryStore* m = store;
+    time_t now = time(NULL);
+    int count = 0;
+
+    pthread_mutex_lock(&m->mutex);
+    for (int i = 0; i < m->session_count; i++) {
+        MemSession* s = &m->sessions[i];
+        if (s->is_active && s->expires_at > now) {
+            visit(ctx, s->session_id, s->user_id, s->expires_at);
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return count;
+}
+
+// ============ Online Players ============
+
+static int memory_set_player_online(void* store, int user_id, const char* status) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u) set_online(m, u, user_id, status);
+    pthread_mutex_unlock(&m->mutex);
+
+    // Online rows only exist for real users (SQLite drops the rest in its joins)
+    return u ? 0 : -1;
+}
+
+static int memory_set_player_offline(void* store, int user_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u && u->online) {
+        // Swap-remove from the online list
+        int last = m->online_ids[--m->online_count];
+        m->online_ids[u->online_slot] = last;
+        m->users[last - 1].online_slot = u->online_slot;
+        u->online = 0;
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_update_heartbeat(void* store, int user_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u && u->online) u->last_heartbeat = time(NULL);
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_get_online_count(void* store) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    int count = m->online_count;
+    pthread_mutex_unlock(&m->mutex);
+    return count;
+}
+
+static int compare_elo_desc(const void* a, const void* b) {
+    const OnlinePlayerInfo* pa = a;
+    const OnlinePlayerInfo* pb = b;
+    return (pb->elo_rating > pa->elo_rating) - (pb->elo_rating < pa->elo_rating);
+}
+
+static int compare_elo_asc(const void* a, const void* b) {
+    return compare_elo_desc(b, a);
+}
+
+// Snapshot online players (optionally only one status) ordered by rating
+static int collect_online(MemoryStore* m, const char* status, int descending,
+                          OnlinePlayerInfo** players, int* count) {
+    pthread_mutex_lock(&m->mutex);
+
+    if (m->online_count == 0) {
+        pthread_mutex_unlock(&m->mutex);
+        return 0;
+    }
+
+    OnlinePlayerInfo* out = malloc(sizeof(OnlinePlayerInfo) * m->online_count);
+    if (!out) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    int n = 0;
+    for (int i = 0; i < m->online_count; i++) {
+        MemUser* u = &m->users[m->online_ids[i] - 1];
+        if (status && strcmp(u->status, status) != 0) continue;
+
+        out[n].user_id = u->row.user_id;
+        memcpy(out[n].username, u->row.username, sizeof(out[n].username));
+        out[n].elo_rating = u->row.elo_rating;
+        memcpy(out[n].status, u->status, sizeof(out[n].status));
+        n++;
+    }
+    pthread_mutex_unlock(&m->mutex);
+
+    if (n == 0) {
+        free(out);
+        return 0;
+    }
+
+    qsort(out, n, sizeof(OnlinePlayerInfo), descending ? compare_elo_desc : compare_elo_asc);
+    *players = out;
+    *count = n;
+    return 0;
+}
+
+static int memory_get_online_players(void* store, OnlinePlayerInfo** players, int* count) {
+    return collect_online(store, NULL, 1, players, count);
+}
+
+static int memory_get_searching_players(void* store, OnlinePlayerInfo** players, int* count) {
+    return collect_online(store, "searching", 0, players, count);
+}
+
+static int memory_set_player_game(void* store, int user_id, int game_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    MemUser* u = find_user(m, user_id);
+    if (u && u->online) {
+        u->current_game_id = game_id;
+        strcpy(u->status, "in_game");
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+// ============ Match Operations ============
+
+static int memory_create_match(void* store, int player1_id, int player2_id, int p1_elo, int p2_elo) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+
+    if (RESERVE(m->matches, m->match_capacity, m->match_count) != 0) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    MemMatch* match = &m->matches[m->match_count];
+    memset(match, 0, sizeof(*match));
+    match->player1_id = player1_id;
+    match->player2_id = player2_id;
+    match->p1_elo_before = p1_elo;
+    match->p2_elo_before = p2_elo;
+    match->start_time = time(NULL);
+
+    int match_id = ++m->match_count;
+    pthread_mutex_unlock(&m->mutex);
+    return match_id;
+}
+
+static int memory_update_match_result(void* store, int match_id, int winner_id, int winner_elo_after, int loser_elo_after) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+
+    MemMatch* match = find_match(m, match_id);
+    if (!match) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    // Player2 won - swap the ELO values (a draw keeps player1 first)
+    int p2_won = (winner_id != 0 && winner_id != match->player1_id);
+    int rc = complete_match(m, match_id, winner_id,
+                            p2_won ? loser_elo_after : winner_elo_after,
+                            p2_won ? winner_elo_after : loser_elo_after);
+
+    pthread_mutex_unlock(&m->mutex);
+    return rc;
+}
+
+static int memory_commit_match_result(void* store, int match_id, int winner_id, int loser_id, MatchCommit* out) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+
+    // Everything is validated before the first write, so a failure leaves
+    // no partial result behind (the SQLite backend's ROLLBACK)
+    // Already recorded (or unknown): a second commit would rate it twice
+    MemMatch* match = find_match(m, match_id);
+    if (!match || match->completed || match->abandoned) goto fail;
+
+    out->player1_id = match->player1_id;
+    out->player2_id = match->player2_id;
+
+    int is_draw = (winner_id == 0);
+    if (is_draw) {
+        winner_id = out->player1_id;
+        loser_id = out->player2_id;
+    } else if (!((winner_id == out->player1_id && loser_id == out->player2_id) ||
+                 (winner_id == out->player2_id && loser_id == out->player1_id))) {
+        goto fail;
+    }
+
+    MemUser* winner = find_user(m, winner_id);
+    MemUser* loser = find_user(m, loser_id);
+    if (!winner || !loser) goto fail;
+
+    strcpy(out->winner_name, winner->row.username);
+    strcpy(out->loser_name, loser->row.username);
+
+    int winner_elo = winner->row.elo_rating;
+    int loser_elo = loser->row.elo_rating;
+    if (is_draw) {
+        out->draw_change = elo_calculate_draw(winner_elo, loser_elo);
+        out->elo.winner_old_elo = winner_elo;
+        out->elo.winner_new_elo = winner_elo + out->draw_change;
+        out->elo.winner_change = out->draw_change;
+        out->elo.loser_old_elo = loser_elo;
+        out->elo.loser_new_elo = loser_elo - out->draw_change;
+        out->elo.loser_change = -out->draw_change;
+    } else {
+        elo_calculate_match(winner_elo, loser_elo, winner->row.total_matches, loser->row.total_matches, &out->elo);
+    }
+
+    // Map winner/loser ratings back onto the match's player1/player2 columns
+    int p1_elo_after = (winner_id == out->player1_id) ? out->elo.winner_new_elo : out->elo.loser_new_elo;
+    int p2_elo_after = (winner_id == out->player1_id) ? out->elo.loser_new_elo : out->elo.winner_new_elo;
+
+    if (complete_match(m, match_id, is_draw ? 0 : winner_id, p1_elo_after, p2_elo_after) != 0) goto fail;
+
+    winner->row.elo_rating = out->elo.winner_new_elo;
+    apply_result(&winner->row, is_draw ? -1 : 1);
+    loser->row.elo_rating = out->elo.loser_new_elo;
+    apply_result(&loser->row, is_draw ? -1 : 0);
+
+    // Only touches rows of players who are still online
+    MemUser* players[2] = { winner, loser };
+    for (int i = 0; i < 2; i++) {
+        if (players[i]->online) {
+            strcpy(players[i]->status, "idle");
+            players[i]->current_game_id = 0;
+            players[i]->last_heartbeat = time(NULL);
+        }
+    }
+
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+
+fail:
+    fprintf(stderr, "[DB] Match %d result commit failed\n", match_id);
+    pthread_mutex_unlock(&m->mutex);
+    return -1;
+}
+
+static int compare_ids(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int memory_abandon_matches(void* store, const int* keep_ids, int keep_count) {
+    MemoryStore* m = store;
+    int count = 0;
+
+    pthread_mutex_lock(&m->mutex);
+    for (int match_id = 1; match_id <= m->match_count; match_id++) {
+        MemMatch* match = find_match(m, match_id);
+        if (match->completed || match->abandoned) continue;
+        if (keep_count > 0 && bsearch(&match_id, keep_ids, keep_count, sizeof(int), compare_ids)) continue;
+        match->abandoned = 1;
+        match->end_time = time(NULL);
+        count++;
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return count;
+}
+
+static int memory_log_move(void* store, int match_id, int player_id, int move_num, const char* move_type, const char* move_data) {
+    MemoryStore* m = store;
+
+    char* type_copy = move_type ? strdup(move_type) : NULL;
+    char* data_copy = move_data ? strdup(move_data) : NULL;
+    if ((move_type && !type_copy) || (move_data && !data_copy)) {
+        free(type_copy);
+        free(data_copy);
+        return -1;
+    }
+
+    pthread_mutex_lock(&m->mutex);
+
+    if (RESERVE(m->moves, m->move_capacity, m->move_count) != 0) {
+        pthread_mutex_unlock(&m->mutex);
+        free(type_copy);
+        free(data_copy);
+        return -1;
+    }
+
+    MemMove* move = &m->moves[m->move_count++];
+    move->match_id = match_id;
+    move->player_id = player_id;
+    move->move_number = move_num;
+    move->move_type = type_copy;
+    move->move_data = data_copy;
+    move->timestamp = time(NULL);
+
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_get_user_match_history(void* store, int user_id, int before_match_id, int limit,
+                                         MatchHistoryEntry** history, int* count) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+
+    MemUser* user = find_user(m, user_id);
+
+    // Resolve the cursor to its place in the completion order. The first
+    // page starts past the newest entry.
+    int end = user ? user->history_count : 0;
+
+    if (before_match_id > 0) {
+        MemMatch* cursor = find_match(m, before_match_id);
+        if (!cursor || !cursor->completed) {
+            pthread_mutex_unlock(&m->mutex);
+            return -1;  // Unknown cursor
+        }
+
+        // First history entry at or after the cursor
+        int lo = 0, hi = end;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (m->matches[user->history[mid] - 1].completion_seq < cursor->completion_seq) lo = mid + 1;
+            else hi = mid;
+        }
+        end = lo;
+    }
+
+    if (end == 0) {
+        pthread_mutex_unlock(&m->mutex);
+        return 0;
+    }
+
+    int n = end < limit ? end : limit;
+    *history = malloc(sizeof(MatchHistoryEntry) * n);
+    if (!*history) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int match_id = user->history[end - 1 - i];
+        MemMatch* match = &m->matches[match_id - 1];
+        int is_p1 = (match->player1_id == user_id);
+
+        MatchHistoryEntry* entry = &(*history)[i];
+        memset(entry, 0, sizeof(*entry));
+        entry->match_id = match_id;
+        entry->opponent_id = is_p1 ? match->player2_id : match->player1_id;
+
+        MemUser* opponent = find_user(m, entry->opponent_id);
+        snprintf(entry->opponent_name, sizeof(entry->opponent_name), "%s", opponent ? opponent->row.username : "Unknown");
+
+        entry->is_win = (match->winner_id == user_id) ? 1 : (match->winner_id == 0 ? -1 : 0);
+        entry->elo_change = is_p1 ? match->p1_elo_after - match->p1_elo_before
+                                  : match->p2_elo_after - match->p2_elo_before;
+
+        struct tm tm_utc;
+        gmtime_r(&match->start_time, &tm_utc);
+        strftime(entry->timestamp, sizeof(entry->timestamp), "%Y-%m-%d %H:%M:%S", &tm_utc);
+    }
+
+    pthread_mutex_unlock(&m->mutex);
+
+    *count = n;
+    return 0;
+}
+
+static int memory_save_match_logs(void* store, const MatchLogBlob* logs, int count) {
+    MemoryStore* m = store;
+
+    // Copy outside the lock; the batch is applied all-or-nothing
+    uint8_t** copies = calloc(count, sizeof(uint8_t*));
+    if (!copies) return -1;
+
+    int max_id = 0;
+    for (int i = 0; i < count; i++) {
+        if (logs[i].match_id < 0) goto fail;
+        copies[i] = malloc(logs[i].length ? logs[i].length : 1);
+        if (!copies[i]) goto fail;
+        memcpy(copies[i], logs[i].data, logs[i].length);
+        if (logs[i].match_id > max_id) max_id = logs[i].match_id;
+    }
+
+    pthread_mutex_lock(&m->mutex);
+
+    if (max_id >= m->match_log_capacity) {
+        int new_capacity = m->match_log_capacity ? m->match_log_capacity : 64;
+        while (new_capacity <= max_id) new_capacity *= 2;
+
+        MemMatchLog* grown = realloc(m->match_logs, sizeof(MemMatchLog) * new_capacity);
+        if (!grown) {
+            pthread_mutex_unlock(&m->mutex);
+            goto fail;
+        }
+        memset(grown + m->match_log_capacity, 0, sizeof(MemMatchLog) * (new_capacity - m->match_log_capacity));
+        m->match_logs = grown;
+        m->match_log_capacity = new_capacity;
+    }
+
+    for (int i = 0; i < count; i++) {
+        MemMatchLog* slot = &m->match_logs[logs[i].match_id];
+        free(slot->data);
+        slot->data = copies[i];
+        slot->length = logs[i].length;
+        slot->event_count = logs[i].event_count;
+    }
+
+    pthread_mutex_unlock(&m->mutex);
+    free(copies);
+    return 0;
+
+fail:
+    for (int i = 0; i < count; i++) free(copies[i]);
+    free(copies);
+    return -1;
+}
+
+static int memory_load_match_log(void* store, int match_id, uint8_t** data, size_t* length) {
+    MemoryStore* m = store;
+    int rc = -1;
+
+    pthread_mutex_lock(&m->mutex);
+    if (match_id >= 0 && match_id < m->match_log_capacity && m->match_logs[match_id].data) {
+        MemMatchLog* slot = &m->match_logs[match_id];
+        *data = malloc(slot->length ? slot->length : 1);
+        if (*data) {
+            memcpy(*data, slot->data, slot->length);
+            *length = slot->length;
+            rc = 0;
+        }
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return rc;
+}
+
+static int memory_get_match_log_ids(void* store, int** match_ids, int* count) {
+    MemoryStore* m = store;
+    int rc = 0;
+
+    pthread_mutex_lock(&m->mutex);
+    int total = 0;
+    for (int i = 0; i < m->match_log_capacity; i++) {
+        if (m->match_logs[i].data) total++;
+    }
+    if (total > 0) {
+        *match_ids = malloc(sizeof(int) * total);
+        if (*match_ids) {
+            for (int i = 0; i < m->match_log_capacity; i++) {
+                if (m->match_logs[i].data) (*match_ids)[(*count)++] = i;
+            }
+        } else {
+            rc = -1;
+        }
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return rc;
+}
+
+// ============ Hibernated Games ============
+
+// Index of a hibernated game, or -1 (hibernated games are few)
+static int find_hibernated(MemoryStore* m, int match_id) {
+    for (int i = 0; i < m->hibernated_count; i++) {
+        if (m->hibernated[i].match_id == match_id) return i;
+    }
+    return -1;
+}
+
+static int memory_save_hibernated_game(void* store, int match_id, const uint8_t* data, size_t length) {
+    MemoryStore* m = store;
+
+    uint8_t* copy = malloc(length);
+    if (!copy) return -1;
+    memcpy(copy, data, length);
+
+    pthread_mutex_lock(&m->mutex);
+
+    int index = find_hibernated(m, match_id);
+    if (index < 0) {
+        if (RESERVE(m->hibernated, m->hibernated_capacity, m->hibernated_count) != 0) {
+            pthread_mutex_unlock(&m->mutex);
+            free(copy);
+            return -1;
+        }
+        index = m->hibernated_count++;
+        m->hibernated[index].match_id = match_id;
+        m->hibernated[index].data = NULL;
+    }
+    free(m->hibernated[index].data);
+    m->hibernated[index].data = copy;
+    m->hibernated[index].length = length;
+
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_load_hibernated_game(void* store, int match_id, uint8_t** data, size_t* length) {
+    MemoryStore* m = store;
+    int rc = -1;
+
+    pthread_mutex_lock(&m->mutex);
+    int index = find_hibernated(m, match_id);
+    if (index >= 0) {
+        MemHibernatedGame* game = &m->hibernated[index];
+        *data = malloc(game->length);
+        if (*data) {
+            memcpy(*data, game->data, game->length);
+            *length = game->length;
+            rc = 0;
+        }
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return rc;
+}
+
+static int memory_delete_hibernated_game(void* store, int match_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    int index = find_hibernated(m, match_id);
+    if (index >= 0) {
+        free(m->hibernated[index].data);
+        m->hibernated[index] = m->hibernated[--m->hibernated_count];
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_load_hibernated_games(void* store,
+                                        void (*visit)(void* ctx, int match_id, const uint8_t* data, size_t length),
+                                        void* ctx) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    int count = m->hibernated_count;
+    for (int i = 0; i < count; i++) {
+        visit(ctx, m->hibernated[i].match_id, m->hibernated[i].data, m->hibernated[i].length);
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return count;
+}
+
+// ============ Challenge Operations ============
+
+static int memory_create_challenge(void* store, int challenger_id, int challenged_id) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+
+    if (RESERVE(m->challenges, m->challenge_capacity, m->challenge_count) != 0) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    MemChallenge* c = &m->challenges[m->challenge_count];
+    memset(c, 0, sizeof(*c));
+    c->challenger_id = challenger_id;
+    c->challenged_id = challenged_id;
+    strcpy(c->status, "pending");
+    c->created_at = time(NULL);
+
+    int challenge_id = ++m->challenge_count;
+    pthread_mutex_unlock(&m->mutex);
+    return challenge_id;
+}
+
+// Skip the resolved prefix so pending scans start at the oldest live row
+static void advance_pending_floor(MemoryStore* m) {
+    while (m->pending_floor < m->challenge_count &&
+           strcmp(m->challenges[m->pending_floor].status, "pending") != 0) {
+        m->pending_floor++;
+    }
+}
+
+static int memory_respond_challenge(void* store, int challenge_id, const char* status) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    if (challenge_id >= 1 && challenge_id <= m->challenge_count) {
+        MemChallenge* c = &m->challenges[challenge_id - 1];
+        strncpy(c->status, status, sizeof(c->status) - 1);
+        c->responded_at = time(NULL);
+        advance_pending_floor(m);
+    }
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_get_challenge(void* store, int challenge_id, int* challenger_id, int* challenged_id, char* status) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+    if (challenge_id < 1 || challenge_id > m->challenge_count) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    MemChallenge* c = &m->challenges[challenge_id - 1];
+    if (challenger_id) *challenger_id = c->challenger_id;
+    if (challenged_id) *challenged_id = c->challenged_id;
+    if (status) strcpy(status, c->status);
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_get_pending_challenges(void* store, int user_id, int** challenge_ids, int* count) {
+    MemoryStore* m = store;
+
+    pthread_mutex_lock(&m->mutex);
+
+    int n = 0;
+    for (int i = m->pending_floor; i < m->challenge_count; i++) {
+        MemChallenge* c = &m->challenges[i];
+        if (c->challenged_id == user_id && strcmp(c->status, "pending") == 0) n++;
+    }
+
+    if (n == 0) {
+        pthread_mutex_unlock(&m->mutex);
+        return 0;
+    }
+
+    *challenge_ids = malloc(sizeof(int) * n);
+    if (!*challenge_ids) {
+        pthread_mutex_unlock(&m->mutex);
+        return -1;
+    }
+
+    // Newest first
+    int k = 0;
+    for (int i = m->challenge_count - 1; i >= m->pending_floor && k < n; i--) {
+        MemChallenge* c = &m->challenges[i];
+        if (c->challenged_id == user_id && strcmp(c->status, "pending") == 0) {
+            (*challenge_ids)[k++] = i + 1;
+        }
+    }
+    *count = k;
+
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+static int memory_expire_old_challenges(void* store, int timeout_seconds) {
+    MemoryStore* m = store;
+    time_t cutoff = time(NULL) - timeout_seconds;
+
+    pthread_mutex_lock(&m->mutex);
+
+    // Rows are in creation order: stop at the first one still in time
+    for (int i = m->pending_floor; i < m->challenge_count; i++) {
+        MemChallenge* c = &m->challenges[i];
+        if (c->created_at >= cutoff) break;
+        if (strcmp(c->status, "pending") == 0) strcpy(c->status, "expired");
+    }
+    advance_pending_floor(m);
+
+    pthread_mutex_unlock(&m->mutex);
+    return 0;
+}
+
+// ============ Backend Table ============
+
+const StorageOps memory_storage_ops = {
+    .name = "memory",
+    .open = memory_open,
+    .close = memory_close,
+
+    .create_user = memory_create_user,
+    .get_user_by_name = memory_get_user_by_name,
+    .get_user_by_id = memory_get_user_by_id,
+    .update_user_elo = memory_update_user_elo,
+    .update_user_stats = memory_update_user_stats,
+    .update_last_login = memory_update_last_login,
+
+    .create_session = memory_create_session,
+    .validate_session = memory_validate_session,
+    .delete_session = memory_delete_session,
+    .delete_user_sessions = memory_delete_user_sessions,
+    .load_active_sessions = memory_load_active_sessions,
+
+    .set_player_online = memory_set_player_online,
+    .set_player_offline = memory_set_player_offline,
+    .update_heartbeat = memory_update_heartbeat,
+    .get_online_count = memory_get_online_count,
+    .get_online_players = memory_get_online_players,
+    .get_searching_players = memory_get_searching_players,
+    .set_player_game = memory_set_player_game,
+
+    .create_match = memory_create_match,
+    .update_match_result = memory_update_match_result,
+    .commit_match_result = memory_commit_match_result,
+    .abandon_matches = memory_abandon_matches,
+    .log_move = memory_log_move,
+    .get_user_match_history = memory_get_user_match_history,
+    .save_match_logs = memory_save_match_logs,
+    .load_match_log = memory_load_match_log,
+    .get_match_log_ids = memory_get_match_log_ids,
+
+    .save_hibernated_game = memory_save_hibernated_game,
+    .load_hibernated_game = memory_load_hibernated_game,
+    .delete_hibernated_game = memory_delete_hibernated_game,
+    .load_hibernated_games = memory_load_hibernated_games,
+
+    .create_challenge = memory_create_challenge,
+    .respond_challenge = memory_respond_challenge,
+    .get_challenge = memory_get_challenge,
+    .get_pending_challenges = memory_get_pending_challenges,
+    .expire_old_challenges = memory_expire_old_challenges,
+
+    .get_cache_stats = NULL     // Rows are already in memory
+};
@@ -0,0 +1,1655 @@
+/*
+ * SQLite Storage Backend
+ *
+ * Persistent engine behind the Database interface. All statements run
+ * under one connection mutex; user rows are served through the sharded
+ * user cache.
+ */
+
+#include "storage.h"
+#include "move_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    sqlite3* db;
+    pthread_mutex_t mutex;
+    UserCache* user_cache;  // Read-through cache of users rows
+} SqliteStore;
+
+// SQL for creating tables (embedded from schema)
+static const char* CREATE_TABLES_SQL = 
+    "CREATE TABLE IF NOT EXISTS users ("
+    "    user_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "    username VARCHAR(50) UNIQUE NOT NULL,"
+    "    password_hash VARCHAR(64) NOT NULL,"
+    "    email VARCHAR(100) UNIQUE,"
+    "    elo_rating INTEGER DEFAULT 1200,"
+    "    total_matches INTEGER DEFAULT 0,"
+    "    wins INTEGER DEFAULT 0,"
+    "    losses INTEGER DEFAULT 0,"
+    "    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    "    last_login TIMESTAMP"
+    ");"
+    "CREATE TABLE IF NOT EXISTS sessions ("
+    "    session_id VARCHAR(64) PRIMARY KEY,"
+    "    user_id INTEGER NOT NULL,"
+    "    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    "    expires_at TIMESTAMP,"
+    "    is_active BOOLEAN DEFAULT 1,"
+    "    FOREIGN KEY (user_id) REFERENCES users(user_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS online_players ("
+    "    user_id INTEGER PRIMARY KEY,"
+    "    status VARCHAR(20),"
+    "    current_game_id INTEGER,"
+    "    last_heartbeat TIMESTAMP,"
+    "    FOREIGN KEY (user_id) REFERENCES users(user_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS matches ("
+    "    match_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "    player1_id INTEGER NOT NULL,"
+    "    player2_id INTEGER NOT NULL,"
+    "    winner_id INTEGER,"
+    "    player1_elo_before INTEGER,"
+    "    player2_elo_before INTEGER,"
+    "    player1_elo_after INTEGER,"
+    "    player2_elo_after INTEGER,"
+    "    start_time TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    "    end_time TIMESTAMP,"
+    "    status VARCHAR(20),"
+    "    FOREIGN KEY (player1_id) REFERENCES users(user_id),"
+    "    FOREIGN KEY (player2_id) REFERENCES users(user_id),"
+    "    FOREIGN KEY (winner_id) REFERENCES users(user_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS game_moves ("
+    "    move_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "    match_id INTEGER NOT NULL,"
+    "    player_id INTEGER NOT NULL,"
+    "    move_number INTEGER,"
+    "    move_type VARCHAR(50),"
+    "    move_data TEXT,"
+    "    timestamp TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    "    FOREIGN KEY (match_id) REFERENCES matches(match_id),"
+    "    FOREIGN KEY (player_id) REFERENCES users(user_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS match_logs ("
+    "    match_id INTEGER PRIMARY KEY,"
+    "    format_version INTEGER NOT NULL,"
+    "    event_count INTEGER NOT NULL,"
+    "    log BLOB NOT NULL,"
+    "    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    "    FOREIGN KEY (match_id) REFERENCES matches(match_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS hibernated_games ("
+    "    match_id INTEGER PRIMARY KEY,"
+    "    state BLOB NOT NULL,"
+    "    hibernated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    "    FOREIGN KEY (match_id) REFERENCES matches(match_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS challenge_requests ("
+    "    challenge_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    "    challenger_id INTEGER NOT NULL,"
+    "    challenged_id INTEGER NOT NULL,"
+    "    status VARCHAR(20) DEFAULT 'pending',"
+    "    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,"
+    "    responded_at TIMESTAMP,"
+    "    FOREIGN KEY (challenger_id) REFERENCES users(user_id),"
+    "    FOREIGN KEY (challenged_id) REFERENCES users(user_id)"
+    ");"
+    "CREATE INDEX IF NOT EXISTS idx_users_username ON users(username);"
+    "CREATE INDEX IF NOT EXISTS idx_sessions_user ON sessions(user_id);"
+    "CREATE INDEX IF NOT EXISTS idx_challenges_challenged ON challenge_requests(challenged_id);"
+    "CREATE INDEX IF NOT EXISTS idx_matches_p1_history ON matches(player1_id, end_time, match_id) "
+    "    WHERE status = 'completed';"
+    "CREATE INDEX IF NOT EXISTS idx_matches_p2_history ON matches(player2_id, end_time, match_id) "
+    "    WHERE status = 'completed';";
+
+static void sqlite_close(void* store);
+
+static void* sqlite_open(const char* filename) {
+    if (!filename) return NULL;
+    
+    SqliteStore* db = calloc(1, sizeof(SqliteStore));
+    if (!db) return NULL;
+    
+    pthread_mutex_init(&db->mutex, NULL);
+    
+    db->user_cache = user_cache_create(USER_CACHE_DEFAULT_CAPACITY);
+    if (!db->user_cache) {
+        fprintf(stderr, "Cannot allocate user cache\n");
+        sqlite_close(db);
+        return NULL;
+    }
+    
+    int rc = sqlite3_open(filename, &db->db);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db->db));
+        sqlite_close(db);
+        return NULL;
+    }
+    
+    // Create tables
+    char* err_msg = NULL;
+    rc = sqlite3_exec(db->db, CREATE_TABLES_SQL, NULL, NULL, &err_msg);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite_close(db);
+        return NULL;
+    }
+    
+    printf("Database initialized successfully: %s\n", filename);
+    return db;
+}
+
+static void sqlite_close(void* store) {
+    SqliteStore* db = store;
+    
+    // sqlite3_close also releases a handle whose open failed
+    sqlite3_close(db->db);
+    if (db->user_cache) {
+        user_cache_destroy(db->user_cache);
+    }
+    pthread_mutex_destroy(&db->mutex);
+    free(db);
+}
+
+// ============ User Operations ============ 
+
+static int sqlite_create_user(void* store, const char* username, const char* password_hash, const char* email) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT INTO users (username, password_hash, email) VALUES (?, ?, ?)";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, password_hash, -1, SQLITE_STATIC);
+    if (email) {
+        sqlite3_bind_text(stmt, 3, email, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 3);
+    }
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;  // Probably duplicate username
+    }
+    
+    int user_id = (int)sqlite3_last_insert_rowid(db->db);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return user_id;
+}
+
+// Load a full users row into the cache (caller holds the mutex)
+// Exactly one of user_id / username selects the row
+static int load_user_row(SqliteStore* db, int user_id, const char* username, CachedUser* out) {
+    sqlite3_stmt* stmt;
+    const char* sql = username
+        ? "SELECT user_id, username, password_hash, elo_rating, total_matches, wins, losses "
+          "FROM users WHERE username = ?"
+        : "SELECT user_id, username, password_hash, elo_rating, total_matches, wins, losses "
+          "FROM users WHERE user_id = ?";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return -1;
+    
+    if (username) {
+        sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_int(stmt, 1, user_id);
+    }
+    
+    int rc = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        memset(out, 0, sizeof(*out));
+        out->user_id = sqlite3_column_int(stmt, 0);
+        const char* name = (const char*)sqlite3_column_text(stmt, 1);
+        strncpy(out->username, name ? name : "", sizeof(out->username) - 1);
+        const char* hash = (const char*)sqlite3_column_text(stmt, 2);
+        strncpy(out->password_hash, hash ? hash : "", sizeof(out->password_hash) - 1);
+        out->elo_rating = sqlite3_column_int(stmt, 3);
+        out->total_matches = sqlite3_column_int(stmt, 4);
+        out->wins = sqlite3_column_int(stmt, 5);
+        out->losses = sqlite3_column_int(stmt, 6);
+        
+        // Filled under the database mutex, so a concurrent writer's
+        // invalidation cannot be overtaken by this (older) row
+        user_cache_put(db->user_cache, out);
+        rc = 0;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+static int sqlite_get_user_by_name(void* store, const char* username, CachedUser* user) {
+    SqliteStore* db = store;
+    
+    if (user_cache_get_by_name(db->user_cache, username, user) == 0) return 0;
+    
+    pthread_mutex_lock(&db->mutex);
+    int rc = load_user_row(db, 0, username, user);
+    pthread_mutex_unlock(&db->mutex);
+    return rc;
+}
+
+static int sqlite_get_user_by_id(void* store, int user_id, CachedUser* user) {
+    SqliteStore* db = store;
+    
+    if (user_cache_get_by_id(db->user_cache, user_id, user) == 0) return 0;
+    
+    pthread_mutex_lock(&db->mutex);
+    int rc = load_user_row(db, user_id, NULL, user);
+    pthread_mutex_unlock(&db->mutex);
+    return rc;
+}
+
+static int sqlite_update_user_elo(void* store, int user_id, int new_elo) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE users SET elo_rating = ? WHERE user_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, new_elo);
+    sqlite3_bind_int(stmt, 2, user_id);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    user_cache_invalidate(db->user_cache, user_id);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_update_user_stats(void* store, int user_id, int is_win) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    const char* sql;
+    if (is_win == 1) {
+        sql = "UPDATE users SET total_matches = total_matches + 1, wins = wins + 1 WHERE user_id = ?";
+    } else if (is_win == 0) {
+        sql = "UPDATE users SET total_matches = total_matches + 1, losses = losses + 1 WHERE user_id = ?";
+    } else {
+        // Draw (is_win = -1): only increment total_matches
+        sql = "UPDATE users SET total_matches = total_matches + 1 WHERE user_id = ?";
+    }
+    
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    user_cache_invalidate(db->user_cache, user_id);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_update_last_login(void* store, int user_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE users SET last_login = CURRENT_TIMESTAMP WHERE user_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+// ============ Session Operations ============ 
+
+static int sqlite_create_session(void* store, int user_id, const char* session_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT INTO sessions (session_id, user_id, expires_at) "
+                      "VALUES (?, ?, datetime('now', '+24 hours'))";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_text(stmt, 1, session_id, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, user_id);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_validate_session(void* store, const char* session_id, int* user_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT user_id FROM sessions "
+                      "WHERE session_id = ? AND is_active = 1 "
+                      "AND (expires_at IS NULL OR expires_at > datetime('now'))";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_text(stmt, 1, session_id, -1, SQLITE_STATIC);
+    
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        if (user_id) *user_id = sqlite3_column_int(stmt, 0);
+        sqlite3_finalize(stmt);
+        pthread_mutex_unlock(&db->mutex);
+        return 0;
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    return -1;
+}
+
+static int sqlite_delete_session(void* store, const char* session_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE sessions SET is_active = 0 WHERE session_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_text(stmt, 1, session_id, -1, SQLITE_STATIC);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_delete_user_sessions(void* store, int user_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE sessions SET is_active = 0 WHERE user_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_load_active_sessions(void* store,
+                                       void (*visit)(void* ctx, const char* session_id, int user_id, time_t expires_at),
+                                       void* ctx) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT session_id, user_id, CAST(strftime('%s', expires_at) AS INTEGER) "
+                      "FROM sessions WHERE is_active = 1 AND expires_at > datetime('now')";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    int count = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* session_id = (const char*)sqlite3_column_text(stmt, 0);
+        if (!session_id) continue;
+        visit(ctx, session_id, sqlite3_column_int(stmt, 1), (time_t)sqlite3_column_int64(stmt, 2));
+        count++;
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    return count;
+}
+
+// ============ Online Players ============ 
+
+static int sqlite_set_player_online(void* store, int user_id, const char* status) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT OR REPLACE INTO online_players (user_id, status, last_heartbeat) "
+                      "VALUES (?, ?, datetime('now'))";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    sqlite3_bind_text(stmt, 2, status, -1, SQLITE_STATIC);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_set_player_offline(void* store, int user_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "DELETE FROM online_players WHERE user_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_update_heartbeat(void* store, int user_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE online_players SET last_heartbeat = datetime('now') WHERE user_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_get_online_count(void* store) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT COUNT(*) FROM online_players";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return 0;
+    }
+    
+    int count = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return count;
+}
+
+// ============ Match Operations ============ 
+
+static int sqlite_create_match(void* store, int player1_id, int player2_id, int p1_elo, int p2_elo) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT INTO matches (player1_id, player2_id, player1_elo_before, player2_elo_before, status) "
+                      "VALUES (?, ?, ?, ?, 'ongoing')";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, player1_id);
+    sqlite3_bind_int(stmt, 2, player2_id);
+    sqlite3_bind_int(stmt, 3, p1_elo);
+    sqlite3_bind_int(stmt, 4, p2_elo);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    int match_id = (int)sqlite3_last_insert_rowid(db->db);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return match_id;
+}
+
+static int sqlite_update_match_result(void* store, int match_id, int winner_id, int winner_elo_after, int loser_elo_after) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    // First, get player1_id and player2_id from match to determine correct ELO assignment
+    sqlite3_stmt* stmt;
+    const char* lookup_sql = "SELECT player1_id, player2_id FROM matches WHERE match_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, lookup_sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, match_id);
+    
+    int player1_id = 0, player2_id = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        player1_id = sqlite3_column_int(stmt, 0);
+        player2_id = sqlite3_column_int(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+    
+    if (player1_id == 0 || player2_id == 0) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    // Determine which ELO goes where based on who won
+    int p1_elo_after, p2_elo_after;
+    if (winner_id == 0) {
+        // Draw case - winner_elo_after is p1's new elo, loser_elo_after is p2's new elo
+        p1_elo_after = winner_elo_after;
+        p2_elo_after = loser_elo_after;
+    } else if (winner_id == player1_id) {
+        // Player1 won
+        p1_elo_after = winner_elo_after;
+        p2_elo_after = loser_elo_after;
+    } else {
+        // Player2 won - swap the ELO values
+        p1_elo_after = loser_elo_after;
+        p2_elo_after = winner_elo_after;
+    }
+    
+    const char* sql = "UPDATE matches SET winner_id = ?, player1_elo_after = ?, player2_elo_after = ?, "
+                      "status = 'completed', end_time = datetime('now') WHERE match_id = ?";
+    
+    rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, winner_id);
+    sqlite3_bind_int(stmt, 2, p1_elo_after);
+    sqlite3_bind_int(stmt, 3, p2_elo_after);
+    sqlite3_bind_int(stmt, 4, match_id);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+// Read rating, match count and name for one user (caller holds the mutex)
+static int read_user_for_commit(SqliteStore* db, int user_id, int* elo, int* games, char* name) {
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT elo_rating, total_matches, username FROM users WHERE user_id = ?";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return -1;
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    
+    int rc = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *elo = sqlite3_column_int(stmt, 0);
+        *games = sqlite3_column_int(stmt, 1);
+        const char* username = (const char*)sqlite3_column_text(stmt, 2);
+        strncpy(name, username ? username : "", 49);
+        name[49] = '\0';
+        rc = 0;
+    }
+    sqlite3_finalize(stmt);
+    return rc;
+}
+
+// Apply a rating and one finished game to a user (caller holds the mutex)
+static int write_user_for_commit(SqliteStore* db, int user_id, int new_elo, int is_win) {
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE users SET elo_rating = ?, total_matches = total_matches + 1, "
+                      "wins = wins + ?, losses = losses + ? WHERE user_id = ?";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) return -1;
+    
+    sqlite3_bind_int(stmt, 1, new_elo);
+    sqlite3_bind_int(stmt, 2, is_win == 1);
+    sqlite3_bind_int(stmt, 3, is_win == 0);
+    sqlite3_bind_int(stmt, 4, user_id);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return (rc == SQLITE_DONE && sqlite3_changes(db->db) == 1) ? 0 : -1;
+}
+
+static int sqlite_commit_match_result(void* store, int match_id, int winner_id, int loser_id, MatchCommit* out) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    if (sqlite3_exec(db->db, "BEGIN IMMEDIATE", NULL, NULL, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_stmt* stmt;
+    const char* lookup_sql = "SELECT player1_id, player2_id FROM matches "
+                             "WHERE match_id = ? AND status = 'ongoing'";
+    
+    if (sqlite3_prepare_v2(db->db, lookup_sql, -1, &stmt, NULL) != SQLITE_OK) goto rollback;
+    
+    sqlite3_bind_int(stmt, 1, match_id);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        out->player1_id = sqlite3_column_int(stmt, 0);
+        out->player2_id = sqlite3_column_int(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+    
+    // Already recorded (or unknown): a second commit would rate it twice
+    if (out->player1_id == 0 || out->player2_id == 0) goto rollback;
+    
+    int is_draw = (winner_id == 0);
+    if (is_draw) {
+        winner_id = out->player1_id;
+        loser_id = out->player2_id;
+    } else if (!((winner_id == out->player1_id && loser_id == out->player2_id) ||
+                 (winner_id == out->player2_id && loser_id == out->player1_id))) {
+        goto rollback;
+    }
+    
+    int winner_elo, loser_elo, winner_games, loser_games;
+    if (read_user_for_commit(db, winner_id, &winner_elo, &winner_games, out->winner_name) != 0 ||
+        read_user_for_commit(db, loser_id, &loser_elo, &loser_games, out->loser_name) != 0) {
+        goto rollback;
+    }
+    
+    if (is_draw) {
+        out->draw_change = elo_calculate_draw(winner_elo, loser_elo);
+        out->elo.winner_old_elo = winner_elo;
+        out->elo.winner_new_elo = winner_elo + out->draw_change;
+        out->elo.winner_change = out->draw_change;
+        out->elo.loser_old_elo = loser_elo;
+        out->elo.loser_new_elo = loser_elo - out->draw_change;
+        out->elo.loser_change = -out->draw_change;
+    } else {
+        elo_calculate_match(winner_elo, loser_elo, winner_games, loser_games, &out->elo);
+    }
+    
+    if (write_user_for_commit(db, winner_id, out->elo.winner_new_elo, is_draw ? -1 : 1) != 0 ||
+        write_user_for_commit(db, loser_id, out->elo.loser_new_elo, is_draw ? -1 : 0) != 0) {
+        goto rollback;
+    }
+    
+    // Map winner/loser ratings back onto the match's player1/player2 columns
+    int p1_elo_after = (winner_id == out->player1_id) ? out->elo.winner_new_elo : out->elo.loser_new_elo;
+    int p2_elo_after = (winner_id == out->player1_id) ? out->elo.loser_new_elo : out->elo.winner_new_elo;
+    
+    const char* match_sql = "UPDATE matches SET winner_id = ?, player1_elo_after = ?, player2_elo_after = ?, "
+                            "status = 'completed', end_time = datetime('now') "
+                            "WHERE match_id = ? AND status = 'ongoing'";
+    
+    if (sqlite3_prepare_v2(db->db, match_sql, -1, &stmt, NULL) != SQLITE_OK) goto rollback;
+    
+    sqlite3_bind_int(stmt, 1, is_draw ? 0 : winner_id);
+    sqlite3_bind_int(stmt, 2, p1_elo_after);
+    sqlite3_bind_int(stmt, 3, p2_elo_after);
+    sqlite3_bind_int(stmt, 4, match_id);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE || sqlite3_changes(db->db) != 1) goto rollback;
+    
+    // Only touches rows of players who are still online
+    const char* online_sql = "UPDATE online_players SET status = 'idle', current_game_id = NULL, "
+                             "last_heartbeat = datetime('now') WHERE user_id IN (?, ?)";
+    
+    if (sqlite3_prepare_v2(db->db, online_sql, -1, &stmt, NULL) != SQLITE_OK) goto rollback;
+    
+    sqlite3_bind_int(stmt, 1, winner_id);
+    sqlite3_bind_int(stmt, 2, loser_id);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) goto rollback;
+    
+    if (sqlite3_exec(db->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) goto rollback;
+    
+    user_cache_invalidate(db->user_cache, winner_id);
+    user_cache_invalidate(db->user_cache, loser_id);
+    pthread_mutex_unlock(&db->mutex);
+    return 0;
+    
+rollback:
+    fprintf(stderr, "[DB] Match %d result commit failed: %s\n", match_id, sqlite3_errmsg(db->db));
+    sqlite3_exec(db->db, "ROLLBACK", NULL, NULL, NULL);
+    pthread_mutex_unlock(&db->mutex);
+    return -1;
+}
+
+static int compare_ids(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int sqlite_abandon_matches(void* store, const int* keep_ids, int keep_count) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    if (sqlite3_exec(db->db, "BEGIN IMMEDIATE", NULL, NULL, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    // Collect first: the rows being read are the ones being changed
+    int* ids = NULL;
+    int count = 0, capacity = 0;
+    sqlite3_stmt* stmt;
+    const char* select_sql = "SELECT match_id FROM matches WHERE status = 'ongoing'";
+    
+    if (sqlite3_prepare_v2(db->db, select_sql, -1, &stmt, NULL) != SQLITE_OK) goto rollback;
+    
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int match_id = sqlite3_column_int(stmt, 0);
+        if (keep_count > 0 && bsearch(&match_id, keep_ids, keep_count, sizeof(int), compare_ids)) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            int* grown = realloc(ids, sizeof(int) * capacity);
+            if (!grown) {
+                sqlite3_finalize(stmt);
+                goto rollback;
+            }
+            ids = grown;
+        }
+        ids[count++] = match_id;
+    }
+    sqlite3_finalize(stmt);
+    
+    const char* update_sql = "UPDATE matches SET status = 'abandoned', end_time = datetime('now') "
+                             "WHERE match_id = ? AND status = 'ongoing'";
+    
+    if (sqlite3_prepare_v2(db->db, update_sql, -1, &stmt, NULL) != SQLITE_OK) goto rollback;
+    
+    for (int i = 0; i < count; i++) {
+        sqlite3_bind_int(stmt, 1, ids[i]);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            sqlite3_finalize(stmt);
+            goto rollback;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    
+    if (sqlite3_exec(db->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) goto rollback;
+    
+    free(ids);
+    pthread_mutex_unlock(&db->mutex);
+    return count;
+    
+rollback:
+    fprintf(stderr, "[DB] Abandoning lost matches failed: %s\n", sqlite3_errmsg(db->db));
+    sqlite3_exec(db->db, "ROLLBACK", NULL, NULL, NULL);
+    free(ids);
+    pthread_mutex_unlock(&db->mutex);
+    return -1;
+}
+
+static int sqlite_log_move(void* store, int match_id, int player_id, int move_num, const char* move_type, const char* move_data) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT INTO game_moves (match_id, player_id, move_number, move_type, move_data) "
+                      "VALUES (?, ?, ?, ?, ?)";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, match_id);
+    sqlite3_bind_int(stmt, 2, player_id);
+    sqlite3_bind_int(stmt, 3, move_num);
+    sqlite3_bind_text(stmt, 4, move_type, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, move_data, -1, SQLITE_STATIC);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_save_match_logs(void* store, const MatchLogBlob* logs, int count) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    if (sqlite3_exec(db->db, "BEGIN IMMEDIATE", NULL, NULL, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT OR REPLACE INTO match_logs (match_id, format_version, event_count, log, updated_at) "
+                      "VALUES (?, ?, ?, ?, datetime('now'))";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) goto rollback;
+    
+    // One prepared statement for the whole batch
+    for (int i = 0; i < count; i++) {
+        sqlite3_bind_int(stmt, 1, logs[i].match_id);
+        sqlite3_bind_int(stmt, 2, MOVE_LOG_VERSION);
+        sqlite3_bind_int(stmt, 3, logs[i].event_count);
+        sqlite3_bind_blob(stmt, 4, logs[i].data, (int)logs[i].length, SQLITE_STATIC);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE) {
+            sqlite3_finalize(stmt);
+            goto rollback;
+        }
+    }
+    sqlite3_finalize(stmt);
+    
+    if (sqlite3_exec(db->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) goto rollback;
+    
+    pthread_mutex_unlock(&db->mutex);
+    return 0;
+    
+rollback:
+    fprintf(stderr, "[DB] Match log batch (%d logs) failed: %s\n", count, sqlite3_errmsg(db->db));
+    sqlite3_exec(db->db, "ROLLBACK", NULL, NULL, NULL);
+    pthread_mutex_unlock(&db->mutex);
+    return -1;
+}
+
+static int sqlite_load_match_log(void* store, int match_id, uint8_t** data, size_t* length) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT log FROM match_logs WHERE match_id = ?";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, match_id);
+    
+    int rc = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        int size = sqlite3_column_bytes(stmt, 0);
+        const void* blob = sqlite3_column_blob(stmt, 0);
+        *data = malloc(size > 0 ? size : 1);
+        if (*data) {
+            if (size > 0) memcpy(*data, blob, size);
+            *length = size;
+            rc = 0;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    return rc;
+}
+
+static int sqlite_get_match_log_ids(void* store, int** match_ids, int* count) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT match_id FROM match_logs ORDER BY match_id";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    int capacity = 0;
+    int rc = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            int* grown = realloc(*match_ids, sizeof(int) * capacity);
+            if (!grown) {
+                rc = -1;
+                break;
+            }
+            *match_ids = grown;
+        }
+        (*match_ids)[(*count)++] = sqlite3_column_int(stmt, 0);
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    if (rc != 0) {
+        free(*match_ids);
+        *match_ids = NULL;
+        *count = 0;
+    }
+    return rc;
+}
+
+// ============ Hibernated Games ============ 
+
+static int sqlite_save_hibernated_game(void* store, int match_id, const uint8_t* data, size_t length) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT OR REPLACE INTO hibernated_games (match_id, state, hibernated_at) "
+                      "VALUES (?, ?, datetime('now'))";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, match_id);
+    sqlite3_bind_blob(stmt, 2, data, (int)length, SQLITE_STATIC);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_load_hibernated_game(void* store, int match_id, uint8_t** data, size_t* length) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT state FROM hibernated_games WHERE match_id = ?";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, match_id);
+    
+    int rc = -1;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        int size = sqlite3_column_bytes(stmt, 0);
+        const void* blob = sqlite3_column_blob(stmt, 0);
+        *data = malloc(size > 0 ? size : 1);
+        if (*data) {
+            if (size > 0) memcpy(*data, blob, size);
+            *length = size;
+            rc = 0;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    return rc;
+}
+
+static int sqlite_delete_hibernated_game(void* store, int match_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "DELETE FROM hibernated_games WHERE match_id = ?";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, match_id);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_load_hibernated_games(void* store,
+                                        void (*visit)(void* ctx, int match_id, const uint8_t* data, size_t length),
+                                        void* ctx) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT match_id, state FROM hibernated_games ORDER BY match_id";
+    
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    int count = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const uint8_t* blob = sqlite3_column_blob(stmt, 1);
+        int size = sqlite3_column_bytes(stmt, 1);
+        if (!blob || size <= 0) continue;
+        visit(ctx, sqlite3_column_int(stmt, 0), blob, (size_t)size);
+        count++;
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    return count;
+}
+
+// ============ Challenge Operations ============ 
+
+static int sqlite_create_challenge(void* store, int challenger_id, int challenged_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "INSERT INTO challenge_requests (challenger_id, challenged_id, status) "
+                      "VALUES (?, ?, 'pending')";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, challenger_id);
+    sqlite3_bind_int(stmt, 2, challenged_id);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    int challenge_id = (int)sqlite3_last_insert_rowid(db->db);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return challenge_id;
+}
+
+static int sqlite_respond_challenge(void* store, int challenge_id, const char* status) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE challenge_requests SET status = ?, responded_at = datetime('now') "
+                      "WHERE challenge_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_text(stmt, 1, status, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, challenge_id);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_get_challenge(void* store, int challenge_id, int* challenger_id, int* challenged_id, char* status) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "SELECT challenger_id, challenged_id, status FROM challenge_requests WHERE challenge_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, challenge_id);
+    
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        if (challenger_id) *challenger_id = sqlite3_column_int(stmt, 0);
+        if (challenged_id) *challenged_id = sqlite3_column_int(stmt, 1);
+        if (status) {
+            const char* s = (const char*)sqlite3_column_text(stmt, 2);
+            strcpy(status, s ? s : "");
+        }
+        sqlite3_finalize(stmt);
+        pthread_mutex_unlock(&db->mutex);
+        return 0;
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    return -1;
+}
+
+static int sqlite_get_pending_challenges(void* store, int user_id, int** challenge_ids, int* count) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    // First count challenges
+    sqlite3_stmt* stmt;
+    const char* sql_count = "SELECT COUNT(*) FROM challenge_requests "
+                            "WHERE challenged_id = ? AND status = 'pending'";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql_count, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    
+    if (*count == 0) {
+        pthread_mutex_unlock(&db->mutex);
+        return 0;
+    }
+    
+    // Allocate array
+    *challenge_ids = malloc(sizeof(int) * (*count));
+    if (!*challenge_ids) {
+        pthread_mutex_unlock(&db->mutex);
+        *count = 0;
+        return -1;
+    }
+    
+    // Get challenge IDs
+    const char* sql_get = "SELECT challenge_id FROM challenge_requests "
+                          "WHERE challenged_id = ? AND status = 'pending' "
+                          "ORDER BY created_at DESC";
+    
+    rc = sqlite3_prepare_v2(db->db, sql_get, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        free(*challenge_ids);
+        *challenge_ids = NULL;
+        *count = 0;
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    
+    int i = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW && i < *count) {
+        (*challenge_ids)[i++] = sqlite3_column_int(stmt, 0);
+    }
+    
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return 0;
+}
+
+static int sqlite_expire_old_challenges(void* store, int timeout_seconds) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    char sql[256];
+    snprintf(sql, sizeof(sql), 
+             "UPDATE challenge_requests SET status = 'expired' "
+             "WHERE status = 'pending' AND created_at < datetime('now', '-%d seconds')",
+             timeout_seconds);
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+// ============ Online Players (Extended) ============ 
+
+static int sqlite_get_online_players(void* store, OnlinePlayerInfo** players, int* count) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    // Count first
+    sqlite3_stmt* stmt;
+    const char* sql_count = "SELECT COUNT(*) FROM online_players op "
+                            "JOIN users u ON op.user_id = u.user_id";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql_count, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    
+    if (*count == 0) {
+        pthread_mutex_unlock(&db->mutex);
+        return 0;
+    }
+    
+    // Allocate
+    *players = malloc(sizeof(OnlinePlayerInfo) * (*count));
+    if (!*players) {
+        pthread_mutex_unlock(&db->mutex);
+        *count = 0;
+        return -1;
+    }
+    
+    // Get players
+    const char* sql_get = "SELECT op.user_id, u.username, u.elo_rating, op.status "
+                          "FROM online_players op "
+                          "JOIN users u ON op.user_id = u.user_id "
+                          "ORDER BY u.elo_rating DESC";
+    
+    rc = sqlite3_prepare_v2(db->db, sql_get, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        free(*players);
+        *players = NULL;
+        *count = 0;
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    int i = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW && i < *count) {
+        (*players)[i].user_id = sqlite3_column_int(stmt, 0);
+        
+        const char* name = (const char*)sqlite3_column_text(stmt, 1);
+        strncpy((*players)[i].username, name ? name : "", sizeof((*players)[i].username) - 1);
+        
+        (*players)[i].elo_rating = sqlite3_column_int(stmt, 2);
+        
+        const char* status = (const char*)sqlite3_column_text(stmt, 3);
+        strncpy((*players)[i].status, status ? status : "", sizeof((*players)[i].status) - 1);
+        
+        i++;
+    }
+    
+    *count = i;  // Update to actual count
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return 0;
+}
+
+static int sqlite_get_searching_players(void* store, OnlinePlayerInfo** players, int* count) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    // Count searching players
+    sqlite3_stmt* stmt;
+    const char* sql_count = "SELECT COUNT(*) FROM online_players op "
+                            "JOIN users u ON op.user_id = u.user_id "
+                            "WHERE op.status = 'searching'";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql_count, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    
+    if (*count == 0) {
+        pthread_mutex_unlock(&db->mutex);
+        return 0;
+    }
+    
+    // Allocate
+    *players = malloc(sizeof(OnlinePlayerInfo) * (*count));
+    if (!*players) {
+        pthread_mutex_unlock(&db->mutex);
+        *count = 0;
+        return -1;
+    }
+    
+    // Get searching players
+    const char* sql_get = "SELECT op.user_id, u.username, u.elo_rating, op.status "
+                          "FROM online_players op "
+                          "JOIN users u ON op.user_id = u.user_id "
+                          "WHERE op.status = 'searching' "
+                          "ORDER BY u.elo_rating";
+    
+    rc = sqlite3_prepare_v2(db->db, sql_get, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        free(*players);
+        *players = NULL;
+        *count = 0;
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    int i = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW && i < *count) {
+        (*players)[i].user_id = sqlite3_column_int(stmt, 0);
+        
+        const char* name = (const char*)sqlite3_column_text(stmt, 1);
+        strncpy((*players)[i].username, name ? name : "", sizeof((*players)[i].username) - 1);
+        
+        (*players)[i].elo_rating = sqlite3_column_int(stmt, 2);
+        
+        const char* status = (const char*)sqlite3_column_text(stmt, 3);
+        strncpy((*players)[i].status, status ? status : "", sizeof((*players)[i].status) - 1);
+        
+        i++;
+    }
+    
+    *count = i;
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return 0;
+}
+
+static int sqlite_set_player_game(void* store, int user_id, int game_id) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    const char* sql = "UPDATE online_players SET current_game_id = ?, status = 'in_game' WHERE user_id = ?";
+    
+    int rc = sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, game_id);
+    sqlite3_bind_int(stmt, 2, user_id);
+    
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int sqlite_get_user_match_history(void* store, int user_id, int before_match_id, int limit,
+                                         MatchHistoryEntry** history, int* count) {
+    SqliteStore* db = store;
+    
+    pthread_mutex_lock(&db->mutex);
+    
+    sqlite3_stmt* stmt;
+    
+    // Resolve the cursor to its (end_time, match_id) key. The first page
+    // starts above every possible key.
+    char cursor_time[32] = "9999-12-31 23:59:59";
+    int cursor_id = 0x7FFFFFFF;
+    
+    if (before_match_id > 0) {
+        const char* cursor_sql = "SELECT end_time FROM matches WHERE match_id = ? AND status = 'completed'";
+        
+        if (sqlite3_prepare_v2(db->db, cursor_sql, -1, &stmt, NULL) != SQLITE_OK) {
+            pthread_mutex_unlock(&db->mutex);
+            return -1;
+        }
+        
+        sqlite3_bind_int(stmt, 1, before_match_id);
+        
+        const char* end_time = NULL;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            end_time = (const char*)sqlite3_column_text(stmt, 0);
+        }
+        if (!end_time) {
+            sqlite3_finalize(stmt);
+            pthread_mutex_unlock(&db->mutex);
+            return -1;  // Unknown cursor
+        }
+        
+        strncpy(cursor_time, end_time, sizeof(cursor_time) - 1);
+        cursor_id = before_match_id;
+        sqlite3_finalize(stmt);
+    }
+    
+    *history = malloc(sizeof(MatchHistoryEntry) * limit);
+    if (!*history) {
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    // Keyset pagination: each branch seeks into its own partial index
+    // (player1 side / player2 side) and reads at most one page, so the cost
+    // of a page does not depend on how deep into the history it is.
+    const char* sql = 
+        "SELECT h.match_id, h.opponent_id, u.username, "
+        "    CASE WHEN h.winner_id = ?1 THEN 1 WHEN h.winner_id = 0 OR h.winner_id IS NULL THEN -1 ELSE 0 END, "
+        "    h.elo_change, h.start_time "
+        "FROM ("
+        "    SELECT * FROM ("
+        "        SELECT match_id, end_time, start_time, winner_id, player2_id AS opponent_id, "
+        "               player1_elo_after - player1_elo_before AS elo_change "
+        "        FROM matches "
+        "        WHERE player1_id = ?1 AND status = 'completed' AND (end_time, match_id) < (?2, ?3) "
+        "        ORDER BY end_time DESC, match_id DESC LIMIT ?4) "
+        "    UNION ALL "
+        "    SELECT * FROM ("
+        "        SELECT match_id, end_time, start_time, winner_id, player1_id AS opponent_id, "
+        "               player2_elo_after - player2_elo_before AS elo_change "
+        "        FROM matches "
+        "        WHERE player2_id = ?1 AND status = 'completed' AND (end_time, match_id) < (?2, ?3) "
+        "        ORDER BY end_time DESC, match_id DESC LIMIT ?4)"
+        ") h "
+        "LEFT JOIN users u ON u.user_id = h.opponent_id "
+        "ORDER BY h.end_time DESC, h.match_id DESC LIMIT ?4";
+        
+    if (sqlite3_prepare_v2(db->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "[DB] History query failed: %s\n", sqlite3_errmsg(db->db));
+        free(*history);
+        *history = NULL;
+        pthread_mutex_unlock(&db->mutex);
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, user_id);
+    sqlite3_bind_text(stmt, 2, cursor_time, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, cursor_id);
+    sqlite3_bind_int(stmt, 4, limit);
+    
+    int i = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW && i < limit) {
+        MatchHistoryEntry* entry = &(*history)[i];
+        memset(entry, 0, sizeof(*entry));
+        
+        entry->match_id = sqlite3_column_int(stmt, 0);
+        entry->opponent_id = sqlite3_column_int(stmt, 1);
+        
+        const char* username = (const char*)sqlite3_column_text(stmt, 2);
+        strncpy(entry->opponent_name, username ? username : "Unknown", sizeof(entry->opponent_name) - 1);
+        
+        entry->is_win = sqlite3_column_int(stmt, 3);
+        entry->elo_change = sqlite3_column_int(stmt, 4);
+        
+        const char* time_str = (const char*)sqlite3_column_text(stmt, 5);
+        strncpy(entry->timestamp, time_str ? time_str : "", sizeof(entry->timestamp) - 1);
+        
+        i++;
+    }
+    
+    *count = i;
+    sqlite3_finalize(stmt);
+    pthread_mutex_unlock(&db->mutex);
+    
+    if (*count == 0) {
+        free(*history);
+        *history = NULL;
+    }
+    return 0;
+}
+
+static int sqlite_get_cache_stats(void* store, UserCacheStats* stats) {
+    SqliteStore* db = store;
+    user_cache_get_stats(db->user_cache, stats);
+    return 0;
+}
+
+// ============ Backend Table ============
+
+const StorageOps sqlite_storage_ops = {
+    .name = "sqlite",
+    .open = sqlite_open,
+    .close = sqlite_close,
+    
+    .create_user = sqlite_create_user,
+    .get_user_by_name = sqlite_get_user_by_name,
+    .get_user_by_id = sqlite_get_user_by_id,
+    .update_user_elo = sqlite_update_user_elo,
+    .update_user_stats = sqlite_update_user_stats,
+    .update_last_login = sqlite_update_last_login,
+    
+    .create_session = sqlite_create_session,
+    .validate_session = sqlite_validate_session,
+    .delete_session = sqlite_delete_session,
+    .delete_user_sessions = sqlite_delete_user_sessions,
+    .load_active_sessions = sqlite_load_active_sessions,
+    
+    .set_player_online = sqlite_set_player_online,
+    .set_player_offline = sqlite_set_player_offline,
+    .update_heartbeat = sqlite_update_heartbeat,
+    .get_online_count = sqlite_get_online_count,
+    .get_online_players = sqlite_get_online_players,
+    .get_searching_players = sqlite_get_searching_players,
+    .set_player_game = sqlite_set_player_game,
+    
+    .create_match = sqlite_create_match,
+    .update_match_result = sqlite_update_match_result,
+    .commit_match_result = sqlite_commit_match_result,
+    .abandon_matches = sqlite_abandon_matches,
+    .log_move = sqlite_log_move,
+    .get_user_match_history = sqlite_get_user_match_history,
+    .save_match_logs = sqlite_save_match_logs,
+    .load_match_log = sqlite_load_match_log,
+    .get_match_log_ids = sqlite_get_match_log_ids,
+    
+    .save_hibernated_game = sqlite_save_hibernated_game,
+    .load_hibernated_game = sqlite_load_hibernated_game,
+    .delete_hibernated_game = sqlite_delete_hibernated_game,
+    .load_hibernated_games = sqlite_load_hibernated_games,
+    
+    .create_challenge = sqlite_create_challenge,
+    .respond_challenge = sqlite_respond_challenge,
+    .get_challenge = sqlite_get_challenge,
+    .get_pending_challenges = sqlite_get_pending_challenges,
+    .expire_old_challenges = sqlite_expire_old_challenges,
+    
+    .get_cache_stats = sqlite_get_cache_stats
+};
+
+sqlite3* storage_sqlite_handle(Database* db) {
+    if (!db || db->ops != &sqlite_storage_ops) return NULL;
+    return ((SqliteStore*)db->store)->db;
+}
@@ -0,0 +1,347 @@
+/*
+ * Hot Upgrade Implementation
+ */
+
+#include "upgrade.h"
+#include "game_state.h"
+#include "matchmaking.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define UPGRADE_MAGIC "MGUP"
+#define UPGRADE_VERSION 4   // 2: checkpoint images carry the rules version, 3: and the log event count,
+                            // 4: clients carry their search start and round trip
+#define UPGRADE_ACK 'A'
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    int64_t stopped_at_us;
+    uint32_t client_count;
+    uint32_t reserved;
+    uint64_t games_length;
+} UpgradeHeader;
+
+static int64_t wall_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void set_timeouts(int fd) {
+    struct timeval tv = { .tv_sec = UPGRADE_TIMEOUT, .tv_usec = 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static int write_all(int fd, const void* data, size_t length) {
+    const uint8_t* p = data;
+    while (length > 0) {
+        ssize_t n = send(fd, p, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        length -= n;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void* data, size_t length) {
+    uint8_t* p = data;
+    while (length > 0) {
+        ssize_t n = recv(fd, p, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        length -= n;
+    }
+    return 0;
+}
+
+static int fill_address(struct sockaddr_un* addr, const char* path) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (!path[0] || strlen(path) >= sizeof(addr->sun_path)) return -1;
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+// ============ Control Socket ============
+
+void upgrade_socket_path(const char* db_file, char* path, size_t size) {
+    struct sockaddr_un addr;
+    int n = snprintf(path, size, "%s.upgrade", db_file);
+    if (n < 0 || (size_t)n >= size || (size_t)n >= sizeof(addr.sun_path)) {
+        path[0] = '\0';
+    }
+}
+
+int upgrade_listen(GameServer* server, const char* path) {
+    server->upgrade_socket = -1;
+
+    struct sockaddr_un addr;
+    if (fill_address(&addr, path) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1) < 0) {
+        perror("[UPGRADE] control socket");
+        close(fd);
+        return -1;
+    }
+
+    server->upgrade_socket = fd;
+    snprintf(server->upgrade_path, sizeof(server->upgrade_path), "%s", path);
+    return 0;
+}
+
+// ============ Old Process ============
+
+// Header plus every socket in one message
+static int send_header(int conn, const UpgradeHeader* header, const int* fds, int fd_count) {
+    struct iovec iov = { .iov_base = (void*)header, .iov_len = sizeof(*header) };
+
+    size_t control_size = CMSG_SPACE(sizeof(int) * fd_count);
+    char* control = calloc(1, control_size);
+    if (!control) return -1;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = control_size;
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+
+    ssize_t sent = sendmsg(conn, &msg, MSG_NOSIGNAL);
+    free(control);
+    return sent == (ssize_t)sizeof(*header) ? 0 : -1;
+}
+
+int upgrade_handoff(GameServer* server) {
+    int conn = accept(server->upgrade_socket, NULL, NULL);
+    if (conn < 0) return -1;
+    set_timeouts(conn);
+
+    int64_t stopped_at = wall_us();
+    printf("[UPGRADE] New process connected, handing over\n");
+
+    // Everything the new process reads from the database must be written
+    // first (it loads the sessions table when it starts its own store)
+    game_flush_move_logs(&server->db);
+    session_store_shutdown(&server->sessions);
+
+    pthread_mutex_lock(&server->clients_mutex);
+    int count = server->client_count;
+    int* fds = malloc(sizeof(int) * (count + 1));
+    UpgradeClient* clients = calloc(count > 0 ? count : 1, sizeof(UpgradeClient));
+    if (fds && clients) {
+        fds[0] = server->server_socket;
+        for (int i = 0; i < count; i++) {
+            ConnectedClient* c = server->clients[i];
+            UpgradeClient* out = &clients[i];
+            fds[i + 1] = c->socket_fd;
+            out->user_id = c->user_id;
+            memcpy(out->username, c->username, sizeof(out->username));
+            memcpy(out->session_id, c->session_id, sizeof(out->session_id));
+            out->elo_rating = c->elo_rating;
+            out->status = c->status;
+            out->current_match_id = c->current_match_id;
+            out->last_heartbeat = c->last_heartbeat;
+            out->search_started_ms = c->search_started_ms;
+            out->rtt_ms = c->rtt_ms;
+        }
+    }
+    pthread_mutex_unlock(&server->clients_mutex);
+
+    size_t games_length = 0;
+    int game_count = 0;
+    uint8_t* games = checkpoint_export_games(&games_length, &game_count);
+
+    int rc = -1;
+    if (fds && clients && games) {
+        UpgradeHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, UPGRADE_MAGIC, 4);
+        header.version = UPGRADE_VERSION;
+        header.stopped_at_us = stopped_at;
+        header.client_count = (uint32_t)count;
+        header.games_length = games_length;
+
+        char ack = 0;
+        if (send_header(conn, &header, fds, count + 1) == 0 &&
+            write_all(conn, clients, sizeof(UpgradeClient) * count) == 0 &&
+            write_all(conn, games, games_length) == 0 &&
+            read_all(conn, &ack, 1) == 0 && ack == UPGRADE_ACK) {
+            rc = 0;
+        }
+    }
+
+    free(fds);
+    free(clients);
+    free(games);
+    close(conn);
+
+    if (rc != 0) {
+        fprintf(stderr, "[UPGRADE] Handoff failed, resuming service\n");
+        session_store_init(&server->sessions, &server->db);
+        return -1;
+    }
+
+    server->handed_off = 1;
+    server->running = 0;
+    printf("[UPGRADE] Handed over %d clients and %d games (%zu bytes) in %.1f ms\n",
+           count, game_count, games_length, (wall_us() - stopped_at) / 1000.0);
+    return 0;
+}
+
+// ============ New Process ============
+
+int upgrade_receive(const char* path, UpgradeImage* image) {
+    memset(image, 0, sizeof(*image));
+    image->conn = -1;
+    image->listen_fd = -1;
+
+    struct sockaddr_un addr;
+    if (fill_address(&addr, path) != 0) return -1;
+
+    int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conn < 0) return -1;
+    if (connect(conn, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("[UPGRADE] connect");
+        close(conn);
+        return -1;
+    }
+    set_timeouts(conn);
+    image->conn = conn;
+
+    UpgradeHeader header;
+    size_t control_size = CMSG_SPACE(sizeof(int) * (MAX_CLIENTS + 1));
+    char* control = calloc(1, control_size);
+    if (!control) return -1;
+
+    struct iovec iov = { .iov_base = &header, .iov_len = sizeof(header) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = control_size;
+
+    ssize_t n = recvmsg(conn, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+
+    // Take ownership of whatever sockets arrived before validating anything
+    int* fds = NULL;
+    int fd_count = 0;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (n > 0 && cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        fd_count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        fds = malloc(sizeof(int) * (fd_count > 0 ? fd_count : 1));
+        if (fds) memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * fd_count);
+    }
+    free(control);
+
+    if (fds && fd_count > 0) {
+        image->listen_fd = fds[0];
+        image->client_fds = fds;
+        image->client_count = fd_count - 1;
+    }
+
+    if (n != (ssize_t)sizeof(header) || (msg.msg_flags & MSG_CTRUNC) || !fds ||
+        memcmp(header.magic, UPGRADE_MAGIC, 4) != 0 || header.version != UPGRADE_VERSION ||
+        header.client_count != (uint32_t)image->client_count) {
+        fprintf(stderr, "[UPGRADE] Bad handoff header\n");
+        return -1;
+    }
+
+    image->stopped_at_us = header.stopped_at_us;
+    image->games_length = header.games_length;
+    image->clients = calloc(image->client_count > 0 ? image->client_count : 1, sizeof(UpgradeClient));
+    image->games = malloc(image->games_length > 0 ? image->games_length : 1);
+    if (!image->clients || !image->games ||
+        read_all(conn, image->clients, sizeof(UpgradeClient) * image->client_count) != 0 ||
+        read_all(conn, image->games, image->games_length) != 0) {
+        fprintf(stderr, "[UPGRADE] Truncated handoff image\n");
+        return -1;
+    }
+    return 0;
+}
+
+int upgrade_apply(GameServer* server, UpgradeImage* image) {
+    int games = checkpoint_import_games(&server->checkpoint, image->games, image->games_length, &server->db);
+    if (games < 0) {
+        fprintf(stderr, "[UPGRADE] Corrupt game image\n");
+        return -1;
+    }
+
+    server->server_socket = image->listen_fd;
+
+    pthread_mutex_lock(&server->clients_mutex);
+    for (int i = 0; i < image->client_count && server->client_count < MAX_CLIENTS; i++) {
+        UpgradeClient* in = &image->clients[i];
+        ConnectedClient* client = calloc(1, sizeof(ConnectedClient));
+        if (!client) break;
+
+        client->socket_fd = image->client_fds[i + 1];
+        client->user_id = in->user_id;
+        memcpy(client->username, in->username, sizeof(client->username));
+        client->username[sizeof(client->username) - 1] = '\0';
+        memcpy(client->session_id, in->session_id, sizeof(client->session_id));
+        client->session_id[SESSION_ID_LENGTH] = '\0';
+        client->elo_rating = in->elo_rating;
+        client->status = (PlayerStatus)in->status;
+        client->current_match_id = in->current_match_id;
+        client->last_heartbeat = (time_t)in->last_heartbeat;
+        client->search_started_ms = in->search_started_ms;
+        client->rtt_ms = in->rtt_ms;
+        client->is_connected = 1;
+        matchmaking_requeue(client);
+
+        server->clients[server->client_count++] = client;
+        image->client_fds[i + 1] = -1;  // Owned by the client now
+    }
+    pthread_mutex_unlock(&server->clients_mutex);
+
+    image->listen_fd = -1;  // Owned by the server now
+
+    printf("[UPGRADE] Took over %d clients and %d games, service paused %.1f ms\n",
+           server->client_count, games, (wall_us() - image->stopped_at_us) / 1000.0);
+    return 0;
+}
+
+void upgrade_finish(UpgradeImage* image, int ok) {
+    if (image->conn >= 0) {
+        if (ok) {
+            char ack = UPGRADE_ACK;
+            write_all(image->conn, &ack, 1);
+        }
+        close(image->conn);
+        image->conn = -1;
+    }
+
+    // Sockets nobody adopted (the old process still has its own copies)
+    if (image->listen_fd >= 0) close(image->listen_fd);
+    for (int i = 0; image->client_fds && i < image->client_count; i++) {
+        if (image->client_fds[i + 1] >= 0) close(image->client_fds[i + 1]);
+    }
+
+    free(image->client_fds);
+    free(image->clients);
+    free(image->games);
+    memset(image, 0, sizeof(*image));
+    image->conn = -1;
+    image->listen_fd = -1;
+}
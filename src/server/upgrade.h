@@ -0,0 +1,72 @@
+/*
+ * Hot Upgrade
+ *
+ * Hands a running server over to a new binary without disconnecting
+ * anyone:
+ * - Every server listens on a Unix control socket next to its database
+ *   (<database>.upgrade)
+ * - A new process started with -u connects to it. The old process stops
+ *   serving, flushes sessions and move logs, and sends the listening socket
+ *   and every client socket (SCM_RIGHTS) together with an image of the
+ *   client registry and the running games
+ * - The new process rebuilds its state and acknowledges; the old one then
+ *   exits without touching the connections. Without an acknowledgement
+ *   the old process resumes serving
+ *
+ * Clients only see a pause (reported by both processes), since messages
+ * sent meanwhile wait in the kernel socket buffers.
+ */
+
+#ifndef UPGRADE_H
+#define UPGRADE_H
+
+#include "server.h"
+
+#define UPGRADE_TIMEOUT 10      // Seconds either side waits for the other
+
+// One client registry entry (socket passed alongside, in the same order)
+typedef struct {
+    int32_t user_id;
+    char username[50];
+    char session_id[SESSION_ID_LENGTH + 1];
+    int32_t elo_rating;
+    int32_t status;
+    int32_t current_match_id;
+    int64_t last_heartbeat;
+    int64_t search_started_ms;
+    int32_t rtt_ms;
+} UpgradeClient;
+
+// What the new process received
+typedef struct {
+    int conn;               // Control connection (acknowledged on success)
+    int listen_fd;
+    int client_count;
+    int* client_fds;
+    UpgradeClient* clients;
+    uint8_t* games;         // checkpoint_export_games format
+    size_t games_length;
+    int64_t stopped_at_us;  // When the old process stopped serving (wall clock)
+} UpgradeImage;
+
+// Control socket path for a database file (empty if it does not fit)
+void upgrade_socket_path(const char* db_file, char* path, size_t size);
+
+// Start listening on the control socket (replaces a stale one)
+int upgrade_listen(GameServer* server, const char* path);
+
+// Old process: accept the new process and hand everything over
+// Returns 0 once the new process took over, -1 if serving continues here
+int upgrade_handoff(GameServer* server);
+
+// New process: receive the image from the server listening on path
+int upgrade_receive(const char* path, UpgradeImage* image);
+
+// New process: adopt the received sockets, clients and games
+// (after the session store, game state and checkpoint are initialized)
+int upgrade_apply(GameServer* server, UpgradeImage* image);
+
+// New process: acknowledge (ok) or abort the takeover and free the image
+void upgrade_finish(UpgradeImage* image, int ok);
+
+#endif // UPGRADE_H
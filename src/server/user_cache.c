@@ -0,0 +1,320 @@
+/*
+ * User Profile Cache Implementation
+ */
+
+#include "user_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct UserCacheEntry {
+    CachedUser user;
+    UserCacheEntry* hash_next;
+    UserCacheEntry* lru_prev;
+    UserCacheEntry* lru_next;
+};
+
+struct UserNameEntry {
+    char username[50];
+    int user_id;
+    UserNameEntry* next;
+};
+
+// ============ Hashing ============
+
+static uint32_t hash_id(int user_id) {
+    uint32_t x = (uint32_t)user_id;
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint32_t hash_name(const char* name) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static UserCacheShard* id_shard(UserCache* cache, int user_id, uint32_t* bucket) {
+    uint32_t h = hash_id(user_id);
+    UserCacheShard* shard = &cache->shards[h % USER_CACHE_SHARDS];
+    *bucket = (h / USER_CACHE_SHARDS) % shard->bucket_count;
+    return shard;
+}
+
+static UserNameShard* name_shard(UserCache* cache, const char* username, uint32_t* bucket) {
+    uint32_t h = hash_name(username);
+    UserNameShard* shard = &cache->name_shards[h % USER_CACHE_SHARDS];
+    *bucket = (h / USER_CACHE_SHARDS) % shard->bucket_count;
+    return shard;
+}
+
+// ============ Name Index ============
+
+static void name_index_put(UserCache* cache, const char* username, int user_id) {
+    uint32_t bucket;
+    UserNameShard* shard = name_shard(cache, username, &bucket);
+    
+    pthread_mutex_lock(&shard->mutex);
+    for (UserNameEntry* e = shard->buckets[bucket]; e; e = e->next) {
+        if (strcmp(e->username, username) == 0) {
+            e->user_id = user_id;
+            pthread_mutex_unlock(&shard->mutex);
+            return;
+        }
+    }
+    
+    UserNameEntry* e = malloc(sizeof(UserNameEntry));
+    if (e) {
+        strncpy(e->username, username, sizeof(e->username) - 1);
+        e->username[sizeof(e->username) - 1] = '\0';
+        e->user_id = user_id;
+        e->next = shard->buckets[bucket];
+        shard->buckets[bucket] = e;
+    }
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+static void name_index_remove(UserCache* cache, const char* username) {
+    uint32_t bucket;
+    UserNameShard* shard = name_shard(cache, username, &bucket);
+    
+    pthread_mutex_lock(&shard->mutex);
+    UserNameEntry** link = &shard->buckets[bucket];
+    while (*link) {
+        if (strcmp((*link)->username, username) == 0) {
+            UserNameEntry* dead = *link;
+            *link = dead->next;
+            free(dead);
+            break;
+        }
+        link = &(*link)->next;
+    }
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+// ============ LRU Helpers (shard lock held) ============
+
+static void lru_unlink(UserCacheShard* shard, UserCacheEntry* e) {
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+    else shard->lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+    else shard->lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void lru_push_front(UserCacheShard* shard, UserCacheEntry* e) {
+    e->lru_prev = NULL;
+    e->lru_next = shard->lru_head;
+    if (shard->lru_head) shard->lru_head->lru_prev = e;
+    shard->lru_head = e;
+    if (!shard->lru_tail) shard->lru_tail = e;
+}
+
+static UserCacheEntry* shard_find(UserCacheShard* shard, uint32_t bucket, int user_id) {
+    for (UserCacheEntry* e = shard->buckets[bucket]; e; e = e->hash_next) {
+        if (e->user.user_id == user_id) return e;
+    }
+    return NULL;
+}
+
+// Unlink from hash chain and LRU, drop the name mapping, free
+static void shard_remove(UserCache* cache, UserCacheShard* shard, UserCacheEntry* e) {
+    uint32_t bucket = (hash_id(e->user.user_id) / USER_CACHE_SHARDS) % shard->bucket_count;
+    UserCacheEntry** link = &shard->buckets[bucket];
+    while (*link && *link != e) link = &(*link)->hash_next;
+    if (*link) *link = e->hash_next;
+    
+    lru_unlink(shard, e);
+    name_index_remove(cache, e->user.username);
+    shard->size--;
+    free(e);
+}
+
+// ============ Public API ============
+
+UserCache* user_cache_create(int capacity) {
+    if (capacity <= 0) capacity = USER_CACHE_DEFAULT_CAPACITY;
+    
+    UserCache* cache = calloc(1, sizeof(UserCache));
+    if (!cache) return NULL;
+    
+    int per_shard = (capacity + USER_CACHE_SHARDS - 1) / USER_CACHE_SHARDS;
+    
+    for (int i = 0; i < USER_CACHE_SHARDS; i++) {
+        UserCacheShard* shard = &cache->shards[i];
+        pthread_mutex_init(&shard->mutex, NULL);
+        shard->capacity = per_shard;
+        shard->bucket_count = per_shard * 2;
+        shard->buckets = calloc(shard->bucket_count, sizeof(UserCacheEntry*));
+        
+        UserNameShard* names = &cache->name_shards[i];
+        pthread_mutex_init(&names->mutex, NULL);
+        names->bucket_count = per_shard * 2;
+        names->buckets = calloc(names->bucket_count, sizeof(UserNameEntry*));
+        
+        if (!shard->buckets || !names->buckets) {
+            user_cache_destroy(cache);
+            return NULL;
+        }
+    }
+    
+    return cache;
+}
+
+void user_cache_destroy(UserCache* cache) {
+    if (!cache) return;
+    
+    for (int i = 0; i < USER_CACHE_SHARDS; i++) {
+        UserCacheShard* shard = &cache->shards[i];
+        UserCacheEntry* e = shard->lru_head;
+        while (e) {
+            UserCacheEntry* next = e->lru_next;
+            free(e);
+            e = next;
+        }
+        free(shard->buckets);
+        pthread_mutex_destroy(&shard->mutex);
+        
+        UserNameShard* names = &cache->name_shards[i];
+        for (int b = 0; names->buckets && b < names->bucket_count; b++) {
+            UserNameEntry* n = names->buckets[b];
+            while (n) {
+                UserNameEntry* next = n->next;
+                free(n);
+                n = next;
+            }
+        }
+        free(names->buckets);
+        pthread_mutex_destroy(&names->mutex);
+    }
+    
+    free(cache);
+}
+
+int user_cache_get_by_id(UserCache* cache, int user_id, CachedUser* out) {
+    if (!cache || !out) return -1;
+    
+    uint32_t bucket;
+    UserCacheShard* shard = id_shard(cache, user_id, &bucket);
+    
+    pthread_mutex_lock(&shard->mutex);
+    UserCacheEntry* e = shard_find(shard, bucket, user_id);
+    if (!e) {
+        shard->misses++;
+        pthread_mutex_unlock(&shard->mutex);
+        return -1;
+    }
+    
+    lru_unlink(shard, e);
+    lru_push_front(shard, e);
+    *out = e->user;
+    shard->hits++;
+    pthread_mutex_unlock(&shard->mutex);
+    return 0;
+}
+
+int user_cache_get_by_name(UserCache* cache, const char* username, CachedUser* out) {
+    if (!cache || !username || !out) return -1;
+    
+    uint32_t bucket;
+    UserNameShard* names = name_shard(cache, username, &bucket);
+    
+    int user_id = 0;
+    pthread_mutex_lock(&names->mutex);
+    for (UserNameEntry* n = names->buckets[bucket]; n; n = n->next) {
+        if (strcmp(n->username, username) == 0) {
+            user_id = n->user_id;
+            break;
+        }
+    }
+    if (!user_id) names->misses++;
+    pthread_mutex_unlock(&names->mutex);
+    
+    if (!user_id) return -1;
+    
+    // The entry may have been evicted or invalidated in between
+    if (user_cache_get_by_id(cache, user_id, out) != 0) return -1;
+    return strcmp(out->username, username) == 0 ? 0 : -1;
+}
+
+void user_cache_put(UserCache* cache, const CachedUser* user) {
+    if (!cache || !user || user->user_id <= 0) return;
+    
+    uint32_t bucket;
+    UserCacheShard* shard = id_shard(cache, user->user_id, &bucket);
+    
+    pthread_mutex_lock(&shard->mutex);
+    
+    UserCacheEntry* e = shard_find(shard, bucket, user->user_id);
+    if (e) {
+        e->user = *user;
+        lru_unlink(shard, e);
+        lru_push_front(shard, e);
+        pthread_mutex_unlock(&shard->mutex);
+        return;
+    }
+    
+    if (shard->size >= shard->capacity && shard->lru_tail) {
+        shard_remove(cache, shard, shard->lru_tail);
+        shard->evictions++;
+    }
+    
+    e = calloc(1, sizeof(UserCacheEntry));
+    if (!e) {
+        pthread_mutex_unlock(&shard->mutex);
+        return;
+    }
+    e->user = *user;
+    e->hash_next = shard->buckets[bucket];
+    shard->buckets[bucket] = e;
+    lru_push_front(shard, e);
+    shard->size++;
+    
+    name_index_put(cache, user->username, user->user_id);
+    
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+void user_cache_invalidate(UserCache* cache, int user_id) {
+    if (!cache) return;
+    
+    uint32_t bucket;
+    UserCacheShard* shard = id_shard(cache, user_id, &bucket);
+    
+    pthread_mutex_lock(&shard->mutex);
+    UserCacheEntry* e = shard_find(shard, bucket, user_id);
+    if (e) {
+        shard_remove(cache, shard, e);
+        shard->invalidations++;
+    }
+    pthread_mutex_unlock(&shard->mutex);
+}
+
+void user_cache_get_stats(UserCache* cache, UserCacheStats* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!cache) return;
+    
+    for (int i = 0; i < USER_CACHE_SHARDS; i++) {
+        UserCacheShard* shard = &cache->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        stats->hits += shard->hits;
+        stats->misses += shard->misses;
+        stats->evictions += shard->evictions;
+        stats->invalidations += shard->invalidations;
+        stats->size += shard->size;
+        pthread_mutex_unlock(&shard->mutex);
+        
+        UserNameShard* names = &cache->name_shards[i];
+        pthread_mutex_lock(&names->mutex);
+        stats->misses += names->misses;
+        pthread_mutex_unlock(&names->mutex);
+    }
+}
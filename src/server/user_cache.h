@@ -0,0 +1,93 @@
+/*
+ * User Profile Cache
+ *
+ * Sharded LRU cache of user rows in front of SQLite:
+ * - Entries are keyed by user_id; a secondary index maps username -> user_id
+ * - Each shard has its own lock, so hits never touch the database mutex
+ * - Writers (ELO/stats updates) invalidate the affected user
+ */
+
+#ifndef USER_CACHE_H
+#define USER_CACHE_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define USER_CACHE_SHARDS 16
+#define USER_CACHE_DEFAULT_CAPACITY 4096   // Total entries across all shards
+
+// Cached copy of a users row
+typedef struct {
+    int user_id;
+    char username[50];
+    char password_hash[65];
+    int elo_rating;
+    int total_matches;
+    int wins;
+    int losses;
+} CachedUser;
+
+typedef struct UserCacheEntry UserCacheEntry;
+typedef struct UserNameEntry UserNameEntry;
+
+// One shard: hash chains by user_id plus an LRU list (head = most recent)
+typedef struct {
+    pthread_mutex_t mutex;
+    UserCacheEntry** buckets;
+    int bucket_count;
+    UserCacheEntry* lru_head;
+    UserCacheEntry* lru_tail;
+    int size;
+    int capacity;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t invalidations;
+} UserCacheShard;
+
+// Secondary index shard: username -> user_id
+// Lock order: an id shard may take a name shard lock, never the reverse
+typedef struct {
+    pthread_mutex_t mutex;
+    UserNameEntry** buckets;
+    int bucket_count;
+    uint64_t misses;        // Username not indexed at all
+} UserNameShard;
+
+typedef struct {
+    UserCacheShard shards[USER_CACHE_SHARDS];
+    UserNameShard name_shards[USER_CACHE_SHARDS];
+} UserCache;
+
+// Aggregated counters
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t invalidations;
+    int size;
+} UserCacheStats;
+
+// Create a cache holding up to `capacity` users (<= 0 uses the default)
+// Returns NULL on allocation failure
+UserCache* user_cache_create(int capacity);
+
+// Free the cache and all entries
+void user_cache_destroy(UserCache* cache);
+
+// Look up by user_id / username; copies the row into `out`
+// Returns 0 on hit, -1 on miss
+int user_cache_get_by_id(UserCache* cache, int user_id, CachedUser* out);
+int user_cache_get_by_name(UserCache* cache, const char* username, CachedUser* out);
+
+// Insert or refresh a row (evicts the least recently used entry when full)
+void user_cache_put(UserCache* cache, const CachedUser* user);
+
+// Drop a user after their row changed in the database
+void user_cache_invalidate(UserCache* cache, int user_id);
+
+// Sum counters over all shards
+void user_cache_get_stats(UserCache* cache, UserCacheStats* stats);
+
+#endif // USER_CACHE_H
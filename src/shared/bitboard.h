@@ -0,0 +1,138 @@
+/*
+ * Board Bitboards
+ *
+ * Property sets as 40-bit masks (bit n = board square n), shared by the
+ * server rules, the local game and the simulators:
+ * - Each player's properties are one mask, kept up to date on every change
+ * - Color groups, railroads and utilities are precomputed masks, so a
+ *   monopoly check is one AND/compare and a railroad count one popcount
+ * - Sums over a set (net worth, mortgage value) visit only the set bits
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+typedef uint64_t BoardMask;
+
+#define BOARD_SQUARES 40
+#define BOARD_BIT(pos) ((BoardMask)1 << (pos))
+
+// Color groups in board order
+typedef enum {
+    BOARD_GROUP_BROWN,
+    BOARD_GROUP_LIGHT_BLUE,
+    BOARD_GROUP_PINK,
+    BOARD_GROUP_ORANGE,
+    BOARD_GROUP_RED,
+    BOARD_GROUP_YELLOW,
+    BOARD_GROUP_GREEN,
+    BOARD_GROUP_DARK_BLUE,
+    BOARD_GROUP_RAILROAD,
+    BOARD_GROUP_UTILITY,
+    BOARD_GROUP_COUNT,
+    BOARD_GROUP_NONE = BOARD_GROUP_COUNT   // Corners, taxes, cards
+} BoardGroup;
+
+#define BOARD_STREET_GROUPS 8   // BOARD_GROUP_BROWN .. BOARD_GROUP_DARK_BLUE
+
+#define BOARD_RAILROADS (BOARD_BIT(5) | BOARD_BIT(15) | BOARD_BIT(25) | BOARD_BIT(35))
+#define BOARD_UTILITIES (BOARD_BIT(12) | BOARD_BIT(28))
+
+static const BoardMask board_group_masks[BOARD_GROUP_COUNT + 1] = {
+    BOARD_BIT(1) | BOARD_BIT(3),
+    BOARD_BIT(6) | BOARD_BIT(8) | BOARD_BIT(9),
+    BOARD_BIT(11) | BOARD_BIT(13) | BOARD_BIT(14),
+    BOARD_BIT(16) | BOARD_BIT(18) | BOARD_BIT(19),
+    BOARD_BIT(21) | BOARD_BIT(23) | BOARD_BIT(24),
+    BOARD_BIT(26) | BOARD_BIT(27) | BOARD_BIT(29),
+    BOARD_BIT(31) | BOARD_BIT(32) | BOARD_BIT(34),
+    BOARD_BIT(37) | BOARD_BIT(39),
+    BOARD_RAILROADS,
+    BOARD_UTILITIES,
+    0
+};
+
+// Group of every square
+static const uint8_t board_square_group[BOARD_SQUARES] = {
+    BOARD_GROUP_NONE, BOARD_GROUP_BROWN, BOARD_GROUP_NONE, BOARD_GROUP_BROWN,
+    BOARD_GROUP_NONE, BOARD_GROUP_RAILROAD, BOARD_GROUP_LIGHT_BLUE, BOARD_GROUP_NONE,
+    BOARD_GROUP_LIGHT_BLUE, BOARD_GROUP_LIGHT_BLUE,
+    BOARD_GROUP_NONE, BOARD_GROUP_PINK, BOARD_GROUP_UTILITY, BOARD_GROUP_PINK,
+    BOARD_GROUP_PINK, BOARD_GROUP_RAILROAD, BOARD_GROUP_ORANGE, BOARD_GROUP_NONE,
+    BOARD_GROUP_ORANGE, BOARD_GROUP_ORANGE,
+    BOARD_GROUP_NONE, BOARD_GROUP_RED, BOARD_GROUP_NONE, BOARD_GROUP_RED,
+    BOARD_GROUP_RED, BOARD_GROUP_RAILROAD, BOARD_GROUP_YELLOW, BOARD_GROUP_YELLOW,
+    BOARD_GROUP_UTILITY, BOARD_GROUP_YELLOW,
+    BOARD_GROUP_NONE, BOARD_GROUP_GREEN, BOARD_GROUP_GREEN, BOARD_GROUP_NONE,
+    BOARD_GROUP_GREEN, BOARD_GROUP_RAILROAD, BOARD_GROUP_NONE, BOARD_GROUP_DARK_BLUE,
+    BOARD_GROUP_NONE, BOARD_GROUP_DARK_BLUE
+};
+
+static inline int board_popcount(BoardMask mask) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(mask);
+#else
+    mask = mask - ((mask >> 1) & 0x5555555555555555ULL);
+    mask = (mask & 0x3333333333333333ULL) + ((mask >> 2) & 0x3333333333333333ULL);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((mask * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Remove and return the lowest square in *mask (mask must not be empty)
+static inline int board_pop_lowest(BoardMask* mask) {
+#if defined(__GNUC__)
+    int pos = __builtin_ctzll(*mask);
+#else
+    int pos = board_popcount((*mask & (0 - *mask)) - 1);
+#endif
+    *mask &= *mask - 1;
+    return pos;
+}
+
+// Every square of the group pos belongs to (0 for squares nobody can own)
+static inline BoardMask board_group_mask(int pos) {
+    return board_group_masks[board_square_group[pos]];
+}
+
+// First square of set after pos, going round the board (-1 if set is empty)
+static inline int board_next_in(BoardMask set, int pos) {
+    BoardMask ahead = set & ~((BOARD_BIT(pos) << 1) - 1);
+    if (ahead) return board_pop_lowest(&ahead);
+    return set ? board_pop_lowest(&set) : -1;
+}
+
+// Number of squares of set owned (railroads, utilities, a color group)
+static inline int board_count(BoardMask owned, BoardMask set) {
+    return board_popcount(owned & set);
+}
+
+// Whether owned holds the whole color group of the street at pos
+static inline int board_owns_group(BoardMask owned, int pos) {
+    BoardMask group = board_group_mask(pos);
+    return board_square_group[pos] < BOARD_STREET_GROUPS && (owned & group) == group;
+}
+
+// All streets of owned that are part of a complete color group
+static inline BoardMask board_monopolies(BoardMask owned) {
+    BoardMask result = 0;
+    for (int g = 0; g < BOARD_STREET_GROUPS; g++) {
+        if ((owned & board_group_masks[g]) == board_group_masks[g]) {
+            result |= board_group_masks[g];
+        }
+    }
+    return result;
+}
+
+// Sum of values[pos] over the squares in mask
+static inline int board_sum(BoardMask mask, const int values[BOARD_SQUARES]) {
+    int sum = 0;
+    while (mask) {
+        sum += values[board_pop_lowest(&mask)];
+    }
+    return sum;
+}
+
+#endif // BITBOARD_H
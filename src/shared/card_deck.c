@@ -0,0 +1,82 @@
+#include "card_deck.h"
+#include <stdlib.h>
+
+static const CardDef chance_cards[CARD_DECK_SIZE] = {
+    { CARD_ACT_ADVANCE, 0, 0, 0, "Advance to GO (Collect $200)" },
+    { CARD_ACT_ADVANCE, 24, 0, 0, "Advance to Illinois Avenue" },
+    { CARD_ACT_ADVANCE, 11, 0, 0, "Advance to St. Charles Place" },
+    { CARD_ACT_NEAREST, BOARD_GROUP_UTILITY, 0, 0, "Advance token to nearest Utility" },
+    { CARD_ACT_NEAREST, BOARD_GROUP_RAILROAD, 0, 0, "Advance token to nearest Railroad" },
+    { CARD_ACT_NEAREST, BOARD_GROUP_RAILROAD, 0, 0, "Advance token to nearest Railroad" },
+    { CARD_ACT_MONEY, 0, 50, 0, "Bank pays you dividend of $50" },
+    { CARD_ACT_JAIL_FREE, 0, 0, 0, "Get Out of Jail Free" },
+    { CARD_ACT_BACK, 0, 3, 0, "Go Back 3 Spaces" },
+    { CARD_ACT_JAIL, 0, 0, 0, "Go to Jail" },
+    { CARD_ACT_REPAIRS, 0, 25, 100, "Make general repairs - $25 per house, $100 per hotel" },
+    { CARD_ACT_MONEY, 0, -15, 0, "Pay poor tax of $15" },
+    { CARD_ACT_ADVANCE, 5, 0, 0, "Take a trip to Reading Railroad" },
+    { CARD_ACT_ADVANCE, 39, 0, 0, "Take a walk on the Boardwalk" },
+    { CARD_ACT_EACH_PLAYER, 0, -50, 0, "You have been elected Chairman of the Board - Pay each player $50" },
+    { CARD_ACT_MONEY, 0, 150, 0, "Your building loan matures - Collect $150" }
+};
+
+static const CardDef community_chest_cards[CARD_DECK_SIZE] = {
+    { CARD_ACT_ADVANCE, 0, 0, 0, "Advance to GO (Collect $200)" },
+    { CARD_ACT_MONEY, 0, 200, 0, "Bank error in your favor - Collect $200" },
+    { CARD_ACT_MONEY, 0, -50, 0, "Doctor's fee - Pay $50" },
+    { CARD_ACT_MONEY, 0, 50, 0, "From sale of stock you get $50" },
+    { CARD_ACT_JAIL_FREE, 0, 0, 0, "Get Out of Jail Free" },
+    { CARD_ACT_JAIL, 0, 0, 0, "Go to Jail" },
+    { CARD_ACT_EACH_PLAYER, 0, 50, 0, "Grand Opera Night - Collect $50 from every player" },
+    { CARD_ACT_MONEY, 0, 100, 0, "Holiday Fund matures - Collect $100" },
+    { CARD_ACT_MONEY, 0, 20, 0, "Income tax refund - Collect $20" },
+    { CARD_ACT_EACH_PLAYER, 0, 10, 0, "It is your birthday - Collect $10 from each player" },
+    { CARD_ACT_MONEY, 0, 100, 0, "Life insurance matures - Collect $100" },
+    { CARD_ACT_MONEY, 0, -100, 0, "Hospital fees - Pay $100" },
+    { CARD_ACT_MONEY, 0, -150, 0, "School fees - Pay $150" },
+    { CARD_ACT_MONEY, 0, 25, 0, "Receive for services $25" },
+    { CARD_ACT_REPAIRS, 0, 40, 115, "You are assessed for street repairs - $40 per house, $115 per hotel" },
+    { CARD_ACT_MONEY, 0, 10, 0, "You have won second prize in a beauty contest - Collect $10" }
+};
+
+const CardDef* card_def(DeckKind deck, int index) {
+    if (index < 0 || index >= CARD_DECK_SIZE) return NULL;
+    switch (deck) {
+        case DECK_CHANCE: return &chance_cards[index];
+        case DECK_COMMUNITY_CHEST: return &community_chest_cards[index];
+        default: return NULL;
+    }
+}
+
+const char* card_deck_name(DeckKind deck) {
+    return deck == DECK_CHANCE ? "Chance" : "Community Chest";
+}
+
+// Fisher-Yates shuffle
+void card_deck_shuffle(CardDeck* deck, unsigned int* rng) {
+    for (int i = 0; i < CARD_DECK_SIZE; i++) {
+        deck->order[i] = (uint8_t)i;
+    }
+    for (int i = CARD_DECK_SIZE - 1; i > 0; i--) {
+        int j = rand_r(rng) % (i + 1);
+        uint8_t temp = deck->order[i];
+        deck->order[i] = deck->order[j];
+        deck->order[j] = temp;
+    }
+    deck->next = 0;
+}
+
+int card_deck_draw(CardDeck* deck) {
+    int index = deck->order[deck->next];
+    deck->next = (uint8_t)((deck->next + 1) % CARD_DECK_SIZE);
+    return index;
+}
+
+int card_deck_valid(const CardDeck* deck) {
+    unsigned int seen = 0;
+    for (int i = 0; i < CARD_DECK_SIZE; i++) {
+        if (deck->order[i] >= CARD_DECK_SIZE) return 0;
+        seen |= 1u << deck->order[i];
+    }
+    return seen == 0xFFFFu && deck->next < CARD_DECK_SIZE;
+}
@@ -0,0 +1,66 @@
+/*
+ * Card Decks
+ *
+ * The 16 Chance and 16 Community Chest cards as data, and deck state that
+ * lives in each game rather than in globals:
+ * - card_def() describes what a card does; the rules (server game state,
+ *   local game, simulators) apply it to their own game
+ * - A CardDeck is a shuffled order plus the next position; it is shuffled
+ *   from a caller-owned rand_r state, so one seed gives one sequence of
+ *   cards, and drawing cycles through the deck without reshuffling
+ */
+
+#ifndef CARD_DECK_H
+#define CARD_DECK_H
+
+#include "bitboard.h"
+#include <stdint.h>
+
+#define CARD_DECK_SIZE 16
+
+typedef enum {
+    DECK_CHANCE,
+    DECK_COMMUNITY_CHEST,
+    DECK_COUNT
+} DeckKind;
+
+typedef enum {
+    CARD_ACT_MONEY,         // amount from (positive) or to (negative) the bank
+    CARD_ACT_ADVANCE,       // forward to square target (GO salary when passing it)
+    CARD_ACT_BACK,          // back amount squares
+    CARD_ACT_NEAREST,       // forward to the nearest square of group target
+    CARD_ACT_JAIL,          // straight to jail
+    CARD_ACT_JAIL_FREE,     // keep until needed
+    CARD_ACT_REPAIRS,       // amount per house, hotel per hotel
+    CARD_ACT_EACH_PLAYER    // amount from (positive) or to (negative) every other player
+} CardAction;
+
+typedef struct {
+    uint8_t action;         // CardAction
+    int8_t target;          // Square (ADVANCE) or BoardGroup (NEAREST)
+    int16_t amount;
+    int16_t hotel;          // REPAIRS: cost per hotel
+    const char* text;
+} CardDef;
+
+typedef struct {
+    uint8_t order[CARD_DECK_SIZE];
+    uint8_t next;
+} CardDeck;
+
+// Card index (0-15) of a deck; NULL if out of range
+const CardDef* card_def(DeckKind deck, int index);
+
+// Deck name for messages ("Chance", "Community Chest")
+const char* card_deck_name(DeckKind deck);
+
+// Put the cards in a fresh shuffled order
+void card_deck_shuffle(CardDeck* deck, unsigned int* rng);
+
+// Take the next card; returns its index
+int card_deck_draw(CardDeck* deck);
+
+// Whether the deck state is a permutation with a valid next position
+int card_deck_valid(const CardDeck* deck);
+
+#endif // CARD_DECK_H
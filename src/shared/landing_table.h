@@ -0,0 +1,329 @@
+/*
+ * Landing Probabilities
+ *
+ * Generated by src/bench/landing_gen.c from the board and the card decks;
+ * do not edit. Regenerate with: make tables
+ *
+ * Long-run chances of a token ending a roll on each square, for valuing
+ * squares without simulating (see landing_gen.c for the rules modelled).
+ * The jail square counts turns spent in jail as well as visits.
+ */
+
+#ifndef LANDING_TABLE_H
+#define LANDING_TABLE_H
+
+#include "bitboard.h"
+
+#define LANDING_FROM_JAIL BOARD_SQUARES  // landing_next_turn row for a turn started in jail
+
+// Share of rolls that end on each square
+static const float landing_per_roll[BOARD_SQUARES] = {
+    0.03022726f, 0.02096401f, 0.01882151f, 0.02115668f, 0.02287897f, 0.02915529f, 0.02228959f, 0.00889899f,
+    0.02287811f, 0.02268669f, 0.09383540f, 0.02663443f, 0.02659915f, 0.02237011f, 0.02422453f, 0.02672709f,
+    0.02636553f, 0.02314206f, 0.02760796f, 0.02799562f, 0.02773823f, 0.02609981f, 0.01066016f, 0.02569606f,
+    0.02998070f, 0.02875340f, 0.02526724f, 0.02506497f, 0.02641686f, 0.02432476f, 0.00594473f, 0.02520830f,
+    0.02488204f, 0.02297588f, 0.02401446f, 0.02355514f, 0.00883210f, 0.02169049f, 0.02154626f, 0.02588946f,
+};
+
+// Expected rolls ending on each square per turn (1.1784 rolls per turn)
+static const float landing_per_turn[BOARD_SQUARES] = {
+    0.03561965f, 0.02470389f, 0.02217917f, 0.02493093f, 0.02696046f, 0.03435645f, 0.02626595f, 0.01048653f,
+    0.02695945f, 0.02673389f, 0.11057517f, 0.03138588f, 0.03134430f, 0.02636082f, 0.02854607f, 0.03149507f,
+    0.03106901f, 0.02727049f, 0.03253308f, 0.03298990f, 0.03268659f, 0.03075589f, 0.01256187f, 0.03028011f,
+    0.03532910f, 0.03388286f, 0.02977479f, 0.02953644f, 0.03112950f, 0.02866418f, 0.00700524f, 0.02970533f,
+    0.02932087f, 0.02707466f, 0.02829852f, 0.02775726f, 0.01040770f, 0.02555997f, 0.02539001f, 0.03050801f,
+};
+
+// Expected rolls ending on each square during one turn started on a square
+// (no doubles yet, no jail card) or in jail
+static const float landing_next_turn[BOARD_SQUARES + 1][BOARD_SQUARES] = {
+    { // 0 GO
+        0.01360146f, 0.00000000f, 0.02435294f, 0.05566289f, 0.09488194f, 0.12366593f, 0.14196459f, 0.06423925f,
+        0.14567225f, 0.12017680f, 0.11391795f, 0.07903022f, 0.05180963f, 0.01445922f, 0.01449447f, 0.03644190f,
+        0.01406848f, 0.01214022f, 0.01200819f, 0.01136544f, 0.00831627f, 0.00658275f, 0.00169043f, 0.00337845f,
+        0.01291919f, 0.00205294f, 0.00086270f, 0.00106632f, 0.00084160f, 0.00063765f, 0.00001072f, 0.00036437f,
+        0.00016611f, 0.00014216f, 0.00008038f, 0.00007502f, 0.00000804f, 0.00001072f, 0.00000536f, 0.01099017f,
+    },
+    { // 1 Mediterranean Avenue
+        0.01025293f, 0.00006393f, 0.00014144f, 0.02805473f, 0.06485258f, 0.09399941f, 0.11329969f, 0.05354480f,
+        0.17209907f, 0.14616926f, 0.13776160f, 0.10296937f, 0.07591282f, 0.03930731f, 0.01215094f, 0.03035819f,
+        0.01348568f, 0.01148380f, 0.01355684f, 0.01272417f, 0.01184769f, 0.00903145f, 0.00275115f, 0.00494687f,
+        0.01303855f, 0.00304427f, 0.00167837f, 0.00106894f, 0.00174684f, 0.00088643f, 0.00000301f, 0.00075507f,
+        0.00074837f, 0.00037990f, 0.00037144f, 0.00018105f, 0.00004503f, 0.00002194f, 0.00001656f, 0.00940419f,
+    },
+    { // 2 Community Chest
+        0.00853441f, 0.00000000f, 0.00000703f, 0.00001608f, 0.03484530f, 0.06316352f, 0.08414513f, 0.04226044f,
+        0.14201550f, 0.17137131f, 0.15966667f, 0.12813238f, 0.10138350f, 0.06834598f, 0.04130900f, 0.02876338f,
+        0.01456002f, 0.01317957f, 0.01404562f, 0.01442330f, 0.01197997f, 0.01111058f, 0.00313414f, 0.00660955f,
+        0.01199780f, 0.00435886f, 0.00187275f, 0.00140657f, 0.00129798f, 0.00095647f, 0.00001608f, 0.00067515f,
+        0.00037776f, 0.00036562f, 0.00022773f, 0.00021969f, 0.00002813f, 0.00005894f, 0.00000804f, 0.00757447f,
+    },
+    { // 3 Baltic Avenue
+        0.00696942f, 0.00006393f, 0.00013910f, 0.00027427f, 0.00567427f, 0.03435291f, 0.05619289f, 0.03183236f,
+        0.11340351f, 0.14225765f, 0.18566909f, 0.15122164f, 0.12455558f, 0.09237658f, 0.06589001f, 0.04991523f,
+        0.01314274f, 0.01195584f, 0.01472229f, 0.01504233f, 0.01460725f, 0.01269389f, 0.00442731f, 0.00878078f,
+        0.01289672f, 0.00607308f, 0.00350557f, 0.00208971f, 0.00240391f, 0.00113828f, 0.00000301f, 0.00100424f,
+        0.00108595f, 0.00056979f, 0.00062597f, 0.00030697f, 0.00009325f, 0.00006481f, 0.00005942f, 0.00607413f,
+    },
+    { // 4 Income Tax
+        0.00520415f, 0.00000000f, 0.00000938f, 0.00002143f, 0.00350772f, 0.00430779f, 0.02783136f, 0.02085343f,
+        0.08415852f, 0.11269719f, 0.15268719f, 0.17560945f, 0.14940268f, 0.12056327f, 0.09434478f, 0.07530248f,
+        0.04131837f, 0.01284669f, 0.01456940f, 0.01581690f, 0.01404428f, 0.01389961f, 0.00452715f, 0.01111325f,
+        0.01253289f, 0.00801411f, 0.00434028f, 0.00320430f, 0.00251743f, 0.00127529f, 0.00002143f, 0.00102881f,
+        0.00063229f, 0.00066879f, 0.00046082f, 0.00049297f, 0.00008038f, 0.00019290f, 0.00005358f, 0.00429172f,
+    },
+    { // 5 Reading Railroad
+        0.00536128f, 0.00006393f, 0.00017945f, 0.00036285f, 0.00230501f, 0.00344551f, 0.00086239f, 0.01080407f,
+        0.05653214f, 0.08457415f, 0.12710209f, 0.14410890f, 0.17201337f, 0.14401216f, 0.11823331f, 0.09600186f,
+        0.06691672f, 0.03538580f, 0.01440355f, 0.01561769f, 0.01560935f, 0.01446483f, 0.00535150f, 0.01198777f,
+        0.01347106f, 0.00975027f, 0.00630800f, 0.00427057f, 0.00416614f, 0.00204116f, 0.00002713f, 0.00122125f,
+        0.00141817f, 0.00077539f, 0.00092336f, 0.00049183f, 0.00017865f, 0.00017733f, 0.00017195f, 0.00277438f,
+    },
+    { // 6 Oriental Avenue
+        0.00524831f, 0.00000000f, 0.00001172f, 0.00002679f, 0.00004437f, 0.00100361f, 0.00006698f, 0.00002512f,
+        0.02784476f, 0.05560914f, 0.09639867f, 0.11360032f, 0.14206992f, 0.17136596f, 0.14594452f, 0.12057700f,
+        0.09437559f, 0.05981211f, 0.04134918f, 0.01556681f, 0.01458682f, 0.01505969f, 0.00531734f, 0.01390228f,
+        0.01289248f, 0.01275442f, 0.00817955f, 0.00637378f, 0.00509388f, 0.00305159f, 0.00002679f, 0.00138246f,
+        0.00088681f, 0.00097196f, 0.00069391f, 0.00076625f, 0.00013262f, 0.00032686f, 0.00009913f, 0.00100495f,
+    },
+    { // 7 Chance
+        0.00710808f, 0.00004287f, 0.00008021f, 0.00010733f, 0.00017615f, 0.00129304f, 0.00026524f, 0.00012354f,
+        0.00027026f, 0.02800752f, 0.07204220f, 0.08521663f, 0.11283876f, 0.14199909f, 0.17140891f, 0.14594148f,
+        0.12061158f, 0.08256977f, 0.06839697f, 0.04212531f, 0.01450786f, 0.01423718f, 0.00551429f, 0.01349773f,
+        0.01421340f, 0.01326030f, 0.01064172f, 0.00794378f, 0.00726110f, 0.00429473f, 0.00002411f, 0.00189686f,
+        0.00149498f, 0.00080106f, 0.00111454f, 0.00061621f, 0.00027830f, 0.00036973f, 0.00041259f, 0.00114970f,
+    },
+    { // 8 Vermont Avenue
+        0.00866842f, 0.00008573f, 0.00005157f, 0.00007502f, 0.00005325f, 0.00108323f, 0.00008038f, 0.00003014f,
+        0.00008038f, 0.00006430f, 0.04640104f, 0.05655573f, 0.08424258f, 0.11268647f, 0.14207444f, 0.17138136f,
+        0.14597533f, 0.10550224f, 0.09440640f, 0.06927549f, 0.04136392f, 0.01467657f, 0.00552883f, 0.01506237f,
+        0.01500159f, 0.01558716f, 0.01184735f, 0.01082926f, 0.00894563f, 0.00619963f, 0.00003215f, 0.00319359f,
+        0.00191294f, 0.00127747f, 0.00092700f, 0.00108239f, 0.00020094f, 0.00054655f, 0.00023041f, 0.00122522f,
+    },
+    { // 9 Connecticut Avenue
+        0.01064575f, 0.00016075f, 0.00018369f, 0.00014484f, 0.00021365f, 0.00134093f, 0.00026524f, 0.00012354f,
+        0.00027026f, 0.00022974f, 0.02299804f, 0.02888980f, 0.05576377f, 0.08412872f, 0.11272406f, 0.14204059f,
+        0.17140891f, 0.12768454f, 0.12060890f, 0.09512828f, 0.06818263f, 0.04099151f, 0.00537330f, 0.01402285f,
+        0.01538722f, 0.01528174f, 0.01343879f, 0.01163570f, 0.01174404f, 0.00815276f, 0.00002411f, 0.00438314f,
+        0.00333826f, 0.00173011f, 0.00150034f, 0.00087341f, 0.00042113f, 0.00062157f, 0.00074481f, 0.00135365f,
+    },
+    { // 10 Jail / Just Visiting
+        0.01394398f, 0.00028511f, 0.00028047f, 0.00041835f, 0.00049222f, 0.00341604f, 0.00064233f, 0.00025933f,
+        0.00064094f, 0.00057862f, 0.02770150f, 0.00318935f, 0.02842489f, 0.05591642f, 0.08459244f, 0.11310656f,
+        0.14247113f, 0.15024579f, 0.14637603f, 0.12346574f, 0.09469456f, 0.06857911f, 0.01566226f, 0.01489963f,
+        0.01703854f, 0.01944922f, 0.01286210f, 0.01216618f, 0.01250327f, 0.00845150f, 0.00027596f, 0.00530681f,
+        0.00385268f, 0.00269680f, 0.00213201f, 0.00192173f, 0.00043514f, 0.00100455f, 0.00052603f, 0.00325915f,
+    },
+    { // 11 St. Charles Place
+        0.01427988f, 0.00036437f, 0.00039970f, 0.00026809f, 0.00033690f, 0.00481013f, 0.00030811f, 0.00012354f,
+        0.00027026f, 0.00022974f, 0.03080615f, 0.00449081f, 0.00023199f, 0.02780156f, 0.05562530f, 0.08417022f,
+        0.11272406f, 0.12426322f, 0.17140623f, 0.15005222f, 0.12039993f, 0.09402328f, 0.02550301f, 0.04078254f,
+        0.01839628f, 0.02251688f, 0.01460691f, 0.01369867f, 0.01789076f, 0.01183931f, 0.00002411f, 0.00824117f,
+        0.00655328f, 0.00393447f, 0.00334362f, 0.00190222f, 0.00056397f, 0.00087341f, 0.00111990f, 0.00497892f,
+    },
+    { // 12 Electric Company
+        0.01405896f, 0.00053628f, 0.00042559f, 0.00059768f, 0.00057079f, 0.00698318f, 0.00065874f, 0.00026571f,
+        0.00064663f, 0.00058431f, 0.03188043f, 0.00657518f, 0.00074416f, 0.00037159f, 0.02829751f, 0.05601791f,
+        0.08463032f, 0.09890124f, 0.14250201f, 0.17758660f, 0.14629036f, 0.12079640f, 0.03554720f, 0.06856904f,
+        0.04715710f, 0.02571584f, 0.01339525f, 0.01337181f, 0.01791924f, 0.01131019f, 0.00027060f, 0.00984803f,
+        0.00771874f, 0.00553326f, 0.00455935f, 0.00366588f, 0.00079370f, 0.00125874f, 0.00069951f, 0.00690938f,
+    },
+    { // 13 States Avenue
+        0.01468324f, 0.00061085f, 0.00069073f, 0.00047706f, 0.00059142f, 0.00854994f, 0.00043671f, 0.00013961f,
+        0.00031313f, 0.00022974f, 0.03362596f, 0.00787227f, 0.00034954f, 0.00002378f, 0.00006974f, 0.02784842f,
+        0.05562530f, 0.07361861f, 0.11272138f, 0.14941524f, 0.17120261f, 0.14559757f, 0.04508617f, 0.09381966f,
+        0.07546323f, 0.05580440f, 0.01423182f, 0.01421843f, 0.02231744f, 0.01389693f, 0.00002411f, 0.01192773f,
+        0.01105431f, 0.00741880f, 0.00655864f, 0.00438850f, 0.00125336f, 0.00189686f, 0.00149498f, 0.00860687f,
+    },
+    { // 14 Virginia Avenue
+        0.01436718f, 0.00083032f, 0.00060821f, 0.00086276f, 0.00074045f, 0.01086646f, 0.00076089f, 0.00030425f,
+        0.00069519f, 0.00063287f, 0.03462365f, 0.00996637f, 0.00093766f, 0.00038230f, 0.00055197f, 0.00048318f,
+        0.02833271f, 0.04894451f, 0.08465852f, 0.12213419f, 0.14241635f, 0.17159909f, 0.05488558f, 0.12078097f,
+        0.10355845f, 0.08585549f, 0.04016298f, 0.01303424f, 0.02170091f, 0.01253993f, 0.00026524f, 0.01267457f,
+        0.01141334f, 0.00957469f, 0.00835843f, 0.00678177f, 0.00169881f, 0.00297040f, 0.00164459f, 0.01056498f,
+    },
+    { // 15 Pennsylvania Railroad
+        0.01518306f, 0.00085734f, 0.00101926f, 0.00072891f, 0.00093703f, 0.01254963f, 0.00069391f, 0.00018784f,
+        0.00044173f, 0.00027261f, 0.03495614f, 0.01125642f, 0.00055818f, 0.00002378f, 0.00006974f, 0.00008672f,
+        0.00006974f, 0.02432431f, 0.05562262f, 0.09472037f, 0.11252312f, 0.14170203f, 0.06413885f, 0.14539931f,
+        0.13107538f, 0.11519252f, 0.06791195f, 0.04097276f, 0.02511250f, 0.01441133f, 0.00002411f, 0.01398534f,
+        0.01384066f, 0.01082811f, 0.01105967f, 0.00824653f, 0.00245715f, 0.00437779f, 0.00332755f, 0.01300911f,
+    },
+    { // 16 St. James Place
+        0.01206855f, 0.00112436f, 0.00079083f, 0.00117069f, 0.00096101f, 0.01163386f, 0.00094876f, 0.00039101f,
+        0.00082949f, 0.00076717f, 0.03248809f, 0.01002734f, 0.00122493f, 0.00039302f, 0.00058420f, 0.00052008f,
+        0.00058449f, 0.00033809f, 0.02835823f, 0.06480101f, 0.08457285f, 0.11291960f, 0.05342277f, 0.17157830f,
+        0.15512924f, 0.13760394f, 0.09320814f, 0.06675187f, 0.04825029f, 0.01222647f, 0.00025988f, 0.01387216f,
+        0.01347899f, 0.01219079f, 0.01198604f, 0.01118367f, 0.00311833f, 0.00605381f, 0.00404715f, 0.01230496f,
+    },
+    { // 17 Community Chest
+        0.01207874f, 0.00187543f, 0.00130510f, 0.00088681f, 0.00117064f, 0.00981444f, 0.00079840f, 0.00015975f,
+        0.00045546f, 0.00019826f, 0.02836562f, 0.00781644f, 0.00076842f, 0.00000000f, 0.00000670f, 0.00005325f,
+        0.00000670f, 0.00000000f, 0.00000670f, 0.03481909f, 0.05556225f, 0.08410494f, 0.04224788f, 0.14197531f,
+        0.17909934f, 0.15995883f, 0.12054184f, 0.09430727f, 0.07537122f, 0.04128086f, 0.00000000f, 0.01453189f,
+        0.01504630f, 0.01291125f, 0.01388889f, 0.01195988f, 0.00415424f, 0.00824653f, 0.00654793f, 0.01212188f,
+    },
+    { // 18 Tennessee Avenue
+        0.00846643f, 0.00112436f, 0.00078849f, 0.00116534f, 0.00095213f, 0.00802575f, 0.00093537f, 0.00038598f,
+        0.00081609f, 0.00075645f, 0.07750260f, 0.00643933f, 0.00195618f, 0.00038766f, 0.00132499f, 0.00051305f,
+        0.00132528f, 0.00033340f, 0.00132125f, 0.00566966f, 0.02898916f, 0.05581816f, 0.03199215f, 0.11289078f,
+        0.14764302f, 0.18128183f, 0.14479582f, 0.11900935f, 0.09774645f, 0.06596286f, 0.00025452f, 0.01351851f,
+        0.01322446f, 0.01188762f, 0.01175295f, 0.01091039f, 0.00306609f, 0.00591985f, 0.00400160f, 0.00867944f,
+    },
+    { // 19 New York Avenue
+        0.01205704f, 0.00435099f, 0.00290892f, 0.00191294f, 0.00157034f, 0.00704642f, 0.00118956f, 0.00025921f,
+        0.00080376f, 0.00041795f, 0.07909786f, 0.00456952f, 0.00108875f, 0.00004287f, 0.00005090f, 0.00008640f,
+        0.00000804f, 0.00000000f, 0.00000804f, 0.00347272f, 0.00000804f, 0.02777778f, 0.02083635f, 0.08410494f,
+        0.11703629f, 0.14892076f, 0.17133916f, 0.14587620f, 0.12401456f, 0.09430727f, 0.00000000f, 0.04128086f,
+        0.01466049f, 0.01352148f, 0.01504630f, 0.01401749f, 0.00519728f, 0.01192773f, 0.01103824f, 0.01259099f,
+    },
+    { // 20 Free Parking
+        0.00912185f, 0.00433336f, 0.00292960f, 0.00293343f, 0.00195485f, 0.00525921f, 0.00116611f, 0.00052030f,
+        0.00107363f, 0.00109436f, 0.12707654f, 0.00333342f, 0.00223122f, 0.00052162f, 0.00135857f, 0.00060855f,
+        0.00131331f, 0.00033809f, 0.00130660f, 0.00215600f, 0.00119674f, 0.00026796f, 0.01085392f, 0.05579201f,
+        0.08640133f, 0.11557503f, 0.14091369f, 0.16985490f, 0.14583655f, 0.11824713f, 0.00024916f, 0.06722811f,
+        0.03998147f, 0.01171402f, 0.01229415f, 0.01214013f, 0.00387475f, 0.00883179f, 0.00777590f, 0.00987546f,
+    },
+    { // 21 Kentucky Avenue
+        0.01445844f, 0.00772945f, 0.00542116f, 0.00419041f, 0.00335751f, 0.00488976f, 0.00176558f, 0.00045308f,
+        0.00138480f, 0.00084595f, 0.13155155f, 0.00149540f, 0.00151750f, 0.00017917f, 0.00022647f, 0.00021230f,
+        0.00010859f, 0.00001875f, 0.00006840f, 0.00001968f, 0.00006304f, 0.00000804f, 0.00002163f, 0.02778046f,
+        0.05656117f, 0.08411215f, 0.11265432f, 0.14197531f, 0.17134277f, 0.14587620f, 0.00000000f, 0.09430727f,
+        0.06832990f, 0.03697220f, 0.01466049f, 0.01444348f, 0.00556684f, 0.01370938f, 0.01344414f, 0.01243233f,
+    },
+    { // 22 Chance
+        0.01463035f, 0.00884332f, 0.00615461f, 0.00585854f, 0.00401893f, 0.00486049f, 0.00160651f, 0.00042543f,
+        0.00077060f, 0.00096082f, 0.18065871f, 0.00149582f, 0.00201823f, 0.00045546f, 0.00111094f, 0.00037975f,
+        0.00096894f, 0.00008439f, 0.00091268f, 0.00012151f, 0.00089928f, 0.00004019f, 0.00032718f, 0.00001340f,
+        0.02855206f, 0.05566462f, 0.08410494f, 0.11266772f, 0.14204324f, 0.17136596f, 0.00000000f, 0.12058203f,
+        0.09356246f, 0.05891975f, 0.03885084f, 0.01128740f, 0.00393481f, 0.00991398f, 0.00979711f, 0.01095183f,
+    },
+    { // 23 Indiana Avenue
+        0.02090006f, 0.01142672f, 0.00937095f, 0.00805647f, 0.00664805f, 0.00737621f, 0.00361690f, 0.00084993f,
+        0.00178132f, 0.00111387f, 0.18636618f, 0.00178157f, 0.00186127f, 0.00035064f, 0.00041402f, 0.00042764f,
+        0.00019432f, 0.00004236f, 0.00010323f, 0.00003977f, 0.00008448f, 0.00002679f, 0.00002967f, 0.00001608f,
+        0.00105869f, 0.02779303f, 0.05556091f, 0.08410762f, 0.11266195f, 0.14198067f, 0.00000000f, 0.14588424f,
+        0.12054720f, 0.08334614f, 0.06833258f, 0.04119513f, 0.00542401f, 0.01422915f, 0.01461227f, 0.01454302f,
+    },
+    { // 24 Illinois Avenue
+        0.02091312f, 0.01004807f, 0.00761244f, 0.00785922f, 0.00598670f, 0.01171649f, 0.00311834f, 0.00096324f,
+        0.00193497f, 0.00192013f, 0.18424336f, 0.00434828f, 0.00488429f, 0.00140090f, 0.00200785f, 0.00138883f,
+        0.00175777f, 0.00070207f, 0.00158965f, 0.00077342f, 0.00147176f, 0.00046270f, 0.00046835f, 0.00023696f,
+        0.00270746f, 0.00021755f, 0.02788780f, 0.05570760f, 0.08438083f, 0.11290366f, 0.00000033f, 0.17169332f,
+        0.14539278f, 0.10630391f, 0.09208020f, 0.06519961f, 0.01404383f, 0.00979809f, 0.01010065f, 0.01328147f,
+    },
+    { // 25 B&O Railroad
+        0.02920052f, 0.01349505f, 0.01182039f, 0.01175107f, 0.01131569f, 0.02146084f, 0.00683996f, 0.00179334f,
+        0.00363532f, 0.00215339f, 0.13518643f, 0.00553728f, 0.00571745f, 0.00056497f, 0.00068729f, 0.00091090f,
+        0.00040866f, 0.00014099f, 0.00022380f, 0.00010274f, 0.00014878f, 0.00004555f, 0.00003771f, 0.00002947f,
+        0.00458132f, 0.00002329f, 0.00001072f, 0.02778314f, 0.05556720f, 0.08411566f, 0.00000000f, 0.14199138f,
+        0.17134988f, 0.13140094f, 0.12054720f, 0.09422422f, 0.02555188f, 0.04098347f, 0.01423718f, 0.01858005f,
+    },
+    { // 26 Atlantic Avenue
+        0.02854094f, 0.01129724f, 0.00946097f, 0.01072075f, 0.00992055f, 0.02641803f, 0.00698943f, 0.00217287f,
+        0.00439680f, 0.00373628f, 0.13390188f, 0.00822639f, 0.00861144f, 0.00176526f, 0.00222478f, 0.00212152f,
+        0.00193451f, 0.00091774f, 0.00168333f, 0.00088694f, 0.00148239f, 0.00049752f, 0.00045827f, 0.00023428f,
+        0.00622672f, 0.00021419f, 0.00011002f, 0.00014937f, 0.02804931f, 0.05579953f, 0.00000033f, 0.11300044f,
+        0.14148653f, 0.15368833f, 0.14368932f, 0.11749460f, 0.03395196f, 0.06359376f, 0.03693067f, 0.01652276f,
+    },
+    { // 27 Ventnor Avenue
+        0.03238609f, 0.01402017f, 0.01284451f, 0.01381672f, 0.01435439f, 0.03518915f, 0.01134902f, 0.00325115f,
+        0.00686105f, 0.00465039f, 0.08347855f, 0.01006192f, 0.00956828f, 0.00077931f, 0.00100344f, 0.00160849f,
+        0.00070873f, 0.00031464f, 0.00047296f, 0.00025411f, 0.00029881f, 0.00010717f, 0.00006182f, 0.00004287f,
+        0.00810126f, 0.00003668f, 0.00001608f, 0.00000804f, 0.00001834f, 0.02779385f, 0.00000000f, 0.08412905f,
+        0.11267040f, 0.13083993f, 0.17134720f, 0.14579582f, 0.04513320f, 0.09401524f, 0.06791731f, 0.04884897f,
+    },
+    { // 28 Water Works
+        0.05545587f, 0.01100320f, 0.00995919f, 0.01195335f, 0.01230583f, 0.03921468f, 0.01068905f, 0.00386475f,
+        0.00823038f, 0.00692418f, 0.07961363f, 0.01355393f, 0.01309948f, 0.00212963f, 0.00244171f, 0.00305783f,
+        0.00215412f, 0.00120844f, 0.00186276f, 0.00113175f, 0.00157876f, 0.00061809f, 0.00046427f, 0.00027447f,
+        0.00973794f, 0.00021619f, 0.00011002f, 0.00014669f, 0.00026985f, 0.00023862f, 0.00000033f, 0.05589364f,
+        0.08361080f, 0.10519615f, 0.13982861f, 0.16837498f, 0.05331353f, 0.11593195f, 0.09003812f, 0.07381123f,
+    },
+    { // 29 Marvin Gardens
+        0.08606072f, 0.04077986f, 0.01251832f, 0.01433916f, 0.01575342f, 0.04701791f, 0.01414341f, 0.00464466f,
+        0.01137280f, 0.00851913f, 0.03111946f, 0.01595026f, 0.01477745f, 0.00176525f, 0.00131958f, 0.00228465f,
+        0.00105166f, 0.00052579f, 0.00080786f, 0.00049658f, 0.00057745f, 0.00025452f, 0.00011808f, 0.00009913f,
+        0.01157030f, 0.00006079f, 0.00002143f, 0.00001072f, 0.00003040f, 0.00002143f, 0.00000000f, 0.02780993f,
+        0.05557699f, 0.08297827f, 0.11266504f, 0.14189761f, 0.06418403f, 0.14558953f, 0.12013996f, 0.10530155f,
+    },
+    { // 30 Go To Jail
+        0.10945247f, 0.06655875f, 0.03430745f, 0.01204996f, 0.01332357f, 0.04091227f, 0.01296635f, 0.00501525f,
+        0.01190053f, 0.01129593f, 0.03289182f, 0.01674868f, 0.01485091f, 0.00380379f, 0.00264273f, 0.00379894f,
+        0.00167195f, 0.00152408f, 0.00137791f, 0.00140989f, 0.00105104f, 0.00085118f, 0.00023673f, 0.00038967f,
+        0.00992715f, 0.00017769f, 0.00011002f, 0.00014669f, 0.00023184f, 0.00023862f, 0.00000033f, 0.00033808f,
+        0.02805524f, 0.05658503f, 0.08427306f, 0.11281943f, 0.05331353f, 0.17148750f, 0.14559367f, 0.12951849f,
+    },
+    { // 31 Pacific Avenue
+        0.13438869f, 0.09381698f, 0.05949044f, 0.04109617f, 0.01550744f, 0.03668179f, 0.01530886f, 0.00542731f,
+        0.01416987f, 0.01221641f, 0.03171276f, 0.01627394f, 0.01441391f, 0.00420866f, 0.00309320f, 0.00352880f,
+        0.00139460f, 0.00073694f, 0.00118562f, 0.00078995f, 0.00094182f, 0.00048761f, 0.00022257f, 0.00024113f,
+        0.00818867f, 0.00014385f, 0.00006966f, 0.00001340f, 0.00005049f, 0.00002679f, 0.00000000f, 0.00004019f,
+        0.00002679f, 0.03047961f, 0.05556895f, 0.08402992f, 0.04217906f, 0.14169399f, 0.17094800f, 0.15336024f,
+    },
+    { // 32 North Carolina Avenue
+        0.15715217f, 0.11881958f, 0.08073760f, 0.06578920f, 0.04018621f, 0.02980407f, 0.01349382f, 0.00545462f,
+        0.01394441f, 0.01407659f, 0.03262160f, 0.01770798f, 0.01514368f, 0.00700809f, 0.00510750f, 0.00577545f,
+        0.00268192f, 0.00185228f, 0.00161895f, 0.00179518f, 0.00129476f, 0.00118607f, 0.00031406f, 0.00064420f,
+        0.00652491f, 0.00033207f, 0.00015289f, 0.00018688f, 0.00024205f, 0.00023326f, 0.00000033f, 0.00033004f,
+        0.00027211f, 0.00480382f, 0.02794322f, 0.05571798f, 0.03160322f, 0.11280032f, 0.14168809f, 0.17680708f,
+    },
+    { // 33 Community Chest
+        0.18365077f, 0.14587620f, 0.10548817f, 0.09434210f, 0.06929558f, 0.05273814f, 0.01474623f, 0.00553687f,
+        0.01514811f, 0.01411930f, 0.03096810f, 0.01634143f, 0.01525778f, 0.00801612f, 0.00619293f, 0.00598764f,
+        0.00313866f, 0.00161253f, 0.00150436f, 0.00106891f, 0.00129003f, 0.00075017f, 0.00033741f, 0.00045546f,
+        0.00492007f, 0.00030526f, 0.00019290f, 0.00005358f, 0.00010976f, 0.00003215f, 0.00000000f, 0.00004823f,
+        0.00003215f, 0.00306633f, 0.00001608f, 0.02779385f, 0.02083333f, 0.08410494f, 0.11265432f, 0.14641848f,
+    },
+    { // 34 Pennsylvania Avenue
+        0.15286298f, 0.16966580f, 0.12589246f, 0.11807096f, 0.09322983f, 0.07294666f, 0.04025585f, 0.00531528f,
+        0.01444508f, 0.01522831f, 0.03420338f, 0.01695528f, 0.01526499f, 0.01149840f, 0.00894400f, 0.00893079f,
+        0.00514936f, 0.00345577f, 0.00263160f, 0.00218316f, 0.00153848f, 0.00156384f, 0.00040747f, 0.00098445f,
+        0.00321108f, 0.00062040f, 0.00028149f, 0.00031280f, 0.00029781f, 0.00027077f, 0.00000033f, 0.00032201f,
+        0.00026675f, 0.00171811f, 0.00016276f, 0.00015975f, 0.01047160f, 0.05569921f, 0.08381303f, 0.11461617f,
+    },
+    { // 35 Short Line Railroad
+        0.12637462f, 0.14203924f, 0.15007024f, 0.14616119f, 0.12356304f, 0.09758366f, 0.06899939f, 0.01581754f,
+        0.01545255f, 0.01485710f, 0.03498108f, 0.01601060f, 0.01505667f, 0.00985772f, 0.00838401f, 0.01138723f,
+        0.00491229f, 0.00301607f, 0.00303033f, 0.00241534f, 0.00236874f, 0.00173067f, 0.00074477f, 0.00124692f,
+        0.00387524f, 0.00088082f, 0.00061205f, 0.00036432f, 0.00045078f, 0.00030237f, 0.00000301f, 0.00039338f,
+        0.00033578f, 0.00024159f, 0.00020801f, 0.00014622f, 0.00002895f, 0.02779972f, 0.05557211f, 0.08688033f,
+    },
+    { // 36 Chance
+        0.09771535f, 0.11265432f, 0.12428717f, 0.17144114f, 0.15020240f, 0.12486754f, 0.09426976f, 0.02559939f,
+        0.04103940f, 0.01425259f, 0.03385113f, 0.01905268f, 0.01807803f, 0.01366618f, 0.01190638f, 0.01960725f,
+        0.00830823f, 0.00575438f, 0.00444753f, 0.00341831f, 0.00196125f, 0.00151910f, 0.00035218f, 0.00114401f,
+        0.00496067f, 0.00088347f, 0.00038580f, 0.00042867f, 0.00023008f, 0.00017147f, 0.00000000f, 0.00004287f,
+        0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.02777778f, 0.05987858f,
+    },
+    { // 37 Park Place
+        0.06918543f, 0.08416887f, 0.09871866f, 0.14225762f, 0.17766866f, 0.15248298f, 0.12120328f, 0.03569139f,
+        0.06911124f, 0.04159535f, 0.03464132f, 0.01987415f, 0.01956791f, 0.01195820f, 0.01124002f, 0.02174395f,
+        0.00945618f, 0.00641378f, 0.00625339f, 0.00490497f, 0.00418523f, 0.00273537f, 0.00087773f, 0.00148001f,
+        0.00757000f, 0.00116616f, 0.00093891f, 0.00057062f, 0.00072205f, 0.00042561f, 0.00000301f, 0.00042821f,
+        0.00037329f, 0.00023690f, 0.00020533f, 0.00014354f, 0.00002895f, 0.00002194f, 0.00001656f, 0.03388892f,
+    },
+    { // 38 Luxury Tax
+        0.04138505f, 0.05555556f, 0.07364490f, 0.11275898f, 0.14957112f, 0.17900648f, 0.14585209f, 0.04518456f,
+        0.09408456f, 0.06794343f, 0.06070429f, 0.02201250f, 0.02187075f, 0.01483431f, 0.01397203f, 0.02892746f,
+        0.01200283f, 0.00969747f, 0.00831359f, 0.00670332f, 0.00445289f, 0.00336505f, 0.00074803f, 0.00153249f,
+        0.00855279f, 0.00137711f, 0.00062425f, 0.00072606f, 0.00046886f, 0.00036169f, 0.00000536f, 0.00013932f,
+        0.00004019f, 0.00003357f, 0.00001875f, 0.00001608f, 0.00000402f, 0.00000536f, 0.00000268f, 0.00765526f,
+    },
+    { // 39 Boardwalk
+        0.01363054f, 0.02784171f, 0.04875490f, 0.08438457f, 0.12220101f, 0.15191248f, 0.17199257f, 0.05501868f,
+        0.12131246f, 0.09461104f, 0.08857648f, 0.04997227f, 0.02244485f, 0.01251547f, 0.01246708f, 0.03028954f,
+        0.01228540f, 0.00966145f, 0.01076245f, 0.00885743f, 0.00737345f, 0.00519754f, 0.00155724f, 0.00248470f,
+        0.01126476f, 0.00163368f, 0.00130864f, 0.00081978f, 0.00117014f, 0.00063459f, 0.00000301f, 0.00054877f,
+        0.00049653f, 0.00026972f, 0.00024552f, 0.00014086f, 0.00002895f, 0.00002194f, 0.00001656f, 0.00944689f,
+    },
+    { // In jail
+        0.00173611f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00173611f, 0.00000000f, 0.00000000f,
+        0.00000000f, 0.00000000f, 0.83506944f, 0.00173611f, 0.02777778f, 0.00000000f, 0.02777778f, 0.00000000f,
+        0.02777778f, 0.00000000f, 0.02777778f, 0.00173611f, 0.02777778f, 0.00000000f, 0.01041667f, 0.00000000f,
+        0.00173611f, 0.00347222f, 0.00000000f, 0.00000000f, 0.00173611f, 0.00000000f, 0.00000000f, 0.00000000f,
+        0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00000000f, 0.00173611f,
+    },
+};
+
+#endif // LANDING_TABLE_H
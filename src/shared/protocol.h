@@ -54,7 +54,7 @@ typedef enum {
     MSG_ERROR = 101,
     MSG_INVALID_MOVE = 102,
     MSG_NOT_YOUR_TURN = 103,
-    MSG_HEARTBEAT = 104,
+    MSG_HEARTBEAT = 104,     // Either way; the server's carry a time to echo in the ACK
     MSG_HEARTBEAT_ACK = 105
 } MessageType;
 